@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Registers a pvclock page and compares the cost of reading time through
+// rdtime, CLINT mtime MMIO and the paravirtual clock.
+
+#include <stdint.h>
+
+#define CLINT_MTIME 0x0200BFF8
+#define TEST_BASE 0x00100000
+#define PVCLOCK_BASE 0x10005000
+#define CONSOLE_BASE 0x10008000
+
+#define PVCLOCK_MAGIC 0x6b637670
+#define TIMEBASE_HZ 10000000ULL
+#define NS_PER_TICK (1000000000ULL / TIMEBASE_HZ)
+
+#define ITERATIONS 100000
+
+struct pvclock_info {
+    volatile uint32_t version;
+    uint32_t pad0;
+    volatile uint64_t cycle_timestamp;
+    volatile uint64_t system_time;
+    volatile uint32_t cycle_to_system_mul;
+    volatile int8_t cycle_shift;
+    volatile uint8_t flags;
+    uint8_t pad[2];
+};
+
+static struct pvclock_info pvti __attribute__((aligned(32)));
+
+#define read_csr(reg)                                                          \
+    ({                                                                         \
+        uint64_t __tmp;                                                        \
+        asm volatile("csrr %0, " #reg : "=r"(__tmp));                          \
+        __tmp;                                                                 \
+    })
+
+#define barrier() asm volatile("fence r, r" ::: "memory")
+
+static void putchar(char c) { *(volatile char*)CONSOLE_BASE = c; }
+
+static void puts(const char* s) {
+    while (*s)
+        putchar(*s++);
+}
+
+static void print_dec(uint64_t val) {
+    char buf[21];
+    int i = 20;
+
+    buf[i] = '\0';
+    do {
+        buf[--i] = '0' + (val % 10);
+        val /= 10;
+    } while (val);
+
+    puts(&buf[i]);
+}
+
+static inline uint64_t rdtime_ns(void) {
+    return read_csr(time) * NS_PER_TICK;
+}
+
+static inline uint64_t mmio_ns(void) {
+    return *(volatile uint64_t*)CLINT_MTIME * NS_PER_TICK;
+}
+
+static inline uint64_t pvclock_ns(void) {
+    uint32_t version;
+    uint64_t ns;
+
+    do {
+        version = pvti.version;
+        barrier();
+
+        uint64_t delta = read_csr(time) - pvti.cycle_timestamp;
+        int8_t shift = pvti.cycle_shift;
+        delta = shift >= 0 ? delta << shift : delta >> -shift;
+        ns = pvti.system_time +
+             (uint64_t)(((unsigned __int128)delta * pvti.cycle_to_system_mul) >>
+                        32);
+
+        barrier();
+    } while ((version & 1) || version != pvti.version);
+
+    return ns;
+}
+
+static void bench(const char* name, uint64_t (*clock)(void)) {
+    volatile uint64_t sink = 0;
+    uint64_t insns = read_csr(minstret);
+    uint64_t start = rdtime_ns();
+
+    for (int i = 0; i < ITERATIONS; i++)
+        sink += clock();
+
+    uint64_t elapsed = rdtime_ns() - start;
+    insns = read_csr(minstret) - insns;
+
+    puts(name);
+    puts(": ");
+    print_dec(elapsed / ITERATIONS);
+    puts(" ns/read, ");
+    print_dec(insns / ITERATIONS);
+    puts(" insns/read\n");
+}
+
+int main(void) {
+    if (*(volatile uint32_t*)PVCLOCK_BASE != PVCLOCK_MAGIC) {
+        puts("pvclock device not found\n");
+        *(volatile uint32_t*)TEST_BASE = 0x3333 | (1 << 16);
+        return 1;
+    }
+
+    *(volatile uint64_t*)(PVCLOCK_BASE + 8) = (uint64_t)&pvti | 1;
+
+    bench("rdtime ", rdtime_ns);
+    bench("mmio   ", mmio_ns);
+    bench("pvclock", pvclock_ns);
+
+    // Check that pvclock agrees with rdtime and is monotonic.
+    uint64_t prev = 0, max_skew = 0;
+    for (int i = 0; i < ITERATIONS; i++) {
+        uint64_t pv = pvclock_ns();
+        uint64_t rt = rdtime_ns();
+
+        if (pv < prev) {
+            puts("pvclock went backwards\n");
+            *(volatile uint32_t*)TEST_BASE = 0x3333 | (1 << 16);
+            return 1;
+        }
+        prev = pv;
+
+        uint64_t skew = pv > rt ? pv - rt : rt - pv;
+        if (skew > max_skew)
+            max_skew = skew;
+    }
+
+    puts("max skew vs rdtime: ");
+    print_dec(max_skew);
+    puts(" ns\n");
+
+    *(volatile uint32_t*)TEST_BASE = 0x5555;
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+namespace uemu {
+
+// Bounded wait-free single-producer/single-consumer ring. One slot is kept
+// free, so the usable capacity is N - 1.
+template <typename T, size_t N> class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+    // Returns false (dropping `value`) if the queue is full.
+    bool push(const T& value) noexcept {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) & (N - 1);
+
+        if (next == head_.load(std::memory_order_acquire)) [[unlikely]]
+            return false;
+
+        slots_[tail] = value;
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> pop() noexcept {
+        const size_t head = head_.load(std::memory_order_relaxed);
+
+        if (head == tail_.load(std::memory_order_acquire))
+            return std::nullopt;
+
+        T value = slots_[head];
+        head_.store((head + 1) & (N - 1), std::memory_order_release);
+        return value;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0}; // Consumer-owned
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0}; // Producer-owned
+    alignas(CACHE_LINE) std::array<T, N> slots_{};
+};
+
+} // namespace uemu
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace uemu {
+
+// Event counter with a single writing thread that any thread may read.
+// Relaxed load/store instead of fetch_add keeps an increment as cheap as a
+// plain one, while readers never see a torn value.
+class StatCounter {
+public:
+    StatCounter() = default;
+    StatCounter(const StatCounter& other) noexcept : value_(other.get()) {}
+
+    StatCounter& operator=(const StatCounter& other) noexcept {
+        value_.store(other.get(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    void add(uint64_t n = 1) noexcept {
+        value_.store(value_.load(std::memory_order_relaxed) + n,
+                     std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t get() const noexcept {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+// Event counter that several threads write, such as a device accessed by
+// both the CPU thread and the device thread.
+class SharedStatCounter {
+public:
+    SharedStatCounter() = default;
+    SharedStatCounter(const SharedStatCounter& other) noexcept
+        : value_(other.get()) {}
+
+    SharedStatCounter& operator=(const SharedStatCounter& other) noexcept {
+        value_.store(other.get(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    void add(uint64_t n = 1) noexcept {
+        value_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t get() const noexcept {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+} // namespace uemu
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <format>
+#include <functional>
 #include <print>
 #include <stdexcept>
 #include <vector>
@@ -25,11 +26,16 @@
 #include "core/dram.hpp"
 #include "device/device.hpp"
 
+namespace uemu::profile {
+class MmioProfiler;
+} // namespace uemu::profile
+
 namespace uemu::core {
 
 class Bus {
 public:
-    explicit Bus(std::shared_ptr<Dram> dram) : dram_(std::move(dram)) {}
+    explicit Bus(std::shared_ptr<Dram> dram, bool verbose = true)
+        : dram_(std::move(dram)), verbose_(verbose) {}
 
     // Register a memory-mapped device.
     // Device address range must not overlap DRAM or existing devices.
@@ -58,8 +64,9 @@ public:
             }
         }
 
-        std::println("Bus: Add device '{}' [{:#x}-{:#x}]", dev->name(),
-                     dev->start(), dev->end());
+        if (verbose_)
+            std::println("Bus: Add device '{}' [{:#x}-{:#x}]", dev->name(),
+                         dev->start(), dev->end());
 
         devices_.push_back(std::move(dev));
     }
@@ -72,9 +79,14 @@ public:
         if (dram_->is_valid_addr(addr, sizeof(T))) [[likely]]
             return dram_->read<T>(addr);
 
-        for (const auto& dev : devices_)
-            if (dev->contains(addr, sizeof(T)))
-                return dev->read<T>(addr);
+        for (const auto& dev : devices_) {
+            if (!dev->contains(addr, sizeof(T)))
+                continue;
+            if (mmio_profiler_) [[unlikely]]
+                return timed_read(*dev, addr, sizeof(T))
+                    .transform([](uint64_t v) { return static_cast<T>(v); });
+            return dev->read<T>(addr);
+        }
 
         return std::nullopt;
     }
@@ -86,16 +98,35 @@ public:
     [[nodiscard]] bool write(addr_t addr, T value) noexcept {
         if (dram_->is_valid_addr(addr, sizeof(T))) [[likely]] {
             dram_->write<T>(addr, value);
+            if ((addr & ~WATCH_PAGE_MASK) == watch_page_) [[unlikely]]
+                watch_callback_(addr);
             return true;
         }
 
-        for (const auto& dev : devices_)
-            if (dev->contains(addr, sizeof(T)))
-                return dev->write<T>(addr, value);
+        for (const auto& dev : devices_) {
+            if (!dev->contains(addr, sizeof(T)))
+                continue;
+            if (mmio_profiler_) [[unlikely]]
+                return timed_write(*dev, addr, sizeof(T),
+                                   static_cast<uint64_t>(value));
+            return dev->write<T>(addr, value);
+        }
 
         return false;
     }
 
+    // Call `callback` after every store to the DRAM page containing `addr`,
+    // for mailboxes kept in plain memory such as HTIF's tohost.
+    void watch_page(addr_t addr, std::function<void(addr_t)> callback) {
+        watch_page_ = addr & ~WATCH_PAGE_MASK;
+        watch_callback_ = std::move(callback);
+    }
+
+    // Time every device access; nullptr turns profiling off.
+    void set_mmio_profiler(profile::MmioProfiler* profiler) noexcept {
+        mmio_profiler_ = profiler;
+    }
+
     // Check if a byte at 'addr' is accessible.
     bool accessible(addr_t addr) {
         if (dram_->is_valid_addr(addr)) [[likely]]
@@ -105,18 +136,36 @@ public:
             devices_, [addr](const auto& dev) { return dev->contains(addr); });
     }
 
+    [[nodiscard]] const std::vector<std::shared_ptr<device::Device>>&
+    devices() const noexcept {
+        return devices_;
+    }
+
     void tick_devices() {
         for (auto& dev : devices_)
             dev->tick();
     }
 
 private:
+    static constexpr addr_t WATCH_PAGE_MASK = 0xFFF;
+
     static bool check_overlap(addr_t s1, addr_t e1, addr_t s2, addr_t e2) {
         return std::max(s1, s2) <= std::min(e1, e2);
     }
 
+    // Device accesses while the MMIO profiler is on, kept out of line
+    std::optional<uint64_t> timed_read(device::Device& dev, addr_t addr,
+                                       size_t size) noexcept;
+    bool timed_write(device::Device& dev, addr_t addr, size_t size,
+                     uint64_t value) noexcept;
+
     std::shared_ptr<Dram> dram_;
     std::vector<std::shared_ptr<device::Device>> devices_;
+    bool verbose_;
+    profile::MmioProfiler* mmio_profiler_ = nullptr;
+
+    addr_t watch_page_ = ~addr_t{0}; // Never page aligned: nothing watched
+    std::function<void(addr_t)> watch_callback_;
 };
 
 } // namespace uemu::core
@@ -16,8 +16,13 @@
 
 #pragma once
 
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <cstring>
+#include <exception>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <string>
 
@@ -29,7 +34,10 @@ class Dram {
 public:
     static constexpr addr_t DRAM_BASE = 0x80000000;
 
-    explicit Dram(size_t size) : mem_(new uint8_t[size]()), size_(size) {}
+    // Backed by an anonymous mapping: pages are zero and only committed
+    // once the guest touches them.
+    explicit Dram(size_t size)
+        : mem_(map_anonymous(size), Unmap{size}), size_(size) {}
 
     Dram(const Dram&) = delete;
     Dram& operator=(const Dram&) = delete;
@@ -80,8 +88,60 @@ public:
         std::memcpy(dst, mem_.get() + (addr - DRAM_BASE), len);
     }
 
+    void fill(addr_t addr, uint8_t value, size_t len) {
+        if (!is_valid_addr(addr, len))
+            throw std::out_of_range(
+                "Memory fill out of bounds at address 0x" +
+                std::to_string(addr) + ", length " + std::to_string(len));
+
+        std::memset(mem_.get() + (addr - DRAM_BASE), value, len);
+    }
+
+    // Map `len` bytes of `fd` at `offset` copy-on-write at `addr`, replacing
+    // what was there. Needs `addr`, `offset` and `len` aligned to the host
+    // page size; returns false (and changes nothing) otherwise. A failed
+    // mmap also returns false, but may already have dropped the old pages:
+    // the range is then zero-filled and the caller must copy into it.
+    // Pages the guest has not written yet keep following the file: changing
+    // it shows through, and truncating it makes the next access SIGBUS.
+    [[nodiscard]] bool map_file(addr_t addr, int fd, uint64_t offset,
+                                size_t len) noexcept {
+        const auto page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+
+        if (!is_valid_addr(addr, len) || len == 0 ||
+            ((addr - DRAM_BASE) | offset | len) % page != 0)
+            return false;
+
+        uint8_t* dst = mem_.get() + (addr - DRAM_BASE);
+
+        if (::mmap(dst, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+                   fd, static_cast<off_t>(offset)) != MAP_FAILED)
+            return true;
+
+        // A failed MAP_FIXED may already have unmapped the range; put zero
+        // pages back so guest memory never has a hole.
+        if (::mmap(dst, len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1,
+                   0) == MAP_FAILED)
+            std::terminate();
+        return false;
+    }
+
 private:
-    std::unique_ptr<uint8_t[]> mem_;
+    struct Unmap {
+        size_t size;
+        void operator()(uint8_t* p) const noexcept { ::munmap(p, size); }
+    };
+
+    static uint8_t* map_anonymous(size_t size) {
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+        return static_cast<uint8_t*>(p);
+    }
+
+    std::unique_ptr<uint8_t, Unmap> mem_;
     size_t size_;
 };
 
@@ -24,14 +24,24 @@
 #include <memory>
 
 #include "common/float.hpp"
+#include "common/stat_counter.hpp"
 #include "core/dram.hpp"
+#include "profile/irq_latency.hpp"
 
 namespace uemu::device {
 class Clint;
-}
+class Imsic;
+} // namespace uemu::device
+
+namespace uemu::profile {
+class RegionProfiler;
+} // namespace uemu::profile
 
 namespace uemu::core {
 
+class Sbi;
+class LinuxUser;
+
 enum class PrivilegeLevel : uint8_t {
     U = 0, // User mode
     S = 1, // Supervisor mode
@@ -148,6 +158,22 @@ private:
 
 class MMU;
 
+// Emulator self-statistics of one hart, written only by its CPU thread.
+// Kept on their own cache lines, apart from the architectural state.
+struct alignas(64) HartStats {
+    static constexpr size_t CAUSES = 64;
+
+    StatCounter instructions; // Retired, i.e. minstret without CSR writes
+    StatCounter itlb_hits;
+    StatCounter itlb_misses;
+    StatCounter dtlb_hits;
+    StatCounter dtlb_misses;
+    StatCounter page_walks;
+    std::array<StatCounter, CAUSES> exceptions; // By cause code
+    std::array<StatCounter, CAUSES> interrupts;
+    StatCounter wfi_ns; // Time stalled in WFI
+};
+
 class Hart {
 public:
     static constexpr size_t GPR_COUNT = 32;
@@ -176,12 +202,54 @@ public:
     // Reset to false by check_interrupts().
     mutable bool interrupt_check_pending;
 
+    HartStats stats;
+
     device::Clint* get_clint() const noexcept { return clint_; }
 
     void set_clint(device::Clint* c) noexcept { clint_ = c; }
 
+    device::Imsic* get_imsic(bool mmode) const noexcept {
+        return mmode ? m_imsic_ : s_imsic_;
+    }
+
+    void set_imsic(bool mmode, device::Imsic* imsic) noexcept {
+        (mmode ? m_imsic_ : s_imsic_) = imsic;
+    }
+
+    // Non-null when S-mode ecalls are serviced by the emulator itself.
+    Sbi* get_sbi() const noexcept { return sbi_; }
+
+    void set_sbi(Sbi* sbi) noexcept { sbi_ = sbi; }
+
+    // Non-null when U-mode ecalls and faults go to the Linux personality.
+    LinuxUser* get_linux_user() const noexcept { return linux_user_; }
+
+    void set_linux_user(LinuxUser* user) noexcept { linux_user_ = user; }
+
+    // Non-null while interrupt and trap latency is being measured.
+    profile::IrqLatency* get_irq_latency() const noexcept {
+        return irq_latency_;
+    }
+
+    void set_irq_latency(profile::IrqLatency* l) noexcept { irq_latency_ = l; }
+
+    // Non-null while guest benchmark regions are being recorded.
+    profile::RegionProfiler* get_region_profiler() const noexcept {
+        return region_profiler_;
+    }
+
+    void set_region_profiler(profile::RegionProfiler* p) noexcept {
+        region_profiler_ = p;
+    }
+
 private:
     device::Clint* clint_;
+    device::Imsic* m_imsic_;
+    device::Imsic* s_imsic_;
+    Sbi* sbi_;
+    LinuxUser* linux_user_;
+    profile::IrqLatency* irq_latency_;
+    profile::RegionProfiler* region_profiler_;
 
     template <typename T>
     void add_csr() {
@@ -599,10 +667,14 @@ public:
             new_val = (old_val & ~write_mask) | (v & write_mask);
         } while (!value_atomic_.compare_exchange_weak(
             old_val, new_val, std::memory_order_relaxed));
+
+        report_raised(old_val, new_val);
     }
 
     void set_pending(reg_t mask) noexcept {
-        value_atomic_.fetch_or(mask & read_mask_, std::memory_order_relaxed);
+        const reg_t old_val = value_atomic_.fetch_or(mask & read_mask_,
+                                                     std::memory_order_relaxed);
+        report_raised(old_val, old_val | (mask & read_mask_));
     }
 
     void clear_pending(reg_t mask) noexcept {
@@ -616,6 +688,12 @@ private:
 
     static constexpr reg_t write_mask_ = Field::SSIP | Field::SEIP;
 
+    void report_raised(reg_t old_val, reg_t new_val) const noexcept {
+        auto* latency = hart_->get_irq_latency();
+        if (latency && (new_val & ~old_val)) [[unlikely]]
+            latency->pending(new_val & ~old_val);
+    }
+
     std::atomic<reg_t> value_atomic_;
     MENVCFG* menvcfg_;
 };
@@ -692,15 +770,26 @@ public:
         assert(mcountinhibit_);
     }
 
+    // Atomic so that it can be sampled off the cpu thread.
+    [[nodiscard]] reg_t read_unchecked() const noexcept override {
+        return value_atomic_.load(std::memory_order_relaxed);
+    }
+
+    void write_unchecked(reg_t v) noexcept override {
+        value_atomic_.store(v, std::memory_order_relaxed);
+    }
+
     void advance() noexcept {
         if (mcountinhibit_->read_unchecked() & MCOUNTINHIBIT::Field::CY)
             return;
 
-        value_++;
+        value_atomic_.store(value_atomic_.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
     }
 
 private:
     MCOUNTINHIBIT* mcountinhibit_;
+    std::atomic<reg_t> value_atomic_{0};
 };
 
 class MINSTRET final : public CSR {
@@ -822,6 +911,70 @@ public:
     MTVAL(Hart* hart) : CSR(hart, PrivilegeLevel::M, 0) {}
 };
 
+// AIA indirect register select (miselect / siselect).
+class ISELECTCSR : public CSR {
+public:
+    ISELECTCSR(Hart* hart, PrivilegeLevel min_priv) : CSR(hart, min_priv, 0) {}
+
+    void write_unchecked(reg_t v) noexcept override { value_ = v & 0xFFF; }
+};
+
+// AIA indirect register alias (mireg / sireg). Only the IMSIC interrupt file
+// registers are implemented; any other *iselect value raises an illegal
+// instruction exception.
+class IREGCSR : public CSR {
+public:
+    IREGCSR(Hart* hart, PrivilegeLevel min_priv, size_t iselect_address)
+        : CSR(hart, min_priv, 0),
+          iselect_(hart_->csrs[iselect_address].get()) {
+        assert(iselect_);
+    }
+
+    [[nodiscard]] reg_t read_unchecked() const noexcept override;
+    void write_unchecked(reg_t v) noexcept override;
+
+protected:
+    [[nodiscard]] bool check_permissions() const noexcept override;
+
+private:
+    CSR* iselect_;
+};
+
+// AIA top external interrupt (mtopei / stopei). A write of any value claims
+// the reported interrupt identity.
+class TOPEICSR : public CSR {
+public:
+    TOPEICSR(Hart* hart, PrivilegeLevel min_priv) : CSR(hart, min_priv, 0) {}
+
+    [[nodiscard]] reg_t read_unchecked() const noexcept override;
+    void write_unchecked(reg_t v) noexcept override;
+
+protected:
+    [[nodiscard]] bool check_permissions() const noexcept override;
+};
+
+class MISELECT final : public ISELECTCSR {
+public:
+    static constexpr size_t ADDRESS = 0x350;
+
+    MISELECT(Hart* hart) : ISELECTCSR(hart, PrivilegeLevel::M) {}
+};
+
+class MIREG final : public IREGCSR {
+public:
+    static constexpr size_t ADDRESS = 0x351;
+
+    MIREG(Hart* hart)
+        : IREGCSR(hart, PrivilegeLevel::M, MISELECT::ADDRESS) {}
+};
+
+class MTOPEI final : public TOPEICSR {
+public:
+    static constexpr size_t ADDRESS = 0x35C;
+
+    MTOPEI(Hart* hart) : TOPEICSR(hart, PrivilegeLevel::M) {}
+};
+
 class MCONFIGPTR final : public ConstCSR {
 public:
     static constexpr size_t ADDRESS = 0xF15;
@@ -1027,6 +1180,28 @@ public:
     STVAL(Hart* hart) : CSR(hart, PrivilegeLevel::S, 0) {}
 };
 
+class SISELECT final : public ISELECTCSR {
+public:
+    static constexpr size_t ADDRESS = 0x150;
+
+    SISELECT(Hart* hart) : ISELECTCSR(hart, PrivilegeLevel::S) {}
+};
+
+class SIREG final : public IREGCSR {
+public:
+    static constexpr size_t ADDRESS = 0x151;
+
+    SIREG(Hart* hart)
+        : IREGCSR(hart, PrivilegeLevel::S, SISELECT::ADDRESS) {}
+};
+
+class STOPEI final : public TOPEICSR {
+public:
+    static constexpr size_t ADDRESS = 0x15C;
+
+    STOPEI(Hart* hart) : TOPEICSR(hart, PrivilegeLevel::S) {}
+};
+
 class SENVCFG final : public CSR {
 public:
     static constexpr size_t ADDRESS = 0x10A;
@@ -1099,6 +1274,11 @@ public:
 
     void write_unchecked(reg_t v) noexcept override;
 
+    // For the CLINT, which re-checks the deadline if it moves under it.
+    [[nodiscard]] const std::atomic<reg_t>& deadline() const noexcept {
+        return value_atomic_;
+    }
+
 protected:
     [[nodiscard]] bool check_permissions() const noexcept override {
         if (hart_->priv == PrivilegeLevel::M)
@@ -1223,6 +1403,25 @@ public:
                              HPMCOUNTERN::MIN_ADDRESS) {}
 };
 
+// Benchmark region markers in the custom user read/write CSR space:
+// `csrw 0x8c0, id` begins region `id` and `csrw 0x8c1, id` ends it.
+// Reads return 0; writes are ignored unless a RegionProfiler is attached.
+class REGIONMARKER final : public CSR {
+public:
+    static constexpr size_t BEGIN_ADDRESS = 0x8C0;
+    static constexpr size_t END_ADDRESS = 0x8C1;
+
+    REGIONMARKER(Hart* hart, size_t address)
+        : CSR(hart, PrivilegeLevel::U, 0), begin_(address == BEGIN_ADDRESS) {}
+
+    [[nodiscard]] reg_t read_unchecked() const noexcept override { return 0; }
+
+    void write_unchecked(reg_t v) noexcept override;
+
+private:
+    bool begin_;
+};
+
 class FFLAGS final : public CSR {
 public:
     static constexpr size_t ADDRESS = 0x001;
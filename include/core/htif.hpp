@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/dram.hpp"
+
+namespace uemu::core {
+
+class Bus;
+
+// Berkeley Host-Target Interface, as used by riscv-tests, riscv-pk and
+// libgloss-htif. The target writes a command to the `tohost` doubleword;
+// replies go to `fromhost`. Both live in ordinary DRAM, so commands are
+// picked up by watching stores to the tohost page rather than by polling.
+class Htif {
+public:
+    // tohost layout: device[63:56] | command[55:48] | payload[47:0]
+    static constexpr uint8_t DEV_SYSCALL = 0;
+    static constexpr uint8_t DEV_CONSOLE = 1;
+    static constexpr uint8_t CMD_GETCHAR = 0;
+    static constexpr uint8_t CMD_PUTCHAR = 1;
+
+    // Proxied system calls (riscv-pk / fesvr numbering)
+    static constexpr uint64_t SYS_GETCWD = 17;
+    static constexpr uint64_t SYS_MKDIRAT = 34;
+    static constexpr uint64_t SYS_UNLINKAT = 35;
+    static constexpr uint64_t SYS_FACCESSAT = 48;
+    static constexpr uint64_t SYS_OPENAT = 56;
+    static constexpr uint64_t SYS_CLOSE = 57;
+    static constexpr uint64_t SYS_LSEEK = 62;
+    static constexpr uint64_t SYS_READ = 63;
+    static constexpr uint64_t SYS_WRITE = 64;
+    static constexpr uint64_t SYS_PREAD = 67;
+    static constexpr uint64_t SYS_PWRITE = 68;
+    static constexpr uint64_t SYS_FSTATAT = 79;
+    static constexpr uint64_t SYS_FSTAT = 80;
+    static constexpr uint64_t SYS_EXIT = 93;
+    static constexpr uint64_t SYS_GETMAINVARS = 2011;
+
+    using ExitCallback = std::function<void(uint16_t code)>;
+
+    // `argv` is what getmainvars reports, argv[0] being the loaded ELF.
+    Htif(Bus& bus, Dram& dram, addr_t tohost, std::optional<addr_t> fromhost,
+         std::vector<std::string> argv, ExitCallback exit_callback);
+
+    Htif(const Htif&) = delete;
+    Htif& operator=(const Htif&) = delete;
+
+    // Services the command currently in tohost, if any.
+    void handle_tohost() noexcept;
+
+private:
+    using SyscallArgs = std::array<uint64_t, 8>; // magic_mem: nr, a0-a6
+
+    int64_t syscall(const SyscallArgs& a);
+    int64_t sys_getmainvars(addr_t buf, size_t limit);
+    [[nodiscard]] std::optional<std::string> read_path(addr_t addr,
+                                                       size_t len) const;
+    void reply(uint8_t dev, uint8_t cmd, uint64_t payload) noexcept;
+
+    Dram& dram_;
+    addr_t tohost_;
+    std::optional<addr_t> fromhost_;
+    std::vector<std::string> argv_;
+    ExitCallback exit_callback_;
+};
+
+} // namespace uemu::core
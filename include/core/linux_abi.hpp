@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <utility>
+
+// Linux asm-generic ABI as seen by a riscv64 guest, for code that forwards
+// guest system calls to the host.
+
+namespace uemu::core::abi {
+
+// open(2) flags whose values differ between architectures
+inline constexpr std::pair<int, int> OPEN_FLAGS[] = {
+    {00000100, O_CREAT},
+    {00000200, O_EXCL},
+    {00000400, O_NOCTTY},
+    {00001000, O_TRUNC},
+    {00002000, O_APPEND},
+    {00004000, O_NONBLOCK},
+    {00010000, O_DSYNC},
+    {00040000, O_DIRECT},
+    {00200000, O_DIRECTORY},
+    {00400000, O_NOFOLLOW},
+    {01000000, O_NOATIME},
+    {02000000, O_CLOEXEC},
+    {04000000, O_SYNC & ~O_DSYNC},
+    {010000000, O_PATH},
+    {020000000, O_TMPFILE & ~O_DIRECTORY},
+};
+
+[[nodiscard]] inline int open_flags_to_host(int flags) noexcept {
+    int host = flags & O_ACCMODE;
+    for (const auto& [guest_bit, host_bit] : OPEN_FLAGS)
+        if (flags & guest_bit)
+            host |= host_bit;
+    return host;
+}
+
+[[nodiscard]] inline int open_flags_from_host(int flags) noexcept {
+    int guest = flags & O_ACCMODE;
+    for (const auto& [guest_bit, host_bit] : OPEN_FLAGS)
+        if (flags & host_bit)
+            guest |= guest_bit;
+    return guest;
+}
+
+// struct stat from asm-generic/stat.h
+struct GuestStat {
+    uint64_t dev;
+    uint64_t ino;
+    uint32_t mode;
+    uint32_t nlink;
+    uint32_t uid;
+    uint32_t gid;
+    uint64_t rdev;
+    uint64_t pad1;
+    int64_t size;
+    int32_t blksize;
+    int32_t pad2;
+    int64_t blocks;
+    int64_t atime;
+    uint64_t atime_nsec;
+    int64_t mtime;
+    uint64_t mtime_nsec;
+    int64_t ctime;
+    uint64_t ctime_nsec;
+    uint32_t unused[2];
+};
+
+static_assert(sizeof(GuestStat) == 128);
+
+[[nodiscard]] inline GuestStat to_guest_stat(const struct stat& st) noexcept {
+    return {
+        .dev = st.st_dev,
+        .ino = st.st_ino,
+        .mode = st.st_mode,
+        .nlink = static_cast<uint32_t>(st.st_nlink),
+        .uid = st.st_uid,
+        .gid = st.st_gid,
+        .rdev = st.st_rdev,
+        .pad1 = 0,
+        .size = st.st_size,
+        .blksize = static_cast<int32_t>(st.st_blksize),
+        .pad2 = 0,
+        .blocks = st.st_blocks,
+        .atime = st.st_atim.tv_sec,
+        .atime_nsec = static_cast<uint64_t>(st.st_atim.tv_nsec),
+        .mtime = st.st_mtim.tv_sec,
+        .mtime_nsec = static_cast<uint64_t>(st.st_mtim.tv_nsec),
+        .ctime = st.st_ctim.tv_sec,
+        .ctime_nsec = static_cast<uint64_t>(st.st_ctim.tv_nsec),
+        .unused = {},
+    };
+}
+
+} // namespace uemu::core::abi
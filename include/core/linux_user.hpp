@@ -0,0 +1,222 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/dram.hpp"
+#include "core/hart.hpp"
+
+namespace uemu::core {
+
+class MMU;
+
+// Linux user-mode personality: runs a riscv64 Linux ELF executable in U-mode
+// without booting a kernel. Guest memory is backed by DRAM pages mapped
+// through Sv39 page tables owned here, U-mode ecalls are translated to host
+// system calls, and any other trap terminates the process as a signal would.
+// Threads created by clone(CLONE_VM | CLONE_THREAD) share the one hart: each
+// keeps its registers here while it is switched out, and is switched on
+// futex waits, sched_yield(), exit() and a CLINT time slice. There is no
+// second process, so fork, vfork and execve fail with ENOSYS.
+class LinuxUser {
+public:
+    // User address space layout (Sv39 lower half)
+    static constexpr addr_t STACK_TOP = 0x3FFFFFF000;
+    static constexpr size_t STACK_SIZE = 8 * 1024 * 1024;
+    static constexpr addr_t PIE_BASE = 0x40000000;    // ET_DYN executables
+    static constexpr addr_t MMAP_BASE = 0x2000000000; // mmap and ld.so
+
+    struct Options {
+        std::filesystem::path exe;
+        std::vector<std::string> argv; // argv[0] defaults to `exe`
+        std::vector<std::string> envp;
+        // Absolute guest paths (PT_INTERP, open...) are looked up here
+        // first, like qemu-user's -L.
+        std::filesystem::path sysroot;
+    };
+
+    using ExitCallback = std::function<void(int status)>;
+
+    LinuxUser(Hart& hart, MMU& mmu, Dram& dram, ExitCallback exit_callback);
+    ~LinuxUser();
+
+    LinuxUser(const LinuxUser&) = delete;
+    LinuxUser& operator=(const LinuxUser&) = delete;
+
+    // Maps the executable and its interpreter, builds the initial stack and
+    // auxv, and points the hart at the entry point in U-mode.
+    void load(const Options& opts);
+
+    // Services the syscall in a7 with arguments a0-a5; the result (or
+    // -errno) goes to a0.
+    void handle_ecall();
+
+    // Terminates the process for a trap that a kernel would turn into a
+    // signal.
+    void handle_fault(const Trap& trap) noexcept;
+
+    // Resumes at the interrupted pc; the time slice timer switches to the
+    // next runnable thread.
+    void handle_interrupt(const Trap& trap) noexcept;
+
+    // Guest virtual memory access as the guest's own loads and stores; false
+    // if any byte is unmapped or lacks read (write) permission.
+    [[nodiscard]] bool copy_from_guest(addr_t va, void* dst, size_t len) const;
+    [[nodiscard]] bool copy_to_guest(addr_t va, const void* src, size_t len);
+    [[nodiscard]] std::optional<std::string> read_string(addr_t va) const;
+
+    [[nodiscard]] addr_t brk() const noexcept { return brk_; }
+
+    [[nodiscard]] size_t thread_count() const noexcept {
+        return threads_.size();
+    }
+
+private:
+    struct Image {
+        addr_t bias;
+        addr_t entry;
+        addr_t phdr;
+        size_t phnum;
+        addr_t end; // End of the highest segment
+        std::string interp;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // A guest thread. While it runs, its registers live in the hart and
+    // only the rest is current here.
+    struct Thread {
+        RegisterFile gprs;
+        std::array<FPR, Hart::FPR_COUNT> fprs;
+        reg_t fcsr = 0;
+        addr_t pc = 0;
+        addr_t clear_child_tid = 0; // Zeroed and woken on exit
+
+        // Blocked in FUTEX_WAIT on `futex` until woken or `deadline`
+        bool waiting = false;
+        addr_t futex = 0;
+        uint32_t futex_bitset = 0;
+        std::optional<Clock::time_point> deadline;
+    };
+
+    Image load_elf(const std::filesystem::path& path, bool interp);
+    addr_t build_stack(const Options& opts, const Image& exe,
+                       const Image* interp);
+
+    // Page tables. Perms are PTE R/W/X bits.
+    addr_t alloc_page();
+    [[nodiscard]] std::optional<addr_t> walk(addr_t va, bool create);
+    // Physical address of `va` if its page is allocated and has all `perm`
+    [[nodiscard]] std::optional<addr_t> translate(addr_t va,
+                                                  reg_t perm) const;
+    // Fills allocated pages whatever their protection, as the kernel does
+    // when loading an ELF or a file mapping.
+    [[nodiscard]] bool fill_guest(addr_t va, const void* src, size_t len);
+    [[nodiscard]] bool write_guest(addr_t va, const void* src, size_t len,
+                                   reg_t perm);
+    void map(addr_t va, size_t len, reg_t perm);
+    void unmap(addr_t va, size_t len);
+    void protect(addr_t va, size_t len, reg_t perm);
+    // Whether every page of [va, va + len) is allocated and has all `perm`
+    [[nodiscard]] bool is_mapped(addr_t va, size_t len, reg_t perm = 0) const;
+    addr_t reserve(size_t len);
+
+    [[nodiscard]] std::filesystem::path
+    host_path(const std::string& path) const;
+
+    static constexpr addr_t page_up(addr_t v) noexcept {
+        return (v + 0xFFF) & ~addr_t{0xFFF};
+    }
+
+    // Threads, in linux_syscalls.cpp. Syscalls only change thread states
+    // and set resched_; the switch happens once a0 holds the result.
+    void save(Thread& t) const noexcept;
+    void restore(const Thread& t) noexcept;
+    void reschedule();
+    void wake_expired(Clock::time_point now);
+    int64_t futex_wake(addr_t uaddr, int64_t count, uint32_t bitset);
+    void arm_time_slice() noexcept;
+
+    // System calls, in linux_syscalls.cpp. They return a value or -errno.
+    int64_t dispatch(reg_t nr);
+    int64_t sys_brk(addr_t addr);
+    int64_t sys_mmap(addr_t addr, size_t len, int prot, int flags, int fd,
+                     int64_t offset);
+    int64_t sys_munmap(addr_t addr, size_t len);
+    int64_t sys_mprotect(addr_t addr, size_t len, int prot);
+    int64_t sys_read(int fd, addr_t buf, size_t len,
+                     std::optional<int64_t> off);
+    int64_t sys_write(int fd, addr_t buf, size_t len,
+                      std::optional<int64_t> off);
+    int64_t sys_iov(int fd, addr_t iov, int iovcnt, bool write);
+    int64_t sys_openat(int dirfd, addr_t path, int flags, int mode);
+    int64_t sys_fstatat(int dirfd, addr_t path, addr_t buf, int flags);
+    int64_t sys_statx(int dirfd, addr_t path, int flags, unsigned mask,
+                      addr_t buf);
+    int64_t sys_readlinkat(int dirfd, addr_t path, addr_t buf, size_t len);
+    int64_t sys_ioctl(int fd, reg_t request, addr_t arg);
+    int64_t sys_fcntl(int fd, int cmd, reg_t arg);
+    int64_t sys_getdents64(int fd, addr_t buf, size_t len);
+    int64_t sys_uname(addr_t buf);
+    int64_t sys_futex(addr_t uaddr, int op, uint32_t val, addr_t timeout,
+                      uint32_t val3);
+    int64_t sys_clone(reg_t flags, addr_t stack, addr_t ptid, addr_t tls,
+                      addr_t ctid);
+    int64_t sys_prlimit64(int resource, addr_t new_limit, addr_t old_limit);
+    int64_t sys_path_call(reg_t nr, int dirfd, addr_t path, reg_t a2, reg_t a3);
+    void sys_exit(int status);
+    void sys_exit_thread(int status);
+
+    [[nodiscard]] reg_t arg(size_t n) const noexcept {
+        return hart_.gprs[10 + n];
+    }
+
+    Hart& hart_;
+    MMU& mmu_;
+    Dram& dram_;
+    ExitCallback exit_callback_;
+
+    std::filesystem::path exe_;
+    std::filesystem::path sysroot_;
+
+    addr_t root_;      // Sv39 root page table
+    addr_t next_page_; // Physical page bump allocator
+    std::vector<addr_t> free_pages_;
+
+    addr_t brk_start_;
+    addr_t brk_;
+    addr_t mmap_next_;
+
+    std::map<int, Thread> threads_; // By tid, the running one included
+    int tid_;                       // Running thread
+    int next_tid_;
+    std::deque<int> runnable_; // Ready to run, in FIFO order
+    std::unordered_map<addr_t, std::deque<int>> futex_waiters_;
+    bool resched_ = false;
+};
+
+} // namespace uemu::core
@@ -32,6 +32,21 @@ public:
 
     enum class AccessType { Fetch, Load, Store };
 
+    static constexpr reg_t PTE_V = 1 << 0;
+    static constexpr reg_t PTE_R = 1 << 1;
+    static constexpr reg_t PTE_W = 1 << 2;
+    static constexpr reg_t PTE_X = 1 << 3;
+    static constexpr reg_t PTE_U = 1 << 4;
+    static constexpr reg_t PTE_G = 1 << 5;
+    static constexpr reg_t PTE_A = 1 << 6;
+    static constexpr reg_t PTE_D = 1 << 7;
+    static constexpr reg_t PTE_RESERVED_MASK = 0xFFC0000000000000ULL;
+    static constexpr reg_t PTE_PERM_MASK = PTE_R | PTE_W | PTE_X | PTE_U;
+
+    static constexpr size_t LEVELS = 3;
+    static constexpr size_t PTESIZE = 8;
+    static constexpr size_t VPNBITS = 9;
+
     struct TLBEntry {
         addr_t vpn;
         addr_t ppn;
@@ -184,6 +199,44 @@ public:
         return {insn, Ilen::Normal};
     }
 
+    // Walk the page table in satp the way a debugger would: no privilege or
+    // permission checks, no TLB fill and no A/D updates. Lets a profiler
+    // read kernel memory while the hart is in U-mode. PTEs are read from
+    // `dram` only, so a bogus table pointer never runs MMIO read handlers.
+    [[nodiscard]] std::optional<addr_t>
+    peek_translate(addr_t vaddr, const Dram& dram) const noexcept {
+        const reg_t satp = hart_->csrs[SATP::ADDRESS]->read_unchecked();
+        const reg_t mode =
+            (satp & SATP::Field::MODE) >> SATP::Shift::MODE_SHIFT;
+
+        if (mode == SATP::Mode::Bare)
+            return vaddr;
+
+        addr_t a = ((satp & SATP::Field::PPN) >> SATP::Shift::PPN_SHIFT)
+                   << PGSHIFT;
+
+        for (int i = static_cast<int>(LEVELS - 1); i >= 0; i--) {
+            const reg_t vpn_i =
+                (vaddr >> (PGSHIFT + i * VPNBITS)) & ((1 << VPNBITS) - 1);
+            const addr_t pte_addr = a + vpn_i * PTESIZE;
+            if (!dram.is_valid_addr(pte_addr, sizeof(uint64_t)))
+                return std::nullopt;
+
+            const uint64_t pte = dram.read<uint64_t>(pte_addr);
+            if (!(pte & PTE_V))
+                return std::nullopt;
+
+            const addr_t ppn = ((pte >> 10) & ((1ULL << 44) - 1)) << PGSHIFT;
+            if (pte & (PTE_R | PTE_X)) {
+                const addr_t mask = (addr_t{1} << (PGSHIFT + i * VPNBITS)) - 1;
+                return (ppn & ~mask) | (vaddr & mask);
+            }
+            a = ppn;
+        }
+
+        return std::nullopt;
+    }
+
     void tlb_flush_all() noexcept {
         memset(itlb_, 0, sizeof(itlb_));
         memset(dtlb_, 0, sizeof(dtlb_));
@@ -204,21 +257,6 @@ public:
     bool reservation_valid = false;
 
 private:
-    static constexpr reg_t PTE_V = 1 << 0;
-    static constexpr reg_t PTE_R = 1 << 1;
-    static constexpr reg_t PTE_W = 1 << 2;
-    static constexpr reg_t PTE_X = 1 << 3;
-    static constexpr reg_t PTE_U = 1 << 4;
-    static constexpr reg_t PTE_G = 1 << 5;
-    static constexpr reg_t PTE_A = 1 << 6;
-    static constexpr reg_t PTE_D = 1 << 7;
-    static constexpr reg_t PTE_RESERVED_MASK = 0xFFC0000000000000ULL;
-    static constexpr reg_t PTE_PERM_MASK = PTE_R | PTE_W | PTE_X | PTE_U;
-
-    static constexpr size_t LEVELS = 3;
-    static constexpr size_t PTESIZE = 8;
-    static constexpr size_t VPNBITS = 9;
-
     static constexpr size_t TLB_ENTRIES = 128;
 
     Hart* hart_;
@@ -322,10 +360,18 @@ private:
             if (type == AccessType::Store && !entry->dirty)
                 goto miss;
 
+            (type == AccessType::Fetch ? hart_->stats.itlb_hits
+                                       : hart_->stats.dtlb_hits)
+                .add();
             return (entry->ppn << PGSHIFT) | (vaddr & PGMASK);
         }
 
+        (type == AccessType::Fetch ? hart_->stats.itlb_misses
+                                   : hart_->stats.dtlb_misses)
+            .add();
+
     miss:;
+        hart_->stats.page_walks.add();
         reg_t ppn = (satp & SATP::Field::PPN) >> SATP::Shift::PPN_SHIFT;
         bool adue = hart_->csrs[MENVCFG::ADDRESS]->read_unchecked() &
                     MENVCFG::Field::ADUE;
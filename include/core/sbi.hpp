@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <optional>
+
+#include "core/hart.hpp"
+
+namespace uemu::device {
+class Clint;
+} // namespace uemu::device
+
+namespace uemu::core {
+
+class Bus;
+class MMU;
+
+// Native implementation of the RISC-V SBI (v2.0) for a single hart. When
+// attached to a Hart, ecall from S-mode is serviced here instead of trapping
+// into M-mode firmware.
+class Sbi {
+public:
+    // Extension IDs
+    static constexpr reg_t EXT_LEGACY_SET_TIMER = 0x00;
+    static constexpr reg_t EXT_LEGACY_PUTCHAR = 0x01;
+    static constexpr reg_t EXT_LEGACY_GETCHAR = 0x02;
+    static constexpr reg_t EXT_LEGACY_SHUTDOWN = 0x08;
+    static constexpr reg_t EXT_BASE = 0x10;
+    static constexpr reg_t EXT_TIME = 0x54494D45;
+    static constexpr reg_t EXT_IPI = 0x735049;
+    static constexpr reg_t EXT_RFENCE = 0x52464E43;
+    static constexpr reg_t EXT_HSM = 0x48534D;
+    static constexpr reg_t EXT_SRST = 0x53525354;
+    static constexpr reg_t EXT_DBCN = 0x4442434E;
+
+    static constexpr reg_t SPEC_VERSION = 2ULL << 24; // v2.0
+    static constexpr reg_t IMPL_ID = 0x75656D75;      // "uemu"
+    static constexpr reg_t IMPL_VERSION = 1;
+
+    enum Error : int64_t {
+        SUCCESS = 0,
+        ERR_FAILED = -1,
+        ERR_NOT_SUPPORTED = -2,
+        ERR_INVALID_PARAM = -3,
+        ERR_DENIED = -4,
+        ERR_INVALID_ADDRESS = -5,
+        ERR_ALREADY_AVAILABLE = -6,
+    };
+
+    enum HartState : reg_t { HART_STARTED = 0, HART_STOPPED = 1 };
+
+    enum ResetType : uint32_t {
+        RESET_SHUTDOWN = 0,
+        RESET_COLD_REBOOT = 1,
+        RESET_WARM_REBOOT = 2,
+    };
+
+    enum ResetReason : uint32_t {
+        RESET_REASON_NONE = 0,
+        RESET_REASON_SYSFAIL = 1,
+    };
+
+    struct Console {
+        std::function<void(char)> write_char;
+        std::function<std::optional<char>(void)> read_char;
+    };
+
+    using ResetCallback = std::function<void(uint32_t type, uint32_t reason)>;
+
+    Sbi(Hart& hart, MMU& mmu, Bus& bus, device::Clint& clint, Console console,
+        ResetCallback reset_callback);
+
+    // Services the call in a0-a7 and returns the (error, value) pair in
+    // a0/a1. May throw WfiWait for a retentive HSM suspend.
+    void handle_ecall();
+
+private:
+    struct Ret {
+        int64_t error;
+        reg_t value;
+    };
+
+    Ret call(reg_t eid, reg_t fid);
+    Ret call_legacy(reg_t eid);
+
+    Ret base(reg_t fid);
+    Ret time(reg_t fid);
+    Ret ipi(reg_t fid);
+    Ret rfence(reg_t fid);
+    Ret hsm(reg_t fid);
+    Ret srst(reg_t fid);
+    Ret dbcn(reg_t fid);
+
+    [[nodiscard]] reg_t arg(size_t n) const noexcept {
+        return hart_.gprs[10 + n];
+    }
+
+    // Whether an SBI hart mask selects hart 0 (the only hart), or nullopt if
+    // it names a hart that does not exist.
+    [[nodiscard]] static std::optional<bool> decode_hart_mask(reg_t mask,
+                                                              reg_t base) {
+        if (base == ~reg_t{0})
+            return true;
+        if (mask == 0)
+            return false;
+        if (base != 0 || (mask & ~reg_t{1}))
+            return std::nullopt;
+        return true;
+    }
+
+    Hart& hart_;
+    MMU& mmu_;
+    Bus& bus_;
+    device::Clint& clint_;
+    Console console_;
+    ResetCallback reset_callback_;
+    MIP* mip_;
+};
+
+} // namespace uemu::core
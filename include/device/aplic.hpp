@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "device/device.hpp"
+
+namespace uemu::device {
+
+// Advanced Platform-Level Interrupt Controller (AIA APLIC), single interrupt
+// domain in MSI delivery mode. Wired interrupt sources are converted into MSI
+// writes targeting the IMSIC interrupt files, so the hart takes and claims
+// external interrupts through *topei instead of PLIC claim/complete MMIO.
+//
+// Delegation to child domains is not implemented: sourcecfg.D reads as zero.
+class Aplic final : public Device {
+public:
+    static constexpr addr_t DEFAULT_BASE = 0xd000000;
+    static constexpr size_t SIZE = 0x8000;
+
+    static constexpr addr_t DOMAINCFG = 0x0000;
+    static constexpr addr_t SOURCECFG_BASE = 0x0004;
+    static constexpr addr_t MMSIADDRCFG = 0x1BC0;
+    static constexpr addr_t MMSIADDRCFGH = 0x1BC4;
+    static constexpr addr_t SMSIADDRCFG = 0x1BC8;
+    static constexpr addr_t SMSIADDRCFGH = 0x1BCC;
+    static constexpr addr_t SETIP_BASE = 0x1C00;
+    static constexpr addr_t SETIPNUM = 0x1CDC;
+    static constexpr addr_t IN_CLRIP_BASE = 0x1D00;
+    static constexpr addr_t CLRIPNUM = 0x1DDC;
+    static constexpr addr_t SETIE_BASE = 0x1E00;
+    static constexpr addr_t SETIENUM = 0x1EDC;
+    static constexpr addr_t CLRIE_BASE = 0x1F00;
+    static constexpr addr_t CLRIENUM = 0x1FDC;
+    static constexpr addr_t SETIPNUM_LE = 0x2000;
+    static constexpr addr_t SETIPNUM_BE = 0x2004;
+    static constexpr addr_t GENMSI = 0x3000;
+    static constexpr addr_t TARGET_BASE = 0x3004;
+
+    // domaincfg bits
+    static constexpr uint32_t DOMAINCFG_RO80 = 0x80000000;
+    static constexpr uint32_t DOMAINCFG_IE = 1u << 8;
+    static constexpr uint32_t DOMAINCFG_DM = 1u << 2;
+
+    // sourcecfg source modes
+    enum SourceMode : uint32_t {
+        SM_INACTIVE = 0,
+        SM_DETACHED = 1,
+        SM_EDGE1 = 4,
+        SM_EDGE0 = 5,
+        SM_LEVEL1 = 6,
+        SM_LEVEL0 = 7,
+    };
+    static constexpr uint32_t SOURCECFG_SM_MASK = 0x7;
+
+    // msiaddrcfgh fields
+    static constexpr uint32_t MSIADDRCFGH_L = 1u << 31;
+    static constexpr uint32_t MSIADDRCFGH_HHXS_SHIFT = 24;
+    static constexpr uint32_t MSIADDRCFGH_LHXS_SHIFT = 20;
+    static constexpr uint32_t MSIADDRCFGH_HHXW_SHIFT = 16;
+    static constexpr uint32_t MSIADDRCFGH_LHXW_SHIFT = 12;
+    static constexpr uint32_t MSIADDRCFGH_PPN_MASK = 0xFFF;
+
+    // target fields (MSI delivery mode)
+    static constexpr uint32_t TARGET_HART_SHIFT = 18;
+    static constexpr uint32_t TARGET_GUEST_SHIFT = 12;
+    static constexpr uint32_t TARGET_GUEST_MASK = 0x3F;
+    static constexpr uint32_t TARGET_EIID_MASK = 0x7FF;
+
+    // genmsi busy bit
+    static constexpr uint32_t GENMSI_BUSY = 1u << 12;
+
+    // Performs a 32-bit little-endian MSI write on the system bus.
+    using MsiCallback = std::function<void(addr_t addr, uint32_t data)>;
+
+    // mmode selects whether MSIs go to machine- or supervisor-level interrupt
+    // files. The corresponding msiaddrcfg starts out pointing at imsic_base.
+    Aplic(MsiCallback msi_callback, bool mmode, addr_t imsic_base,
+          uint32_t ndev = 31);
+
+    void set_interrupt_level(uint32_t id, bool lvl);
+
+    void emit_dt(DtContext& ctx) const override;
+
+private:
+    std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
+    bool write_internal(addr_t offset, size_t size, uint64_t value) override;
+
+    struct Msi {
+        addr_t addr;
+        uint32_t data;
+    };
+
+    [[nodiscard]] bool source_active(uint32_t id) const noexcept;
+    [[nodiscard]] bool rectified_input(uint32_t id) const noexcept;
+    [[nodiscard]] addr_t msi_address(uint32_t hart_index,
+                                     uint32_t guest_index) const noexcept;
+
+    void sourcecfg_write(uint32_t id, uint32_t val);
+    void set_pending(uint32_t id, bool pending);
+    void set_enabled(uint32_t id, bool enabled);
+    void forward(uint32_t id);
+    void deliver(uint32_t hart_index, uint32_t guest_index, uint32_t eiid);
+    void send(const std::vector<Msi>& msis) const;
+
+    MsiCallback msi_callback_;
+    const bool mmode_;
+    const uint32_t num_ids_;
+
+    std::mutex aplic_mutex_;
+
+    uint32_t domaincfg_;
+    uint32_t mmsiaddrcfg_;
+    uint32_t mmsiaddrcfgh_;
+    uint32_t smsiaddrcfg_;
+    uint32_t smsiaddrcfgh_;
+    uint32_t genmsi_;
+
+    std::vector<uint32_t> sourcecfg_;
+    std::vector<uint32_t> target_;
+    std::vector<bool> level_;
+    std::vector<bool> pending_;
+    std::vector<bool> enabled_;
+
+    // MSIs are collected under the lock and written out after it is
+    // released, so an IMSIC write never runs with aplic_mutex_ held.
+    std::vector<Msi> outbox_;
+};
+
+} // namespace uemu::device
@@ -32,7 +32,10 @@ public:
     static constexpr addr_t RNG_STATUS = 0x4;
     static constexpr addr_t RNG_DATA = 0x8;
 
-    BCM2835Rng() : Device("BCM2835Rng", DEFAULT_BASE, SIZE), gen_(rd_()) {}
+    explicit BCM2835Rng(addr_t base = DEFAULT_BASE)
+        : Device("BCM2835Rng", base, SIZE), gen_(rd_()) {}
+
+    void emit_dt(DtContext& ctx) const override;
 
 private:
     std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
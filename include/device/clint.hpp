@@ -16,8 +16,8 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
-#include <mutex>
 
 #include "core/hart.hpp"
 #include "device/device.hpp"
@@ -32,28 +32,67 @@ public:
     static constexpr addr_t MSIP_OFFSET = 0x0;
     static constexpr addr_t MTIMECMP_OFFSET = 0x4000;
     static constexpr addr_t MTIME_OFFSET = 0xBFF8;
+    static constexpr uint64_t NS_PER_SEC = 1000000000;
 
     Clint(std::shared_ptr<core::Hart> hart, uint64_t freq_hz = DEFAULT_FREQ);
 
+    // Evaluates the mtimecmp / stimecmp deadlines. Called by the scheduler.
     void tick() override;
-    uint64_t get_mtime() noexcept;
+
+    [[nodiscard]] uint64_t get_freq() const noexcept { return freq_hz_; }
+
+    // Supervisor timer for the built-in SBI: once armed, STIP follows
+    // mtime >= value, as M-mode firmware would do on MTIP.
+    void set_sbi_timer(uint64_t value) noexcept;
+
+    // Lock-free; does not evaluate any deadline, so that rdtime stays cheap.
+    [[nodiscard]] uint64_t get_mtime() const noexcept {
+        return host_to_mtime(host_now_ns()) +
+               mtime_offset_.load(std::memory_order_relaxed);
+    }
+
+    void emit_dt(DtContext& ctx) const override;
 
 private:
     std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
     bool write_internal(addr_t offset, size_t size, uint64_t value) override;
 
-    inline void tick_internal();
-    inline void handle_mtimecmp();
-    inline void handle_stimecmp();
+    [[nodiscard]] uint64_t host_now_ns() const noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start_time_)
+            .count();
+    }
+
+    // mtime = ns * freq / 1e9, split into integer and 0.64 fixed-point
+    // fractional multipliers so that no division is needed on the hot path.
+    [[nodiscard]] uint64_t host_to_mtime(uint64_t ns) const noexcept {
+        return ns * mult_int_ +
+               static_cast<uint64_t>(
+                   (static_cast<__uint128_t>(ns) * mult_frac_) >> 64);
+    }
+
+    void check_deadlines(uint64_t mtime) noexcept;
+    // Sets or clears `tip` from mtime >= timecmp.
+    void update_tip(reg_t tip, const std::atomic<uint64_t>& timecmp,
+                    uint64_t mtime) noexcept;
+    // Tells the latency profiler that `tip` is about to become pending.
+    void note_deadline(reg_t tip, uint64_t late_ticks) const noexcept;
 
     std::shared_ptr<core::Hart> hart_;
 
-    std::mutex clint_mutex_;
-    uint64_t mtime_;
-    uint64_t mtimecmp_;
+    core::MIP* mip_;
+    core::MENVCFG* menvcfg_;
+    core::STIMECMP* stimecmp_;
+
+    std::atomic<uint64_t> mtime_offset_;
+    std::atomic<uint64_t> mtimecmp_;
+    std::atomic<uint64_t> sbi_timecmp_;
+    std::atomic<bool> sbi_timer_armed_;
 
-    std::chrono::steady_clock::time_point start_time_;
+    const std::chrono::steady_clock::time_point start_time_;
     const uint64_t freq_hz_;
+    const uint64_t mult_int_;
+    const uint64_t mult_frac_;
 };
 
 } // namespace uemu::device
@@ -20,12 +20,21 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
+#include "common/stat_counter.hpp"
 #include "common/types.hpp"
 
+namespace uemu::utils {
+struct FdtNode;
+} // namespace uemu::utils
+
 namespace uemu::device {
 
+struct DtContext; // utils/device_tree.hpp
+
 class Device {
 public:
     explicit Device(const std::string& name, addr_t start, size_t size)
@@ -56,6 +65,7 @@ public:
 
     template <typename T>
     [[nodiscard]] std::optional<T> read(addr_t addr) noexcept {
+        mmio_reads_.add();
         std::optional<uint64_t> v = read_internal(addr - start_, sizeof(T));
 
         if (v == std::nullopt) [[unlikely]]
@@ -66,12 +76,32 @@ public:
 
     template <typename T>
     [[nodiscard]] bool write(addr_t addr, T value) noexcept {
+        mmio_writes_.add();
         return write_internal(addr - start_, sizeof(T),
                               static_cast<uint64_t>(value));
     }
 
+    // Accesses through the bus: guest loads and stores, and messages from
+    // other devices, such as APLIC MSIs to an IMSIC on the device thread
+    [[nodiscard]] uint64_t mmio_reads() const noexcept {
+        return mmio_reads_.get();
+    }
+
+    [[nodiscard]] uint64_t mmio_writes() const noexcept {
+        return mmio_writes_.get();
+    }
+
+    void reset_mmio_counts() noexcept {
+        mmio_reads_ = {};
+        mmio_writes_ = {};
+    }
+
     virtual void tick() {}
 
+    // Adds the device's node(s) to the device tree. Devices without a guest
+    // driver binding emit nothing.
+    virtual void emit_dt(DtContext& /* ctx */) const {}
+
 protected:
     virtual std::optional<uint64_t> read_internal(addr_t offset,
                                                   size_t size) = 0;
@@ -102,10 +132,18 @@ protected:
             base[offset + i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
     }
 
+    // Appends "<node_name>@<start>" under /soc with its reg property set.
+    utils::FdtNode& add_soc_node(DtContext& ctx,
+                                 std::string_view node_name) const;
+
     std::string name_;
 
     addr_t start_;
     addr_t end_;
+
+private:
+    SharedStatCounter mmio_reads_;
+    SharedStatCounter mmio_writes_;
 };
 
 class IrqDevice : public Device {
@@ -120,6 +158,10 @@ public:
 protected:
     void update_irq(bool lvl) { irq_callback_(interrupt_id_, lvl); }
 
+    // Wires `node` to the interrupt controller that emitted before it, if
+    // the machine has one.
+    void set_dt_interrupt(utils::FdtNode& node, const DtContext& ctx) const;
+
 private:
     IrqCallback irq_callback_;
     uint32_t interrupt_id_;
@@ -46,7 +46,10 @@ public:
 
     GoldfishBattery(IrqCallback irq_callback,
                     uint32_t interrupt_id = DEFAULT_INTERRUPT_ID,
-                    uint32_t init_capacity = 96);
+                    uint32_t init_capacity = 96,
+                    addr_t base = DEFAULT_BASE);
+
+    void emit_dt(DtContext& ctx) const override;
 
 private:
     std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
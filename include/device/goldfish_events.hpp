@@ -45,10 +45,13 @@ public:
 
     GoldfishEvents(IrqCallback irq_callback,
                    uint32_t interrupt_id = DEFAULT_INTERRUPT_ID,
-                   const std::string& device_name = "qwerty2");
+                   const std::string& device_name = "qwerty2",
+                   addr_t base = DEFAULT_BASE);
 
     void push_key_event(KeyEvent event) override;
 
+    void emit_dt(DtContext& ctx) const override;
+
 private:
     // Device state
     enum State : uint32_t {
@@ -39,10 +39,13 @@ public:
     static constexpr addr_t CLEAR_INTERRUPT = 0x1c;
 
     GoldfishRTC(IrqCallback irq_callback,
-                uint32_t interrupt_id = DEFAULT_INTERRUPT_ID);
+                uint32_t interrupt_id = DEFAULT_INTERRUPT_ID,
+                addr_t base = DEFAULT_BASE);
 
     void tick() override;
 
+    void emit_dt(DtContext& ctx) const override;
+
 private:
     std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
     bool write_internal(addr_t offset, size_t size, uint64_t value) override;
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "core/hart.hpp"
+#include "device/device.hpp"
+
+namespace uemu::device {
+
+// Incoming MSI Controller (AIA IMSIC) interrupt file. One instance models a
+// single interrupt file (machine or supervisor level) of hart 0. Devices post
+// MSIs by writing an interrupt identity to seteipnum_le, the hart consumes
+// them through the *iselect / *ireg / *topei CSRs.
+class Imsic final : public Device {
+public:
+    static constexpr addr_t DEFAULT_M_BASE = 0x24000000;
+    static constexpr addr_t DEFAULT_S_BASE = 0x28000000;
+    static constexpr size_t SIZE = 0x1000;
+
+    static constexpr addr_t SETEIPNUM_LE = 0x0;
+    static constexpr addr_t SETEIPNUM_BE = 0x4;
+
+    // Implemented interrupt identities are 1..NUM_IDS-1.
+    static constexpr uint32_t NUM_IDS = 256;
+    static constexpr uint32_t NUM_WORDS = NUM_IDS / 64;
+
+    // Indirectly accessed registers (*iselect values).
+    static constexpr reg_t EIDELIVERY = 0x70;
+    static constexpr reg_t EITHRESHOLD = 0x72;
+    static constexpr reg_t EIP0 = 0x80;
+    static constexpr reg_t EIP63 = 0xBF;
+    static constexpr reg_t EIE0 = 0xC0;
+    static constexpr reg_t EIE63 = 0xFF;
+
+    static constexpr uint32_t TOPEI_ID_SHIFT = 16;
+
+    Imsic(std::shared_ptr<core::Hart> hart, bool mmode);
+
+    // Sets the pending bit of an interrupt identity, as an MSI write would.
+    void send_msi(uint32_t id) noexcept;
+
+    [[nodiscard]] bool ireg_valid(reg_t iselect) const noexcept;
+    [[nodiscard]] reg_t ireg_read(reg_t iselect) const noexcept;
+    void ireg_write(reg_t iselect, reg_t value) noexcept;
+
+    [[nodiscard]] reg_t topei() const noexcept;
+    void claim_topei() noexcept;
+
+    void emit_dt(DtContext& ctx) const override;
+
+private:
+    std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
+    bool write_internal(addr_t offset, size_t size, uint64_t value) override;
+
+    [[nodiscard]] uint32_t top_id() const noexcept;
+    void update_irq() noexcept;
+
+    // On RV64 only the even-numbered eipN / eieN registers exist, each one
+    // covering 64 identities.
+    [[nodiscard]] static std::optional<size_t>
+    word_index(reg_t iselect) noexcept;
+
+    std::shared_ptr<core::Hart> hart_;
+    core::MIP* mip_;
+    const bool mmode_;
+    const reg_t eip_mask_;
+
+    std::atomic<uint64_t> eip_[NUM_WORDS];
+    std::atomic<uint64_t> eie_[NUM_WORDS];
+    std::atomic<uint32_t> eidelivery_;
+    std::atomic<uint32_t> eithreshold_;
+};
+
+} // namespace uemu::device
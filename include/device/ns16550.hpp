@@ -23,6 +23,7 @@
  * https://opensource.org/licenses/BSD-3-Clause
  */
 
+#include <chrono>
 #include <mutex>
 #include <queue>
 
@@ -42,7 +43,17 @@ public:
     static constexpr uint32_t DEFAULT_REG_SHIFT = 0;
     static constexpr uint32_t DEFAULT_REG_IO_WIDTH = 1;
 
-    static constexpr size_t QUEUE_SIZE = 64;
+    // Input clock of the baud rate generator, matches the DTS
+    // clock-frequency property.
+    static constexpr uint64_t CLOCK_FREQ = 3686400;
+
+    // Depth of the transmit and receive FIFOs of a 16550A.
+    static constexpr size_t FIFO_SIZE = 16;
+
+    // The receiver raises a timeout interrupt when the RX FIFO holds data
+    // but no character has been received or read for this many character
+    // times.
+    static constexpr uint64_t RX_TIMEOUT_CHARS = 4;
 
     static constexpr uint8_t RX = 0;  // Receive buffer (R)
     static constexpr uint8_t TX = 0;  // Transmit buffer (W)
@@ -70,6 +81,7 @@ public:
         0x02; // Transmitter holding register empty
     static constexpr uint8_t IIR_RDI = 0x04;  // Receiver data interrupt
     static constexpr uint8_t IIR_RLSI = 0x06; // Receiver line status interrupt
+    static constexpr uint8_t IIR_CTI = 0x0c;  // Character timeout interrupt
     static constexpr uint8_t IIR_TYPE_BITS = 0xc0;
 
     // FCR bits
@@ -77,6 +89,11 @@ public:
     static constexpr uint8_t FCR_CLEAR_RCVR = 0x02;  // Clear receive FIFO
     static constexpr uint8_t FCR_CLEAR_XMIT = 0x04;  // Clear transmit FIFO
     static constexpr uint8_t FCR_DMA_SELECT = 0x08;  // DMA mode select
+    static constexpr uint8_t FCR_TRIGGER_MASK = 0xc0; // RX trigger level
+    static constexpr uint8_t FCR_TRIGGER_1 = 0x00;    // 1 byte
+    static constexpr uint8_t FCR_TRIGGER_4 = 0x40;    // 4 bytes
+    static constexpr uint8_t FCR_TRIGGER_8 = 0x80;    // 8 bytes
+    static constexpr uint8_t FCR_TRIGGER_14 = 0xc0;   // 14 bytes
 
     // LCR bits
     static constexpr uint8_t LCR_DLAB = 0x80;   // Divisor latch access bit
@@ -118,18 +135,38 @@ public:
     explicit NS16550(IrqCallback irq_callback,
                      uint32_t interrupt_id = DEFAULT_INTERRUPT_ID,
                      uint32_t reg_shift = DEFAULT_REG_SHIFT,
-                     uint32_t reg_io_width = DEFAULT_REG_IO_WIDTH);
+                     uint32_t reg_io_width = DEFAULT_REG_IO_WIDTH,
+                     addr_t base = DEFAULT_BASE);
 
     void tick() override;
 
+    void emit_dt(DtContext& ctx) const override;
+
 private:
     std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
     bool write_internal(addr_t offset, size_t size, uint64_t value) override;
 
     void update_interrupt();
 
+    void fifo_control_write(uint8_t val);
+
+    [[nodiscard]] bool fifo_enabled() const noexcept {
+        return fcr_ & FCR_ENABLE_FIFO;
+    }
+
+    // Without FIFOs the 16550 degrades to a 16450 with single-byte RBR/THR.
+    [[nodiscard]] size_t fifo_depth() const noexcept {
+        return fifo_enabled() ? FIFO_SIZE : 1;
+    }
+
+    [[nodiscard]] size_t rx_trigger_level() const noexcept;
+    [[nodiscard]] std::chrono::nanoseconds rx_timeout() const noexcept;
+
+    void rx_push(uint8_t val);
     uint8_t rx_byte();
     void tx_byte(uint8_t val);
+    void tx_flush();
+    bool tx_drain();
 
     uint32_t reg_shift_;
     uint32_t reg_io_width_;
@@ -137,6 +174,17 @@ private:
     std::mutex ns16550_mutex_;
 
     std::queue<uint8_t> rx_queue_;
+    std::queue<uint8_t> tx_queue_;
+
+    // THRE interrupt is an event, not a level: it is raised once whenever the
+    // TX FIFO drains (or THRI gets enabled while THRE is set) and cleared by
+    // reading IIR or writing THR.
+    bool thr_ipending_;
+
+    // Character timeout indication for the RX FIFO.
+    bool timeout_ipending_;
+    std::chrono::steady_clock::time_point rx_last_activity_;
+
     uint8_t dll_;
     uint8_t dlm_;
     uint8_t iir_;
@@ -30,6 +30,8 @@ public:
 
     void load(const std::filesystem::path& path, size_t offset);
 
+    void emit_dt(DtContext& ctx) const override;
+
 private:
     std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
     bool write_internal(addr_t offset, size_t size, uint64_t value) override;
@@ -25,7 +25,8 @@
 
 #pragma once
 
-#include <mutex>
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "core/hart.hpp"
@@ -67,25 +68,49 @@ public:
 
     void set_interrupt_level(uint32_t id, bool lvl);
 
+    void emit_dt(DtContext& ctx) const override;
+
 private:
+    // Source state (level, pending, claimed) is global and kept in atomic
+    // bitmaps. Each context only owns its enable bits and a cached
+    // highest-priority pending ID above its threshold, so a claim takes the
+    // cached ID and only rescans the contexts that cached the same one.
     struct Context {
-        Context(core::Hart* hart, bool mmode) : hart_(hart), mmode_(mmode) {}
-
-        core::Hart* hart_;
-        bool mmode_;
-
-        uint8_t priority_threshold{};
-        uint32_t enable[MAX_DEVICES / 32]{};
-        uint32_t pending[MAX_DEVICES / 32]{};
-        uint8_t pending_priority[MAX_DEVICES]{};
-        uint32_t claimed[MAX_DEVICES / 32]{};
+        Context(core::Hart* hart, bool mmode)
+            : mip_(dynamic_cast<core::MIP*>(
+                  hart->csrs[core::MIP::ADDRESS].get())),
+              eip_mask_(mmode ? core::MIP::Field::MEIP
+                              : core::MIP::Field::SEIP) {
+            assert(mip_);
+        }
+
+        void set_irq(bool lvl) noexcept {
+            if (lvl)
+                mip_->set_pending(eip_mask_);
+            else
+                mip_->clear_pending(eip_mask_);
+        }
+
+        core::MIP* mip_;
+        reg_t eip_mask_;
+
+        std::atomic<uint8_t> priority_threshold{};
+        std::atomic<uint32_t> enable[MAX_DEVICES / 32]{};
+
+        // Cached best pending ID, or 0 if none is above the threshold.
+        std::atomic<uint32_t> best_id{};
+        // Bumped after every change that may invalidate best_id.
+        std::atomic<uint64_t> seq{};
     };
 
     std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
     bool write_internal(addr_t offset, size_t size, uint64_t value) override;
 
+    [[nodiscard]] bool id_better(uint32_t id, uint32_t than) const noexcept;
     uint32_t context_best_pending(const Context* ctx) const;
-    void context_update(const Context* ctx);
+    void context_raise(Context* ctx, uint32_t id);
+    void context_update(Context* ctx);
+    void update_all_contexts();
     uint32_t context_claim(Context* ctx);
     uint32_t priority_read(reg_t offset);
     void priority_write(reg_t offset, uint32_t val);
@@ -97,14 +122,13 @@ private:
 
     std::shared_ptr<core::Hart> hart_;
 
-    std::mutex plic_mutex_;
-
-    std::vector<Context> contexts_;
+    std::vector<std::unique_ptr<Context>> contexts_;
     uint32_t num_ids_;
     uint32_t num_ids_word_;
     uint32_t max_prio_;
-    uint8_t priority_[MAX_DEVICES];
-    uint32_t level_[MAX_DEVICES / 32];
+    std::atomic<uint8_t> priority_[MAX_DEVICES];
+    std::atomic<uint32_t> pending_[MAX_DEVICES / 32];
+    std::atomic<uint32_t> claimed_[MAX_DEVICES / 32];
 };
 
 } // namespace uemu::device
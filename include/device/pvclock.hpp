@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+#include "core/dram.hpp"
+#include "device/clint.hpp"
+#include "device/device.hpp"
+
+namespace uemu::device {
+
+// Paravirtual clock, modelled after kvmclock. The guest registers a
+// PvClockInfo structure in DRAM through SYSTEM_TIME, and the emulator keeps
+// it updated with a (counter base, time base, scale) tuple under a version
+// seqlock. Time then costs an rdtime plus a few loads and a multiply:
+//
+//   do {
+//       v = info->version;  (retry while odd)
+//       delta = rdtime() - info->cycle_timestamp;
+//       delta = shift >= 0 ? delta << shift : delta >> -shift;
+//       ns = info->system_time + ((u128)delta * info->cycle_to_system_mul >> 32);
+//   } while (v != info->version);
+//
+// As kvmclock does with a stable TSC, the counter is the constant-rate CLINT
+// timebase, so the scale is fixed and time never drifts from rdtime. The
+// tuple is rebased every UPDATE_INTERVAL to keep the rounding of the scale
+// from adding up; a rebase never goes backwards.
+class PvClock final : public Device {
+public:
+    static constexpr addr_t DEFAULT_BASE = 0x10005000;
+    static constexpr size_t SIZE = 0x1000;
+
+    static constexpr addr_t MAGIC = 0x0;
+    static constexpr addr_t SYSTEM_TIME = 0x8; // GPA of PvClockInfo | ENABLE
+
+    static constexpr uint32_t MAGIC_VALUE = 0x6b637670; // "pvck"
+    static constexpr uint64_t SYSTEM_TIME_ENABLE = 1;
+
+    // Set while the guest is expected to see monotonic time across updates.
+    static constexpr uint8_t FLAG_STABLE = 1 << 0;
+
+    static constexpr std::chrono::milliseconds UPDATE_INTERVAL{1};
+
+    // Guest-visible layout, identical to pvclock_vcpu_time_info.
+    struct PvClockInfo {
+        uint32_t version;
+        uint32_t pad0;
+        uint64_t cycle_timestamp; // CLINT mtime
+        uint64_t system_time;
+        uint32_t cycle_to_system_mul;
+        int8_t cycle_shift;
+        uint8_t flags;
+        uint8_t pad[2];
+    };
+    static_assert(sizeof(PvClockInfo) == 32);
+
+    PvClock(std::shared_ptr<core::Dram> dram, std::shared_ptr<Clint> clint);
+
+    void tick() override;
+
+private:
+    std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
+    bool write_internal(addr_t offset, size_t size, uint64_t value) override;
+
+    void publish();
+
+    std::shared_ptr<core::Dram> dram_;
+    std::shared_ptr<Clint> clint_;
+
+    std::mutex pvclock_mutex_;
+
+    uint64_t system_time_msr_;
+    uint32_t version_;
+
+    // ns per timebase tick as mul * 2^shift / 2^32, rounded down
+    uint32_t mul_;
+    int8_t shift_;
+
+    std::chrono::steady_clock::time_point last_update_;
+};
+
+} // namespace uemu::device
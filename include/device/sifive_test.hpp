@@ -36,6 +36,8 @@ public:
         : Device("SiFiveTest", DEFAULT_BASE, SIZE),
           on_shutdown_(std::move(on_shutdown)) {}
 
+    void emit_dt(DtContext& ctx) const override;
+
 private:
     std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
     bool write_internal(addr_t offset, size_t size, uint64_t value) override;
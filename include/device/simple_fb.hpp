@@ -16,6 +16,10 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <vector>
+
 #include "device/device.hpp"
 #include "ui/pixel_source.hpp"
 
@@ -29,8 +33,14 @@ public:
 
     static constexpr addr_t DEFAULT_BASE = 0x50000000;
     static constexpr size_t SIZE = DEFAULT_WIDTH * DEFAULT_HEIGHT * BPP;
+    static constexpr size_t PITCH = DEFAULT_WIDTH * BPP;
 
-    SimpleFB() : Device("SimpleFB", DEFAULT_BASE, SIZE) { vram_.resize(SIZE); }
+    SimpleFB() : Device("SimpleFB", DEFAULT_BASE, SIZE) {
+        vram_.resize(SIZE);
+        // Start fully dirty so that the first frame is always presented.
+        for (auto& word : dirty_rows_)
+            word.store(~uint64_t{0}, std::memory_order_relaxed);
+    }
 
     size_t get_width() const override { return DEFAULT_WIDTH; }
 
@@ -42,16 +52,26 @@ public:
 
     const uint8_t* get_pixels() const override { return vram_.data(); }
 
-    [[nodiscard]] std::unique_lock<std::mutex> acquire_lock() const override {
-        return std::unique_lock<std::mutex>(simple_fb_mutex_);
-    }
+    void take_dirty_spans(std::vector<DirtySpan>& spans) override;
+
+    void emit_dt(DtContext& ctx) const override;
 
 private:
+    static constexpr size_t DIRTY_WORDS = (DEFAULT_HEIGHT + 63) / 64;
+
     std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
     bool write_internal(addr_t offset, size_t size, uint64_t value) override;
 
-    mutable std::mutex simple_fb_mutex_;
+    // Publishes the pixels stored before it to whoever clears the bit.
+    void mark_dirty(size_t row) noexcept {
+        dirty_rows_[row / 64].fetch_or(uint64_t{1} << (row % 64),
+                                       std::memory_order_release);
+    }
+
+    // The guest stores to vram_ without any lock. A reader may catch a row
+    // mid-update, but that row stays dirty and is sent again next frame.
     std::vector<uint8_t> vram_;
+    std::array<std::atomic<uint64_t>, DIRTY_WORDS> dirty_rows_; // 1 bit/row
 };
 
 } // namespace uemu::device
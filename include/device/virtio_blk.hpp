@@ -147,7 +147,8 @@ public:
 
     VirtioBlk(std::shared_ptr<core::Dram> dram,
               const std::filesystem::path& disk_path, IrqCallback irq_callback,
-              uint32_t interrupt_id = DEFAULT_INTERRUPT_ID);
+              uint32_t interrupt_id = DEFAULT_INTERRUPT_ID,
+              addr_t base = DEFAULT_BASE);
 
     VirtioBlk(const VirtioBlk&) = delete;
     VirtioBlk& operator=(const VirtioBlk&) = delete;
@@ -156,6 +157,8 @@ public:
 
     ~VirtioBlk() override;
 
+    void emit_dt(DtContext& ctx) const override;
+
 private:
     std::optional<uint64_t> read_internal(addr_t offset, size_t size) override;
     bool write_internal(addr_t offset, size_t size, uint64_t value) override;
@@ -17,17 +17,39 @@
 #pragma once
 
 #include <filesystem>
+#include <optional>
 
+#include "core/htif.hpp"
+#include "core/linux_user.hpp"
+#include "core/sbi.hpp"
 #include "execution_engine.hpp"
+#include "machine_config.hpp"
+#include "profile/bbv.hpp"
+#include "profile/coverage.hpp"
+#include "profile/irq_latency.hpp"
+#include "profile/mmio_profiler.hpp"
+#include "profile/region_profiler.hpp"
+#include "profile/sampler.hpp"
+#include "profile/stats_reporter.hpp"
+#include "profile/tracer.hpp"
+#include "ui/frame_capture.hpp"
+#include "utils/checkpoint.hpp"
+#include "utils/fdt.hpp"
+#include "utils/linux_loader.hpp"
+#include "utils/symbol_table.hpp"
 
 namespace uemu {
 
 class Emulator {
 public:
-    explicit Emulator(size_t dram_size, bool headless = true,
-                      const std::filesystem::path& disk_path = "",
-                      const std::filesystem::path& flash0_path = "",
-                      const std::filesystem::path& flash1_path = "");
+    // A desktop machine, headless, without disk or flash images
+    explicit Emulator(size_t dram_size);
+
+    explicit Emulator(const MachineConfig& machine, bool headless = true,
+                      unsigned ui_fps = 60,
+                      std::optional<ui::FrameCapture::Options> capture =
+                          std::nullopt,
+                      bool sbi = false);
     ~Emulator() = default;
 
     Emulator(const Emulator&) = delete;
@@ -38,8 +60,86 @@ public:
     void
     run(std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
 
-    // Load an elf from path to DRAM
-    void loadelf(const std::filesystem::path& path);
+    // Load an elf from path to DRAM, with the generated device tree passed
+    // in a1 as a previous boot stage would. If the elf has a `tohost` symbol,
+    // HTIF commands are serviced and `args` are its program arguments.
+    // `map_segments` maps the segments instead of copying them (see
+    // ElfLoader::load).
+    void loadelf(const std::filesystem::path& path,
+                 const std::vector<std::string>& args = {},
+                 bool map_segments = false);
+
+    // Load a Linux kernel, initrd and device tree and set the hart up to
+    // enter the kernel in S-mode. Requires the built-in SBI. Without a dtb
+    // the device tree is generated from the machine.
+    void boot_linux(const utils::LinuxLoader::Options& opts,
+                    const std::filesystem::path& dtb = "");
+
+    // Load a riscv64 Linux executable and run it in U-mode with its system
+    // calls serviced by the host. The guest's exit status becomes the
+    // shutdown code.
+    void load_user(const core::LinuxUser::Options& opts);
+
+    // Sample guest call stacks while running; the report is written when
+    // run() returns.
+    void enable_profiler(profile::Sampler::Options opts);
+
+    // Record a control-flow trace of the run for TraceDecoder.
+    void enable_tracer(profile::Tracer::Options opts);
+
+    // Report the emulator's own counters periodically, on SIGUSR1 and at
+    // the end of run().
+    void enable_stats(profile::StatsReporter::Options opts);
+
+    // Time every MMIO access per device register; the report, sorted by
+    // host time spent, is written to `output` at the end of run().
+    void enable_mmio_profiler(const std::filesystem::path& output);
+
+    // Histogram interrupt and trap latencies (assert, pending, taken,
+    // xRET); the percentiles are written to `output` at the end of run().
+    void enable_irq_latency(const std::filesystem::path& output);
+
+    // Record the benchmark regions the guest marks with the REGIONMARKER
+    // CSRs; the per-region JSON is written to `output` at the end of run().
+    void enable_regions(const std::filesystem::path& output);
+
+    // Write SimPoint basic-block vectors of the run.
+    void enable_bbv(profile::BbvProfiler::Options opts);
+
+    // Save a checkpoint `warmup` instructions ahead of each interval (of
+    // `interval` instructions) that SimPoint picked in `simpoints`, as
+    // `dir`/simpoint-<index>.ckpt, and stop after the last one. Throws
+    // std::runtime_error unless a bare-metal program was loaded on a
+    // machine without an interrupt controller.
+    void save_simpoint_checkpoints(const std::filesystem::path& simpoints,
+                                   uint64_t interval, uint64_t warmup,
+                                   const std::filesystem::path& dir);
+
+    // Continue from a checkpoint on top of the program it was taken from.
+    // For a SimPoint slice, run its warm-up, then restart the
+    // self-statistics and stop once the slice has retired.
+    void restore_checkpoint(const std::filesystem::path& path);
+
+    // Record the guest basic blocks executed; the drcov file is written at
+    // the end of run(), with the program from loadelf() and the kernel
+    // (from `opts.system_map`) as modules.
+    void enable_coverage(profile::Coverage::Options opts);
+
+    // Current self-statistics as JSON
+    [[nodiscard]] std::string stats_json() const;
+
+    // Device tree describing this machine as configured
+    [[nodiscard]] utils::Fdt device_tree();
+
+    // Devices of this machine
+    [[nodiscard]] const core::Bus& bus() const noexcept {
+        return engine_->get_bus();
+    }
+
+    // Symbols of the last ELF loaded with loadelf()
+    [[nodiscard]] const utils::SymbolTable& symbols() const noexcept {
+        return symbols_;
+    }
 
     // Load data from p to DRAM
     void load(addr_t addr, const void* p, size_t n);
@@ -62,8 +162,45 @@ public:
         return engine_->shutdown_status();
     }
 
+    // Verdict of the UI backend's end-of-run check (headless golden frame).
+    [[nodiscard]] std::optional<bool> ui_result() const noexcept {
+        return ui_result_;
+    }
+
 private:
+    struct CheckpointPlan {
+        std::vector<uint64_t> intervals; // Ascending SimPoint indices
+        uint64_t length;
+        uint64_t warmup;
+        std::filesystem::path dir;
+    };
+
+    void require_checkpointable(const char* what) const;
+    void schedule_checkpoint(std::shared_ptr<const CheckpointPlan> plan,
+                             size_t next);
+    void restart_stats();
+
     std::unique_ptr<ExecutionEngine> engine_;
+    std::unique_ptr<core::Sbi> sbi_;
+    std::unique_ptr<core::LinuxUser> linux_user_;
+    std::unique_ptr<core::Htif> htif_;
+    std::shared_ptr<ui::UIBackend> ui_backend_;
+    std::shared_ptr<profile::Sampler> sampler_;
+    std::shared_ptr<profile::Tracer> tracer_;
+    std::shared_ptr<profile::BbvProfiler> bbv_;
+    std::shared_ptr<profile::Coverage> coverage_;
+    std::unique_ptr<profile::StatsReporter> stats_;
+    std::unique_ptr<profile::MmioProfiler> mmio_profiler_;
+    std::filesystem::path mmio_profile_path_;
+    std::unique_ptr<profile::IrqLatency> irq_latency_;
+    std::filesystem::path irq_latency_path_;
+    std::unique_ptr<profile::RegionProfiler> regions_;
+    std::filesystem::path regions_path_;
+    std::optional<bool> ui_result_;
+    utils::SymbolTable symbols_;
+    std::filesystem::path program_; // Of symbols_
+    addr_t program_base_ = 0;
+    bool irqchip_ = false;
 };
 
 } // namespace uemu
@@ -15,10 +15,15 @@
  */
 
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <thread>
 
 #include "core/mmu.hpp"
+#include "profile/bbv.hpp"
+#include "profile/coverage.hpp"
+#include "profile/sampler.hpp"
+#include "profile/tracer.hpp"
 #include "ui/ui_backend.hpp"
 
 namespace uemu {
@@ -57,12 +62,41 @@ public:
 
     core::Dram& get_dram() noexcept { return *dram_.get(); }
 
+    core::Bus& get_bus() noexcept { return *bus_.get(); }
+
     void set_ui_backend(std::shared_ptr<ui::UIBackend> ui_backend) noexcept {
         ui_backend_ = std::move(ui_backend);
     }
 
+    // The sampler is polled every Sampler::BATCH instructions.
+    void set_sampler(std::shared_ptr<profile::Sampler> sampler) noexcept {
+        sampler_ = std::move(sampler);
+    }
+
+    void set_tracer(std::shared_ptr<profile::Tracer> tracer) noexcept {
+        tracer_ = std::move(tracer);
+    }
+
+    void set_bbv(std::shared_ptr<profile::BbvProfiler> bbv) noexcept {
+        bbv_ = std::move(bbv);
+    }
+
+    void set_coverage(std::shared_ptr<profile::Coverage> coverage) noexcept {
+        coverage_ = std::move(coverage);
+    }
+
+    // Calls `f` on the CPU thread, between two instructions, once the hart
+    // has retired `instructions` in total (HartStats::instructions). `f` may
+    // set the next milestone or request a shutdown from the guest side.
+    void set_milestone(uint64_t instructions, std::function<void()> f) {
+        milestone_ = instructions;
+        milestone_fn_ = std::move(f);
+    }
+
 private:
     void cpu_thread();
+    void device_thread();
+    void stop_device_thread();
 
     std::shared_ptr<core::Hart> hart_;
     std::shared_ptr<core::Dram> dram_;
@@ -70,6 +104,10 @@ private:
     std::shared_ptr<core::MMU> mmu_;
 
     std::shared_ptr<ui::UIBackend> ui_backend_;
+    std::shared_ptr<profile::Sampler> sampler_;
+    std::shared_ptr<profile::Tracer> tracer_;
+    std::shared_ptr<profile::BbvProfiler> bbv_;
+    std::shared_ptr<profile::Coverage> coverage_;
 
     bool cpu_thread_running_;
     std::unique_ptr<std::thread> cpu_thread_;
@@ -77,6 +115,11 @@ private:
     std::condition_variable cpu_cond_;
     std::exception_ptr cpu_thread_exception_;
 
+    // Devices tick on their own thread so that UI frame pacing and rendering
+    // on the calling thread never delay timers or UARTs, and vice versa.
+    std::atomic_bool device_thread_running_;
+    std::unique_ptr<std::thread> device_thread_;
+
     bool shutdown_from_guest_;
     uint16_t shutdown_code_;
     uint16_t shutdown_status_;
@@ -85,6 +128,9 @@ private:
 
     core::MCYCLE* mcycle_;
     core::MINSTRET* minstret_;
+
+    uint64_t milestone_;
+    std::function<void()> milestone_fn_;
 };
 
 } // namespace uemu
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+
+#include "common/types.hpp"
+
+namespace uemu {
+
+// Declarative description of the machine: which devices exist, where the
+// wired peripherals live and which interrupt they raise. Devices that are
+// left out are neither ticked nor scanned on bus accesses.
+struct MachineConfig {
+    enum class Profile {
+        Minimal, // CLINT, SiFiveTest and NemuConsole for bare-metal code
+        Test,    // Minimal plus an interrupt controller, UART, TestIntrGen
+        Desktop, // Every device, for booting a full system
+    };
+
+    struct Peripheral {
+        bool enabled = false;
+        addr_t base = 0;
+        uint32_t irq = 0;
+    };
+
+    size_t dram_size = 0;
+
+    // The CLINT is always present: the timer is architectural.
+    bool irqchip = false; // PLIC, or APLIC + IMSIC with `aia`
+    bool aia = false;
+    bool test_intr_gen = false;
+    bool sifive_test = false;
+    bool nemu_console = false;
+    bool simple_fb = false;
+    bool pvclock = false;
+    bool flash = false; // Two CFI banks at 0x20000000 and 0x22000000
+
+    Peripheral uart;
+    Peripheral virtio_blk; // Only created when a disk image is given
+    Peripheral rtc;
+    Peripheral events;
+    Peripheral battery;
+    Peripheral rng; // No interrupt
+
+    std::filesystem::path disk;
+    std::filesystem::path flash0;
+    std::filesystem::path flash1;
+
+    // Log device registration to stdout
+    bool verbose = true;
+
+    [[nodiscard]] static MachineConfig profile(Profile profile,
+                                               size_t dram_size);
+
+    // Throws std::invalid_argument for an unknown profile name.
+    [[nodiscard]] static Profile parse_profile(std::string_view name);
+};
+
+} // namespace uemu
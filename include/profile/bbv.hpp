@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#include "common/types.hpp"
+
+namespace uemu::profile {
+
+// Basic-block vectors for SimPoint: every `interval` retired instructions,
+// one `T:id:count :id:count ...` line with the instructions executed in
+// each basic block, as valgrind's exp-bbv writes them. A block starts at
+// the target of a taken control transfer or trap and ends at the next
+// one; ids are dense, numbered from 1 in order of first execution.
+class BbvProfiler {
+public:
+    struct Options {
+        std::filesystem::path output;
+        uint64_t interval = 100'000'000;
+    };
+
+    explicit BbvProfiler(Options opts);
+    ~BbvProfiler();
+
+    BbvProfiler(const BbvProfiler&) = delete;
+    BbvProfiler& operator=(const BbvProfiler&) = delete;
+
+    // CPU thread, after each retired instruction
+    void retire(addr_t pc, addr_t next_pc, unsigned ilen) {
+        if (!in_block_) [[unlikely]] {
+            block_start_ = pc;
+            in_block_ = true;
+        }
+        block_insns_++;
+
+        if (next_pc != pc + ilen) [[unlikely]]
+            end_block();
+
+        if (++interval_insns_ == opts_.interval) [[unlikely]]
+            flush();
+    }
+
+    // CPU thread, after a trap was taken; the faulting instruction did not
+    // retire.
+    void trap() { end_block(); }
+
+    // Writes the final, partial interval.
+    void finish();
+
+    [[nodiscard]] uint64_t intervals() const noexcept { return intervals_; }
+
+    [[nodiscard]] size_t blocks() const noexcept { return ids_.size(); }
+
+private:
+    void end_block();
+    void commit();
+    void flush();
+
+    Options opts_;
+    std::ofstream out_;
+
+    bool in_block_ = false;
+    addr_t block_start_ = 0;
+    uint64_t block_insns_ = 0;
+    uint64_t interval_insns_ = 0;
+    uint64_t intervals_ = 0;
+
+    std::unordered_map<addr_t, uint32_t> ids_;
+    std::vector<uint64_t> counts_;  // By id - 1, for this interval
+    std::vector<uint32_t> touched_; // Ids with a count in this interval
+};
+
+} // namespace uemu::profile
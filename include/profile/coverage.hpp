@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/hart.hpp"
+#include "utils/symbol_table.hpp"
+
+namespace uemu::profile {
+
+// Guest code coverage without guest instrumentation: the basic blocks
+// executed at each privilege level, by virtual PC, written at exit in
+// drcov format for tools such as Lighthouse or bncov. Each block is looked
+// up once per execution in a small direct-mapped cache; only its first
+// execution (or a longer run through it) touches the hash set.
+class Coverage {
+public:
+    struct Options {
+        std::filesystem::path output;
+        std::filesystem::path system_map; // Kernel symbols, optional
+    };
+
+    explicit Coverage(Options opts);
+
+    Coverage(const Coverage&) = delete;
+    Coverage& operator=(const Coverage&) = delete;
+
+    // Blocks from `base`, where the image is loaded, to the end of its last
+    // symbol are reported as offsets into the module `path`. Others go to a
+    // catch-all module per privilege level and 4 GiB window.
+    void add_module(const std::string& path, addr_t base,
+                    const utils::SymbolTable& symbols);
+
+    // CPU thread, after each retired instruction
+    void retire(addr_t pc, addr_t next_pc, unsigned ilen,
+                core::PrivilegeLevel priv) {
+        if (!in_block_) [[unlikely]] {
+            block_start_ = pc;
+            block_priv_ = priv;
+            in_block_ = true;
+        }
+        block_end_ = pc + ilen;
+
+        if (next_pc != block_end_) [[unlikely]]
+            end_block();
+    }
+
+    // CPU thread, after a trap was taken; the faulting instruction did not
+    // retire.
+    void trap() {
+        if (in_block_)
+            end_block();
+    }
+
+    // Writes the drcov file. Throws std::runtime_error if it cannot.
+    void finish();
+
+    // Distinct blocks executed so far
+    [[nodiscard]] size_t blocks() const noexcept;
+
+private:
+    struct Module {
+        std::string path;
+        addr_t start;
+        addr_t end;
+    };
+
+    struct CacheEntry {
+        addr_t start = UINT64_MAX;
+        addr_t end = 0;
+        core::PrivilegeLevel priv{};
+    };
+
+    static constexpr size_t CACHE_SIZE = 4096;
+    static constexpr size_t PRIVS = 4; // Indexed by PrivilegeLevel
+
+    void end_block();
+
+    Options opts_;
+    std::vector<Module> modules_;
+
+    bool in_block_ = false;
+    addr_t block_start_ = 0;
+    addr_t block_end_ = 0;
+    core::PrivilegeLevel block_priv_{};
+
+    std::array<CacheEntry, CACHE_SIZE> cache_{};
+    // Block start to the furthest end seen, per privilege level
+    std::array<std::unordered_map<addr_t, addr_t>, PRIVS> blocks_;
+};
+
+} // namespace uemu::profile
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace uemu::profile {
+
+// Log-linear histogram in the style of HdrHistogram: each power of two is
+// split into 2^SUB_BITS buckets, so any recorded value is reported within
+// about 6% over the full uint64_t range while the table stays small. The
+// table is fixed, so recording never allocates.
+class HdrHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 4;
+    static constexpr uint64_t SUB_COUNT = 1ULL << SUB_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    void record(uint64_t v) noexcept {
+        counts_[index(v)]++;
+        count_++;
+        min_ = std::min(min_, v);
+        max_ = std::max(max_, v);
+    }
+
+    [[nodiscard]] uint64_t count() const noexcept { return count_; }
+    [[nodiscard]] uint64_t min() const noexcept { return count_ ? min_ : 0; }
+    [[nodiscard]] uint64_t max() const noexcept { return max_; }
+
+    // Highest value equivalent to the p-th quantile (0 <= p <= 1)
+    [[nodiscard]] uint64_t percentile(double p) const noexcept {
+        if (count_ == 0)
+            return 0;
+
+        const auto rank = static_cast<uint64_t>(
+            std::clamp(p, 0.0, 1.0) * static_cast<double>(count_ - 1));
+        uint64_t seen = 0;
+
+        for (size_t i = 0; i < counts_.size(); i++) {
+            seen += counts_[i];
+            if (seen > rank)
+                return std::min(highest_equivalent(i), max_);
+        }
+
+        return max_;
+    }
+
+private:
+    static size_t index(uint64_t v) noexcept {
+        if (v < SUB_COUNT)
+            return v;
+        const unsigned shift = std::bit_width(v) - SUB_BITS - 1;
+        return (shift + 1) * SUB_COUNT + ((v >> shift) - SUB_COUNT);
+    }
+
+    static uint64_t highest_equivalent(size_t i) noexcept {
+        if (i < SUB_COUNT)
+            return i;
+        const unsigned shift = i / SUB_COUNT - 1;
+        const uint64_t base = (SUB_COUNT + i % SUB_COUNT) << shift;
+        return base + ((1ULL << shift) - 1);
+    }
+
+    std::array<uint64_t, BUCKETS> counts_{};
+    uint64_t count_ = 0;
+    uint64_t min_ = std::numeric_limits<uint64_t>::max();
+    uint64_t max_ = 0;
+};
+
+} // namespace uemu::profile
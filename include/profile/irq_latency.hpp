@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <ostream>
+
+#include "common/stat_counter.hpp"
+#include "common/types.hpp"
+#include "profile/hdr_histogram.hpp"
+
+namespace uemu::profile {
+
+// Interrupt and trap latency, in host nanoseconds and guest instructions.
+// An interrupt is followed from assertion at its source (PLIC line raised,
+// CLINT deadline reached) to pending in mip to taken by handle_trap; a
+// trap of any cause from entry to the xRET that leaves its handler.
+//
+// Other threads only store timestamps; the histograms, one per cause and
+// edge, are recorded on the CPU thread and never allocate.
+class IrqLatency {
+public:
+    static constexpr unsigned CODES = 16;           // Interrupt codes tracked
+    static constexpr unsigned EXCEPTION_CODES = 32; // Exception codes tracked
+
+    // `instret` counts the hart's retired instructions.
+    explicit IrqLatency(const StatCounter& instret) : instret_(instret) {}
+
+    // The source of interrupt `code` fired `late_ns` before this call. Only
+    // the first assertion before the interrupt is taken counts. Any thread.
+    void asserted(unsigned code, uint64_t late_ns = 0) noexcept;
+
+    // mip bits that just went from 0 to 1. Any thread.
+    void pending(reg_t bits) noexcept;
+
+    // The hart vectored to the handler of `cause` (mcause encoding).
+    void taken(reg_t cause) noexcept;
+
+    // The hart executed an xRET.
+    void returned() noexcept;
+
+    // Forget the samples and the timestamps in flight, after the caller
+    // zeroed `instret`. CPU thread.
+    void restart() noexcept;
+
+    // Once the CPU thread has stopped
+    void report(std::ostream& out) const;
+
+private:
+    // Every trap has the first two; the others are for interrupts only.
+    enum Edge : unsigned {
+        ENTRY_XRET_NS,
+        ENTRY_XRET_INSNS,
+        ASSERT_PENDING_NS,
+        PENDING_TAKEN_NS,
+        PENDING_TAKEN_INSNS,
+        ASSERT_TAKEN_NS,
+        EDGES,
+    };
+
+    static constexpr unsigned TRAP_EDGES = ASSERT_PENDING_NS;
+
+    struct Frame {
+        reg_t cause;
+        uint64_t ns;
+        uint64_t insns;
+    };
+
+    static constexpr size_t MAX_NESTING = 8;
+
+    static uint64_t now_ns() noexcept;
+    void record(reg_t cause, Edge edge, uint64_t v) noexcept;
+
+    const StatCounter& instret_;
+
+    std::array<std::atomic<uint64_t>, CODES> asserted_ns_{};
+    std::array<std::atomic<uint64_t>, CODES> pending_ns_{};
+    std::array<std::atomic<uint64_t>, CODES> pending_insns_{};
+
+    // CPU thread: handlers currently running, innermost last
+    std::array<Frame, MAX_NESTING> frames_{};
+    size_t depth_ = 0;
+
+    // CPU thread, by code and edge
+    std::array<std::array<HdrHistogram, EDGES>, CODES> interrupts_{};
+    std::array<std::array<HdrHistogram, TRAP_EDGES>, EXCEPTION_CODES>
+        exceptions_{};
+};
+
+} // namespace uemu::profile
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+#include "device/device.hpp"
+
+namespace uemu::profile {
+
+// Per-register MMIO hot spots: how often each device offset is read and
+// written, and how much host time the device's handler took, as a log2
+// latency histogram. The report is sorted by total time, so the registers
+// most worth paravirtualizing come first.
+class MmioProfiler {
+public:
+    static constexpr size_t BUCKETS = 32; // Bucket i: [2^i, 2^(i+1)) ns
+
+    struct Entry {
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t total_ns = 0;
+        std::array<uint64_t, BUCKETS> histogram{};
+
+        [[nodiscard]] uint64_t count() const noexcept { return reads + writes; }
+
+        // Upper bound of the bucket holding the p-th quantile
+        [[nodiscard]] uint64_t percentile_ns(double p) const noexcept;
+    };
+
+    // Times a device access and records it.
+    template <typename F>
+    auto measure(const device::Device& dev, addr_t addr, bool write, F&& f) {
+        using clock = std::chrono::steady_clock;
+
+        const auto start = clock::now();
+        auto result = f();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            clock::now() - start)
+                            .count();
+
+        record(dev, addr - dev.start(), write, static_cast<uint64_t>(ns));
+        return result;
+    }
+
+    void record(const device::Device& dev, addr_t offset, bool write,
+                uint64_t ns);
+
+    void report(std::ostream& out) const;
+
+private:
+    struct Key {
+        const device::Device* dev;
+        addr_t offset;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& k) const noexcept {
+            return std::hash<const void*>{}(k.dev) ^
+                   (k.offset * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    // Devices may also be touched from the device thread.
+    mutable std::mutex mutex_;
+    std::unordered_map<Key, Entry, KeyHash> entries_;
+};
+
+} // namespace uemu::profile
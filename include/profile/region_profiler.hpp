@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+
+#include "core/bus.hpp"
+#include "core/hart.hpp"
+
+namespace uemu::profile {
+
+// Per-region statistics for code the guest brackets with the marker CSRs
+// (core::REGIONMARKER): instructions, host wall time, TLB misses, traps
+// and MMIO accesses between region_begin(id) and region_end(id), summed
+// over every run of the region. Driven from the CPU thread.
+class RegionProfiler {
+public:
+    RegionProfiler(const core::Hart& hart, const core::Bus& bus)
+        : hart_(hart), bus_(bus) {}
+
+    void begin(reg_t id);
+    void end(reg_t id);
+
+    [[nodiscard]] std::string json() const;
+
+private:
+    struct Counters {
+        uint64_t instructions = 0;
+        uint64_t wall_ns = 0;
+        uint64_t itlb_misses = 0;
+        uint64_t dtlb_misses = 0;
+        uint64_t page_walks = 0;
+        uint64_t exceptions = 0;
+        uint64_t interrupts = 0;
+        uint64_t mmio_reads = 0;
+        uint64_t mmio_writes = 0;
+    };
+
+    struct Region {
+        uint64_t runs = 0;
+        Counters total;
+        uint64_t min_wall_ns = UINT64_MAX;
+        uint64_t max_wall_ns = 0;
+    };
+
+    [[nodiscard]] Counters snapshot() const;
+
+    const core::Hart& hart_;
+    const core::Bus& bus_;
+    const std::chrono::steady_clock::time_point start_ =
+        std::chrono::steady_clock::now();
+
+    std::map<reg_t, Counters> open_; // Counters at region_begin
+    std::map<reg_t, Region> regions_;
+    uint64_t unmatched_ends_ = 0;
+};
+
+} // namespace uemu::profile
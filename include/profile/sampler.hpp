@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/spsc_queue.hpp"
+#include "core/dram.hpp"
+#include "core/hart.hpp"
+#include "utils/symbol_table.hpp"
+
+namespace uemu::core {
+class MMU;
+} // namespace uemu::core
+
+namespace uemu::profile {
+
+// Statistical guest profiler. The CPU thread calls poll() once per batch of
+// instructions; when a sample is due it records the pc, privilege, satp and
+// the frame-pointer call chain into a lock-free queue, and a background
+// thread aggregates identical stacks. Symbolization happens only once, when
+// the report is written.
+//
+// Stacks are rooted at the context they ran in: [firmware] for M-mode,
+// [kernel] for S-mode and [user] followed by the process, named after the
+// Linux task's comm when its offset is known and by satp otherwise.
+class Sampler {
+public:
+    static constexpr unsigned BATCH = 256; // Instructions per poll()
+    static constexpr size_t MAX_DEPTH = 32;
+    static constexpr size_t TASK_COMM_LEN = 16;
+
+    struct Options {
+        std::filesystem::path output; // Folded stacks ("a;b;c count")
+        uint64_t period = 0;          // Instructions per sample; 0 = timer
+        unsigned frequency = 1000;    // Host-timer samples per second
+        std::filesystem::path system_map; // Kernel symbols, optional
+        // offsetof(struct task_struct, comm) in the guest kernel
+        std::optional<uint64_t> comm_offset;
+    };
+
+    struct Breakdown {
+        uint64_t firmware = 0;
+        uint64_t kernel = 0;
+        uint64_t user = 0;
+        std::map<std::string, uint64_t> processes; // User samples by process
+    };
+
+    struct Sample {
+        addr_t pc;
+        reg_t satp;
+        core::PrivilegeLevel priv;
+        uint8_t depth;
+        std::array<addr_t, MAX_DEPTH> callers; // Innermost first
+        std::array<char, TASK_COMM_LEN> comm;  // Empty if unknown
+    };
+
+    Sampler(core::Hart& hart, core::MMU& mmu, core::Dram& dram,
+            Options opts);
+    ~Sampler();
+
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    void poll() noexcept {
+        insns_ += BATCH;
+
+        if (opts_.period) {
+            if (insns_ < next_sample_)
+                return;
+            next_sample_ = insns_ + opts_.period;
+        } else if (!timer_due_.load(std::memory_order_relaxed)) {
+            return;
+        } else {
+            timer_due_.store(false, std::memory_order_relaxed);
+        }
+
+        take_sample();
+    }
+
+    // Stops sampling and writes the report. Safe to call once the CPU
+    // thread has stopped.
+    void finish(const utils::SymbolTable& symbols);
+
+    [[nodiscard]] uint64_t samples() const noexcept { return total_; }
+    [[nodiscard]] uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    // Where the samples went, valid after finish()
+    [[nodiscard]] const Breakdown& breakdown() const noexcept {
+        return breakdown_;
+    }
+
+private:
+    void take_sample() noexcept;
+    [[nodiscard]] std::optional<uint64_t>
+    read_guest(addr_t va, core::PrivilegeLevel priv) const noexcept;
+    void read_comm(Sample& s) const noexcept;
+    void account(const Sample& s);
+    void drain();
+    void stop();
+
+    [[nodiscard]] static std::string process(const Sample& s);
+    [[nodiscard]] std::string
+    frame_name(addr_t addr, core::PrivilegeLevel priv,
+               const utils::SymbolTable& symbols) const;
+
+    core::Hart& hart_;
+    core::MMU& mmu_;
+    core::Dram& dram_;
+    Options opts_;
+    utils::SymbolTable kernel_symbols_;
+
+    // CPU thread
+    uint64_t insns_ = 0;
+    uint64_t next_sample_ = 0;
+
+    std::atomic_bool timer_due_{false};
+    std::atomic_bool running_{true};
+    std::atomic<uint64_t> dropped_{0};
+    SpscQueue<Sample, 1024> queue_;
+    std::thread timer_thread_;
+    std::thread drain_thread_;
+
+    // Drain thread: {context, {priv, pc, callers...}} -> count
+    std::map<std::pair<std::string, std::vector<addr_t>>, uint64_t> stacks_;
+    Breakdown breakdown_;
+    uint64_t total_ = 0;
+};
+
+} // namespace uemu::profile
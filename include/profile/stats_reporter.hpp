@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "core/bus.hpp"
+#include "core/hart.hpp"
+
+namespace uemu::profile {
+
+// Reports the emulator's self-statistics (HartStats and per-device MMIO
+// counts) as JSON: every `interval`, when the process gets SIGUSR1, and
+// optionally once more when the run is over.
+class StatsReporter {
+public:
+    struct Options {
+        std::filesystem::path output; // Empty: stderr
+        std::chrono::milliseconds interval{0}; // 0: no periodic dumps
+        bool on_exit = true;
+    };
+
+    StatsReporter(const core::Hart& hart, const core::Bus& bus, Options opts);
+    ~StatsReporter();
+
+    StatsReporter(const StatsReporter&) = delete;
+    StatsReporter& operator=(const StatsReporter&) = delete;
+
+    [[nodiscard]] static std::string
+    json(const core::Hart& hart, const core::Bus& bus,
+         std::chrono::nanoseconds elapsed);
+
+    [[nodiscard]] std::string json() const;
+
+    // Final report; stops the reporting thread.
+    void finish();
+
+    // Measure elapsed time from now on, after the caller zeroed the
+    // counters.
+    void restart();
+
+private:
+    void run();
+    void stop();
+    void dump() const;
+
+    const core::Hart& hart_;
+    const core::Bus& bus_;
+    Options opts_;
+    std::chrono::steady_clock::time_point start_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+} // namespace uemu::profile
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "common/types.hpp"
+
+namespace uemu::profile {
+
+// Rebuilds the executed instruction stream from a Tracer file. Code comes
+// from images at the virtual addresses it ran at; the decoder walks from
+// each recorded target to the next discontinuity, printing one instruction
+// per line and a '#' comment for traps, context changes and gaps where no
+// image covers the pc.
+class TraceDecoder {
+public:
+    struct Stats {
+        uint64_t instructions = 0;
+        uint64_t branches = 0;
+        uint64_t traps = 0;
+        uint64_t gaps = 0;
+    };
+
+    // PT_LOAD segments at their virtual addresses
+    void add_elf(const std::filesystem::path& path);
+
+    // A flat binary loaded at `base`
+    void add_raw(const std::filesystem::path& path, addr_t base);
+
+    void add_image(addr_t base, std::vector<uint8_t> bytes);
+
+    // Throws std::runtime_error on a malformed trace.
+    Stats decode(std::span<const uint8_t> trace, std::ostream& out) const;
+
+private:
+    struct Image {
+        addr_t base;
+        std::vector<uint8_t> bytes;
+    };
+
+    [[nodiscard]] std::optional<uint32_t> fetch(addr_t pc) const noexcept;
+
+    void walk(addr_t pc, addr_t stop, bool inclusive, std::ostream& out,
+              Stats& stats) const;
+
+    std::vector<Image> images_;
+};
+
+} // namespace uemu::profile
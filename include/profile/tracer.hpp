@@ -0,0 +1,158 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "core/hart.hpp"
+
+namespace uemu::profile {
+
+// Control-flow trace. Only discontinuities are recorded: taken branches and
+// jumps (including xRET) as a from/to pair, traps with their cause, and
+// context (privilege/satp) changes. Addresses are varint deltas against the
+// previous target, so a typical taken branch costs two bytes. The decoder
+// rebuilds every instruction in between from the guest images.
+//
+// The stream is a magic string followed by chunks of records. Each chunk
+// opens with a SYNC record holding absolute state, so in ring mode, where
+// only the newest chunks are kept, decoding can start at any chunk.
+class Tracer {
+public:
+    static constexpr char MAGIC[8] = {'U', 'E', 'M', 'U', 'T', 'R', 'C', '1'};
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    // Low 3 bits of a record's header byte
+    enum Record : uint8_t {
+        SYNC = 0,    // varint pc, varint satp, byte priv
+        BRANCH = 1,  // [skip], zigzag to - from
+        TRAP = 2,    // [skip], zigzag to - from, varint cause
+        CONTEXT = 3, // priv in bits 4-5, bit 3: varint satp follows
+        END = 4,     // [skip]
+    };
+
+    // [skip] is from - previous target: (skip / 2 + 1) in the header's top
+    // five bits when small and even, else 0 and a zigzag varint.
+    static constexpr unsigned SKIP_SHIFT = 3;
+    static constexpr addr_t SKIP_INLINE_MAX = 62;
+
+    struct Options {
+        std::filesystem::path output;
+        size_t ring_size = 0; // Keep only the newest bytes; 0 = keep all
+    };
+
+    Tracer(core::Hart& hart, Options opts);
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    // The instruction at `from` moved pc to `to`
+    void branch(addr_t from, addr_t to) noexcept {
+        uint8_t* p = reserve();
+        p = put_skip(p, BRANCH, from);
+        p = put_varint(p, zigzag(to - from));
+        commit(p, to);
+    }
+
+    // A trap was taken with pc at `from` (not retired) and entered `to`
+    void trap(addr_t from, addr_t to, core::TrapCause cause) noexcept {
+        const reg_t c = static_cast<reg_t>(cause);
+        uint8_t* p = reserve();
+        p = put_skip(p, TRAP, from);
+        p = put_varint(p, zigzag(to - from));
+        p = put_varint(p, (c << 1) | (c >> 63));
+        commit(p, to);
+    }
+
+    // Record the final pc and write everything out
+    void finish();
+
+    [[nodiscard]] uint64_t bytes() const noexcept {
+        return written_ + pos_;
+    }
+
+    [[nodiscard]] static uint64_t zigzag(addr_t v) noexcept {
+        return (v << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(v) >> 63);
+    }
+
+    [[nodiscard]] static addr_t unzigzag(uint64_t v) noexcept {
+        return (v >> 1) ^ (0 - (v & 1));
+    }
+
+private:
+    static constexpr size_t MAX_RECORD = 64; // A record plus a context
+
+    static uint8_t* put_varint(uint8_t* p, uint64_t v) noexcept {
+        while (v >= 0x80) {
+            *p++ = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        *p++ = static_cast<uint8_t>(v);
+        return p;
+    }
+
+    uint8_t* put_skip(uint8_t* p, Record type, addr_t from) noexcept {
+        const addr_t skip = from - last_;
+        if (skip < SKIP_INLINE_MAX && !(skip & 1)) [[likely]] {
+            *p++ = static_cast<uint8_t>(type | (skip / 2 + 1) << SKIP_SHIFT);
+            return p;
+        }
+        *p++ = type;
+        return put_varint(p, zigzag(skip));
+    }
+
+    uint8_t* reserve() noexcept {
+        if (pos_ > CHUNK_SIZE - MAX_RECORD) [[unlikely]]
+            next_chunk();
+        return buf_.data() + pos_;
+    }
+
+    void commit(uint8_t* p, addr_t target) noexcept {
+        pos_ = static_cast<size_t>(p - buf_.data());
+        last_ = target;
+
+        // Privilege only changes across a trap or xRET, but an S-mode
+        // kernel switches satp without one, so both are compared. The new
+        // context takes effect at `target`.
+        if (hart_.priv != priv_ || satp_csr_.read_unchecked() != satp_)
+            [[unlikely]]
+            put_context();
+    }
+
+    void put_sync() noexcept;
+    void put_context() noexcept;
+    void next_chunk() noexcept;
+
+    core::Hart& hart_;
+    const core::CSR& satp_csr_;
+    Options opts_;
+    std::ofstream out_;
+
+    std::vector<uint8_t> buf_;
+    size_t pos_ = 0;
+    std::deque<std::vector<uint8_t>> ring_; // Ring mode: retained chunks
+    uint64_t written_ = 0;
+
+    addr_t last_;
+    core::PrivilegeLevel priv_;
+    reg_t satp_;
+};
+
+} // namespace uemu::profile
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "ui/pixel_source.hpp"
+
+namespace uemu::ui {
+
+// Captures frames from a PixelSource without a window: periodic or
+// on-change dumps, a raw video stream, and a final golden-image check.
+class FrameCapture {
+public:
+    enum class Format : uint8_t { Png, Raw };
+
+    struct Options {
+        std::filesystem::path dir;    // Per-frame dumps (empty = off)
+        Format format = Format::Png;  // Format of the per-frame dumps
+        unsigned fps = 0;             // 0 = whenever the frame changes
+        std::filesystem::path stream; // Raw XRGB8888 frames (file or FIFO)
+        std::filesystem::path golden; // Compared with the final frame
+        unsigned tolerance = 0;       // Max per-channel difference
+        double max_mismatch = 0.0;    // Fraction of pixels over tolerance
+    };
+
+    struct CompareResult {
+        size_t mismatched_pixels;
+        unsigned max_delta;
+    };
+
+    FrameCapture(std::shared_ptr<PixelSource> pixel_source, Options options);
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Called from the UI thread once per frame.
+    void poll(std::chrono::steady_clock::time_point now);
+
+    // Captures the final frame and runs the golden comparison, if any.
+    // Returns whether the comparison passed.
+    std::optional<bool> finish();
+
+    [[nodiscard]] uint64_t frame_hash() const noexcept { return hash_; }
+    [[nodiscard]] size_t frames_written() const noexcept { return written_; }
+
+    // Hash of an XRGB8888 frame; the unused X byte is ignored.
+    [[nodiscard]] static uint64_t hash_frame(const uint8_t* data, size_t size);
+
+    // Compares two XRGB8888 frames of equal size; the X byte is ignored.
+    [[nodiscard]] static CompareResult compare_frames(const uint8_t* a,
+                                                      const uint8_t* b,
+                                                      size_t size,
+                                                      unsigned tolerance);
+
+private:
+    // Pulls the dirty rows into frame_ and returns whether the image changed.
+    bool refresh();
+    void dump_frame();
+    void write_png(const std::filesystem::path& path) const;
+    std::optional<bool> compare_golden() const;
+
+    std::shared_ptr<PixelSource> pixel_source_;
+    Options options_;
+
+    size_t width_;
+    size_t height_;
+    size_t pitch_;
+    std::vector<uint8_t> frame_;
+    std::vector<PixelSource::DirtySpan> dirty_spans_;
+
+    uint64_t hash_ = 0;
+    bool have_frame_ = false;
+    size_t written_ = 0;
+
+    std::optional<std::chrono::steady_clock::time_point> next_capture_;
+    std::FILE* stream_ = nullptr;
+};
+
+} // namespace uemu::ui
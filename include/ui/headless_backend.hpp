@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "ui/frame_capture.hpp"
 #include "ui/host_console.hpp"
 #include "ui/ui_backend.hpp"
 
@@ -23,14 +24,29 @@ namespace uemu::ui {
 
 class HeadlessBackend : public UIBackend {
 public:
-    HeadlessBackend(Endpoints endpoints) : UIBackend(std::move(endpoints)) {
-        HostConsole::apply_to_endpoint(*endpoints_.console_endpoint);
+    HeadlessBackend(Endpoints endpoints,
+                    std::optional<FrameCapture::Options> capture = std::nullopt)
+        : UIBackend(std::move(endpoints)) {
+        if (endpoints_.console_endpoint)
+            HostConsole::apply_to_endpoint(*endpoints_.console_endpoint);
+
+        if (capture && endpoints_.pixel_source)
+            capture_ = std::make_unique<FrameCapture>(endpoints_.pixel_source,
+                                                      std::move(*capture));
+    }
+
+    void update() override {
+        if (capture_)
+            capture_->poll(std::chrono::steady_clock::now());
     }
 
-    void update() override {}
+    std::optional<bool> finish() override {
+        return capture_ ? capture_->finish() : std::nullopt;
+    }
 
 private:
     HostConsole host_console_;
+    std::unique_ptr<FrameCapture> capture_;
 };
 
 } // namespace uemu::ui
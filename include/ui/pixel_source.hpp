@@ -16,12 +16,20 @@
 
 #pragma once
 
-#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace uemu::ui {
 
 class PixelSource {
 public:
+    // A run of consecutive scanlines modified since the last collection.
+    struct DirtySpan {
+        size_t first_row;
+        size_t num_rows;
+    };
+
     virtual ~PixelSource() = default;
 
     [[nodiscard]] virtual size_t get_width() const = 0;
@@ -30,7 +38,10 @@ public:
 
     [[nodiscard]] virtual const uint8_t* get_pixels() const = 0;
 
-    [[nodiscard]] virtual std::unique_lock<std::mutex> acquire_lock() const = 0;
+    // Appends the dirty spans to `spans` and marks them clean. Lock-free: the
+    // pixels of the returned rows must be read after this call, and any row
+    // the producer touches meanwhile is reported again on the next call.
+    virtual void take_dirty_spans(std::vector<DirtySpan>& spans) = 0;
 };
 
 } // namespace uemu::ui
@@ -25,11 +25,19 @@ namespace uemu::ui {
 
 class SDL3Backend : public UIBackend {
 public:
-    SDL3Backend(Endpoints endpoints);
+    static constexpr unsigned DEFAULT_FPS = 60;
+
+    // fps == 0 paces frames to the display refresh rate with vsync on.
+    SDL3Backend(Endpoints endpoints, unsigned fps = DEFAULT_FPS);
     ~SDL3Backend() override;
 
     void update() override;
 
+    [[nodiscard]] std::chrono::microseconds
+    frame_interval() const noexcept override {
+        return frame_interval_;
+    }
+
 private:
     void update_view();
 
@@ -42,7 +50,10 @@ private:
 
     size_t display_width_ = 0;
     size_t display_height_ = 0;
-    std::vector<uint8_t> pixel_buffer_;
+    std::chrono::microseconds frame_interval_{};
+    std::vector<PixelSource::DirtySpan> dirty_spans_;
+    bool redraw_pending_ = true;
+    bool reupload_pending_ = false;
 
     HostConsole host_console_;
 };
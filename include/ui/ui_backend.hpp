@@ -16,10 +16,13 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 
+#include "common/spsc_queue.hpp"
 #include "ui/console_endpoint.hpp"
 #include "ui/input_sink.hpp"
 #include "ui/pixel_source.hpp"
@@ -46,17 +49,44 @@ public:
 
     virtual ~UIBackend() { initialized_ = false; }
 
+    // Runs on the UI thread once per frame: pumps host events and presents.
     virtual void update() = 0;
 
+    // Called once after the guest stops. Returns a pass/fail verdict if the
+    // backend was asked to check something (e.g. a golden frame).
+    virtual std::optional<bool> finish() { return std::nullopt; }
+
+    // How often the UI thread calls update().
+    [[nodiscard]] virtual std::chrono::microseconds
+    frame_interval() const noexcept {
+        return std::chrono::milliseconds(10);
+    }
+
+    // Runs on the device thread: forwards queued input to the InputSink, so
+    // the UI thread never contends with the guest for the device lock.
+    void deliver_input() {
+        while (auto event = input_queue_.pop())
+            endpoints_.input_sink->push_key_event(*event);
+    }
+
 protected:
     void request_exit() const {
         if (endpoints_.exit_callback)
             endpoints_.exit_callback();
     }
 
+    void queue_key_event(InputSink::KeyEvent event) noexcept {
+        if (endpoints_.input_sink)
+            input_queue_.push(event); // Dropped if the guest lags behind
+    }
+
     Endpoints endpoints_;
 
 private:
+    static constexpr size_t INPUT_QUEUE_SIZE = 256;
+
+    SpscQueue<InputSink::KeyEvent, INPUT_QUEUE_SIZE> input_queue_;
+
     static bool initialized_;
 };
 
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <filesystem>
+
+#include "core/hart.hpp"
+#include "device/clint.hpp"
+
+namespace uemu::utils {
+
+// Saves and restores a bare-metal machine: the hart's architectural state,
+// DRAM (non-zero pages only) and the CLINT. No other device is saved, so a
+// checkpoint suits workloads that only talk to HTIF or a console; it is
+// restored on top of a machine that loaded the same program.
+class Checkpoint {
+public:
+    Checkpoint() = delete;
+    ~Checkpoint() = delete;
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint& operator=(const Checkpoint&) = delete;
+
+    static constexpr char MAGIC[8] = {'U', 'E', 'M', 'U', 'C', 'K', 'P', '1'};
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    // The simulation slice the checkpoint was taken for, in instructions:
+    // `warmup` to run before measuring `length`. Zero when not sampling.
+    struct Slice {
+        uint64_t interval = 0; // SimPoint interval index
+        uint64_t warmup = 0;
+        uint64_t length = 0;
+    };
+
+    // Throws std::runtime_error if `path` cannot be written. `slice` is
+    // {} outside of sampled simulation.
+    static void save(const std::filesystem::path& path, const core::Hart& hart,
+                     const core::Dram& dram, device::Clint* clint,
+                     const Slice& slice);
+
+    // Throws std::runtime_error if `path` is not a checkpoint of a machine
+    // with this DRAM size.
+    static Slice restore(const std::filesystem::path& path, core::Hart& hart,
+                         core::Dram& dram, device::Clint* clint);
+};
+
+} // namespace uemu::utils
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "core/bus.hpp"
+#include "utils/fdt.hpp"
+
+namespace uemu::device {
+
+// State shared by the per-device node emitters while a device tree is being
+// built. Interrupt controllers are registered on the bus before the devices
+// wired to them, so they publish their phandles here for later emitters.
+struct DtContext {
+    utils::Fdt::Node& root;
+    utils::Fdt::Node& soc;
+
+    std::vector<uint32_t> cpu_intc{}; // Per-hart "riscv,cpu-intc" phandles
+    std::vector<std::string> isa_extensions{};
+
+    uint32_t irq_parent = 0; // Wired interrupt controller
+    uint32_t irq_cells = 1;
+    uint32_t msi_parent = 0; // Supervisor-level IMSIC
+
+    uint32_t next_phandle = 1;
+
+    uint32_t alloc_phandle() noexcept { return next_phandle++; }
+};
+
+} // namespace uemu::device
+
+namespace uemu::utils {
+
+// Builds the device tree of the running machine: harts, DRAM and whatever
+// devices are registered on the bus, each contributing its own node.
+class DeviceTree {
+public:
+    DeviceTree() = delete;
+    ~DeviceTree() = delete;
+    DeviceTree(const DeviceTree&) = delete;
+    DeviceTree& operator=(const DeviceTree&) = delete;
+
+    struct Config {
+        size_t dram_size;
+        unsigned num_harts = 1;
+        reg_t misa;                  // Selects the single-letter extensions
+        uint64_t timebase_frequency; // CLINT mtime rate
+        std::string bootargs;
+    };
+
+    [[nodiscard]] static Fdt build(const core::Bus& bus, const Config& cfg);
+};
+
+} // namespace uemu::utils
@@ -18,11 +18,16 @@
 
 #include <elf.h>
 #include <filesystem>
+#include <span>
+#include <vector>
 
 #include "core/dram.hpp"
+#include "utils/symbol_table.hpp"
 
 namespace uemu::utils {
 
+class MappedFile;
+
 class ElfLoader {
 public:
     ElfLoader() = delete;
@@ -30,18 +35,38 @@ public:
     ElfLoader(const ElfLoader&) = delete;
     ElfLoader& operator=(const ElfLoader&) = delete;
 
+    // Physical range [start, end) a PT_LOAD segment occupies, bss included
+    struct Segment {
+        addr_t start;
+        addr_t end;
+    };
+
+    struct Image {
+        uint64_t entry;
+        uint64_t load_base; // Lowest PT_LOAD virtual address
+        std::vector<Segment> segments;
+        SymbolTable symbols;
+    };
+
     static bool is_elf(const std::filesystem::path& p);
 
-    static uint64_t load(const std::filesystem::path& p, core::Dram& dram);
+    // Places every PT_LOAD segment at its physical address. The file is
+    // mapped rather than read and segments are copied from the mapping.
+    // With `map_segments`, page-aligned parts of a segment are mapped
+    // copy-on-write into DRAM instead, and the file must then stay intact
+    // for as long as the guest runs (see Dram::map_file).
+    static Image load(const std::filesystem::path& p, core::Dram& dram,
+                      bool map_segments = false);
 
-private:
-    static const Elf64_Shdr* get_section_header(const uint8_t* file_data,
-                                                const char* name);
+    // Function, object and untyped symbols from the file's .symtab, except
+    // absolute ones such as linker-script constants
+    static SymbolTable read_symbols(std::span<const uint8_t> file);
 
-    static const Elf64_Sym* get_symbol(const uint8_t* file_data,
-                                       const char* name);
+private:
+    static void load_segment(const MappedFile& file, const Elf64_Phdr& phdr,
+                             core::Dram& dram, bool map);
 
-    static void validate_elf_header(const Elf64_Ehdr* hdr);
+    static const Elf64_Ehdr* validate_elf_header(std::span<const uint8_t> file);
 };
 
 } // namespace uemu::utils
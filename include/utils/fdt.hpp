@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace uemu::utils {
+
+struct FdtProperty {
+    std::string name;
+    std::vector<uint8_t> value;
+};
+
+// A device tree node. Declared outside Fdt, as Fdt::Node, so that headers
+// such as device/device.hpp can forward-declare it.
+struct FdtNode {
+    std::string name;
+    std::vector<FdtProperty> props;
+    std::vector<FdtNode> children;
+
+    [[nodiscard]] FdtNode* find_child(std::string_view child_name);
+    [[nodiscard]] const FdtProperty*
+    find_prop(std::string_view prop_name) const;
+
+    // Returns the named child, appending it if missing. The reference is
+    // invalidated by adding further children to this node.
+    FdtNode& child(std::string_view child_name);
+
+    void set_prop(std::string_view prop_name, std::vector<uint8_t> value);
+    void set_empty(std::string_view prop_name);
+    void set_u32(std::string_view prop_name, uint32_t value);
+    void set_u64(std::string_view prop_name, uint64_t value);
+    void set_string(std::string_view prop_name, std::string_view value);
+    void set_strings(std::string_view prop_name,
+                     std::initializer_list<std::string_view> values);
+    void set_cells(std::string_view prop_name,
+                   std::initializer_list<uint32_t> cells);
+    void set_cells(std::string_view prop_name,
+                   std::span<const uint32_t> cells);
+    // Appends big-endian cells to a property, creating it if missing.
+    void append_cells(std::string_view prop_name,
+                      std::span<const uint32_t> cells);
+    void remove_prop(std::string_view prop_name);
+};
+
+// In-memory flattened device tree: parse an existing blob, edit nodes and
+// properties, and serialise it back (DTB format v17).
+class Fdt {
+public:
+    static constexpr uint32_t MAGIC = 0xd00dfeed;
+    static constexpr uint32_t VERSION = 17;
+    static constexpr uint32_t LAST_COMP_VERSION = 16;
+
+    using Property = FdtProperty;
+    using Node = FdtNode;
+
+    Fdt() = default;
+
+    // Throws std::runtime_error on a malformed blob.
+    [[nodiscard]] static Fdt parse(std::span<const uint8_t> blob);
+
+    [[nodiscard]] std::vector<uint8_t> serialize() const;
+
+    Node& root() noexcept { return root_; }
+    const Node& root() const noexcept { return root_; }
+
+    // Looks up an absolute path such as "/soc/serial@10000000".
+    [[nodiscard]] Node* find(std::string_view path);
+
+    uint32_t boot_cpuid_phys = 0;
+
+private:
+    Node root_;
+};
+
+} // namespace uemu::utils
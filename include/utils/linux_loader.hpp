@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "core/dram.hpp"
+#include "utils/fdt.hpp"
+
+namespace uemu::utils {
+
+// Places a RISC-V Linux kernel, an optional initrd and the device tree in
+// DRAM so that the kernel can be entered directly in S-mode.
+class LinuxLoader {
+public:
+    LinuxLoader() = delete;
+    ~LinuxLoader() = delete;
+    LinuxLoader(const LinuxLoader&) = delete;
+    LinuxLoader& operator=(const LinuxLoader&) = delete;
+
+    // Default RV64 Image text offset (2 MiB) for images without a header
+    static constexpr addr_t DEFAULT_TEXT_OFFSET = 0x200000;
+    static constexpr uint32_t IMAGE_MAGIC2 = 0x05435352; // "RSC\x05"
+    static constexpr size_t MAX_FDT_SIZE = 0x100000;
+
+    struct Options {
+        std::filesystem::path kernel; // Image or flat binary
+        std::filesystem::path initrd;
+        std::string append; // Kernel command line
+    };
+
+    struct BootInfo {
+        addr_t entry;
+        addr_t dtb_addr;
+        addr_t initrd_start;
+        addr_t initrd_end;
+    };
+
+    // Where the device tree goes: 2 MiB aligned near the top of the first
+    // 3 GiB of DRAM, which every kernel maps early.
+    [[nodiscard]] static addr_t fdt_address(const core::Dram& dram) noexcept;
+
+    // Fills /chosen (bootargs, initrd range) in `fdt` and writes everything
+    // to DRAM. Throws std::runtime_error if the images do not fit.
+    static BootInfo load(const Options& opts, Fdt& fdt, core::Dram& dram);
+};
+
+} // namespace uemu::utils
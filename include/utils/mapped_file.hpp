@@ -0,0 +1,50 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace uemu::utils {
+
+// A whole file mapped read-only, for parsing without copying it first.
+class MappedFile {
+public:
+    // Throws std::runtime_error if the file cannot be opened or mapped.
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] std::span<const uint8_t> data() const noexcept {
+        return {data_, size_};
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+
+    // Still open, for mapping parts of the file elsewhere
+    [[nodiscard]] int fd() const noexcept { return fd_; }
+
+private:
+    int fd_;
+    const uint8_t* data_;
+    size_t size_;
+};
+
+} // namespace uemu::utils
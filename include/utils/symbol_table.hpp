@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace uemu::utils {
+
+struct Symbol {
+    std::string name;
+    uint64_t addr;
+    uint64_t size; // 0 if unknown, e.g. assembly labels
+};
+
+// Symbols indexed both by name (hashed) and by address (sorted), so that
+// loaders and tracing tools can go either way cheaply.
+class SymbolTable {
+public:
+    SymbolTable() = default;
+    explicit SymbolTable(std::vector<Symbol> symbols);
+
+    // Text symbols from an `nm`-style listing such as a kernel System.map.
+    // Throws std::runtime_error if the file cannot be read.
+    [[nodiscard]] static SymbolTable
+    load_system_map(const std::filesystem::path& path);
+
+    [[nodiscard]] std::optional<uint64_t> lookup(std::string_view name) const;
+
+    // The symbol covering `addr`: the closest one at or below it, if `addr`
+    // lies within its size (or it has none). nullptr otherwise.
+    [[nodiscard]] const Symbol* find(uint64_t addr) const noexcept;
+
+    [[nodiscard]] bool empty() const noexcept { return by_addr_.empty(); }
+    [[nodiscard]] size_t size() const noexcept { return by_addr_.size(); }
+
+    [[nodiscard]] const std::vector<Symbol>& symbols() const noexcept {
+        return by_addr_;
+    }
+
+private:
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const noexcept {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    std::vector<Symbol> by_addr_;
+    std::unordered_map<std::string, uint64_t, Hash, std::equal_to<>> by_name_;
+};
+
+} // namespace uemu::utils
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2025-2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/bus.hpp"
+#include "profile/mmio_profiler.hpp"
+
+namespace uemu::core {
+
+std::optional<uint64_t> Bus::timed_read(device::Device& dev, addr_t addr,
+                                        size_t size) noexcept {
+    return mmio_profiler_->measure(
+        dev, addr, false, [&]() -> std::optional<uint64_t> {
+            switch (size) {
+                case 1: return dev.read<uint8_t>(addr);
+                case 2: return dev.read<uint16_t>(addr);
+                case 4: return dev.read<uint32_t>(addr);
+                default: return dev.read<uint64_t>(addr);
+            }
+        });
+}
+
+bool Bus::timed_write(device::Device& dev, addr_t addr, size_t size,
+                      uint64_t value) noexcept {
+    return mmio_profiler_->measure(dev, addr, true, [&] {
+        switch (size) {
+            case 1: return dev.write<uint8_t>(addr, value);
+            case 2: return dev.write<uint16_t>(addr, value);
+            case 4: return dev.write<uint32_t>(addr, value);
+            default: return dev.write<uint64_t>(addr, value);
+        }
+    });
+}
+
+} // namespace uemu::core
@@ -20,7 +20,9 @@
 #include "common/float.hpp"
 #include "core/execute.hpp"
 #include "core/hart.hpp"
+#include "core/linux_user.hpp"
 #include "core/mmu.hpp"
+#include "core/sbi.hpp"
 
 namespace uemu::core {
 
@@ -257,9 +259,17 @@ IMPL(ecall, {
             Trap::raise_exception(pc, TrapCause::EnvironmentCallFromM, 0);
             break;
         case PrivilegeLevel::S:
+            if (Sbi* sbi = hart->get_sbi()) {
+                sbi->handle_ecall();
+                break;
+            }
             Trap::raise_exception(pc, TrapCause::EnvironmentCallFromS, 0);
             break;
         case PrivilegeLevel::U:
+            if (LinuxUser* user = hart->get_linux_user()) {
+                user->handle_ecall();
+                break;
+            }
             Trap::raise_exception(pc, TrapCause::EnvironmentCallFromU, 0);
             break;
         default: std::unreachable();
@@ -289,6 +299,9 @@ IMPL(mret, {
     mstatus &= ~MSTATUS::Field::MPP;
 
     hart->csrs[MSTATUS::ADDRESS]->write_unchecked(mstatus);
+
+    if (auto* latency = hart->get_irq_latency()) [[unlikely]]
+        latency->returned();
 })
 IMPL(sfence_vma, {
     if (hart->priv == PrivilegeLevel::U ||
@@ -334,6 +347,9 @@ IMPL(sret, {
         hart->csrs[MSTATUS::ADDRESS]->write_unchecked(
             hart->csrs[MSTATUS::ADDRESS]->read_unchecked() &
             ~MSTATUS::Field::MPRV);
+
+    if (auto* latency = hart->get_irq_latency()) [[unlikely]]
+        latency->returned();
 })
 IMPL(wfi, {
     hart->interrupt_check_pending = true;
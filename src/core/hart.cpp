@@ -20,8 +20,11 @@
 
 #include "core/decoder.hpp"
 #include "core/hart.hpp"
+#include "core/linux_user.hpp"
 #include "core/mmu.hpp" // IWYU pragma: keep
 #include "device/clint.hpp"
+#include "device/imsic.hpp"
+#include "profile/region_profiler.hpp"
 
 namespace uemu::core {
 
@@ -63,6 +66,17 @@ void ConstCSR::write_checked(const DecodedInsn& insn,
     Trap::raise_exception(insn.pc, TrapCause::IllegalInstruction, insn.insn);
 }
 
+void REGIONMARKER::write_unchecked(reg_t v) noexcept {
+    auto* profiler = hart_->get_region_profiler();
+    if (!profiler) [[likely]]
+        return;
+
+    if (begin_)
+        profiler->begin(v);
+    else
+        profiler->end(v);
+}
+
 MSTATUS::MSTATUS(Hart* hart) : CSR(hart, PrivilegeLevel::M, 0) {
     using F = MSTATUS::Field;
     using S = MSTATUS::Shift;
@@ -91,7 +105,10 @@ void SATP::write_unchecked(reg_t v) noexcept {
 }
 
 Hart::Hart(addr_t reset_pc)
-    : pc(reset_pc), interrupt_check_pending(false), clint_(nullptr) {
+    : pc(reset_pc), interrupt_check_pending(false), clint_(nullptr),
+      m_imsic_(nullptr), s_imsic_(nullptr), sbi_(nullptr),
+      linux_user_(nullptr), irq_latency_(nullptr),
+      region_profiler_(nullptr) {
     // Machine Level
     add_csr<MISA>(MISA::Field::I | MISA::Field::M | MISA::Field::A |
                   MISA::Field::F | MISA::Field::D | MISA::Field::C |
@@ -124,6 +141,10 @@ Hart::Hart(addr_t reset_pc)
 
     add_csr<MCONFIGPTR>();
 
+    add_csr<MISELECT>();
+    add_csr<MIREG>();
+    add_csr<MTOPEI>();
+
     add_csr_ranged<PMPCFGN>();
     add_csr_ranged<PMPADDRN>();
 
@@ -144,6 +165,10 @@ Hart::Hart(addr_t reset_pc)
 
     add_csr<SENVCFG>();
 
+    add_csr<SISELECT>();
+    add_csr<SIREG>();
+    add_csr<STOPEI>();
+
     add_csr<SATP>();
 
     add_csr<STIMECMP>();
@@ -161,6 +186,11 @@ Hart::Hart(addr_t reset_pc)
          i += HPMCOUNTERN::DELTA_ADDRESS)
         csrs[i] = std::make_unique<HPMCOUNTERN>(this, i);
 
+    csrs[REGIONMARKER::BEGIN_ADDRESS] =
+        std::make_unique<REGIONMARKER>(this, REGIONMARKER::BEGIN_ADDRESS);
+    csrs[REGIONMARKER::END_ADDRESS] =
+        std::make_unique<REGIONMARKER>(this, REGIONMARKER::END_ADDRESS);
+
     // Unimplemented CSR
     for (size_t i = 0; i < csrs.size(); i++)
         if (!csrs[i])
@@ -180,6 +210,20 @@ void Hart::handle_trap(const Trap& trap) noexcept {
     const bool is_interrupt = (cause_val >> 63) & 1;
     const reg_t cause_code = cause_val & ~(1ULL << 63);
 
+    (is_interrupt ? stats.interrupts : stats.exceptions)[cause_code & 63].add();
+
+    // There is no guest kernel to deliver traps to in user mode.
+    if (linux_user_) {
+        if (is_interrupt)
+            linux_user_->handle_interrupt(trap);
+        else
+            linux_user_->handle_fault(trap);
+        return;
+    }
+
+    if (irq_latency_) [[unlikely]]
+        irq_latency_->taken(cause_val);
+
     PrivilegeLevel target_priv = PrivilegeLevel::M;
 
     if (priv <= PrivilegeLevel::S) {
@@ -323,12 +367,51 @@ void Hart::set_interrupt_pending(reg_t mip_mask, bool pending) noexcept {
 }
 
 void STIMECMP::write_unchecked(reg_t v) noexcept {
-    value_atomic_.store(v, std::memory_order_relaxed);
+    // Sequentially consistent, as the CLINT's reload in update_tip needs
+    value_atomic_.store(v);
 
     if (auto* clint = hart_->get_clint(); clint)
         clint->tick();
 }
 
+bool IREGCSR::check_permissions() const noexcept {
+    const auto* imsic = hart_->get_imsic(min_priv_ == PrivilegeLevel::M);
+
+    return CSR::check_permissions() && imsic &&
+           imsic->ireg_valid(iselect_->read_unchecked());
+}
+
+reg_t IREGCSR::read_unchecked() const noexcept {
+    if (const auto* imsic = hart_->get_imsic(min_priv_ == PrivilegeLevel::M);
+        imsic)
+        return imsic->ireg_read(iselect_->read_unchecked());
+
+    return 0;
+}
+
+void IREGCSR::write_unchecked(reg_t v) noexcept {
+    if (auto* imsic = hart_->get_imsic(min_priv_ == PrivilegeLevel::M); imsic)
+        imsic->ireg_write(iselect_->read_unchecked(), v);
+}
+
+bool TOPEICSR::check_permissions() const noexcept {
+    return CSR::check_permissions() &&
+           hart_->get_imsic(min_priv_ == PrivilegeLevel::M);
+}
+
+reg_t TOPEICSR::read_unchecked() const noexcept {
+    if (const auto* imsic = hart_->get_imsic(min_priv_ == PrivilegeLevel::M);
+        imsic)
+        return imsic->topei();
+
+    return 0;
+}
+
+void TOPEICSR::write_unchecked([[maybe_unused]] reg_t v) noexcept {
+    if (auto* imsic = hart_->get_imsic(min_priv_ == PrivilegeLevel::M); imsic)
+        imsic->claim_topei();
+}
+
 reg_t TIME::read_unchecked() const noexcept {
     if (auto* clint = hart_->get_clint(); clint) [[likely]]
         return clint->get_mtime();
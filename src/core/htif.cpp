@@ -0,0 +1,267 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <print>
+#include <unordered_set>
+
+#include "core/bus.hpp"
+#include "core/htif.hpp"
+#include "core/linux_abi.hpp"
+
+namespace uemu::core {
+
+namespace {
+
+int64_t result(int64_t ret) { return ret < 0 ? -errno : ret; }
+
+} // namespace
+
+Htif::Htif(Bus& bus, Dram& dram, addr_t tohost,
+           std::optional<addr_t> fromhost, std::vector<std::string> argv,
+           ExitCallback exit_callback)
+    : dram_(dram), tohost_(tohost), fromhost_(fromhost),
+      argv_(std::move(argv)), exit_callback_(std::move(exit_callback)) {
+    if (!dram_.is_valid_addr(tohost_, sizeof(uint64_t)) ||
+        (fromhost_ && !dram_.is_valid_addr(*fromhost_, sizeof(uint64_t))))
+        throw std::out_of_range("HTIF tohost/fromhost outside DRAM");
+
+    bus.watch_page(tohost_, [this](addr_t addr) -> void {
+        if (addr - tohost_ < sizeof(uint64_t))
+            handle_tohost();
+    });
+}
+
+void Htif::handle_tohost() noexcept {
+    const uint64_t tohost = dram_.read<uint64_t>(tohost_);
+    if (tohost == 0)
+        return;
+
+    const auto dev = static_cast<uint8_t>(tohost >> 56);
+    const auto cmd = static_cast<uint8_t>(tohost >> 48);
+    const uint64_t payload = tohost & ((1ULL << 48) - 1);
+
+    if (dev == DEV_SYSCALL && cmd == 0) {
+        // Odd payloads are riscv-tests style exit codes.
+        if (payload & 1) {
+            exit_callback_(static_cast<uint16_t>(payload >> 1));
+            return;
+        }
+
+        SyscallArgs args;
+        int64_t ret;
+
+        try {
+            dram_.read_bytes(payload, args.data(), sizeof(args));
+            ret = syscall(args);
+        } catch (const std::exception& e) {
+            std::println(stderr, "HTIF: bad syscall block at 0x{:x}: {}",
+                         payload, e.what());
+            ret = -EFAULT;
+        }
+
+        // Never leave the syscall number behind as the return value.
+        if (dram_.is_valid_addr(payload, sizeof(uint64_t)))
+            dram_.write<uint64_t>(payload, static_cast<uint64_t>(ret));
+
+        reply(dev, cmd, 1);
+        return;
+    }
+
+    if (dev == DEV_CONSOLE && cmd == CMD_PUTCHAR) {
+        std::putchar(static_cast<char>(payload));
+        std::fflush(stdout);
+        reply(dev, cmd, 0);
+        return;
+    }
+
+    static std::unordered_set<uint64_t> reported;
+    if (reported.insert(tohost >> 48).second)
+        std::println(stderr, "HTIF: unsupported device {} command {}", dev,
+                     cmd);
+    reply(dev, cmd, 0);
+}
+
+void Htif::reply(uint8_t dev, uint8_t cmd, uint64_t payload) noexcept {
+    dram_.write<uint64_t>(tohost_, 0);
+    if (fromhost_)
+        dram_.write<uint64_t>(*fromhost_, (uint64_t{dev} << 56) |
+                                              (uint64_t{cmd} << 48) | payload);
+}
+
+int64_t Htif::syscall(const SyscallArgs& a) {
+    // Pointers in proxied calls are physical; paths come with their length.
+    const auto fd = static_cast<int>(a[1]);
+
+    switch (a[0]) {
+        case SYS_GETCWD: {
+            if (!dram_.is_valid_addr(a[1], a[2]))
+                return -EFAULT;
+            char buf[PATH_MAX];
+            if (!::getcwd(buf, sizeof(buf)))
+                return -errno;
+            const size_t len = std::strlen(buf) + 1;
+            if (len > a[2])
+                return -ERANGE;
+            dram_.write_bytes(a[1], buf, len);
+            return static_cast<int64_t>(len);
+        }
+
+        case SYS_MKDIRAT:
+        case SYS_UNLINKAT:
+        case SYS_FACCESSAT:
+        case SYS_OPENAT:
+        case SYS_FSTATAT: {
+            const std::optional<std::string> path = read_path(a[2], a[3]);
+            if (!path)
+                return -EFAULT;
+            if (a[0] == SYS_FSTATAT &&
+                !dram_.is_valid_addr(a[4], sizeof(abi::GuestStat)))
+                return -EFAULT;
+
+            const char* p = path->c_str();
+            switch (a[0]) {
+                case SYS_MKDIRAT:
+                    return result(::mkdirat(fd, p, static_cast<mode_t>(a[4])));
+                case SYS_UNLINKAT:
+                    return result(::unlinkat(fd, p, static_cast<int>(a[4])));
+                case SYS_FACCESSAT:
+                    return result(
+                        ::faccessat(fd, p, static_cast<int>(a[4]), 0));
+                case SYS_OPENAT:
+                    return result(::openat(
+                        fd, p, abi::open_flags_to_host(static_cast<int>(a[4])),
+                        static_cast<mode_t>(a[5])));
+                default: {
+                    struct stat st;
+                    if (::fstatat(fd, p, &st, static_cast<int>(a[5])) < 0)
+                        return -errno;
+                    const abi::GuestStat gst = abi::to_guest_stat(st);
+                    dram_.write_bytes(a[4], &gst, sizeof(gst));
+                    return 0;
+                }
+            }
+        }
+
+        case SYS_CLOSE:
+            // Keep the emulator's own stdio intact.
+            return fd <= STDERR_FILENO ? 0 : result(::close(fd));
+
+        case SYS_LSEEK:
+            return result(::lseek(fd, static_cast<off_t>(a[2]),
+                                  static_cast<int>(a[3])));
+
+        case SYS_READ:
+        case SYS_PREAD: {
+            if (!dram_.is_valid_addr(a[2], a[3]))
+                return -EFAULT;
+            std::vector<uint8_t> buf(a[3]);
+            const ssize_t n =
+                a[0] == SYS_READ
+                    ? ::read(fd, buf.data(), buf.size())
+                    : ::pread(fd, buf.data(), buf.size(),
+                              static_cast<off_t>(a[4]));
+            if (n < 0)
+                return -errno;
+            dram_.write_bytes(a[2], buf.data(), n);
+            return n;
+        }
+
+        case SYS_WRITE:
+        case SYS_PWRITE: {
+            if (!dram_.is_valid_addr(a[2], a[3]))
+                return -EFAULT;
+            std::vector<uint8_t> buf(a[3]);
+            dram_.read_bytes(a[2], buf.data(), buf.size());
+            const ssize_t n =
+                a[0] == SYS_WRITE
+                    ? ::write(fd, buf.data(), buf.size())
+                    : ::pwrite(fd, buf.data(), buf.size(),
+                               static_cast<off_t>(a[4]));
+            return result(n);
+        }
+
+        case SYS_FSTAT: {
+            if (!dram_.is_valid_addr(a[2], sizeof(abi::GuestStat)))
+                return -EFAULT;
+            struct stat st;
+            if (::fstat(fd, &st) < 0)
+                return -errno;
+            const abi::GuestStat gst = abi::to_guest_stat(st);
+            dram_.write_bytes(a[2], &gst, sizeof(gst));
+            return 0;
+        }
+
+        case SYS_EXIT:
+            exit_callback_(static_cast<uint16_t>(a[1]));
+            return 0;
+
+        case SYS_GETMAINVARS: return sys_getmainvars(a[1], a[2]);
+
+        default: {
+            static std::unordered_set<uint64_t> reported;
+            if (reported.insert(a[0]).second)
+                std::println(stderr, "HTIF: unimplemented syscall {}", a[0]);
+            return -ENOSYS;
+        }
+    }
+}
+
+int64_t Htif::sys_getmainvars(addr_t buf, size_t limit) {
+    // argc, argv[] with pointers into the same buffer, NULL, empty envp,
+    // then the strings.
+    std::vector<uint64_t> words(argv_.size() + 3, 0);
+    words[0] = argv_.size();
+
+    size_t size = words.size() * sizeof(uint64_t);
+    for (size_t i = 0; i < argv_.size(); i++) {
+        words[i + 1] = buf + size;
+        size += argv_[i].size() + 1;
+    }
+
+    if (size > limit)
+        return -ENOMEM;
+    if (!dram_.is_valid_addr(buf, size))
+        return -EFAULT;
+
+    std::vector<uint8_t> bytes(size, 0);
+    std::memcpy(bytes.data(), words.data(), words.size() * sizeof(uint64_t));
+    for (size_t i = 0; i < argv_.size(); i++)
+        std::memcpy(bytes.data() + (words[i + 1] - buf), argv_[i].c_str(),
+                    argv_[i].size() + 1);
+
+    dram_.write_bytes(buf, bytes.data(), bytes.size());
+    return 0;
+}
+
+std::optional<std::string> Htif::read_path(addr_t addr, size_t len) const {
+    if (len == 0 || len > PATH_MAX || !dram_.is_valid_addr(addr, len))
+        return std::nullopt;
+
+    std::string s(len, '\0');
+    dram_.read_bytes(addr, s.data(), len);
+    s.resize(std::strlen(s.c_str()));
+    return s;
+}
+
+} // namespace uemu::core
@@ -0,0 +1,979 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/random.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <print>
+#include <thread>
+#include <unordered_set>
+
+#include "core/linux_abi.hpp"
+#include "core/linux_user.hpp"
+#include "core/mmu.hpp"
+#include "device/clint.hpp"
+
+// riscv64 uses the asm-generic syscall table. Host errno values match
+// asm-generic on every Linux host we build for, so -errno is passed through
+// unchanged.
+
+namespace uemu::core {
+
+namespace {
+
+enum Syscall : reg_t {
+    NR_getcwd = 17,
+    NR_dup = 23,
+    NR_dup3 = 24,
+    NR_fcntl = 25,
+    NR_ioctl = 29,
+    NR_mkdirat = 34,
+    NR_unlinkat = 35,
+    NR_ftruncate = 46,
+    NR_faccessat = 48,
+    NR_chdir = 49,
+    NR_openat = 56,
+    NR_close = 57,
+    NR_pipe2 = 59,
+    NR_getdents64 = 61,
+    NR_lseek = 62,
+    NR_read = 63,
+    NR_write = 64,
+    NR_readv = 65,
+    NR_writev = 66,
+    NR_pread64 = 67,
+    NR_pwrite64 = 68,
+    NR_readlinkat = 78,
+    NR_newfstatat = 79,
+    NR_fstat = 80,
+    NR_fsync = 82,
+    NR_exit = 93,
+    NR_exit_group = 94,
+    NR_set_tid_address = 96,
+    NR_futex = 98,
+    NR_set_robust_list = 99,
+    NR_nanosleep = 101,
+    NR_clock_gettime = 113,
+    NR_clock_nanosleep = 115,
+    NR_sched_getaffinity = 123,
+    NR_sched_yield = 124,
+    NR_kill = 129,
+    NR_tkill = 130,
+    NR_tgkill = 131,
+    NR_sigaltstack = 132,
+    NR_rt_sigaction = 134,
+    NR_rt_sigprocmask = 135,
+    NR_uname = 160,
+    NR_getrlimit = 163,
+    NR_getrusage = 165,
+    NR_umask = 166,
+    NR_gettimeofday = 169,
+    NR_getpid = 172,
+    NR_getppid = 173,
+    NR_getuid = 174,
+    NR_geteuid = 175,
+    NR_getgid = 176,
+    NR_getegid = 177,
+    NR_gettid = 178,
+    NR_brk = 214,
+    NR_munmap = 215,
+    NR_mremap = 216,
+    NR_clone = 220,
+    NR_execve = 221,
+    NR_mmap = 222,
+    NR_mprotect = 226,
+    NR_madvise = 233,
+    NR_riscv_hwprobe = 258,
+    NR_riscv_flush_icache = 259,
+    NR_wait4 = 260,
+    NR_prlimit64 = 261,
+    NR_renameat2 = 276,
+    NR_getrandom = 278,
+    NR_statx = 291,
+    NR_rseq = 293,
+    NR_clone3 = 435,
+    NR_faccessat2 = 439,
+};
+
+struct GuestIovec {
+    uint64_t base;
+    uint64_t len;
+};
+
+// Kernel termios: 4 flag words, c_line and NCCS = 19 control characters
+constexpr size_t GUEST_TERMIOS_SIZE = 36;
+
+constexpr int GUEST_MAP_FIXED = 0x10;
+constexpr int GUEST_MAP_ANONYMOUS = 0x20;
+constexpr int GUEST_MAP_FIXED_NOREPLACE = 0x100000;
+
+constexpr int FUTEX_WAIT = 0;
+constexpr int FUTEX_WAKE = 1;
+constexpr int FUTEX_WAIT_BITSET = 9;
+constexpr int FUTEX_WAKE_BITSET = 10;
+constexpr int FUTEX_CMD_MASK = 0x7F;
+constexpr int FUTEX_CLOCK_REALTIME = 256;
+constexpr uint32_t FUTEX_BITSET_MATCH_ANY = ~0U;
+
+// What a thread shares with its creator; anything less is a new process.
+constexpr reg_t CLONE_THREAD_FLAGS = CLONE_VM | CLONE_SIGHAND | CLONE_THREAD;
+
+// Preemption points per second while several threads exist
+constexpr uint64_t TIME_SLICES = 100;
+
+constexpr size_t IO_CHUNK = 64 * 1024;
+
+reg_t prot_to_perm(int prot) {
+    return (prot & PROT_READ ? MMU::PTE_R : 0) |
+           (prot & PROT_WRITE ? MMU::PTE_W | MMU::PTE_R : 0) |
+           (prot & PROT_EXEC ? MMU::PTE_X : 0);
+}
+
+int64_t result(int64_t ret) { return ret < 0 ? -errno : ret; }
+
+} // namespace
+
+void LinuxUser::handle_ecall() {
+    const reg_t nr = hart_.gprs[17];
+    int64_t ret;
+
+    try {
+        ret = dispatch(nr);
+    } catch (const std::bad_alloc&) {
+        ret = -ENOMEM;
+    }
+
+    hart_.gprs.write(10, static_cast<reg_t>(ret));
+
+    if (resched_)
+        reschedule();
+}
+
+int64_t LinuxUser::dispatch(reg_t nr) {
+    const auto fd = static_cast<int>(arg(0));
+
+    switch (nr) {
+        case NR_getcwd: {
+            char buf[PATH_MAX];
+            if (!::getcwd(buf, sizeof(buf)))
+                return -errno;
+            const size_t len = std::strlen(buf) + 1;
+            if (len > arg(1))
+                return -ERANGE;
+            return copy_to_guest(arg(0), buf, len) ? static_cast<int64_t>(len)
+                                                   : -EFAULT;
+        }
+
+        case NR_dup: return result(::dup(fd));
+        case NR_dup3:
+            return result(
+                ::dup3(fd, static_cast<int>(arg(1)),
+                       abi::open_flags_to_host(static_cast<int>(arg(2)))));
+        case NR_fcntl:
+            return sys_fcntl(fd, static_cast<int>(arg(1)), arg(2));
+        case NR_ioctl: return sys_ioctl(fd, arg(1), arg(2));
+
+        case NR_mkdirat:
+        case NR_unlinkat:
+        case NR_faccessat:
+        case NR_faccessat2:
+        case NR_renameat2:
+            return sys_path_call(nr, fd, arg(1), arg(2), arg(3));
+        case NR_chdir:
+            return sys_path_call(nr, AT_FDCWD, arg(0), 0, 0);
+
+        case NR_ftruncate:
+            return result(::ftruncate(fd, static_cast<off_t>(arg(1))));
+        case NR_openat:
+            return sys_openat(fd, arg(1), static_cast<int>(arg(2)),
+                              static_cast<int>(arg(3)));
+        case NR_close:
+            // Keep the emulator's own stdio intact.
+            return fd <= STDERR_FILENO ? 0 : result(::close(fd));
+
+        case NR_pipe2: {
+            int fds[2];
+            const int flags = abi::open_flags_to_host(static_cast<int>(arg(1)));
+            if (::pipe2(fds, flags) < 0)
+                return -errno;
+            return copy_to_guest(arg(0), fds, sizeof(fds)) ? 0 : -EFAULT;
+        }
+
+        case NR_getdents64: return sys_getdents64(fd, arg(1), arg(2));
+        case NR_lseek:
+            return result(::lseek(fd, static_cast<off_t>(arg(1)),
+                                  static_cast<int>(arg(2))));
+        case NR_read: return sys_read(fd, arg(1), arg(2), std::nullopt);
+        case NR_write: return sys_write(fd, arg(1), arg(2), std::nullopt);
+        case NR_readv:
+            return sys_iov(fd, arg(1), static_cast<int>(arg(2)), false);
+        case NR_writev:
+            return sys_iov(fd, arg(1), static_cast<int>(arg(2)), true);
+        case NR_pread64: return sys_read(fd, arg(1), arg(2), arg(3));
+        case NR_pwrite64: return sys_write(fd, arg(1), arg(2), arg(3));
+        case NR_readlinkat:
+            return sys_readlinkat(fd, arg(1), arg(2), arg(3));
+        case NR_newfstatat:
+            return sys_fstatat(fd, arg(1), arg(2), static_cast<int>(arg(3)));
+        case NR_fstat: return sys_fstatat(fd, 0, arg(1), AT_EMPTY_PATH);
+        case NR_fsync: return result(::fsync(fd));
+
+        case NR_exit: sys_exit_thread(static_cast<int>(arg(0))); return 0;
+        case NR_exit_group: sys_exit(static_cast<int>(arg(0))); return 0;
+
+        case NR_set_tid_address:
+            threads_.at(tid_).clear_child_tid = arg(0);
+            return tid_;
+        case NR_gettid: return tid_;
+        case NR_getpid: return ::getpid();
+        case NR_getppid: return ::getppid();
+        case NR_getuid: return ::getuid();
+        case NR_geteuid: return ::geteuid();
+        case NR_getgid: return ::getgid();
+        case NR_getegid: return ::getegid();
+
+        case NR_futex:
+            return sys_futex(arg(0), static_cast<int>(arg(1)),
+                             static_cast<uint32_t>(arg(2)), arg(3),
+                             static_cast<uint32_t>(arg(5)));
+
+        case NR_nanosleep:
+        case NR_clock_nanosleep: {
+            // Both take the request timespec just before the remainder.
+            const size_t req = nr == NR_nanosleep ? 0 : 2;
+            timespec ts;
+            if (!copy_from_guest(arg(req), &ts, sizeof(ts)))
+                return -EFAULT;
+            if (nr == NR_clock_nanosleep)
+                return -::clock_nanosleep(static_cast<clockid_t>(arg(0)),
+                                          static_cast<int>(arg(1)), &ts,
+                                          nullptr);
+            return result(::nanosleep(&ts, nullptr));
+        }
+
+        case NR_clock_gettime: {
+            timespec ts;
+            if (::clock_gettime(static_cast<clockid_t>(arg(0)), &ts) < 0)
+                return -errno;
+            return copy_to_guest(arg(1), &ts, sizeof(ts)) ? 0 : -EFAULT;
+        }
+
+        case NR_gettimeofday: {
+            timeval tv;
+            ::gettimeofday(&tv, nullptr);
+            if (arg(0) && !copy_to_guest(arg(0), &tv, sizeof(tv)))
+                return -EFAULT;
+            return 0;
+        }
+
+        case NR_sched_getaffinity: {
+            // One hart, so one CPU.
+            const uint64_t mask = 1;
+            if (arg(1) < sizeof(mask))
+                return -EINVAL;
+            if (!copy_to_guest(arg(2), &mask, sizeof(mask)))
+                return -EFAULT;
+            return sizeof(mask);
+        }
+
+        case NR_sched_yield: resched_ = true; return 0;
+
+        case NR_set_robust_list:
+        case NR_madvise:
+        case NR_riscv_flush_icache: return 0;
+
+        case NR_kill:
+        case NR_tkill:
+        case NR_tgkill: {
+            // Signals are never delivered; one sent to ourselves (e.g. by
+            // abort()) terminates the process with its default action.
+            const int sig = static_cast<int>(arg(nr == NR_tgkill ? 2 : 1));
+            if (sig != 0)
+                exit_callback_(128 + sig);
+            return 0;
+        }
+
+        case NR_sigaltstack:
+            if (arg(1)) {
+                const uint8_t zero[24] = {};
+                if (!copy_to_guest(arg(1), zero, sizeof(zero)))
+                    return -EFAULT;
+            }
+            return 0;
+
+        case NR_rt_sigaction:
+        case NR_rt_sigprocmask:
+            // Report default actions and an empty mask. Kernel sigaction is
+            // handler, flags and mask; a sigset is one word.
+            if (arg(2)) {
+                const uint8_t zero[24] = {};
+                const size_t len = nr == NR_rt_sigaction ? 24 : 8;
+                if (!copy_to_guest(arg(2), zero, len))
+                    return -EFAULT;
+            }
+            return 0;
+
+        case NR_uname: return sys_uname(arg(0));
+        case NR_getrlimit:
+            return sys_prlimit64(static_cast<int>(arg(0)), 0, arg(1));
+        case NR_prlimit64:
+            return sys_prlimit64(static_cast<int>(arg(1)), arg(2), arg(3));
+
+        case NR_getrusage: {
+            rusage usage;
+            if (::getrusage(static_cast<int>(arg(0)), &usage) < 0)
+                return -errno;
+            return copy_to_guest(arg(1), &usage, sizeof(usage)) ? 0 : -EFAULT;
+        }
+
+        case NR_umask: return ::umask(static_cast<mode_t>(arg(0)));
+
+        case NR_brk: return sys_brk(arg(0));
+        case NR_munmap: return sys_munmap(arg(0), arg(1));
+        case NR_mmap:
+            return sys_mmap(arg(0), arg(1), static_cast<int>(arg(2)),
+                            static_cast<int>(arg(3)), static_cast<int>(arg(4)),
+                            static_cast<int64_t>(arg(5)));
+        case NR_mprotect:
+            return sys_mprotect(arg(0), arg(1), static_cast<int>(arg(2)));
+
+        case NR_getrandom: {
+            std::vector<uint8_t> buf(std::min<size_t>(arg(1), IO_CHUNK));
+            const ssize_t n = ::getrandom(buf.data(), buf.size(),
+                                          static_cast<unsigned>(arg(2)));
+            if (n < 0)
+                return -errno;
+            return copy_to_guest(arg(0), buf.data(), n) ? n : -EFAULT;
+        }
+
+        case NR_statx:
+            return sys_statx(fd, arg(1), static_cast<int>(arg(2)),
+                             static_cast<unsigned>(arg(3)), arg(4));
+
+        case NR_clone:
+            return sys_clone(arg(0), arg(1), arg(2), arg(3), arg(4));
+
+        // No second process to run a program in; glibc falls back from
+        // clone3 to clone.
+        case NR_execve:
+        case NR_clone3:
+        case NR_riscv_hwprobe:
+        case NR_rseq: return -ENOSYS;
+        case NR_mremap: return -ENOMEM;
+        case NR_wait4: return -ECHILD;
+
+        default: {
+            static std::unordered_set<reg_t> reported;
+            if (reported.insert(nr).second)
+                std::println(stderr, "uemu: unimplemented syscall {}", nr);
+            return -ENOSYS;
+        }
+    }
+}
+
+int64_t LinuxUser::sys_brk(addr_t addr) {
+    if (addr < brk_start_ || addr >= MMAP_BASE)
+        return brk_;
+
+    const addr_t old_top = page_up(brk_);
+    const addr_t new_top = page_up(addr);
+
+    if (new_top > old_top) {
+        try {
+            map(old_top, new_top - old_top, MMU::PTE_R | MMU::PTE_W);
+        } catch (const std::bad_alloc&) {
+            unmap(old_top, new_top - old_top);
+            return brk_;
+        }
+    } else if (new_top < old_top) {
+        unmap(new_top, old_top - new_top);
+    }
+
+    brk_ = addr;
+    return brk_;
+}
+
+int64_t LinuxUser::sys_mmap(addr_t addr, size_t len, int prot, int flags,
+                            int fd, int64_t offset) {
+    if (len == 0 || (offset & MMU::PGMASK))
+        return -EINVAL;
+
+    len = page_up(len);
+
+    if (flags & (GUEST_MAP_FIXED | GUEST_MAP_FIXED_NOREPLACE)) {
+        if (addr & MMU::PGMASK)
+            return -EINVAL;
+        if ((flags & GUEST_MAP_FIXED_NOREPLACE) && is_mapped(addr, len))
+            return -EEXIST;
+        unmap(addr, len);
+    } else {
+        addr = reserve(len);
+    }
+
+    if (prot == PROT_NONE)
+        return addr; // Address space only; mprotect backs it later
+
+    map(addr, len, prot_to_perm(prot));
+
+    if (!(flags & GUEST_MAP_ANONYMOUS)) {
+        // Files are always mapped as a private copy, MAP_SHARED included:
+        // nothing else can observe the mapping in a single process.
+        std::vector<uint8_t> buf(IO_CHUNK);
+        for (size_t done = 0; done < len;) {
+            const ssize_t n = ::pread(fd, buf.data(),
+                                      std::min(buf.size(), len - done),
+                                      offset + static_cast<int64_t>(done));
+            if (n < 0) {
+                const int err = errno;
+                unmap(addr, len);
+                return -err;
+            }
+            if (n == 0)
+                break;
+            std::ignore = fill_guest(addr + done, buf.data(), n);
+            done += n;
+        }
+    }
+
+    return addr;
+}
+
+int64_t LinuxUser::sys_munmap(addr_t addr, size_t len) {
+    if ((addr & MMU::PGMASK) || len == 0)
+        return -EINVAL;
+    unmap(addr, len);
+    return 0;
+}
+
+int64_t LinuxUser::sys_mprotect(addr_t addr, size_t len, int prot) {
+    if (addr & MMU::PGMASK)
+        return -EINVAL;
+    protect(addr, len, prot_to_perm(prot));
+    return 0;
+}
+
+int64_t LinuxUser::sys_read(int fd, addr_t buf, size_t len,
+                            std::optional<int64_t> off) {
+    // Check up front: bytes consumed from the host fd cannot be put back.
+    if (!is_mapped(buf, len, MMU::PTE_V | MMU::PTE_W))
+        return -EFAULT;
+
+    std::vector<uint8_t> tmp(std::min(len, IO_CHUNK));
+    size_t done = 0;
+
+    while (done < len) {
+        const size_t chunk = std::min(tmp.size(), len - done);
+        const ssize_t n =
+            off ? ::pread(fd, tmp.data(), chunk,
+                          *off + static_cast<int64_t>(done))
+                : ::read(fd, tmp.data(), chunk);
+        if (n < 0)
+            return done ? static_cast<int64_t>(done) : -errno;
+
+        if (!copy_to_guest(buf + done, tmp.data(), n))
+            return done ? static_cast<int64_t>(done) : -EFAULT;
+        done += n;
+
+        // A short read (tty, pipe, EOF) ends the call like it would natively.
+        if (static_cast<size_t>(n) < chunk)
+            break;
+    }
+
+    return done;
+}
+
+int64_t LinuxUser::sys_write(int fd, addr_t buf, size_t len,
+                             std::optional<int64_t> off) {
+    std::vector<uint8_t> tmp(std::min(len, IO_CHUNK));
+    size_t done = 0;
+
+    while (done < len) {
+        const size_t chunk = std::min(tmp.size(), len - done);
+        if (!copy_from_guest(buf + done, tmp.data(), chunk))
+            return done ? static_cast<int64_t>(done) : -EFAULT;
+
+        const ssize_t n =
+            off ? ::pwrite(fd, tmp.data(), chunk,
+                           *off + static_cast<int64_t>(done))
+                : ::write(fd, tmp.data(), chunk);
+        if (n < 0)
+            return done ? static_cast<int64_t>(done) : -errno;
+
+        done += n;
+        if (static_cast<size_t>(n) < chunk)
+            break;
+    }
+
+    return done;
+}
+
+int64_t LinuxUser::sys_iov(int fd, addr_t iov, int iovcnt, bool write) {
+    if (iovcnt < 0 || iovcnt > IOV_MAX)
+        return -EINVAL;
+
+    std::vector<GuestIovec> vec(iovcnt);
+    if (!copy_from_guest(iov, vec.data(), vec.size() * sizeof(GuestIovec)))
+        return -EFAULT;
+
+    int64_t total = 0;
+
+    for (const GuestIovec& v : vec) {
+        const int64_t n = write ? sys_write(fd, v.base, v.len, std::nullopt)
+                                : sys_read(fd, v.base, v.len, std::nullopt);
+        if (n < 0)
+            return total ? total : n;
+
+        total += n;
+        if (static_cast<uint64_t>(n) < v.len)
+            break;
+    }
+
+    return total;
+}
+
+int64_t LinuxUser::sys_openat(int dirfd, addr_t path, int flags, int mode) {
+    const std::optional<std::string> name = read_string(path);
+    if (!name)
+        return -EFAULT;
+
+    const std::filesystem::path host =
+        *name == "/proc/self/exe" ? exe_ : host_path(*name);
+
+    return result(::openat(dirfd, host.c_str(),
+                           abi::open_flags_to_host(flags),
+                           static_cast<mode_t>(mode)));
+}
+
+int64_t LinuxUser::sys_fstatat(int dirfd, addr_t path, addr_t buf,
+                               int flags) {
+    std::string name;
+
+    if (path) {
+        std::optional<std::string> s = read_string(path);
+        if (!s)
+            return -EFAULT;
+        name = std::move(*s);
+    }
+
+    struct stat st;
+    if (::fstatat(dirfd, host_path(name).c_str(), &st, flags) < 0)
+        return -errno;
+
+    const abi::GuestStat gst = abi::to_guest_stat(st);
+    return copy_to_guest(buf, &gst, sizeof(gst)) ? 0 : -EFAULT;
+}
+
+int64_t LinuxUser::sys_statx(int dirfd, addr_t path, int flags,
+                             unsigned mask, addr_t buf) {
+    const std::optional<std::string> name = read_string(path);
+    if (!name)
+        return -EFAULT;
+
+    // struct statx has the same layout on every architecture.
+    struct statx stx;
+    if (::statx(dirfd, host_path(*name).c_str(), flags, mask, &stx) < 0)
+        return -errno;
+
+    return copy_to_guest(buf, &stx, sizeof(stx)) ? 0 : -EFAULT;
+}
+
+int64_t LinuxUser::sys_readlinkat(int dirfd, addr_t path, addr_t buf,
+                                  size_t len) {
+    const std::optional<std::string> name = read_string(path);
+    if (!name)
+        return -EFAULT;
+
+    std::string target;
+
+    if (*name == "/proc/self/exe") {
+        target = exe_.string();
+    } else {
+        char tmp[PATH_MAX];
+        const ssize_t n = ::readlinkat(dirfd, host_path(*name).c_str(), tmp,
+                                       sizeof(tmp));
+        if (n < 0)
+            return -errno;
+        target.assign(tmp, n);
+    }
+
+    const size_t n = std::min(len, target.size());
+    if (!copy_to_guest(buf, target.data(), n))
+        return -EFAULT;
+    return static_cast<int64_t>(n);
+}
+
+int64_t LinuxUser::sys_ioctl(int fd, reg_t request, addr_t arg) {
+    switch (request) {
+        case TCGETS: {
+            // The host kernel termios is at least as large as the guest's
+            // and starts with the same fields.
+            uint8_t termios[64] = {};
+            if (::ioctl(fd, TCGETS, termios) < 0)
+                return -errno;
+            return copy_to_guest(arg, termios, GUEST_TERMIOS_SIZE) ? 0
+                                                                   : -EFAULT;
+        }
+
+        case TCSETS:
+        case TCSETSW:
+        case TCSETSF: {
+            uint8_t termios[64] = {};
+            if (::ioctl(fd, TCGETS, termios) < 0)
+                return -errno;
+            if (!copy_from_guest(arg, termios, GUEST_TERMIOS_SIZE))
+                return -EFAULT;
+            return result(::ioctl(fd, request, termios));
+        }
+
+        case TIOCGWINSZ: {
+            winsize ws;
+            if (::ioctl(fd, TIOCGWINSZ, &ws) < 0)
+                return -errno;
+            return copy_to_guest(arg, &ws, sizeof(ws)) ? 0 : -EFAULT;
+        }
+
+        default: return -ENOTTY;
+    }
+}
+
+int64_t LinuxUser::sys_fcntl(int fd, int cmd, reg_t arg) {
+    switch (cmd) {
+        case F_DUPFD:
+        case F_DUPFD_CLOEXEC:
+        case F_GETFD:
+        case F_SETFD:
+            return result(::fcntl(fd, cmd, static_cast<int>(arg)));
+        case F_GETFL: {
+            const int flags = ::fcntl(fd, F_GETFL);
+            return flags < 0 ? -errno : abi::open_flags_from_host(flags);
+        }
+        case F_SETFL:
+            return result(::fcntl(
+                fd, F_SETFL, abi::open_flags_to_host(static_cast<int>(arg))));
+        default: return -EINVAL;
+    }
+}
+
+int64_t LinuxUser::sys_getdents64(int fd, addr_t buf, size_t len) {
+    // struct linux_dirent64 is architecture independent.
+    std::vector<uint8_t> tmp(std::min(len, IO_CHUNK));
+    const ssize_t n = ::getdents64(fd, tmp.data(), tmp.size());
+    if (n < 0)
+        return -errno;
+    return copy_to_guest(buf, tmp.data(), n) ? n : -EFAULT;
+}
+
+int64_t LinuxUser::sys_uname(addr_t buf) {
+    utsname host;
+    ::uname(&host);
+
+    utsname uts = {};
+    std::strcpy(uts.sysname, "Linux");
+    std::strcpy(uts.nodename, host.nodename);
+    std::strcpy(uts.release, "6.6.0");
+    std::strcpy(uts.version, "#1 SMP");
+    std::strcpy(uts.machine, "riscv64");
+
+    // Six 65-byte fields, same as the guest's new_utsname
+    static_assert(sizeof(uts) == 6 * 65);
+    return copy_to_guest(buf, &uts, sizeof(uts)) ? 0 : -EFAULT;
+}
+
+int64_t LinuxUser::sys_futex(addr_t uaddr, int op, uint32_t val,
+                             addr_t timeout, uint32_t val3) {
+    const int cmd = op & FUTEX_CMD_MASK;
+    const uint32_t bitset = cmd == FUTEX_WAIT || cmd == FUTEX_WAKE
+                                ? FUTEX_BITSET_MATCH_ANY
+                                : val3;
+
+    switch (cmd) {
+        case FUTEX_WAIT:
+        case FUTEX_WAIT_BITSET: {
+            if (bitset == 0)
+                return -EINVAL;
+
+            uint32_t cur;
+            if (!copy_from_guest(uaddr, &cur, sizeof(cur)))
+                return -EFAULT;
+            if (cur != val)
+                return -EAGAIN;
+
+            std::optional<Clock::time_point> deadline;
+            if (timeout) {
+                timespec ts;
+                if (!copy_from_guest(timeout, &ts, sizeof(ts)))
+                    return -EFAULT;
+                auto wait = std::chrono::seconds(ts.tv_sec) +
+                            std::chrono::nanoseconds(ts.tv_nsec);
+
+                // FUTEX_WAIT is relative, FUTEX_WAIT_BITSET absolute
+                if (cmd == FUTEX_WAIT_BITSET) {
+                    timespec now;
+                    ::clock_gettime(op & FUTEX_CLOCK_REALTIME ? CLOCK_REALTIME
+                                                              : CLOCK_MONOTONIC,
+                                    &now);
+                    wait -= std::chrono::seconds(now.tv_sec) +
+                            std::chrono::nanoseconds(now.tv_nsec);
+                }
+                deadline = Clock::now() + wait;
+            }
+
+            // Resumes with a0 = 0 unless the deadline passes first.
+            Thread& t = threads_.at(tid_);
+            t.waiting = true;
+            t.futex = uaddr;
+            t.futex_bitset = bitset;
+            t.deadline = deadline;
+            futex_waiters_[uaddr].push_back(tid_);
+            resched_ = true;
+            return 0;
+        }
+
+        case FUTEX_WAKE:
+        case FUTEX_WAKE_BITSET:
+            if (bitset == 0)
+                return -EINVAL;
+            return futex_wake(uaddr, val, bitset);
+        default: return -ENOSYS;
+    }
+}
+
+int64_t LinuxUser::sys_clone(reg_t flags, addr_t stack, addr_t ptid,
+                             addr_t tls, addr_t ctid) {
+    if ((flags & CLONE_THREAD_FLAGS) != CLONE_THREAD_FLAGS)
+        return -ENOSYS;
+
+    const int tid = next_tid_;
+    if ((flags & CLONE_PARENT_SETTID) && !copy_to_guest(ptid, &tid, 4))
+        return -EFAULT;
+    if ((flags & CLONE_CHILD_SETTID) && !copy_to_guest(ctid, &tid, 4))
+        return -EFAULT;
+
+    // The child returns 0 from the same ecall, on its own stack.
+    Thread child;
+    save(child);
+    child.gprs.write(10, 0);
+    if (stack)
+        child.gprs.write(2, stack);
+    if (flags & CLONE_SETTLS)
+        child.gprs.write(4, tls);
+    if (flags & CLONE_CHILD_CLEARTID)
+        child.clear_child_tid = ctid;
+
+    threads_.emplace(tid, child);
+    runnable_.push_back(tid);
+    next_tid_++;
+    arm_time_slice();
+    return tid;
+}
+
+int64_t LinuxUser::sys_prlimit64(int resource, addr_t new_limit,
+                                 addr_t old_limit) {
+    // Limits are reported but never enforced or changed.
+    std::ignore = new_limit;
+    if (!old_limit)
+        return 0;
+
+    rlimit lim;
+    if (resource == RLIMIT_STACK) {
+        lim.rlim_cur = lim.rlim_max = STACK_SIZE;
+    } else if (::getrlimit(resource, &lim) < 0) {
+        return -errno;
+    }
+
+    return copy_to_guest(old_limit, &lim, sizeof(lim)) ? 0 : -EFAULT;
+}
+
+int64_t LinuxUser::sys_path_call(reg_t nr, int dirfd, addr_t path, reg_t a2,
+                                 reg_t a3) {
+    const std::optional<std::string> name = read_string(path);
+    if (!name)
+        return -EFAULT;
+
+    const std::filesystem::path host = host_path(*name);
+
+    switch (nr) {
+        case NR_mkdirat:
+            return result(
+                ::mkdirat(dirfd, host.c_str(), static_cast<mode_t>(a2)));
+        case NR_unlinkat:
+            return result(
+                ::unlinkat(dirfd, host.c_str(), static_cast<int>(a2)));
+        case NR_faccessat:
+            return result(
+                ::faccessat(dirfd, host.c_str(), static_cast<int>(a2), 0));
+        case NR_faccessat2:
+            return result(::faccessat(dirfd, host.c_str(), static_cast<int>(a2),
+                                      static_cast<int>(a3)));
+        case NR_chdir: return result(::chdir(host.c_str()));
+        case NR_renameat2: {
+            const std::optional<std::string> to = read_string(a3);
+            if (!to)
+                return -EFAULT;
+            return result(::renameat(dirfd, host.c_str(),
+                                     static_cast<int>(a2),
+                                     host_path(*to).c_str()));
+        }
+        default: return -ENOSYS;
+    }
+}
+
+void LinuxUser::sys_exit(int status) { exit_callback_(status & 0xFF); }
+
+void LinuxUser::sys_exit_thread(int status) {
+    if (threads_.size() == 1) {
+        sys_exit(status);
+        return;
+    }
+
+    // CLONE_CHILD_CLEARTID is how pthread_join() learns of the exit.
+    if (const addr_t ctid = threads_.at(tid_).clear_child_tid) {
+        const uint32_t zero = 0;
+        if (copy_to_guest(ctid, &zero, sizeof(zero)))
+            futex_wake(ctid, 1, FUTEX_BITSET_MATCH_ANY);
+    }
+
+    threads_.erase(tid_);
+    resched_ = true;
+}
+
+void LinuxUser::save(Thread& t) const noexcept {
+    t.gprs = hart_.gprs;
+    t.fprs = hart_.fprs;
+    t.fcsr = hart_.csrs[FCSR::ADDRESS]->read_unchecked();
+    t.pc = hart_.pc;
+}
+
+void LinuxUser::restore(const Thread& t) noexcept {
+    hart_.gprs = t.gprs;
+    hart_.fprs = t.fprs;
+    hart_.csrs[FCSR::ADDRESS]->write_unchecked(t.fcsr);
+    hart_.pc = t.pc;
+    // As the kernel does on a switch, so that no SC pairs across threads
+    mmu_.reservation_valid = false;
+}
+
+void LinuxUser::reschedule() {
+    resched_ = false;
+
+    // The running thread may have exited, blocked or just yielded.
+    if (const auto it = threads_.find(tid_); it != threads_.end()) {
+        save(it->second);
+        if (!it->second.waiting)
+            runnable_.push_back(tid_);
+    }
+
+    wake_expired(Clock::now());
+    while (runnable_.empty()) {
+        std::optional<Clock::time_point> next;
+        for (const auto& [tid, t] : threads_)
+            if (t.deadline && (!next || *t.deadline < *next))
+                next = t.deadline;
+
+        if (!next) {
+            std::println(stderr, "uemu: deadlock, every thread waits on a "
+                                 "futex");
+            exit_callback_(128 + SIGABRT);
+            return;
+        }
+
+        std::this_thread::sleep_until(*next);
+        wake_expired(Clock::now());
+    }
+
+    tid_ = runnable_.front();
+    runnable_.pop_front();
+    restore(threads_.at(tid_));
+    arm_time_slice();
+}
+
+void LinuxUser::wake_expired(Clock::time_point now) {
+    for (auto& [tid, t] : threads_) {
+        if (!t.deadline || *t.deadline > now)
+            continue;
+
+        auto& queue = futex_waiters_.at(t.futex);
+        std::erase(queue, tid);
+        if (queue.empty())
+            futex_waiters_.erase(t.futex);
+
+        t.gprs.write(10, static_cast<reg_t>(-ETIMEDOUT));
+        t.waiting = false;
+        t.deadline.reset();
+        runnable_.push_back(tid);
+    }
+}
+
+int64_t LinuxUser::futex_wake(addr_t uaddr, int64_t count, uint32_t bitset) {
+    const auto it = futex_waiters_.find(uaddr);
+    if (it == futex_waiters_.end())
+        return 0;
+
+    int64_t woken = 0;
+    auto& queue = it->second;
+    for (auto w = queue.begin(); w != queue.end() && woken < count;) {
+        Thread& t = threads_.at(*w);
+        if (!(t.futex_bitset & bitset)) {
+            ++w;
+            continue;
+        }
+
+        t.waiting = false;
+        t.deadline.reset();
+        runnable_.push_back(*w);
+        w = queue.erase(w);
+        woken++;
+    }
+
+    if (queue.empty())
+        futex_waiters_.erase(it);
+    return woken;
+}
+
+void LinuxUser::arm_time_slice() noexcept {
+    device::Clint* clint = hart_.get_clint();
+    if (!clint)
+        return;
+
+    // A lone thread runs undisturbed.
+    CSR& mie = *hart_.csrs[MIE::ADDRESS];
+    if (threads_.size() == 1) {
+        mie.write_unchecked(mie.read_unchecked() & ~MIE::Field::MTIE);
+        return;
+    }
+
+    std::ignore = clint->write<uint64_t>(
+        clint->start() + device::Clint::MTIMECMP_OFFSET,
+        clint->get_mtime() + clint->get_freq() / TIME_SLICES);
+    mie.write_unchecked(mie.read_unchecked() | MIE::Field::MTIE);
+    hart_.interrupt_check_pending = true;
+}
+
+} // namespace uemu::core
@@ -0,0 +1,518 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <elf.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <print>
+#include <random>
+
+#include "core/linux_user.hpp"
+#include "core/mmu.hpp"
+#include "utils/mapped_file.hpp"
+
+namespace uemu::core {
+
+namespace {
+
+constexpr addr_t PGSIZE = MMU::PGSIZE;
+
+// RSW bit marking a page we allocated. A PROT_NONE page keeps its frame but
+// drops PTE_V, so this is what "mapped" means here.
+constexpr reg_t PTE_SW_ALLOC = 1 << 8;
+
+// A and D are set up front: with Svade, clear bits would fault.
+constexpr reg_t PTE_LEAF = MMU::PTE_V | MMU::PTE_U | MMU::PTE_A | MMU::PTE_D;
+constexpr reg_t PTE_RWX = MMU::PTE_R | MMU::PTE_W | MMU::PTE_X;
+
+// What guest loads and stores through syscall arguments need
+constexpr reg_t PTE_READABLE = MMU::PTE_V | MMU::PTE_R;
+constexpr reg_t PTE_WRITABLE = MMU::PTE_V | MMU::PTE_W;
+
+constexpr addr_t page_down(addr_t v) { return v & ~MMU::PGMASK; }
+
+constexpr addr_t pte_to_pa(reg_t pte) {
+    return ((pte >> 10) & ((1ULL << 44) - 1)) << MMU::PGSHIFT;
+}
+
+constexpr reg_t pa_to_pte(addr_t pa) { return (pa >> MMU::PGSHIFT) << 10; }
+
+constexpr size_t vpn(addr_t va, int level) {
+    return (va >> (MMU::PGSHIFT + MMU::VPNBITS * level)) & 0x1FF;
+}
+
+constexpr reg_t elf_perm(uint32_t flags) {
+    return (flags & PF_R ? MMU::PTE_R : 0) | (flags & PF_W ? MMU::PTE_W : 0) |
+           (flags & PF_X ? MMU::PTE_X : 0);
+}
+
+constexpr uint8_t ZERO_PAGE[PGSIZE] = {};
+
+} // namespace
+
+LinuxUser::LinuxUser(Hart& hart, MMU& mmu, Dram& dram,
+                     ExitCallback exit_callback)
+    : hart_(hart), mmu_(mmu), dram_(dram),
+      exit_callback_(std::move(exit_callback)), root_(0),
+      next_page_(Dram::DRAM_BASE), brk_start_(0), brk_(0),
+      mmap_next_(MMAP_BASE), tid_(::getpid()), next_tid_(tid_ + 1) {
+    root_ = alloc_page();
+    threads_.try_emplace(tid_);
+    hart_.set_linux_user(this);
+}
+
+LinuxUser::~LinuxUser() { hart_.set_linux_user(nullptr); }
+
+void LinuxUser::load(const Options& opts) {
+    exe_ = std::filesystem::absolute(opts.exe);
+    sysroot_ = opts.sysroot;
+
+    const Image exe = load_elf(exe_, false);
+    std::optional<Image> interp;
+
+    if (!exe.interp.empty())
+        interp = load_elf(host_path(exe.interp), true);
+
+    brk_start_ = brk_ = page_up(exe.end);
+    map(STACK_TOP - STACK_SIZE, STACK_SIZE, MMU::PTE_R | MMU::PTE_W);
+
+    const addr_t sp = build_stack(opts, exe, interp ? &*interp : nullptr);
+
+    // Enter U-mode with translation on and the FPU usable.
+    reg_t mstatus = hart_.csrs[MSTATUS::ADDRESS]->read_unchecked();
+    mstatus = (mstatus & ~MSTATUS::Field::FS) |
+              (reg_t{1} << MSTATUS::Shift::FS_SHIFT); // Initial
+    hart_.csrs[MSTATUS::ADDRESS]->write_unchecked(mstatus);
+
+    constexpr reg_t counters =
+        MCOUNTEREN::CY | MCOUNTEREN::TM | MCOUNTEREN::IR;
+    hart_.csrs[MCOUNTEREN::ADDRESS]->write_unchecked(counters);
+    hart_.csrs[SCOUNTEREN::ADDRESS]->write_unchecked(counters);
+    hart_.csrs[SATP::ADDRESS]->write_unchecked(
+        (SATP::Mode::Sv39 << SATP::Shift::MODE_SHIFT) |
+        (root_ >> MMU::PGSHIFT));
+
+    hart_.gprs.write(2, sp);
+    hart_.gprs.write(10, 0); // No rtld_fini
+    hart_.pc = interp ? interp->entry : exe.entry;
+    hart_.priv = PrivilegeLevel::U;
+    mmu_.tlb_flush_all();
+}
+
+void LinuxUser::handle_fault(const Trap& trap) noexcept {
+    int sig = 11; // SIGSEGV
+    const char* name = "SIGSEGV";
+
+    switch (trap.cause) {
+        case TrapCause::IllegalInstruction:
+            sig = 4;
+            name = "SIGILL";
+            break;
+        case TrapCause::Breakpoint:
+            sig = 5;
+            name = "SIGTRAP";
+            break;
+        case TrapCause::InstructionAddressMisaligned:
+        case TrapCause::LoadAddressMisaligned:
+        case TrapCause::StoreAMOAddressMisaligned:
+            sig = 7;
+            name = "SIGBUS";
+            break;
+        default: break;
+    }
+
+    std::println(stderr, "uemu: {} at pc 0x{:x} (cause {}, tval 0x{:x})", name,
+                 trap.pc, static_cast<reg_t>(trap.cause), trap.tval);
+    exit_callback_(128 + sig);
+}
+
+void LinuxUser::handle_interrupt(const Trap& trap) noexcept {
+    hart_.pc = trap.pc;
+
+    // The slice of the running thread is over.
+    if (trap.cause == TrapCause::MachineTimerInterrupt)
+        reschedule();
+}
+
+bool LinuxUser::copy_from_guest(addr_t va, void* dst, size_t len) const {
+    auto* out = static_cast<uint8_t*>(dst);
+
+    while (len > 0) {
+        const std::optional<addr_t> pa = translate(va, PTE_READABLE);
+        if (!pa)
+            return false;
+
+        const size_t chunk = std::min<size_t>(len, PGSIZE - (va & MMU::PGMASK));
+        dram_.read_bytes(*pa, out, chunk);
+        va += chunk;
+        out += chunk;
+        len -= chunk;
+    }
+
+    return true;
+}
+
+bool LinuxUser::copy_to_guest(addr_t va, const void* src, size_t len) {
+    return write_guest(va, src, len, PTE_WRITABLE);
+}
+
+bool LinuxUser::fill_guest(addr_t va, const void* src, size_t len) {
+    return write_guest(va, src, len, 0);
+}
+
+bool LinuxUser::write_guest(addr_t va, const void* src, size_t len,
+                            reg_t perm) {
+    const auto* in = static_cast<const uint8_t*>(src);
+
+    while (len > 0) {
+        const std::optional<addr_t> pa = translate(va, perm);
+        if (!pa)
+            return false;
+
+        const size_t chunk = std::min<size_t>(len, PGSIZE - (va & MMU::PGMASK));
+        dram_.write_bytes(*pa, in, chunk);
+        va += chunk;
+        in += chunk;
+        len -= chunk;
+    }
+
+    return true;
+}
+
+std::optional<std::string> LinuxUser::read_string(addr_t va) const {
+    constexpr size_t PATH_MAX_LEN = 4096;
+    std::string s;
+
+    while (s.size() < PATH_MAX_LEN) {
+        const std::optional<addr_t> pa = translate(va++, PTE_READABLE);
+        if (!pa)
+            return std::nullopt;
+
+        const char c = dram_.read<char>(*pa);
+        if (c == '\0')
+            return s;
+        s.push_back(c);
+    }
+
+    return std::nullopt;
+}
+
+LinuxUser::Image LinuxUser::load_elf(const std::filesystem::path& path,
+                                     bool interp) {
+    const utils::MappedFile file(path);
+    const std::span<const uint8_t> data = file.data();
+
+    if (data.size() < sizeof(Elf64_Ehdr))
+        throw std::runtime_error("Not an ELF file: " + path.string());
+
+    const auto* hdr = reinterpret_cast<const Elf64_Ehdr*>(data.data());
+
+    if (std::memcmp(hdr->e_ident, ELFMAG, SELFMAG) != 0 ||
+        hdr->e_ident[EI_CLASS] != ELFCLASS64 || hdr->e_machine != EM_RISCV ||
+        (hdr->e_type != ET_EXEC && hdr->e_type != ET_DYN))
+        throw std::runtime_error("Not a riscv64 executable: " + path.string());
+
+    if (hdr->e_phentsize != sizeof(Elf64_Phdr) ||
+        hdr->e_phoff + hdr->e_phnum * sizeof(Elf64_Phdr) > data.size())
+        throw std::runtime_error("Truncated ELF program headers");
+
+    const std::span<const Elf64_Phdr> phdrs(
+        reinterpret_cast<const Elf64_Phdr*>(data.data() + hdr->e_phoff),
+        hdr->e_phnum);
+
+    addr_t lo = ~addr_t{0};
+    addr_t hi = 0;
+
+    for (const Elf64_Phdr& ph : phdrs) {
+        if (ph.p_type != PT_LOAD)
+            continue;
+        lo = std::min(lo, page_down(ph.p_vaddr));
+        hi = std::max(hi, ph.p_vaddr + ph.p_memsz);
+    }
+
+    if (lo >= hi)
+        throw std::runtime_error("ELF has no loadable segments");
+
+    Image img{};
+
+    if (hdr->e_type == ET_DYN)
+        img.bias = (interp ? reserve(hi - lo) : PIE_BASE) - lo;
+
+    for (const Elf64_Phdr& ph : phdrs) {
+        if (ph.p_type == PT_INTERP) {
+            if (ph.p_offset + ph.p_filesz > data.size() || ph.p_filesz == 0)
+                throw std::runtime_error("Bad PT_INTERP");
+            img.interp.assign(
+                reinterpret_cast<const char*>(data.data() + ph.p_offset),
+                ph.p_filesz - 1);
+        } else if (ph.p_type == PT_PHDR) {
+            img.phdr = img.bias + ph.p_vaddr;
+        } else if (ph.p_type == PT_LOAD) {
+            if (ph.p_offset + ph.p_filesz > data.size() ||
+                ph.p_filesz > ph.p_memsz)
+                throw std::runtime_error("Bad PT_LOAD segment");
+
+            const addr_t va = img.bias + ph.p_vaddr;
+            map(va, ph.p_memsz, elf_perm(ph.p_flags));
+            std::ignore =
+                fill_guest(va, data.data() + ph.p_offset, ph.p_filesz);
+
+            // The rest of the page after the file data may be shared with
+            // another segment's bytes; later pages are fresh and zero.
+            const addr_t bss = va + ph.p_filesz;
+            const addr_t bss_end =
+                std::min(va + ph.p_memsz, page_up(bss));
+            std::ignore = fill_guest(bss, ZERO_PAGE, bss_end - bss);
+
+            if (!img.phdr && hdr->e_phoff >= ph.p_offset &&
+                hdr->e_phoff < ph.p_offset + ph.p_filesz)
+                img.phdr = va + (hdr->e_phoff - ph.p_offset);
+        }
+    }
+
+    img.entry = img.bias + hdr->e_entry;
+    img.phnum = hdr->e_phnum;
+    img.end = img.bias + hi;
+    return img;
+}
+
+addr_t LinuxUser::build_stack(const Options& opts, const Image& exe,
+                              const Image* interp) {
+    addr_t sp = STACK_TOP;
+
+    const auto push = [&](const void* p, size_t n) -> addr_t {
+        sp -= n;
+        if (!copy_to_guest(sp, p, n))
+            throw std::runtime_error("Initial stack overflow");
+        return sp;
+    };
+    const auto push_string = [&](const std::string& s) -> addr_t {
+        return push(s.c_str(), s.size() + 1);
+    };
+
+    const addr_t execfn = push_string(exe_.string());
+    const addr_t platform = push_string("riscv64");
+
+    std::random_device rd;
+    uint32_t random_bytes[4];
+    for (uint32_t& r : random_bytes)
+        r = rd();
+    const addr_t random = push(random_bytes, sizeof(random_bytes));
+
+    std::vector<std::string> argv = opts.argv;
+    if (argv.empty())
+        argv.push_back(opts.exe.string());
+
+    std::vector<reg_t> argv_ptrs;
+    std::vector<reg_t> envp_ptrs;
+    for (const std::string& s : argv)
+        argv_ptrs.push_back(push_string(s));
+    for (const std::string& s : opts.envp)
+        envp_ptrs.push_back(push_string(s));
+
+    // Single-letter extensions from misa, as the kernel reports them
+    const reg_t hwcap =
+        hart_.csrs[MISA::ADDRESS]->read_unchecked() & ((1ULL << 26) - 1);
+
+    const std::pair<reg_t, reg_t> auxv[] = {
+        {AT_PHDR, exe.phdr},
+        {AT_PHENT, sizeof(Elf64_Phdr)},
+        {AT_PHNUM, exe.phnum},
+        {AT_PAGESZ, PGSIZE},
+        {AT_BASE, interp ? interp->bias : 0},
+        {AT_FLAGS, 0},
+        {AT_ENTRY, exe.entry},
+        {AT_UID, 0},
+        {AT_EUID, 0},
+        {AT_GID, 0},
+        {AT_EGID, 0},
+        {AT_HWCAP, hwcap},
+        {AT_CLKTCK, 100},
+        {AT_PLATFORM, platform},
+        {AT_SECURE, 0},
+        {AT_RANDOM, random},
+        {AT_EXECFN, execfn},
+        {AT_NULL, 0},
+    };
+
+    // argc, argv[], NULL, envp[], NULL, auxv[]; sp stays 16-byte aligned.
+    std::vector<reg_t> words;
+    words.push_back(argv_ptrs.size());
+    words.insert(words.end(), argv_ptrs.begin(), argv_ptrs.end());
+    words.push_back(0);
+    words.insert(words.end(), envp_ptrs.begin(), envp_ptrs.end());
+    words.push_back(0);
+    for (const auto& [type, value] : auxv) {
+        words.push_back(type);
+        words.push_back(value);
+    }
+
+    sp = (sp - words.size() * sizeof(reg_t)) & ~addr_t{15};
+    if (!copy_to_guest(sp, words.data(), words.size() * sizeof(reg_t)))
+        throw std::runtime_error("Initial stack overflow");
+
+    return sp;
+}
+
+addr_t LinuxUser::alloc_page() {
+    addr_t pa;
+
+    if (!free_pages_.empty()) {
+        pa = free_pages_.back();
+        free_pages_.pop_back();
+    } else {
+        if (!dram_.is_valid_addr(next_page_, PGSIZE))
+            throw std::bad_alloc();
+        pa = next_page_;
+        next_page_ += PGSIZE;
+    }
+
+    dram_.write_bytes(pa, ZERO_PAGE, PGSIZE);
+    return pa;
+}
+
+std::optional<addr_t> LinuxUser::walk(addr_t va, bool create) {
+    addr_t table = root_;
+
+    for (int level = MMU::LEVELS - 1; level > 0; level--) {
+        const addr_t pte_addr = table + vpn(va, level) * MMU::PTESIZE;
+        reg_t pte = dram_.read<uint64_t>(pte_addr);
+
+        if (!(pte & MMU::PTE_V)) {
+            if (!create)
+                return std::nullopt;
+            pte = pa_to_pte(alloc_page()) | MMU::PTE_V;
+            dram_.write<uint64_t>(pte_addr, pte);
+        }
+
+        table = pte_to_pa(pte);
+    }
+
+    return table + vpn(va, 0) * MMU::PTESIZE;
+}
+
+std::optional<addr_t> LinuxUser::translate(addr_t va, reg_t perm) const {
+    addr_t table = root_;
+
+    for (int level = MMU::LEVELS - 1; level > 0; level--) {
+        const reg_t pte =
+            dram_.read<uint64_t>(table + vpn(va, level) * MMU::PTESIZE);
+        if (!(pte & MMU::PTE_V))
+            return std::nullopt;
+        table = pte_to_pa(pte);
+    }
+
+    const reg_t pte = dram_.read<uint64_t>(table + vpn(va, 0) * MMU::PTESIZE);
+    if (!(pte & PTE_SW_ALLOC) || (pte & perm) != perm)
+        return std::nullopt;
+
+    return pte_to_pa(pte) | (va & MMU::PGMASK);
+}
+
+void LinuxUser::map(addr_t va, size_t len, reg_t perm) {
+    for (addr_t page = page_down(va); page < page_up(va + len);
+         page += PGSIZE) {
+        const addr_t pte_addr = *walk(page, true);
+        reg_t pte = dram_.read<uint64_t>(pte_addr);
+
+        // Segments sharing a page get the union of their permissions.
+        if (pte & PTE_SW_ALLOC)
+            perm |= pte & PTE_RWX;
+        else
+            pte = pa_to_pte(alloc_page()) | PTE_SW_ALLOC;
+
+        pte = (pte & ~(PTE_RWX | PTE_LEAF)) | perm;
+        if (perm)
+            pte |= PTE_LEAF;
+        dram_.write<uint64_t>(pte_addr, pte);
+    }
+
+    mmu_.tlb_flush_all();
+}
+
+void LinuxUser::unmap(addr_t va, size_t len) {
+    for (addr_t page = page_down(va); page < page_up(va + len);
+         page += PGSIZE) {
+        const std::optional<addr_t> pte_addr = walk(page, false);
+        if (!pte_addr)
+            continue;
+
+        const reg_t pte = dram_.read<uint64_t>(*pte_addr);
+        if (pte & PTE_SW_ALLOC) {
+            free_pages_.push_back(pte_to_pa(pte));
+            dram_.write<uint64_t>(*pte_addr, 0);
+        }
+    }
+
+    mmu_.tlb_flush_all();
+}
+
+void LinuxUser::protect(addr_t va, size_t len, reg_t perm) {
+    for (addr_t page = page_down(va); page < page_up(va + len);
+         page += PGSIZE) {
+        const std::optional<addr_t> pte_addr = walk(page, perm != 0);
+        if (!pte_addr)
+            continue;
+
+        // PROT_NONE mmaps only reserve address space; back them on demand.
+        reg_t pte = dram_.read<uint64_t>(*pte_addr);
+        if (!(pte & PTE_SW_ALLOC)) {
+            if (!perm)
+                continue;
+            pte = pa_to_pte(alloc_page()) | PTE_SW_ALLOC;
+        }
+
+        pte = (pte & ~(PTE_RWX | PTE_LEAF)) | perm;
+        if (perm)
+            pte |= PTE_LEAF;
+        dram_.write<uint64_t>(*pte_addr, pte);
+    }
+
+    mmu_.tlb_flush_all();
+}
+
+bool LinuxUser::is_mapped(addr_t va, size_t len, reg_t perm) const {
+    for (addr_t page = page_down(va); page < va + len; page += PGSIZE)
+        if (!translate(page, perm))
+            return false;
+    return true;
+}
+
+addr_t LinuxUser::reserve(size_t len) {
+    const addr_t va = mmap_next_;
+
+    // Leave an unmapped guard page between regions.
+    if (va + page_up(len) + PGSIZE > STACK_TOP - STACK_SIZE)
+        throw std::bad_alloc();
+
+    mmap_next_ += page_up(len) + PGSIZE;
+    return va;
+}
+
+std::filesystem::path LinuxUser::host_path(const std::string& path) const {
+    if (!sysroot_.empty() && path.starts_with('/')) {
+        std::filesystem::path candidate = sysroot_ / path.substr(1);
+        std::error_code ec;
+        if (std::filesystem::exists(candidate, ec))
+            return candidate;
+    }
+
+    return path;
+}
+
+} // namespace uemu::core
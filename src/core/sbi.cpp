@@ -0,0 +1,271 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/sbi.hpp"
+#include "core/bus.hpp"
+#include "core/mmu.hpp"
+#include "device/clint.hpp"
+
+namespace uemu::core {
+
+Sbi::Sbi(Hart& hart, MMU& mmu, Bus& bus, device::Clint& clint,
+         Console console, ResetCallback reset_callback)
+    : hart_(hart), mmu_(mmu), bus_(bus), clint_(clint),
+      console_(std::move(console)), reset_callback_(std::move(reset_callback)),
+      mip_(dynamic_cast<MIP*>(hart_.csrs[MIP::ADDRESS].get())) {
+    assert(mip_);
+    hart_.set_sbi(this);
+}
+
+void Sbi::handle_ecall() {
+    const reg_t eid = hart_.gprs[17];
+    const reg_t fid = hart_.gprs[16];
+
+    if (eid <= EXT_LEGACY_SHUTDOWN) {
+        // Legacy calls return a single value in a0 and preserve a1.
+        hart_.gprs.write(10, static_cast<reg_t>(call_legacy(eid).error));
+        return;
+    }
+
+    const auto [error, value] = call(eid, fid);
+    hart_.gprs.write(10, static_cast<reg_t>(error));
+    hart_.gprs.write(11, value);
+}
+
+Sbi::Ret Sbi::call(reg_t eid, reg_t fid) {
+    switch (eid) {
+        case EXT_BASE: return base(fid);
+        case EXT_TIME: return time(fid);
+        case EXT_IPI: return ipi(fid);
+        case EXT_RFENCE: return rfence(fid);
+        case EXT_HSM: return hsm(fid);
+        case EXT_SRST: return srst(fid);
+        case EXT_DBCN: return dbcn(fid);
+        default: return {ERR_NOT_SUPPORTED, 0};
+    }
+}
+
+Sbi::Ret Sbi::call_legacy(reg_t eid) {
+    switch (eid) {
+        case EXT_LEGACY_SET_TIMER:
+            clint_.set_sbi_timer(arg(0));
+            hart_.interrupt_check_pending = true;
+            return {SUCCESS, 0};
+
+        case EXT_LEGACY_PUTCHAR:
+            if (console_.write_char)
+                console_.write_char(static_cast<char>(arg(0)));
+            return {SUCCESS, 0};
+
+        case EXT_LEGACY_GETCHAR: {
+            std::optional<char> c;
+            if (console_.read_char)
+                c = console_.read_char();
+            return {c ? static_cast<uint8_t>(*c) : -1, 0};
+        }
+
+        case EXT_LEGACY_SHUTDOWN:
+            reset_callback_(RESET_SHUTDOWN, RESET_REASON_NONE);
+            return {SUCCESS, 0};
+
+        default: return {ERR_NOT_SUPPORTED, 0};
+    }
+}
+
+Sbi::Ret Sbi::base(reg_t fid) {
+    switch (fid) {
+        case 0: return {SUCCESS, SPEC_VERSION};
+        case 1: return {SUCCESS, IMPL_ID};
+        case 2: return {SUCCESS, IMPL_VERSION};
+
+        case 3: { // probe_extension
+            const reg_t eid = arg(0);
+            const bool present =
+                eid == EXT_LEGACY_SET_TIMER || eid == EXT_LEGACY_PUTCHAR ||
+                eid == EXT_LEGACY_GETCHAR || eid == EXT_LEGACY_SHUTDOWN ||
+                eid == EXT_BASE || eid == EXT_TIME || eid == EXT_IPI ||
+                eid == EXT_RFENCE || eid == EXT_HSM || eid == EXT_SRST ||
+                eid == EXT_DBCN;
+            return {SUCCESS, present ? 1u : 0u};
+        }
+
+        case 4:
+            return {SUCCESS, hart_.csrs[MVENDORID::ADDRESS]->read_unchecked()};
+        case 5:
+            return {SUCCESS, hart_.csrs[MARCHID::ADDRESS]->read_unchecked()};
+        case 6:
+            return {SUCCESS, hart_.csrs[MIMPID::ADDRESS]->read_unchecked()};
+        default: return {ERR_NOT_SUPPORTED, 0};
+    }
+}
+
+Sbi::Ret Sbi::time(reg_t fid) {
+    if (fid != 0) [[unlikely]]
+        return {ERR_NOT_SUPPORTED, 0};
+
+    // set_timer: arms the deadline and clears a stale STIP.
+    clint_.set_sbi_timer(arg(0));
+    hart_.interrupt_check_pending = true;
+
+    return {SUCCESS, 0};
+}
+
+Sbi::Ret Sbi::ipi(reg_t fid) {
+    if (fid != 0) [[unlikely]]
+        return {ERR_NOT_SUPPORTED, 0};
+
+    const auto selected = decode_hart_mask(arg(0), arg(1));
+    if (!selected)
+        return {ERR_INVALID_PARAM, 0};
+
+    if (*selected) {
+        mip_->set_pending(MIP::Field::SSIP);
+        hart_.interrupt_check_pending = true;
+    }
+
+    return {SUCCESS, 0};
+}
+
+Sbi::Ret Sbi::rfence(reg_t fid) {
+    // Flushing more pages than this one by one is slower than a full flush.
+    constexpr reg_t MAX_PAGES_TO_FLUSH = 64;
+    constexpr reg_t PAGE_SIZE = 4096;
+
+    if (fid > 2) // HFENCE.*: no hypervisor extension
+        return {ERR_NOT_SUPPORTED, 0};
+
+    if (!decode_hart_mask(arg(0), arg(1)))
+        return {ERR_INVALID_PARAM, 0};
+
+    // remote_fence_i: instructions are always fetched through the MMU, so
+    // there is nothing to synchronise.
+    if (fid == 0)
+        return {SUCCESS, 0};
+
+    // remote_sfence_vma(_asid): the TLB is not ASID-tagged, so both flush
+    // by address only.
+    const reg_t start = arg(2);
+    const reg_t size = arg(3);
+
+    if ((start == 0 && size == 0) || size == ~reg_t{0} ||
+        size > MAX_PAGES_TO_FLUSH * PAGE_SIZE) {
+        mmu_.tlb_flush_all();
+    } else {
+        for (reg_t va = start & ~(PAGE_SIZE - 1); va < start + size;
+             va += PAGE_SIZE)
+            mmu_.tlb_flush_vaddr(va);
+    }
+
+    return {SUCCESS, 0};
+}
+
+Sbi::Ret Sbi::hsm(reg_t fid) {
+    const reg_t hartid = arg(0);
+
+    switch (fid) {
+        case 0: // hart_start: the only hart is always running
+            return {hartid == 0 ? ERR_ALREADY_AVAILABLE : ERR_INVALID_PARAM,
+                    0};
+
+        case 1: // hart_stop: the last running hart cannot stop
+            return {ERR_FAILED, 0};
+
+        case 2: // hart_get_status
+            if (hartid != 0)
+                return {ERR_INVALID_PARAM, 0};
+            return {SUCCESS, HART_STARTED};
+
+        case 3: // hart_suspend
+            if (arg(0) != 0) // Only the default retentive suspend
+                return {ERR_NOT_SUPPORTED, 0};
+
+            // Behaves like WFI and resumes after the ecall with a0 = SUCCESS.
+            if (hart_.has_pending_enabled_interrupt() ||
+                hart_.csrs[MIE::ADDRESS]->read_unchecked() == 0)
+                return {SUCCESS, 0};
+
+            hart_.gprs.write(10, SUCCESS);
+            hart_.gprs.write(11, 0);
+            throw WfiWait{};
+
+        default: return {ERR_NOT_SUPPORTED, 0};
+    }
+}
+
+Sbi::Ret Sbi::srst(reg_t fid) {
+    if (fid != 0) [[unlikely]]
+        return {ERR_NOT_SUPPORTED, 0};
+
+    const auto type = static_cast<uint32_t>(arg(0));
+    const auto reason = static_cast<uint32_t>(arg(1));
+
+    if (type > RESET_WARM_REBOOT)
+        return {ERR_INVALID_PARAM, 0};
+
+    reset_callback_(type, reason);
+    return {SUCCESS, 0};
+}
+
+Sbi::Ret Sbi::dbcn(reg_t fid) {
+    switch (fid) {
+        case 0: { // console_write(num_bytes, base_lo, base_hi)
+            const reg_t n = arg(0);
+            const addr_t base = arg(1);
+
+            if (arg(2) != 0) [[unlikely]]
+                return {ERR_INVALID_PARAM, 0};
+
+            for (reg_t i = 0; i < n; i++) {
+                const auto byte = bus_.read<uint8_t>(base + i);
+                if (!byte) [[unlikely]]
+                    return {i ? SUCCESS : ERR_INVALID_PARAM, i};
+                if (console_.write_char)
+                    console_.write_char(static_cast<char>(*byte));
+            }
+
+            return {SUCCESS, n};
+        }
+
+        case 1: { // console_read(num_bytes, base_lo, base_hi)
+            const reg_t n = arg(0);
+            const addr_t base = arg(1);
+            reg_t i = 0;
+
+            if (arg(2) != 0) [[unlikely]]
+                return {ERR_INVALID_PARAM, 0};
+
+            for (; i < n && console_.read_char; i++) {
+                const auto c = console_.read_char();
+                if (!c)
+                    break;
+                if (!bus_.write<uint8_t>(base + i, static_cast<uint8_t>(*c)))
+                    [[unlikely]]
+                    return {ERR_INVALID_PARAM, 0};
+            }
+
+            return {SUCCESS, i};
+        }
+
+        case 2: // console_write_byte(byte)
+            if (console_.write_char)
+                console_.write_char(static_cast<char>(arg(0)));
+            return {SUCCESS, 0};
+
+        default: return {ERR_NOT_SUPPORTED, 0};
+    }
+}
+
+} // namespace uemu::core
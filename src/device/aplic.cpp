@@ -0,0 +1,340 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <bit>
+
+#include "device/aplic.hpp"
+#include "utils/device_tree.hpp"
+
+namespace uemu::device {
+
+Aplic::Aplic(MsiCallback msi_callback, bool mmode, addr_t imsic_base,
+             uint32_t ndev)
+    : Device(mmode ? "APLIC-M" : "APLIC-S", DEFAULT_BASE, SIZE),
+      msi_callback_(std::move(msi_callback)), mmode_(mmode),
+      num_ids_(ndev + 1), domaincfg_(0),
+      mmsiaddrcfg_(mmode ? static_cast<uint32_t>(imsic_base >> 12) : 0),
+      mmsiaddrcfgh_(0),
+      smsiaddrcfg_(mmode ? 0 : static_cast<uint32_t>(imsic_base >> 12)),
+      smsiaddrcfgh_(0), genmsi_(0), sourcecfg_(num_ids_, 0),
+      target_(num_ids_, 0), level_(num_ids_, false),
+      pending_(num_ids_, false), enabled_(num_ids_, false) {}
+
+void Aplic::set_interrupt_level(uint32_t id, bool lvl) {
+    if (id == 0 || id >= num_ids_)
+        return;
+
+    std::vector<Msi> msis;
+
+    {
+        std::scoped_lock lock(aplic_mutex_);
+
+        bool old_input = rectified_input(id);
+        level_[id] = lvl;
+        bool new_input = rectified_input(id);
+
+        uint32_t sm = sourcecfg_[id] & SOURCECFG_SM_MASK;
+        bool level_mode = sm == SM_LEVEL1 || sm == SM_LEVEL0;
+
+        if (!old_input && new_input)
+            set_pending(id, true);
+        else if (level_mode && !new_input)
+            set_pending(id, false);
+
+        msis.swap(outbox_);
+    }
+
+    send(msis);
+}
+
+std::optional<uint64_t> Aplic::read_internal(addr_t offset, size_t size) {
+    if (size != 4 || (offset & 3)) [[unlikely]]
+        return std::nullopt;
+
+    std::scoped_lock lock(aplic_mutex_);
+
+    auto bitmap_word = [this](const std::vector<bool>& bits,
+                              uint32_t word) -> uint32_t {
+        uint32_t val = 0;
+        for (uint32_t i = 0; i < 32; i++) {
+            uint32_t id = word * 32 + i;
+            if (id != 0 && id < num_ids_ && bits[id])
+                val |= 1u << i;
+        }
+        return val;
+    };
+
+    if (offset == DOMAINCFG)
+        return DOMAINCFG_RO80 | DOMAINCFG_DM | (domaincfg_ & DOMAINCFG_IE);
+
+    if (SOURCECFG_BASE <= offset && offset < MMSIADDRCFG) {
+        uint32_t id = (offset - SOURCECFG_BASE) / 4 + 1;
+        return id < num_ids_ ? sourcecfg_[id] : 0;
+    }
+
+    switch (offset) {
+        case MMSIADDRCFG: return mmsiaddrcfg_;
+        case MMSIADDRCFGH: return mmsiaddrcfgh_;
+        case SMSIADDRCFG: return smsiaddrcfg_;
+        case SMSIADDRCFGH: return smsiaddrcfgh_;
+        case SETIPNUM:
+        case CLRIPNUM:
+        case SETIENUM:
+        case CLRIENUM:
+        case SETIPNUM_LE:
+        case SETIPNUM_BE: return 0;
+        case GENMSI: return genmsi_ & ~GENMSI_BUSY;
+        default: break;
+    }
+
+    if (SETIP_BASE <= offset && offset < SETIPNUM)
+        return bitmap_word(pending_, (offset - SETIP_BASE) / 4);
+
+    if (IN_CLRIP_BASE <= offset && offset < CLRIPNUM) {
+        uint32_t word = (offset - IN_CLRIP_BASE) / 4;
+        uint32_t val = 0;
+        for (uint32_t i = 0; i < 32; i++) {
+            uint32_t id = word * 32 + i;
+            if (id != 0 && id < num_ids_ && rectified_input(id))
+                val |= 1u << i;
+        }
+        return val;
+    }
+
+    if (SETIE_BASE <= offset && offset < SETIENUM)
+        return bitmap_word(enabled_, (offset - SETIE_BASE) / 4);
+
+    if (CLRIE_BASE <= offset && offset < CLRIENUM)
+        return 0;
+
+    if (TARGET_BASE <= offset && offset < SIZE) {
+        uint32_t id = (offset - TARGET_BASE) / 4 + 1;
+        return id < num_ids_ ? target_[id] : 0;
+    }
+
+    return 0;
+}
+
+bool Aplic::write_internal(addr_t offset, size_t size, uint64_t value) {
+    if (size != 4 || (offset & 3)) [[unlikely]]
+        return false;
+
+    uint32_t val = static_cast<uint32_t>(value);
+    std::vector<Msi> msis;
+
+    {
+        std::scoped_lock lock(aplic_mutex_);
+
+        auto for_each_bit = [this](uint32_t word, uint32_t bits, auto fn) {
+            while (bits) {
+                uint32_t id = word * 32 + std::countr_zero(bits);
+                bits &= bits - 1;
+                if (id != 0 && id < num_ids_)
+                    fn(id);
+            }
+        };
+
+        if (offset == DOMAINCFG) {
+            domaincfg_ = val & DOMAINCFG_IE;
+            if (domaincfg_ & DOMAINCFG_IE)
+                for (uint32_t id = 1; id < num_ids_; id++)
+                    forward(id);
+        } else if (SOURCECFG_BASE <= offset && offset < MMSIADDRCFG) {
+            uint32_t id = (offset - SOURCECFG_BASE) / 4 + 1;
+            if (id < num_ids_)
+                sourcecfg_write(id, val);
+        } else if (MMSIADDRCFG <= offset && offset <= SMSIADDRCFGH) {
+            if (!(mmsiaddrcfgh_ & MSIADDRCFGH_L)) {
+                switch (offset) {
+                    case MMSIADDRCFG: mmsiaddrcfg_ = val; break;
+                    case MMSIADDRCFGH: mmsiaddrcfgh_ = val & 0x9F77FFFF; break;
+                    case SMSIADDRCFG: smsiaddrcfg_ = val; break;
+                    case SMSIADDRCFGH: smsiaddrcfgh_ = val & 0x00700FFF; break;
+                    default: break;
+                }
+            }
+        } else if (SETIP_BASE <= offset && offset < SETIPNUM) {
+            for_each_bit((offset - SETIP_BASE) / 4, val,
+                         [this](uint32_t id) { set_pending(id, true); });
+        } else if (offset == SETIPNUM || offset == SETIPNUM_LE ||
+                   offset == SETIPNUM_BE) {
+            uint32_t id = offset == SETIPNUM_BE ? std::byteswap(val) : val;
+            if (id != 0 && id < num_ids_)
+                set_pending(id, true);
+        } else if (IN_CLRIP_BASE <= offset && offset < CLRIPNUM) {
+            for_each_bit((offset - IN_CLRIP_BASE) / 4, val,
+                         [this](uint32_t id) { set_pending(id, false); });
+        } else if (offset == CLRIPNUM) {
+            if (val != 0 && val < num_ids_)
+                set_pending(val, false);
+        } else if (SETIE_BASE <= offset && offset < SETIENUM) {
+            for_each_bit((offset - SETIE_BASE) / 4, val,
+                         [this](uint32_t id) { set_enabled(id, true); });
+        } else if (offset == SETIENUM) {
+            if (val != 0 && val < num_ids_)
+                set_enabled(val, true);
+        } else if (CLRIE_BASE <= offset && offset < CLRIENUM) {
+            for_each_bit((offset - CLRIE_BASE) / 4, val,
+                         [this](uint32_t id) { set_enabled(id, false); });
+        } else if (offset == CLRIENUM) {
+            if (val != 0 && val < num_ids_)
+                set_enabled(val, false);
+        } else if (offset == GENMSI) {
+            genmsi_ = val & ~(GENMSI_BUSY | (TARGET_GUEST_MASK
+                                             << TARGET_GUEST_SHIFT));
+            deliver(genmsi_ >> TARGET_HART_SHIFT, 0,
+                    genmsi_ & TARGET_EIID_MASK);
+        } else if (TARGET_BASE <= offset && offset < SIZE) {
+            uint32_t id = (offset - TARGET_BASE) / 4 + 1;
+            if (id < num_ids_ && source_active(id)) {
+                uint32_t mask = ~0u << TARGET_HART_SHIFT | TARGET_EIID_MASK;
+                if (!mmode_)
+                    mask |= TARGET_GUEST_MASK << TARGET_GUEST_SHIFT;
+                target_[id] = val & mask;
+            }
+        } else {
+            return false;
+        }
+
+        msis.swap(outbox_);
+    }
+
+    send(msis);
+    return true;
+}
+
+bool Aplic::source_active(uint32_t id) const noexcept {
+    return (sourcecfg_[id] & SOURCECFG_SM_MASK) != SM_INACTIVE;
+}
+
+bool Aplic::rectified_input(uint32_t id) const noexcept {
+    switch (sourcecfg_[id] & SOURCECFG_SM_MASK) {
+        case SM_EDGE1:
+        case SM_LEVEL1: return level_[id];
+        case SM_EDGE0:
+        case SM_LEVEL0: return !level_[id];
+        default: return false;
+    }
+}
+
+addr_t Aplic::msi_address(uint32_t hart_index,
+                          uint32_t guest_index) const noexcept {
+    const uint32_t lhxw = (mmsiaddrcfgh_ >> MSIADDRCFGH_LHXW_SHIFT) & 0xF;
+    const uint32_t hhxw = (mmsiaddrcfgh_ >> MSIADDRCFGH_HHXW_SHIFT) & 0x7;
+    const uint32_t hhxs = (mmsiaddrcfgh_ >> MSIADDRCFGH_HHXS_SHIFT) & 0x1F;
+
+    const uint32_t cfg = mmode_ ? mmsiaddrcfg_ : smsiaddrcfg_;
+    const uint32_t cfgh = mmode_ ? mmsiaddrcfgh_ : smsiaddrcfgh_;
+    const uint32_t lhxs = (cfgh >> MSIADDRCFGH_LHXS_SHIFT) & 0x7;
+
+    const uint64_t ppn =
+        (static_cast<uint64_t>(cfgh & MSIADDRCFGH_PPN_MASK) << 32) | cfg;
+    const uint64_t group = (hart_index >> lhxw) & ((1ULL << hhxw) - 1);
+    const uint64_t hart = hart_index & ((1ULL << lhxw) - 1);
+
+    return (ppn | (group << (hhxs + 12)) | (hart << lhxs) | guest_index)
+           << 12;
+}
+
+void Aplic::sourcecfg_write(uint32_t id, uint32_t val) {
+    uint32_t sm = val & SOURCECFG_SM_MASK;
+
+    // Delegation is not supported, reserved modes read back as inactive.
+    if (sm == 2 || sm == 3)
+        sm = SM_INACTIVE;
+
+    sourcecfg_[id] = sm;
+
+    if (sm == SM_INACTIVE) {
+        pending_[id] = false;
+        enabled_[id] = false;
+        target_[id] = 0;
+        return;
+    }
+
+    // Level-sensitive sources track the rectified input.
+    if (sm == SM_LEVEL1 || sm == SM_LEVEL0)
+        set_pending(id, rectified_input(id));
+}
+
+void Aplic::set_pending(uint32_t id, bool pending) {
+    if (!source_active(id))
+        return;
+
+    uint32_t sm = sourcecfg_[id] & SOURCECFG_SM_MASK;
+
+    // A level-sensitive source can only become pending while asserted.
+    if (pending && (sm == SM_LEVEL1 || sm == SM_LEVEL0) && !rectified_input(id))
+        return;
+
+    pending_[id] = pending;
+    if (pending)
+        forward(id);
+}
+
+void Aplic::set_enabled(uint32_t id, bool enabled) {
+    if (!source_active(id))
+        return;
+
+    enabled_[id] = enabled;
+    if (enabled)
+        forward(id);
+}
+
+// In MSI delivery mode an interrupt that is pending and enabled is turned
+// into an MSI immediately, which clears its pending bit.
+void Aplic::forward(uint32_t id) {
+    if (!pending_[id] || !enabled_[id] || !(domaincfg_ & DOMAINCFG_IE))
+        return;
+
+    pending_[id] = false;
+
+    uint32_t target = target_[id];
+    deliver(target >> TARGET_HART_SHIFT,
+            (target >> TARGET_GUEST_SHIFT) & TARGET_GUEST_MASK,
+            target & TARGET_EIID_MASK);
+}
+
+void Aplic::deliver(uint32_t hart_index, uint32_t guest_index, uint32_t eiid) {
+    outbox_.push_back(Msi{
+        .addr = msi_address(hart_index, guest_index),
+        .data = eiid,
+    });
+}
+
+void Aplic::send(const std::vector<Msi>& msis) const {
+    if (!msi_callback_) [[unlikely]]
+        return;
+
+    for (const auto& msi : msis)
+        msi_callback_(msi.addr, msi.data);
+}
+
+void Aplic::emit_dt(DtContext& ctx) const {
+    const uint32_t phandle = ctx.alloc_phandle();
+    utils::Fdt::Node& node = add_soc_node(ctx, "interrupt-controller");
+
+    node.set_u32("phandle", phandle);
+    node.set_string("compatible", "riscv,aplic");
+    node.set_u32("msi-parent", ctx.msi_parent);
+    node.set_empty("interrupt-controller");
+    node.set_u32("#interrupt-cells", 2);
+    node.set_u32("riscv,num-sources", num_ids_ - 1);
+
+    ctx.irq_parent = phandle;
+    ctx.irq_cells = 2;
+}
+
+} // namespace uemu::device
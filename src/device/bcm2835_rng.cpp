@@ -15,6 +15,7 @@
  */
 
 #include "device/bcm2835_rng.hpp"
+#include "utils/device_tree.hpp"
 
 namespace uemu::device {
 
@@ -68,4 +69,8 @@ bool BCM2835Rng::write_internal(addr_t offset, size_t size, uint64_t value) {
     return false;
 }
 
+void BCM2835Rng::emit_dt(DtContext& ctx) const {
+    add_soc_node(ctx, "rng").set_string("compatible", "brcm,bcm2835-rng");
+}
+
 } // namespace uemu::device
@@ -14,28 +14,33 @@
  * limitations under the License.
  */
 
+#include <bit>
+
 #include "device/clint.hpp"
+#include "utils/device_tree.hpp"
 
 namespace uemu::device {
 
 Clint::Clint(std::shared_ptr<core::Hart> hart, uint64_t freq_hz)
-    : Device("CLINT", DEFAULT_BASE, SIZE), hart_(std::move(hart)), mtime_(0),
-      mtimecmp_(0), freq_hz_(freq_hz) {
-    start_time_ = std::chrono::steady_clock::now();
+    : Device("CLINT", DEFAULT_BASE, SIZE), hart_(std::move(hart)),
+      mip_(dynamic_cast<core::MIP*>(hart_->csrs[core::MIP::ADDRESS].get())),
+      menvcfg_(dynamic_cast<core::MENVCFG*>(
+          hart_->csrs[core::MENVCFG::ADDRESS].get())),
+      stimecmp_(dynamic_cast<core::STIMECMP*>(
+          hart_->csrs[core::STIMECMP::ADDRESS].get())),
+      mtime_offset_(0), mtimecmp_(0), sbi_timecmp_(UINT64_MAX),
+      sbi_timer_armed_(false),
+      start_time_(std::chrono::steady_clock::now()), freq_hz_(freq_hz),
+      mult_int_(freq_hz / NS_PER_SEC),
+      mult_frac_(static_cast<uint64_t>(
+          (static_cast<__uint128_t>(freq_hz % NS_PER_SEC) << 64) /
+          NS_PER_SEC)) {
+    assert(mip_ && menvcfg_ && stimecmp_);
     hart_->set_clint(this);
     tick();
 }
 
-void Clint::tick() {
-    std::scoped_lock lock(clint_mutex_);
-    tick_internal();
-}
-
-uint64_t Clint::get_mtime() noexcept {
-    std::scoped_lock lock(clint_mutex_);
-    tick_internal();
-    return mtime_;
-}
+void Clint::tick() { check_deadlines(get_mtime()); }
 
 std::optional<uint64_t> Clint::read_internal(addr_t offset, size_t size) {
     if (size > 8) [[unlikely]]
@@ -43,10 +48,8 @@ std::optional<uint64_t> Clint::read_internal(addr_t offset, size_t size) {
 
     if (offset >= MSIP_OFFSET && offset < MSIP_OFFSET + 4) {
         // MSIP
-        uint64_t msip_val = (hart_->csrs[core::MIP::ADDRESS]->read_unchecked() &
-                             core::MIP::Field::MSIP)
-                                ? 1
-                                : 0;
+        uint64_t msip_val =
+            (mip_->read_unchecked() & core::MIP::Field::MSIP) ? 1 : 0;
         uint64_t result = 0;
         read_little_endian(&msip_val, offset - MSIP_OFFSET, size, &result);
         return result;
@@ -54,9 +57,9 @@ std::optional<uint64_t> Clint::read_internal(addr_t offset, size_t size) {
 
     if (offset >= MTIMECMP_OFFSET && offset < MTIMECMP_OFFSET + 8) {
         // MTIMECMP
+        uint64_t cmp = mtimecmp_.load(std::memory_order_relaxed);
         uint64_t result = 0;
-        std::scoped_lock lock(clint_mutex_);
-        read_little_endian(&mtimecmp_, offset - MTIMECMP_OFFSET, size, &result);
+        read_little_endian(&cmp, offset - MTIMECMP_OFFSET, size, &result);
         return result;
     }
 
@@ -76,27 +79,24 @@ bool Clint::write_internal(addr_t offset, size_t size, uint64_t value) {
         // MSIP
         uint64_t msip_val = 0;
         write_little_endian(&msip_val, offset - MSIP_OFFSET, size, value);
-        hart_->set_interrupt_pending(core::MIP::Field::MSIP, (msip_val & 1));
+        if (msip_val & 1)
+            mip_->set_pending(core::MIP::Field::MSIP);
+        else
+            mip_->clear_pending(core::MIP::Field::MSIP);
     } else if (offset >= MTIMECMP_OFFSET && offset < MTIMECMP_OFFSET + 8) {
         // MTIMECMP
-        std::scoped_lock lock(clint_mutex_);
-        write_little_endian(&mtimecmp_, offset - MTIMECMP_OFFSET, size, value);
-        tick_internal();
+        uint64_t cmp = mtimecmp_.load(std::memory_order_relaxed);
+        write_little_endian(&cmp, offset - MTIMECMP_OFFSET, size, value);
+        mtimecmp_.store(cmp);
+        check_deadlines(get_mtime());
     } else if (offset >= MTIME_OFFSET && offset < MTIME_OFFSET + 8) {
-        // MTIME
-        std::scoped_lock lock(clint_mutex_);
-        write_little_endian(&mtime_, offset - MTIME_OFFSET, size, value);
-
-        auto now = std::chrono::steady_clock::now();
-        std::chrono::duration<double> new_elapsed(
-            static_cast<double>(static_cast<int64_t>(mtime_)) / freq_hz_);
-        start_time_ =
-            now -
-            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
-                new_elapsed);
-
-        handle_mtimecmp();
-        handle_stimecmp();
+        // MTIME: rebase the offset so that the host clock keeps driving it
+        uint64_t host_mtime = host_to_mtime(host_now_ns());
+        uint64_t cur_mtime =
+            host_mtime + mtime_offset_.load(std::memory_order_relaxed);
+        write_little_endian(&cur_mtime, offset - MTIME_OFFSET, size, value);
+        mtime_offset_.store(cur_mtime - host_mtime, std::memory_order_relaxed);
+        check_deadlines(cur_mtime);
     } else {
         return false;
     }
@@ -104,30 +104,65 @@ bool Clint::write_internal(addr_t offset, size_t size, uint64_t value) {
     return true;
 }
 
-void Clint::tick_internal() {
-    auto now = std::chrono::steady_clock::now();
-    std::chrono::duration<double> elapsed = now - start_time_;
+void Clint::set_sbi_timer(uint64_t value) noexcept {
+    sbi_timecmp_.store(value);
+    sbi_timer_armed_.store(true, std::memory_order_release);
+    check_deadlines(get_mtime());
+}
 
-    mtime_ =
-        static_cast<uint64_t>(elapsed.count() * static_cast<double>(freq_hz_));
-    handle_mtimecmp();
-    handle_stimecmp();
+void Clint::check_deadlines(uint64_t mtime) noexcept {
+    update_tip(core::MIP::Field::MTIP, mtimecmp_, mtime);
+
+    if (menvcfg_->read_unchecked() & core::MENVCFG::Field::STCE)
+        update_tip(core::MIP::Field::STIP, stimecmp_->deadline(), mtime);
+    else if (sbi_timer_armed_.load(std::memory_order_acquire))
+        update_tip(core::MIP::Field::STIP, sbi_timecmp_, mtime);
 }
 
-void Clint::handle_mtimecmp() {
-    hart_->set_interrupt_pending(core::MIP::Field::MTIP, mtime_ >= mtimecmp_);
+void Clint::update_tip(reg_t tip, const std::atomic<uint64_t>& timecmp,
+                       uint64_t mtime) noexcept {
+    // The device thread and the CPU thread both get here. If the other one
+    // moves the deadline while we act on the old value, the reload sees its
+    // store, or its own update comes after ours: a stale deadline cannot
+    // leave `tip` wrongly set or cleared.
+    uint64_t cmp = timecmp.load();
+    while (true) {
+        if (mtime >= cmp) {
+            note_deadline(tip, mtime - cmp);
+            mip_->set_pending(tip);
+        } else {
+            mip_->clear_pending(tip);
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const uint64_t now = timecmp.load();
+        if (now == cmp) [[likely]]
+            return;
+        cmp = now;
+        mtime = get_mtime();
+    }
+}
+
+void Clint::note_deadline(reg_t tip, uint64_t late_ticks) const noexcept {
+    auto* latency = hart_->get_irq_latency();
+    if (!latency || (mip_->read_unchecked() & tip)) [[likely]]
+        return;
+
+    // The deadline passed between two polls; date the assertion back to it
+    const auto late_ns = static_cast<uint64_t>(
+        static_cast<double>(late_ticks) * 1e9 / static_cast<double>(freq_hz_));
+    latency->asserted(std::countr_zero(tip), late_ns);
 }
 
-void Clint::handle_stimecmp() {
-    core::MENVCFG* menvcfg =
-        dynamic_cast<core::MENVCFG*>(hart_->csrs[core::MENVCFG::ADDRESS].get());
-    core::STIMECMP* stimecmp = dynamic_cast<core::STIMECMP*>(
-        hart_->csrs[core::STIMECMP::ADDRESS].get());
-    assert(menvcfg && stimecmp);
+void Clint::emit_dt(DtContext& ctx) const {
+    utils::Fdt::Node& node = add_soc_node(ctx, "clint");
+    node.set_string("compatible", "riscv,clint0");
 
-    if (menvcfg->read_unchecked() & core::MENVCFG::Field::STCE)
-        hart_->set_interrupt_pending(core::MIP::Field::STIP,
-                                     mtime_ >= stimecmp->read_unchecked());
+    // MSIP and MTIP of every hart
+    std::vector<uint32_t> cells;
+    for (uint32_t intc : ctx.cpu_intc)
+        cells.insert(cells.end(), {intc, 3, intc, 7});
+    node.set_cells("interrupts-extended", cells);
 }
 
 }; // namespace uemu::device
@@ -15,12 +15,14 @@
  */
 
 #include "device/goldfish_battery.hpp"
+#include "utils/device_tree.hpp"
 
 namespace uemu::device {
 
 GoldfishBattery::GoldfishBattery(IrqCallback irq_callback,
-                                 uint32_t interrupt_id, uint32_t init_capacity)
-    : IrqDevice("GoldfishBattery", DEFAULT_BASE, SIZE, std::move(irq_callback),
+                                 uint32_t interrupt_id, uint32_t init_capacity,
+                                 addr_t base)
+    : IrqDevice("GoldfishBattery", base, SIZE, std::move(irq_callback),
                 interrupt_id),
       int_status_(0), int_enable_(0), ac_online_(1),
       status_(POWER_SUPPLY_STATUS_CHARGING), health_(POWER_SUPPLY_HEALTH_GOOD),
@@ -62,4 +64,11 @@ bool GoldfishBattery::write_internal(addr_t offset,
     return true;
 }
 
+void GoldfishBattery::emit_dt(DtContext& ctx) const {
+    utils::Fdt::Node& node = add_soc_node(ctx, "goldfish_battery");
+    node.set_string("compatible", "google,goldfish-battery");
+    set_dt_interrupt(node, ctx);
+    node.set_string("status", "okay");
+}
+
 } // namespace uemu::device
@@ -15,12 +15,13 @@
  */
 
 #include "device/goldfish_events.hpp"
+#include "utils/device_tree.hpp"
 
 namespace uemu::device {
 
 GoldfishEvents::GoldfishEvents(IrqCallback irq_callback, uint32_t interrupt_id,
-                               const std::string& device_name)
-    : IrqDevice("GoldfishEvents", DEFAULT_BASE, SIZE, std::move(irq_callback),
+                               const std::string& device_name, addr_t base)
+    : IrqDevice("GoldfishEvents", base, SIZE, std::move(irq_callback),
                 interrupt_id),
       device_name_(device_name), page_(0), state_(STATE_INIT), events_{},
       first_(0), last_(0) {
@@ -181,4 +182,12 @@ uint8_t GoldfishEvents::get_page_data(size_t offset) const {
     return 0;
 }
 
+void GoldfishEvents::emit_dt(DtContext& ctx) const {
+    utils::Fdt::Node& node = add_soc_node(ctx, "events");
+    node.set_string("compatible", "google,goldfish-events-keypad");
+    set_dt_interrupt(node, ctx);
+    node.set_string("label", "goldfish-events");
+    node.set_string("status", "okay");
+}
+
 } // namespace uemu::device
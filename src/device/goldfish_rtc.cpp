@@ -17,11 +17,13 @@
 #include <chrono>
 
 #include "device/goldfish_rtc.hpp"
+#include "utils/device_tree.hpp"
 
 namespace uemu::device {
 
-GoldfishRTC::GoldfishRTC(IrqCallback irq_callback, uint32_t interrupt_id)
-    : IrqDevice("GoldfishRTC", DEFAULT_BASE, SIZE, std::move(irq_callback),
+GoldfishRTC::GoldfishRTC(IrqCallback irq_callback, uint32_t interrupt_id,
+                         addr_t base)
+    : IrqDevice("GoldfishRTC", base, SIZE, std::move(irq_callback),
                 interrupt_id),
       tick_offset_(0), alarm_next_(0), alarm_running_(0), irq_pending_(0),
       irq_enabled_(0), time_high_(0) {
@@ -156,4 +158,10 @@ void GoldfishRTC::update_irq() {
     IrqDevice::update_irq(level);
 }
 
+void GoldfishRTC::emit_dt(DtContext& ctx) const {
+    utils::Fdt::Node& node = add_soc_node(ctx, "rtc");
+    node.set_string("compatible", "google,goldfish-rtc");
+    set_dt_interrupt(node, ctx);
+}
+
 } // namespace uemu::device
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <bit>
+
+#include "device/imsic.hpp"
+#include "utils/device_tree.hpp"
+
+namespace uemu::device {
+
+Imsic::Imsic(std::shared_ptr<core::Hart> hart, bool mmode)
+    : Device(mmode ? "IMSIC-M" : "IMSIC-S",
+             mmode ? DEFAULT_M_BASE : DEFAULT_S_BASE, SIZE),
+      hart_(std::move(hart)),
+      mip_(dynamic_cast<core::MIP*>(hart_->csrs[core::MIP::ADDRESS].get())),
+      mmode_(mmode),
+      eip_mask_(mmode ? core::MIP::Field::MEIP : core::MIP::Field::SEIP),
+      eip_{}, eie_{}, eidelivery_(0), eithreshold_(0) {
+    assert(mip_);
+    hart_->set_imsic(mmode_, this);
+}
+
+void Imsic::send_msi(uint32_t id) noexcept {
+    if (id == 0 || id >= NUM_IDS) [[unlikely]]
+        return;
+
+    eip_[id / 64].fetch_or(1ULL << (id % 64));
+    update_irq();
+}
+
+bool Imsic::ireg_valid(reg_t iselect) const noexcept {
+    if (iselect == EIDELIVERY || iselect == EITHRESHOLD)
+        return true;
+
+    if ((EIP0 <= iselect && iselect <= EIP63) ||
+        (EIE0 <= iselect && iselect <= EIE63))
+        return (iselect & 1) == 0;
+
+    return false;
+}
+
+reg_t Imsic::ireg_read(reg_t iselect) const noexcept {
+    if (iselect == EIDELIVERY)
+        return eidelivery_.load();
+
+    if (iselect == EITHRESHOLD)
+        return eithreshold_.load();
+
+    if (auto idx = word_index(iselect); idx)
+        return iselect < EIE0 ? eip_[*idx].load() : eie_[*idx].load();
+
+    return 0;
+}
+
+void Imsic::ireg_write(reg_t iselect, reg_t value) noexcept {
+    if (iselect == EIDELIVERY) {
+        eidelivery_.store(value & 1);
+    } else if (iselect == EITHRESHOLD) {
+        eithreshold_.store(value & (NUM_IDS - 1));
+    } else if (auto idx = word_index(iselect); idx) {
+        // Identity 0 does not exist
+        if (*idx == 0)
+            value &= ~1ULL;
+        (iselect < EIE0 ? eip_ : eie_)[*idx].store(value);
+    } else {
+        return;
+    }
+
+    update_irq();
+}
+
+reg_t Imsic::topei() const noexcept {
+    uint32_t id = top_id();
+    return (static_cast<reg_t>(id) << TOPEI_ID_SHIFT) | id;
+}
+
+void Imsic::claim_topei() noexcept {
+    if (uint32_t id = top_id(); id)
+        eip_[id / 64].fetch_and(~(1ULL << (id % 64)));
+
+    update_irq();
+}
+
+std::optional<uint64_t> Imsic::read_internal(addr_t offset, size_t size) {
+    // seteipnum_le / seteipnum_be read as zero
+    if (size != 4 || offset > SETEIPNUM_BE)
+        return std::nullopt;
+
+    return 0;
+}
+
+bool Imsic::write_internal(addr_t offset, size_t size, uint64_t value) {
+    if (size != 4)
+        return false;
+
+    switch (offset) {
+        case SETEIPNUM_LE: send_msi(static_cast<uint32_t>(value)); return true;
+        case SETEIPNUM_BE:
+            send_msi(std::byteswap(static_cast<uint32_t>(value)));
+            return true;
+        default: return false;
+    }
+}
+
+// Lower identities have higher priority. A non-zero eithreshold masks every
+// identity at or above it.
+uint32_t Imsic::top_id() const noexcept {
+    uint32_t threshold = eithreshold_.load();
+
+    for (uint32_t i = 0; i < NUM_WORDS; i++) {
+        uint64_t bits = eip_[i].load() & eie_[i].load();
+
+        if (!bits)
+            continue;
+
+        uint32_t id = i * 64 + std::countr_zero(bits);
+        if (threshold != 0 && id >= threshold)
+            return 0;
+
+        return id;
+    }
+
+    return 0;
+}
+
+void Imsic::update_irq() noexcept {
+    if (eidelivery_.load() && top_id() != 0)
+        mip_->set_pending(eip_mask_);
+    else
+        mip_->clear_pending(eip_mask_);
+}
+
+std::optional<size_t> Imsic::word_index(reg_t iselect) noexcept {
+    size_t idx = (iselect & 0x3F) / 2;
+
+    if (idx >= NUM_WORDS)
+        return std::nullopt;
+
+    return idx;
+}
+
+void Imsic::emit_dt(DtContext& ctx) const {
+    const uint32_t phandle = ctx.alloc_phandle();
+    utils::Fdt::Node& node = add_soc_node(ctx, "interrupt-controller");
+
+    node.set_u32("phandle", phandle);
+    node.set_string("compatible", "riscv,imsics");
+    node.set_empty("interrupt-controller");
+    node.set_u32("#interrupt-cells", 0);
+    node.set_empty("msi-controller");
+    node.set_u32("#msi-cells", 0);
+    node.set_u32("riscv,num-ids", NUM_IDS - 1);
+
+    std::vector<uint32_t> cells;
+    for (uint32_t intc : ctx.cpu_intc)
+        cells.insert(cells.end(), {intc, mmode_ ? 11u : 9u});
+    node.set_cells("interrupts-extended", cells);
+
+    if (!mmode_) {
+        ctx.msi_parent = phandle;
+        ctx.isa_extensions.insert(ctx.isa_extensions.end(),
+                                  {"smaia", "ssaia"});
+    }
+}
+
+} // namespace uemu::device
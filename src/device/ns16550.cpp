@@ -25,34 +25,45 @@
 
 #include "device/ns16550.hpp"
 #include "core/mmu.hpp"
+#include "utils/device_tree.hpp"
 
 namespace uemu::device {
 
 NS16550::NS16550(IrqCallback irq_callback, uint32_t interrupt_id,
-                 uint32_t reg_shift, uint32_t reg_io_width)
-    : IrqDevice("NS16550", DEFAULT_BASE, SIZE, std::move(irq_callback),
+                 uint32_t reg_shift, uint32_t reg_io_width, addr_t base)
+    : IrqDevice("NS16550", base, SIZE, std::move(irq_callback),
                 interrupt_id),
-      reg_shift_(reg_shift), reg_io_width_(reg_io_width), dll_(0x0C), dlm_(0),
-      iir_(IIR_NO_INT), ier_(0), fcr_(0), lcr_(0), mcr_(MCR_OUT2),
+      reg_shift_(reg_shift), reg_io_width_(reg_io_width), thr_ipending_(false),
+      timeout_ipending_(false),
+      rx_last_activity_(std::chrono::steady_clock::now()), dll_(0x0C),
+      dlm_(0), iir_(IIR_NO_INT), ier_(0), fcr_(0), lcr_(0), mcr_(MCR_OUT2),
       lsr_(LSR_TEMT | LSR_THRE), msr_(MSR_DCD | MSR_DSR | MSR_CTS), scr_(0) {}
 
 void NS16550::tick() {
     std::scoped_lock lock(ns16550_mutex_);
 
-    if (!(fcr_ & FCR_ENABLE_FIFO) || (mcr_ & MCR_LOOP) ||
-        QUEUE_SIZE <= rx_queue_.size())
-        return;
+    bool changed = tx_drain();
 
-    std::optional<char> c = std::nullopt;
+    if (!(mcr_ & MCR_LOOP) && read_char) [[likely]] {
+        while (rx_queue_.size() < fifo_depth()) {
+            std::optional<char> c = read_char();
+            if (!c.has_value())
+                break;
+            rx_push(static_cast<uint8_t>(*c));
+            changed = true;
+        }
+    }
 
-    if (read_char) [[likely]]
-        c = read_char();
+    if (fifo_enabled() && !rx_queue_.empty() && !timeout_ipending_) {
+        auto now = std::chrono::steady_clock::now();
+        if (now - rx_last_activity_ >= rx_timeout()) {
+            timeout_ipending_ = true;
+            changed = true;
+        }
+    }
 
-    if (c.has_value()) {
-        rx_queue_.push(static_cast<uint8_t>(*c));
-        lsr_ |= LSR_DR;
+    if (changed)
         update_interrupt();
-    }
 }
 
 std::optional<uint64_t> NS16550::read_internal(addr_t offset, size_t size) {
@@ -75,10 +86,26 @@ std::optional<uint64_t> NS16550::read_internal(addr_t offset, size_t size) {
                 return val;
             }
             case IER: return (lcr_ & LCR_DLAB) ? dlm_ : ier_;
-            case IIR: return iir_ | IIR_TYPE_BITS;
+            case IIR: {
+                uint8_t val = iir_ | (fifo_enabled() ? IIR_TYPE_BITS : 0);
+                /* Reading IIR acknowledges a THRE interrupt */
+                if ((iir_ & (IIR_ID | IIR_NO_INT)) == IIR_THRI) {
+                    thr_ipending_ = false;
+                    update_interrupt();
+                }
+                return val;
+            }
             case LCR: return lcr_;
             case MCR: return mcr_;
-            case LSR: return lsr_;
+            case LSR: {
+                uint8_t val = lsr_;
+                /* Error bits are cleared on read */
+                if (lsr_ & LSR_BRK_ERROR_BITS) {
+                    lsr_ &= ~(LSR_BRK_ERROR_BITS | LSR_FIFOE);
+                    update_interrupt();
+                }
+                return val;
+            }
             case MSR: return msr_;
             case SCR: return scr_;
             default: return std::nullopt;
@@ -112,10 +139,8 @@ bool NS16550::write_internal(addr_t offset, size_t size, uint64_t value) {
 
                 /* Loopback mode */
                 if (mcr_ & MCR_LOOP) {
-                    if (rx_queue_.size() < QUEUE_SIZE) {
-                        rx_queue_.push(value);
-                        lsr_ |= LSR_DR;
-                    }
+                    rx_push(value);
+                    thr_ipending_ = true;
                     update_interrupt();
                     return true;
                 }
@@ -124,15 +149,20 @@ bool NS16550::write_internal(addr_t offset, size_t size, uint64_t value) {
                 update_interrupt();
                 return true;
             case IER:
-                if (!(lcr_ & LCR_DLAB))
+                if (!(lcr_ & LCR_DLAB)) {
+                    /* Enabling THRI with an empty THR fires immediately */
+                    if ((value & IER_THRI) && !(ier_ & IER_THRI) &&
+                        (lsr_ & LSR_THRE))
+                        thr_ipending_ = true;
                     ier_ = value & 0x0f;
-                else
+                } else {
                     dlm_ = value;
+                }
 
                 update_interrupt();
                 return true;
             case FCR:
-                fcr_ = value;
+                fifo_control_write(value);
                 update_interrupt();
                 return true;
             case LCR:
@@ -157,51 +187,86 @@ bool NS16550::write_internal(addr_t offset, size_t size, uint64_t value) {
     std::unreachable();
 }
 
-void NS16550::update_interrupt() {
-    uint8_t interrupts = 0;
-
-    /* Handle clear rx */
-    if (fcr_ & FCR_CLEAR_RCVR) {
-        fcr_ &= ~FCR_CLEAR_RCVR;
-
-        while (!rx_queue_.empty())
-            rx_queue_.pop();
+void NS16550::fifo_control_write(uint8_t val) {
+    /* Toggling the FIFO enable bit resets both FIFOs */
+    if ((val ^ fcr_) & FCR_ENABLE_FIFO)
+        val |= FCR_CLEAR_RCVR | FCR_CLEAR_XMIT;
 
+    if (val & FCR_CLEAR_RCVR) {
+        rx_queue_ = {};
         lsr_ &= ~LSR_DR;
+        timeout_ipending_ = false;
     }
 
-    /* Handle clear tx */
-    if (fcr_ & FCR_CLEAR_XMIT) {
-        fcr_ &= ~FCR_CLEAR_XMIT;
+    if (val & FCR_CLEAR_XMIT) {
+        tx_queue_ = {};
         lsr_ |= LSR_TEMT | LSR_THRE;
+        thr_ipending_ = true;
     }
 
-    /* Data ready and rcv interrupt enabled ? */
-    if ((ier_ & IER_RDI) && (lsr_ & LSR_DR))
-        interrupts |= IIR_RDI;
-
-    /* Transmitter empty and interrupt enabled ? */
-    if ((ier_ & IER_THRI) && (lsr_ & LSR_TEMT))
-        interrupts |= IIR_THRI;
-
-    /* Now update the interrup line, if necessary */
-    if (!interrupts) {
-        iir_ = IIR_NO_INT;
-        update_irq(false);
-    } else {
-        iir_ = interrupts;
-        update_irq(true);
+    /* Clear bits are self-clearing */
+    fcr_ = val & ~(FCR_CLEAR_RCVR | FCR_CLEAR_XMIT);
+}
+
+void NS16550::update_interrupt() {
+    uint8_t interrupts = IIR_NO_INT;
+
+    const bool rx_ready =
+        fifo_enabled() ? rx_queue_.size() >= rx_trigger_level()
+                       : !rx_queue_.empty();
+
+    /* Prioritized as on real hardware: RLS > RDA/CTI > THRE > MS */
+    if ((ier_ & IER_RLSI) && (lsr_ & LSR_BRK_ERROR_BITS))
+        interrupts = IIR_RLSI;
+    else if ((ier_ & IER_RDI) && timeout_ipending_)
+        interrupts = IIR_CTI;
+    else if ((ier_ & IER_RDI) && rx_ready)
+        interrupts = IIR_RDI;
+    else if ((ier_ & IER_THRI) && thr_ipending_)
+        interrupts = IIR_THRI;
+    else if ((ier_ & IER_MSI) && (msr_ & MSR_ANY_DELTA))
+        interrupts = IIR_MSI;
+
+    iir_ = interrupts;
+    update_irq(interrupts != IIR_NO_INT);
+}
+
+size_t NS16550::rx_trigger_level() const noexcept {
+    switch (fcr_ & FCR_TRIGGER_MASK) {
+        case FCR_TRIGGER_1: return 1;
+        case FCR_TRIGGER_4: return 4;
+        case FCR_TRIGGER_8: return 8;
+        default: return 14;
     }
+}
 
-    /*
-     * If the OS disabled the tx interrupt, we know that there is nothing
-     * more to transmit.
-     */
-    if (!(ier_ & IER_THRI))
-        lsr_ |= LSR_TEMT | LSR_THRE;
+std::chrono::nanoseconds NS16550::rx_timeout() const noexcept {
+    /* One character is 10 bits, each bit 16 clocks of the divided input */
+    uint64_t divisor = (static_cast<uint64_t>(dlm_) << 8) | dll_;
+    if (divisor == 0)
+        divisor = 1;
+
+    const uint64_t clocks = RX_TIMEOUT_CHARS * 10 * 16 * divisor;
+    return std::chrono::nanoseconds(clocks * 1'000'000'000 / CLOCK_FREQ);
+}
+
+void NS16550::rx_push(uint8_t val) {
+    rx_last_activity_ = std::chrono::steady_clock::now();
+    timeout_ipending_ = false;
+
+    if (rx_queue_.size() >= fifo_depth()) {
+        lsr_ |= LSR_OE;
+        return;
+    }
+
+    rx_queue_.push(val);
+    lsr_ |= LSR_DR;
 }
 
 uint8_t NS16550::rx_byte() {
+    rx_last_activity_ = std::chrono::steady_clock::now();
+    timeout_ipending_ = false;
+
     if (rx_queue_.empty()) {
         lsr_ &= ~LSR_DR;
         return 0;
@@ -222,10 +287,48 @@ uint8_t NS16550::rx_byte() {
 }
 
 void NS16550::tx_byte(uint8_t val) {
+    /* Writing THR acknowledges a THRE interrupt */
+    thr_ipending_ = false;
+
+    /* A guest that overruns THR without polling LSR loses nothing: the
+       queued bytes go out now, as if the line had kept up */
+    if (tx_queue_.size() >= fifo_depth())
+        tx_flush();
+
+    tx_queue_.push(val);
+    lsr_ &= ~(LSR_TEMT | LSR_THRE);
+}
+
+void NS16550::tx_flush() {
+    while (!tx_queue_.empty()) {
+        if (write_char) [[likely]]
+            write_char(tx_queue_.front());
+        tx_queue_.pop();
+    }
+}
+
+bool NS16550::tx_drain() {
+    if (tx_queue_.empty())
+        return false;
+
+    /* The whole FIFO goes out at once, raising a single THRE interrupt */
+    tx_flush();
     lsr_ |= LSR_TEMT | LSR_THRE;
+    thr_ipending_ = true;
+    return true;
+}
+
+void NS16550::emit_dt(DtContext& ctx) const {
+    utils::Fdt::Node& node = add_soc_node(ctx, "uart");
+    const std::string path = "/soc/" + node.name;
+
+    node.set_string("compatible", "ns16550a");
+    node.set_u32("clock-frequency", CLOCK_FREQ);
+    node.set_u32("reg-shift", reg_shift_);
+    node.set_u32("reg-io-width", reg_io_width_);
+    set_dt_interrupt(node, ctx);
 
-    if (write_char) [[likely]]
-        write_char(val);
+    ctx.root.child("chosen").set_string("stdout-path", path);
 }
 
 } // namespace uemu::device
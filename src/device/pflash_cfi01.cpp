@@ -14,10 +14,13 @@
  * limitations under the License.
  */
 
+#include <array>
+#include <format>
 #include <fstream>
 
 #include "common/bit.hpp"
 #include "device/pflash_cfi01.hpp"
+#include "utils/device_tree.hpp"
 
 namespace uemu::device {
 
@@ -372,4 +375,29 @@ void PFlashCFI01::blk_write_flush() {
 
 void PFlashCFI01::blk_write_abort() { blk_offset_ = -1; }
 
+void PFlashCFI01::emit_dt(DtContext& ctx) const {
+    const std::array<uint32_t, 4> reg = {
+        static_cast<uint32_t>(start_ >> 32), static_cast<uint32_t>(start_),
+        static_cast<uint32_t>(total_size_ >> 32),
+        static_cast<uint32_t>(total_size_)};
+
+    // Banks are described as one physmap node with several reg entries,
+    // which Linux concatenates into a single MTD device.
+    for (utils::Fdt::Node& node : ctx.root.children) {
+        const utils::Fdt::Property* compat = node.find_prop("compatible");
+        if (compat && compat->value.size() > 0 &&
+            std::string_view(reinterpret_cast<const char*>(
+                compat->value.data())) == "cfi-flash") {
+            node.append_cells("reg", reg);
+            return;
+        }
+    }
+
+    utils::Fdt::Node& node =
+        ctx.root.child(std::format("flash@{:x}", start_));
+    node.set_u32("bank-width", bank_width_);
+    node.set_cells("reg", reg);
+    node.set_string("compatible", "cfi-flash");
+}
+
 } // namespace uemu::device
@@ -23,46 +23,45 @@
  * https://opensource.org/licenses/BSD-3-Clause
  */
 
+#include <bit>
+
 #include "device/plic.hpp"
+#include "utils/device_tree.hpp"
 
 namespace uemu::device {
 
 Plic::Plic(std::shared_ptr<core::Hart> hart, uint32_t ndev)
     : Device("PLIC", DEFAULT_BASE, SIZE), hart_(std::move(hart)),
       num_ids_(ndev + 1), num_ids_word_(((ndev + 1) + (32 - 1)) / 32),
-      max_prio_((1u << PRIO_BITS) - 1), priority_{}, level_{} {
-    contexts_.emplace_back(hart_.get(), true);
-    contexts_.emplace_back(hart_.get(), false);
+      max_prio_((1u << PRIO_BITS) - 1), priority_{}, pending_{}, claimed_{} {
+    contexts_.push_back(std::make_unique<Context>(hart_.get(), true));
+    contexts_.push_back(std::make_unique<Context>(hart_.get(), false));
 }
 
 void Plic::set_interrupt_level(uint32_t id, bool lvl) {
     if (id <= 0 || num_ids_ <= id)
         return;
 
-    uint8_t id_prio = priority_[id];
     uint32_t id_word = id / 32;
-    uint32_t id_mask = 1 << (id % 32);
-
-    std::scoped_lock lock(plic_mutex_);
-
-    if (lvl)
-        level_[id_word] |= id_mask;
-    else
-        level_[id_word] &= ~id_mask;
-
-    for (auto& c : contexts_) {
-        if (c.enable[id_word] & id_mask) {
-            if (lvl) {
-                c.pending[id_word] |= id_mask;
-                c.pending_priority[id] = id_prio;
-            } else {
-                c.pending[id_word] &= ~id_mask;
-                c.pending_priority[id] = 0;
-                c.claimed[id_word] &= ~id_mask;
-            }
-            context_update(&c);
-            break;
-        }
+    uint32_t id_mask = 1u << (id % 32);
+
+    if (lvl) {
+        uint32_t old = pending_[id_word].fetch_or(id_mask);
+        if (old & id_mask)
+            return;
+
+        for (auto& c : contexts_)
+            if (c->enable[id_word].load(std::memory_order_relaxed) & id_mask)
+                context_raise(c.get(), id);
+    } else {
+        uint32_t old = pending_[id_word].fetch_and(~id_mask);
+        claimed_[id_word].fetch_and(~id_mask);
+        if (!(old & id_mask))
+            return;
+
+        for (auto& c : contexts_)
+            if (c->best_id.load() == id)
+                context_update(c.get());
     }
 }
 
@@ -84,8 +83,6 @@ std::optional<uint64_t> Plic::read_internal(addr_t offset, size_t size) {
     if (size != 4)
         return std::nullopt;
 
-    std::scoped_lock lock(plic_mutex_);
-
     if (PRIORITY_BASE <= offset && offset < PENDING_BASE)
         return priority_read(offset);
 
@@ -96,14 +93,14 @@ std::optional<uint64_t> Plic::read_internal(addr_t offset, size_t size) {
         uint32_t cntx = (offset - ENABLE_BASE) / ENABLE_PER_HART;
         offset -= cntx * ENABLE_PER_HART + ENABLE_BASE;
         if (cntx < contexts_.size())
-            return context_enable_read(&contexts_[cntx], offset);
+            return context_enable_read(contexts_[cntx].get(), offset);
     }
 
     if (CONTEXT_BASE <= offset && offset < SIZE) {
         uint32_t cntx = (offset - CONTEXT_BASE) / CONTEXT_PER_HART;
         offset -= cntx * CONTEXT_PER_HART + CONTEXT_BASE;
         if (cntx < contexts_.size())
-            return context_read(&contexts_[cntx], offset);
+            return context_read(contexts_[cntx].get(), offset);
     }
 
     return std::nullopt;
@@ -117,8 +114,6 @@ bool Plic::write_internal(addr_t offset, size_t size, uint64_t value) {
     if (size != 4)
         return false;
 
-    std::scoped_lock lock(plic_mutex_);
-
     if (PRIORITY_BASE <= offset && offset < ENABLE_BASE) {
         priority_write(offset, value);
         return true;
@@ -129,7 +124,7 @@ bool Plic::write_internal(addr_t offset, size_t size, uint64_t value) {
         offset -= cntx * ENABLE_PER_HART + ENABLE_BASE;
 
         if (cntx < contexts_.size()) {
-            context_enable_write(&contexts_[cntx], offset, value);
+            context_enable_write(contexts_[cntx].get(), offset, value);
             return true;
         }
     }
@@ -139,64 +134,129 @@ bool Plic::write_internal(addr_t offset, size_t size, uint64_t value) {
         offset -= cntx * CONTEXT_PER_HART + CONTEXT_BASE;
 
         if (cntx < contexts_.size())
-            return context_write(&contexts_[cntx], offset, value);
+            return context_write(contexts_[cntx].get(), offset, value);
     }
 
     return false;
 }
 
+// Higher priority wins, ties go to the lower ID.
+bool Plic::id_better(uint32_t id, uint32_t than) const noexcept {
+    if (than == 0)
+        return true;
+
+    uint8_t prio = priority_[id].load(std::memory_order_relaxed);
+    uint8_t than_prio = priority_[than].load(std::memory_order_relaxed);
+
+    return prio > than_prio || (prio == than_prio && id < than);
+}
+
 uint32_t Plic::context_best_pending(const Context* ctx) const {
     uint8_t best_id_prio = 0;
     uint32_t best_id = 0;
 
     for (uint32_t i = 0; i < num_ids_word_; i++) {
-        if (!ctx->pending[i])
-            continue;
+        uint32_t bits = pending_[i].load() & ~claimed_[i].load() &
+                        ctx->enable[i].load(std::memory_order_relaxed);
 
-        for (uint32_t j = 0; j < 32; j++) {
-            uint32_t id = i * 32 + j;
+        while (bits) {
+            uint32_t id = i * 32 + std::countr_zero(bits);
+            bits &= bits - 1;
 
-            if (num_ids_ <= id || !(ctx->pending[i] & (1u << j)) ||
-                (ctx->claimed[i] & (1u << j)))
-                continue;
-
-            if (best_id == 0 || (best_id_prio < ctx->pending_priority[id])) {
+            uint8_t prio = priority_[id].load(std::memory_order_relaxed);
+            if (best_id == 0 || best_id_prio < prio) {
                 best_id = id;
-                best_id_prio = ctx->pending_priority[id];
+                best_id_prio = prio;
             }
         }
     }
 
-    if (best_id_prio <= ctx->priority_threshold)
+    if (best_id_prio <= ctx->priority_threshold.load())
         return 0;
 
     return best_id;
 }
 
-void Plic::context_update(const Context* ctx) {
-    uint32_t best_id = context_best_pending(ctx);
-    reg_t mask = ctx->mmode_ ? core::MIP::Field::MEIP : core::MIP::Field::SEIP;
+// Fast path for a newly pending source: only replaces the cached ID when the
+// new source beats it, no rescan needed.
+void Plic::context_raise(Context* ctx, uint32_t id) {
+    ctx->seq.fetch_add(1);
+
+    if (priority_[id].load(std::memory_order_relaxed) <=
+        ctx->priority_threshold.load())
+        return;
+
+    uint32_t best = ctx->best_id.load();
+    while (id_better(id, best)) {
+        if (ctx->best_id.compare_exchange_weak(best, id)) {
+            // Only a source that becomes the one to deliver starts the clock;
+            // a masked or outranked one must not restamp a waiting interrupt.
+            if (auto* latency = hart_->get_irq_latency()) [[unlikely]]
+                latency->asserted(std::countr_zero(ctx->eip_mask_));
+            break;
+        }
+    }
+
+    ctx->set_irq(ctx->best_id.load() != 0);
+}
+
+// Full rescan. Retried while another thread changed the inputs, so that a
+// stale result can never be the last one published. This is lock-free, not
+// wait-free: a device that keeps raising lines can keep a rescan retrying,
+// but only because that device's own updates keep completing.
+void Plic::context_update(Context* ctx) {
+    uint64_t seq = ctx->seq.fetch_add(1) + 1;
+
+    for (;;) {
+        uint32_t best_id = context_best_pending(ctx);
+        ctx->best_id.store(best_id);
+        ctx->set_irq(best_id != 0);
 
-    ctx->hart_->set_interrupt_pending(mask, best_id != 0);
+        uint64_t cur = ctx->seq.load();
+        if (cur == seq) [[likely]]
+            break;
+        seq = cur;
+    }
+}
+
+void Plic::update_all_contexts() {
+    for (auto& c : contexts_)
+        context_update(c.get());
 }
 
+// The cached ID is taken with one fetch_or on the claimed bitmap. That only
+// removes this ID from the candidates, so just the contexts that cached it
+// are rescanned. Losing a race against another context yields 0, which the
+// spec permits.
+//
+// The claim is lock-free but not wait-free, since it ends in the rescan
+// above. Leaving the rescan to writers and clearing best_id with one CAS
+// would be wait-free, but a source raised between the claim's scan and its
+// CAS, and not better than the claimed ID, would not be seen until the next
+// change: its EIP could be dropped.
 uint32_t Plic::context_claim(Context* ctx) {
-    uint32_t best_id = context_best_pending(ctx);
-    uint32_t best_id_word = best_id / 32;
-    uint32_t best_id_mask = (1u << (best_id % 32));
+    const uint32_t id = ctx->best_id.load();
 
-    if (best_id)
-        ctx->claimed[best_id_word] |= best_id_mask;
+    if (id == 0)
+        return 0;
 
-    context_update(ctx);
-    return best_id;
+    uint32_t id_word = id / 32;
+    uint32_t id_mask = 1u << (id % 32);
+
+    uint32_t old = claimed_[id_word].fetch_or(id_mask);
+
+    for (auto& c : contexts_)
+        if (c.get() == ctx || c->best_id.load() == id)
+            context_update(c.get());
+
+    return old & id_mask ? 0 : id;
 }
 
 uint32_t Plic::priority_read(reg_t offset) {
     uint32_t id = offset >> 2;
 
     if (id > 0 && id < num_ids_)
-        return priority_[id];
+        return priority_[id].load(std::memory_order_relaxed);
 
     return 0;
 }
@@ -206,26 +266,25 @@ void Plic::priority_write(reg_t offset, uint32_t val) {
 
     if (id > 0 && id < num_ids_) {
         val &= (1u << PRIO_BITS) - 1;
-        priority_[id] = val;
+        priority_[id].store(val, std::memory_order_relaxed);
+        update_all_contexts();
     }
 }
 
 uint32_t Plic::pending_read(reg_t offset) {
-    uint32_t val = 0;
     uint32_t id_word = offset >> 2;
 
     if (id_word < num_ids_word_)
-        for (auto& c : contexts_)
-            val |= c.pending[id_word];
+        return pending_[id_word].load() & ~claimed_[id_word].load();
 
-    return val;
+    return 0;
 }
 
 uint32_t Plic::context_enable_read(const Context* ctx, reg_t offset) const {
     uint32_t id_word = offset >> 2;
 
     if (id_word < num_ids_word_)
-        return ctx->enable[id_word];
+        return ctx->enable[id_word].load(std::memory_order_relaxed);
 
     return 0;
 }
@@ -236,70 +295,63 @@ void Plic::context_enable_write(Context* ctx, reg_t offset, uint32_t val) {
     if (id_word >= num_ids_word_)
         return;
 
-    uint32_t old_val = ctx->enable[id_word];
     uint32_t new_val = id_word == 0 ? val & ~static_cast<uint32_t>(1) : val;
 
-    ctx->enable[id_word] = new_val;
-
-    for (uint32_t i = 0; i < 32; i++) {
-        uint32_t id = id_word * 32 + i;
-        uint32_t id_mask = 1u << i;
-        uint8_t id_prio = priority_[id];
-
-        if (!((old_val ^ new_val) & id_mask))
-            continue;
-
-        if ((new_val & id_mask) && (level_[id_word] & id_mask)) {
-            ctx->pending[id_word] |= id_mask;
-            ctx->pending_priority[id] = id_prio;
-        } else if (!(new_val & id_mask)) {
-            ctx->pending[id_word] &= ~id_mask;
-            ctx->pending_priority[id] = 0;
-            ctx->claimed[id_word] &= ~id_mask;
-        }
-    }
-
+    ctx->enable[id_word].store(new_val, std::memory_order_relaxed);
     context_update(ctx);
 }
 
 uint32_t Plic::context_read(Context* ctx, reg_t offset) {
     switch (offset) {
-        case CONTEXT_THRESHOLD: return ctx->priority_threshold;
+        case CONTEXT_THRESHOLD: return ctx->priority_threshold.load();
         case CONTEXT_CLAIM: return context_claim(ctx);
         default: return 0;
     };
 }
 
 bool Plic::context_write(Context* ctx, reg_t offset, uint32_t val) {
-    bool update = false;
-    bool ret = true;
-
     switch (offset) {
         case CONTEXT_THRESHOLD:
             val &= ((1 << PRIO_BITS) - 1);
-            if (val <= max_prio_) {
-                ctx->priority_threshold = val;
-                update = true;
-            } else {
-                ret = false;
-            }
-            break;
+            if (val > max_prio_)
+                return false;
+            ctx->priority_threshold.store(val);
+            context_update(ctx);
+            return true;
         case CONTEXT_CLAIM: {
             uint32_t id_word = val / 32;
             uint32_t id_mask = 1u << (val % 32);
-            if (val < num_ids_ && (ctx->enable[id_word] & id_mask)) {
-                ctx->claimed[id_word] &= ~id_mask;
-                update = true;
+            if (val < num_ids_ &&
+                (ctx->enable[id_word].load(std::memory_order_relaxed) &
+                 id_mask)) {
+                claimed_[id_word].fetch_and(~id_mask);
+                update_all_contexts();
             }
-            break;
+            return true;
         }
-        default: ret = false; break;
+        default: return false;
     }
+}
 
-    if (update)
-        context_update(ctx);
-
-    return ret;
+void Plic::emit_dt(DtContext& ctx) const {
+    const uint32_t phandle = ctx.alloc_phandle();
+    utils::Fdt::Node& node = add_soc_node(ctx, "interrupt-controller");
+
+    node.set_u32("phandle", phandle);
+    node.set_string("compatible", "riscv,plic0");
+    node.set_u32("riscv,ndev", num_ids_ - 1);
+    node.set_empty("interrupt-controller");
+    node.set_u32("#interrupt-cells", 1);
+    node.set_u32("#address-cells", 0);
+
+    // One M-mode and one S-mode context per hart
+    std::vector<uint32_t> cells;
+    for (uint32_t intc : ctx.cpu_intc)
+        cells.insert(cells.end(), {intc, 11, intc, 9});
+    node.set_cells("interrupts-extended", cells);
+
+    ctx.irq_parent = phandle;
+    ctx.irq_cells = 1;
 }
 
 } // namespace uemu::device
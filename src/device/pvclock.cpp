@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+#include "device/pvclock.hpp"
+
+namespace uemu::device {
+
+PvClock::PvClock(std::shared_ptr<core::Dram> dram,
+                 std::shared_ptr<Clint> clint)
+    : Device("PvClock", DEFAULT_BASE, SIZE), dram_(std::move(dram)),
+      clint_(std::move(clint)), system_time_msr_(0), version_(0), mul_(0),
+      shift_(0), last_update_(std::chrono::steady_clock::now()) {
+    // ns per tick as 64.64 fixed point, then normalized so that
+    // mul * 2^shift / 2^32 == ratio / 2^64 with mul in [2^31, 2^32).
+    const __uint128_t ratio =
+        (static_cast<__uint128_t>(Clint::NS_PER_SEC) << 64) /
+        clint_->get_freq();
+    const auto hi = static_cast<uint64_t>(ratio >> 64);
+    const auto lo = static_cast<uint64_t>(ratio);
+    const int width = hi ? 64 + std::bit_width(hi) : std::bit_width(lo);
+    const int shift = std::clamp(width - 64, -31, 31);
+
+    mul_ = static_cast<uint32_t>(
+        std::min<__uint128_t>(ratio >> (32 + shift), UINT32_MAX));
+    shift_ = static_cast<int8_t>(shift);
+}
+
+void PvClock::tick() {
+    auto now = std::chrono::steady_clock::now();
+
+    std::scoped_lock lock(pvclock_mutex_);
+
+    if (now - last_update_ < UPDATE_INTERVAL)
+        return;
+
+    last_update_ = now;
+
+    if (system_time_msr_ & SYSTEM_TIME_ENABLE)
+        publish();
+}
+
+std::optional<uint64_t> PvClock::read_internal(addr_t offset, size_t size) {
+    if (size != 4 && size != 8) [[unlikely]]
+        return std::nullopt;
+
+    std::scoped_lock lock(pvclock_mutex_);
+    uint64_t result = 0;
+
+    if (offset == MAGIC && size == 4)
+        return MAGIC_VALUE;
+
+    if (offset >= SYSTEM_TIME && offset + size <= SYSTEM_TIME + 8) {
+        read_little_endian(&system_time_msr_, offset - SYSTEM_TIME, size,
+                           &result);
+        return result;
+    }
+
+    return std::nullopt;
+}
+
+bool PvClock::write_internal(addr_t offset, size_t size, uint64_t value) {
+    if (size != 4 && size != 8) [[unlikely]]
+        return false;
+
+    if (offset < SYSTEM_TIME || offset + size > SYSTEM_TIME + 8)
+        return false;
+
+    std::scoped_lock lock(pvclock_mutex_);
+
+    write_little_endian(&system_time_msr_, offset - SYSTEM_TIME, size, value);
+
+    addr_t gpa = system_time_msr_ & ~SYSTEM_TIME_ENABLE;
+    if ((gpa % alignof(PvClockInfo)) ||
+        !dram_->is_valid_addr(gpa, sizeof(PvClockInfo)))
+        system_time_msr_ &= ~SYSTEM_TIME_ENABLE;
+
+    if (system_time_msr_ & SYSTEM_TIME_ENABLE)
+        publish();
+
+    return true;
+}
+
+// Seqlock publication: odd version while the structure is being updated.
+void PvClock::publish() {
+    const addr_t gpa = system_time_msr_ & ~SYSTEM_TIME_ENABLE;
+
+    // The scale is rounded down, so the old tuple extrapolates to at most
+    // the exact time here: rebasing never goes backwards.
+    const uint64_t mtime = clint_->get_mtime();
+    const auto ns = static_cast<uint64_t>(static_cast<__uint128_t>(mtime) *
+                                          Clint::NS_PER_SEC /
+                                          clint_->get_freq());
+
+    version_ = (version_ + 1) | 1;
+    dram_->write<uint32_t>(gpa + offsetof(PvClockInfo, version), version_);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    dram_->write<uint64_t>(gpa + offsetof(PvClockInfo, cycle_timestamp),
+                           mtime);
+    dram_->write<uint64_t>(gpa + offsetof(PvClockInfo, system_time), ns);
+    dram_->write<uint32_t>(gpa + offsetof(PvClockInfo, cycle_to_system_mul),
+                           mul_);
+    dram_->write<int8_t>(gpa + offsetof(PvClockInfo, cycle_shift), shift_);
+    dram_->write<uint8_t>(gpa + offsetof(PvClockInfo, flags), FLAG_STABLE);
+
+    std::atomic_thread_fence(std::memory_order_release);
+    version_++;
+    dram_->write<uint32_t>(gpa + offsetof(PvClockInfo, version), version_);
+}
+
+} // namespace uemu::device
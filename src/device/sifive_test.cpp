@@ -15,6 +15,7 @@
  */
 
 #include "device/sifive_test.hpp"
+#include "utils/device_tree.hpp"
 
 namespace uemu::device {
 
@@ -43,4 +44,23 @@ bool SiFiveTest::write_internal(addr_t offset, [[maybe_unused]] size_t size,
     return true;
 }
 
+void SiFiveTest::emit_dt(DtContext& ctx) const {
+    const uint32_t phandle = ctx.alloc_phandle();
+    utils::Fdt::Node& node = add_soc_node(ctx, "sifive_test");
+    node.set_u32("phandle", phandle);
+    node.set_strings("compatible", {"sifive,test1", "sifive,test0", "syscon"});
+
+    const auto add_syscon = [&](std::string_view name, std::string_view compat,
+                                Status value) -> void {
+        utils::Fdt::Node& n = ctx.root.child(name);
+        n.set_u32("value", static_cast<uint32_t>(value));
+        n.set_u32("offset", 0);
+        n.set_u32("regmap", phandle);
+        n.set_string("compatible", compat);
+    };
+
+    add_syscon("poweroff", "syscon-poweroff", PASS);
+    add_syscon("reboot", "syscon-reboot", RESET);
+}
+
 }; // namespace uemu::device
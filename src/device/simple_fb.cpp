@@ -14,7 +14,10 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include "device/simple_fb.hpp"
+#include "utils/device_tree.hpp"
 
 namespace uemu::device {
 
@@ -24,12 +27,8 @@ std::optional<uint64_t> SimpleFB::read_internal(addr_t offset, size_t size) {
 
     uint64_t v = 0;
 
-    {
-        std::scoped_lock lock(simple_fb_mutex_);
-
-        for (size_t i = 0; i < size; i++)
-            v |= static_cast<uint64_t>(vram_[offset + i]) << (8 * i);
-    }
+    for (size_t i = 0; i < size; i++)
+        v |= static_cast<uint64_t>(vram_[offset + i]) << (8 * i);
 
     return v;
 }
@@ -38,14 +37,69 @@ bool SimpleFB::write_internal(addr_t offset, size_t size, uint64_t value) {
     if (size > 8 || offset + size > SIZE) [[unlikely]]
         return false;
 
-    {
-        std::scoped_lock lock(simple_fb_mutex_);
+    for (size_t i = 0; i < size; i++)
+        vram_[offset + i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
 
-        for (size_t i = 0; i < size; i++)
-            vram_[offset + i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
-    }
+    // An access of at most 8 bytes can straddle two scanlines.
+    mark_dirty(offset / PITCH);
+    if ((offset + size - 1) / PITCH != offset / PITCH) [[unlikely]]
+        mark_dirty((offset + size - 1) / PITCH);
 
     return true;
 }
 
+void SimpleFB::take_dirty_spans(std::vector<DirtySpan>& spans) {
+    size_t run_start = 0;
+    size_t run_len = 0;
+
+    for (size_t w = 0; w < DIRTY_WORDS; w++) {
+        // Skip the RMW on clean words; the acquire exchange pairs with the
+        // release in mark_dirty().
+        uint64_t bits = 0;
+        if (dirty_rows_[w].load(std::memory_order_relaxed) != 0)
+            bits = dirty_rows_[w].exchange(0, std::memory_order_acquire);
+
+        // Fast path: whole word clean or whole word dirty
+        if (bits == 0 || bits == ~uint64_t{0}) {
+            if (bits == 0 && run_len) {
+                spans.push_back({run_start, run_len});
+                run_len = 0;
+            } else if (bits != 0) {
+                if (!run_len)
+                    run_start = w * 64;
+                run_len += 64;
+            }
+            continue;
+        }
+
+        for (size_t b = 0; b < 64; b++) {
+            if (bits & (uint64_t{1} << b)) {
+                if (!run_len)
+                    run_start = w * 64 + b;
+                run_len++;
+            } else if (run_len) {
+                spans.push_back({run_start, run_len});
+                run_len = 0;
+            }
+        }
+    }
+
+    if (run_len) {
+        // The bitmap may carry padding bits past the last scanline.
+        run_len = std::min(run_len, DEFAULT_HEIGHT - run_start);
+        spans.push_back({run_start, run_len});
+    }
+}
+
+void SimpleFB::emit_dt(DtContext& ctx) const {
+    utils::Fdt::Node& node = add_soc_node(ctx, "frame-buffer");
+    node.set_string("compatible", "simple-framebuffer");
+    node.set_u32("width", DEFAULT_WIDTH);
+    node.set_u32("height", DEFAULT_HEIGHT);
+    node.set_u32("stride", PITCH);
+    node.set_string("format", "x8r8g8b8");
+    node.set_string("status", "okay");
+    node.set_string("linux,fb-type", "simple");
+}
+
 }; // namespace uemu::device
@@ -15,6 +15,7 @@
  */
 
 #include "device/virtio_blk.hpp"
+#include "utils/device_tree.hpp"
 
 #include <utility>
 
@@ -22,8 +23,9 @@ namespace uemu::device {
 
 VirtioBlk::VirtioBlk(std::shared_ptr<core::Dram> dram,
                      const std::filesystem::path& disk_path,
-                     IrqCallback irq_callback, uint32_t interrupt_id)
-    : IrqDevice("VirtIO-Block", DEFAULT_BASE, SIZE, std::move(irq_callback),
+                     IrqCallback irq_callback, uint32_t interrupt_id,
+                     addr_t base)
+    : IrqDevice("VirtIO-Block", base, SIZE, std::move(irq_callback),
                 interrupt_id),
       dram_(std::move(dram)), config_{}, disk_path_(disk_path) {
     config_.blk_size = DISK_BLK_SIZE;
@@ -482,4 +484,10 @@ bool VirtioBlk::write_internal(addr_t offset, size_t size, uint64_t value) {
     return true;
 }
 
+void VirtioBlk::emit_dt(DtContext& ctx) const {
+    utils::Fdt::Node& node = add_soc_node(ctx, "virtio_blk");
+    node.set_string("compatible", "virtio,mmio");
+    set_dt_interrupt(node, ctx);
+}
+
 } // namespace uemu::device
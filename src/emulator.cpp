@@ -14,19 +14,29 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <fstream>
 #include <print>
 
 #include "core/decoder.hpp"
+#include "core/htif.hpp"
+#include "core/linux_user.hpp"
 #include "core/mmu.hpp"
+#include "core/sbi.hpp"
+#include "device/aplic.hpp"
 #include "device/bcm2835_rng.hpp"
 #include "device/clint.hpp"
 #include "device/goldfish_battery.hpp"
 #include "device/goldfish_events.hpp"
 #include "device/goldfish_rtc.hpp"
+#include "device/imsic.hpp"
 #include "device/nemu_console.hpp"
 #include "device/ns16550.hpp"
 #include "device/pflash_cfi01.hpp"
 #include "device/plic.hpp"
+#include "device/pvclock.hpp"
 #include "device/sifive_test.hpp"
 #include "device/simple_fb.hpp"
 #include "device/test_intr_gen.hpp"
@@ -34,92 +44,185 @@
 #include "emulator.hpp"
 #include "ui/headless_backend.hpp"
 #include "ui/sdl3_backend.hpp"
+#include "utils/device_tree.hpp"
 #include "utils/elfloader.hpp"
 #include "utils/fileloader.hpp"
+#include "utils/mapped_file.hpp"
 
 namespace uemu {
 
-Emulator::Emulator(size_t dram_size, bool headless,
-                   const std::filesystem::path& disk,
-                   const std::filesystem::path& flash0_path,
-                   const std::filesystem::path& flash1_path) {
+Emulator::Emulator(size_t dram_size)
+    : Emulator(MachineConfig::profile(MachineConfig::Profile::Desktop,
+                                      dram_size)) {}
+
+Emulator::Emulator(const MachineConfig& machine, bool headless,
+                   unsigned ui_fps,
+                   std::optional<ui::FrameCapture::Options> capture,
+                   bool sbi) {
     auto hart = std::make_shared<core::Hart>();
-    auto dram = std::make_shared<core::Dram>(dram_size);
-    auto bus = std::make_shared<core::Bus>(dram);
+    auto dram = std::make_shared<core::Dram>(machine.dram_size);
+    auto bus = std::make_shared<core::Bus>(dram, machine.verbose);
     auto mmu = std::make_shared<core::MMU>(hart.get(), bus);
 
     hart->connect_mmu(mmu.get());
 
+    if (!machine.disk.empty() && !machine.virtio_blk.enabled)
+        throw std::runtime_error("This machine has no virtio-blk device");
+    if ((!machine.flash0.empty() || !machine.flash1.empty()) && !machine.flash)
+        throw std::runtime_error("This machine has no flash");
+
     // Clint
-    bus->add_device(std::make_shared<device::Clint>(hart));
+    auto clint = std::make_shared<device::Clint>(hart);
+    bus->add_device(clint);
 
     // TestIntrGen — Sail-style simple interrupt generator for ACT tests
-    bus->add_device(std::make_shared<device::TestIntrGen>(hart));
-
-    // Plic
-    auto plic = std::make_shared<device::Plic>(hart);
-    bus->add_device(plic);
-    auto request_irq = [plic](uint32_t id, bool lvl) -> void {
-        plic->set_interrupt_level(id, lvl);
-    };
+    if (machine.test_intr_gen)
+        bus->add_device(std::make_shared<device::TestIntrGen>(hart));
+
+    // Interrupt controller: either the wired PLIC, or AIA with an APLIC in
+    // MSI mode posting to the IMSIC interrupt files. Without one, device
+    // interrupt lines are left unconnected.
+    device::IrqDevice::IrqCallback request_irq = [](uint32_t, bool) -> void {};
+
+    irqchip_ = machine.irqchip;
+    if (machine.irqchip && machine.aia) {
+        bus->add_device(std::make_shared<device::Imsic>(hart, true));
+        bus->add_device(std::make_shared<device::Imsic>(hart, false));
+
+        auto aplic = std::make_shared<device::Aplic>(
+            [bus = bus.get()](addr_t addr, uint32_t data) -> void {
+                std::ignore = bus->write<uint32_t>(addr, data);
+            },
+            false, device::Imsic::DEFAULT_S_BASE);
+        bus->add_device(aplic);
+        request_irq = [aplic](uint32_t id, bool lvl) -> void {
+            aplic->set_interrupt_level(id, lvl);
+        };
+    } else if (machine.irqchip) {
+        auto plic = std::make_shared<device::Plic>(hart);
+        bus->add_device(plic);
+        request_irq = [plic](uint32_t id, bool lvl) -> void {
+            plic->set_interrupt_level(id, lvl);
+        };
+    }
 
     // SiFiveTest
-    bus->add_device(std::make_shared<device::SiFiveTest>(
-        [this](uint16_t code, device::SiFiveTest::Status status) -> void {
-            std::println("Emulator shutdown with code 0x{:x} and status 0x{:x}",
-                         code, static_cast<uint16_t>(status));
-            engine_->request_shutdown_from_guest(code,
-                                                 static_cast<uint16_t>(status));
-        }));
+    if (machine.sifive_test) {
+        bus->add_device(std::make_shared<device::SiFiveTest>(
+            [this](uint16_t code, device::SiFiveTest::Status status) -> void {
+                std::println(
+                    "Emulator shutdown with code 0x{:x} and status 0x{:x}",
+                    code, static_cast<uint16_t>(status));
+                engine_->request_shutdown_from_guest(
+                    code, static_cast<uint16_t>(status));
+            }));
+    }
 
     // NS16550 and host console
-    auto ns16550 = std::make_shared<device::NS16550>(request_irq);
-    bus->add_device(ns16550);
+    std::shared_ptr<device::NS16550> ns16550;
+    if (machine.uart.enabled) {
+        ns16550 = std::make_shared<device::NS16550>(
+            request_irq, machine.uart.irq, device::NS16550::DEFAULT_REG_SHIFT,
+            device::NS16550::DEFAULT_REG_IO_WIDTH, machine.uart.base);
+        bus->add_device(ns16550);
+    }
 
     // SimpleFB
-    auto simple_fb = std::make_shared<device::SimpleFB>();
-    bus->add_device(simple_fb);
+    std::shared_ptr<device::SimpleFB> simple_fb;
+    if (machine.simple_fb) {
+        simple_fb = std::make_shared<device::SimpleFB>();
+        bus->add_device(simple_fb);
+    }
 
     // VirtioBLK
-    if (!disk.empty())
-        bus->add_device(
-            std::make_shared<device::VirtioBlk>(dram, disk, request_irq));
+    if (!machine.disk.empty())
+        bus->add_device(std::make_shared<device::VirtioBlk>(
+            dram, machine.disk, request_irq, machine.virtio_blk.irq,
+            machine.virtio_blk.base));
 
     // pflash_cfi01
-    auto flash0 =
-        std::make_shared<device::PFlashCFI01>(0x20000000, 0x10000, 512);
-    auto flash1 =
-        std::make_shared<device::PFlashCFI01>(0x22000000, 0x10000, 512);
+    if (machine.flash) {
+        auto flash0 =
+            std::make_shared<device::PFlashCFI01>(0x20000000, 0x10000, 512);
+        auto flash1 =
+            std::make_shared<device::PFlashCFI01>(0x22000000, 0x10000, 512);
 
-    if (!flash0_path.empty())
-        flash0->load(flash0_path, 0);
-    if (!flash1_path.empty())
-        flash1->load(flash1_path, 0);
+        if (!machine.flash0.empty())
+            flash0->load(machine.flash0, 0);
+        if (!machine.flash1.empty())
+            flash1->load(machine.flash1, 0);
 
-    bus->add_device(flash0);
-    bus->add_device(flash1);
+        bus->add_device(flash0);
+        bus->add_device(flash1);
+    }
 
     // GoldfishEvents
-    auto goldfish_events =
-        std::make_shared<device::GoldfishEvents>(request_irq);
-    bus->add_device(goldfish_events);
+    std::shared_ptr<device::GoldfishEvents> goldfish_events;
+    if (machine.events.enabled) {
+        goldfish_events = std::make_shared<device::GoldfishEvents>(
+            request_irq, machine.events.irq, "qwerty2", machine.events.base);
+        bus->add_device(goldfish_events);
+    }
 
     // GoldfishRTC
-    bus->add_device(std::make_shared<device::GoldfishRTC>(request_irq));
+    if (machine.rtc.enabled)
+        bus->add_device(std::make_shared<device::GoldfishRTC>(
+            request_irq, machine.rtc.irq, machine.rtc.base));
 
     // GoldfishBattery
-    bus->add_device(std::make_shared<device::GoldfishBattery>(request_irq));
+    if (machine.battery.enabled)
+        bus->add_device(std::make_shared<device::GoldfishBattery>(
+            request_irq, machine.battery.irq, 96, machine.battery.base));
+
+    // PvClock
+    if (machine.pvclock)
+        bus->add_device(std::make_shared<device::PvClock>(dram, clint));
 
     // BCM2835Rng
-    bus->add_device(std::make_shared<device::BCM2835Rng>());
+    if (machine.rng.enabled)
+        bus->add_device(std::make_shared<device::BCM2835Rng>(machine.rng.base));
 
     // NemuConsole
-    bus->add_device(std::make_shared<device::NemuConsole>());
+    if (machine.nemu_console)
+        bus->add_device(std::make_shared<device::NemuConsole>());
 
     // ExecutionEngine
     engine_ = std::make_unique<ExecutionEngine>(hart, dram, bus, mmu);
 
-    // UI backend
+    // Built-in SBI: S-mode ecalls no longer reach M-mode firmware
+    if (sbi) {
+        sbi_ = std::make_unique<core::Sbi>(
+            *hart, *mmu, *bus, *clint,
+            core::Sbi::Console{
+                .write_char = [ns16550](char ch) -> void {
+                    if (!ns16550)
+                        std::putchar(ch);
+                    else if (ns16550->write_char)
+                        ns16550->write_char(ch);
+                },
+                .read_char = [ns16550]() -> std::optional<char> {
+                    if (ns16550 && ns16550->read_char)
+                        return ns16550->read_char();
+                    return std::nullopt;
+                },
+            },
+            [this](uint32_t type, uint32_t reason) -> void {
+                using Status = device::SiFiveTest::Status;
+
+                Status status = Status::RESET;
+                if (type == core::Sbi::RESET_SHUTDOWN)
+                    status = reason == core::Sbi::RESET_REASON_NONE
+                                 ? Status::PASS
+                                 : Status::FAIL;
+
+                std::println("SBI system reset: type {} reason {}", type,
+                             reason);
+                engine_->request_shutdown_from_guest(
+                    static_cast<uint16_t>(reason), status);
+            });
+    }
+
+    // UI backend. A machine without a framebuffer has nothing to show.
     ui::UIBackend::Endpoints endpoints{
         .console_endpoint = ns16550,
         .input_sink = goldfish_events,
@@ -128,27 +231,379 @@ Emulator::Emulator(size_t dram_size, bool headless,
             engine_->request_shutdown_from_host();
         },
     };
-    std::shared_ptr<ui::UIBackend> ui_backend;
-
-    if (headless)
-        ui_backend = std::make_shared<ui::HeadlessBackend>(endpoints);
+    if (headless || !simple_fb)
+        ui_backend_ = std::make_shared<ui::HeadlessBackend>(endpoints,
+                                                            std::move(capture));
     else
-        ui_backend = std::make_shared<ui::SDL3Backend>(endpoints);
+        ui_backend_ = std::make_shared<ui::SDL3Backend>(endpoints, ui_fps);
 
-    engine_->set_ui_backend(ui_backend);
+    engine_->set_ui_backend(ui_backend_);
 }
 
 void Emulator::run(std::chrono::milliseconds timeout) {
     engine_->execute_until_halt(timeout);
+    ui_result_ = ui_backend_->finish();
+
+    if (stats_)
+        stats_->finish();
+
+    if (mmio_profiler_) {
+        std::ofstream out(mmio_profile_path_);
+        if (!out)
+            throw std::runtime_error("Failed to open MMIO profile output: " +
+                                     mmio_profile_path_.string());
+        mmio_profiler_->report(out);
+    }
+
+    if (irq_latency_) {
+        std::ofstream out(irq_latency_path_);
+        if (!out)
+            throw std::runtime_error("Failed to open IRQ latency output: " +
+                                     irq_latency_path_.string());
+        irq_latency_->report(out);
+    }
+
+    if (regions_) {
+        std::ofstream out(regions_path_);
+        if (!out)
+            throw std::runtime_error("Failed to open region output: " +
+                                     regions_path_.string());
+        out << regions_->json();
+    }
+
+    if (tracer_) {
+        tracer_->finish();
+        std::println(stderr, "Tracer: {} bytes", tracer_->bytes());
+    }
+
+    if (coverage_) {
+        coverage_->finish();
+        std::println(stderr, "Coverage: {} basic blocks", coverage_->blocks());
+    }
+
+    if (bbv_) {
+        bbv_->finish();
+        std::println(stderr, "BBV: {} intervals, {} basic blocks",
+                     bbv_->intervals(), bbv_->blocks());
+    }
+
+    if (sampler_) {
+        sampler_->finish(symbols_);
+        std::println(stderr, "Profiler: {} samples, {} dropped",
+                     sampler_->samples(), sampler_->dropped());
+
+        const profile::Sampler::Breakdown& b = sampler_->breakdown();
+        const double total =
+            static_cast<double>(std::max<uint64_t>(sampler_->samples(), 1));
+        const auto share = [total](uint64_t n) -> double {
+            return 100.0 * static_cast<double>(n) / total;
+        };
+
+        std::println(stderr, "  firmware {:5.1f}%", share(b.firmware));
+        std::println(stderr, "  kernel   {:5.1f}%", share(b.kernel));
+        std::println(stderr, "  user     {:5.1f}%", share(b.user));
+        for (const auto& [name, n] : b.processes)
+            std::println(stderr, "    {:<32} {:5.1f}%", name, share(n));
+    }
 }
 
-void Emulator::loadelf(const std::filesystem::path& path) {
-    addr_t pc = utils::ElfLoader::load(path, engine_->get_dram());
+void Emulator::enable_profiler(profile::Sampler::Options opts) {
+    core::Hart& hart = engine_->get_hart();
 
-    engine_->get_hart().pc = pc;
+    sampler_ = std::make_shared<profile::Sampler>(
+        hart, *hart.mmu, engine_->get_dram(), std::move(opts));
+    engine_->set_sampler(sampler_);
+}
+
+void Emulator::enable_tracer(profile::Tracer::Options opts) {
+    tracer_ = std::make_shared<profile::Tracer>(engine_->get_hart(),
+                                                std::move(opts));
+    engine_->set_tracer(tracer_);
+}
+
+void Emulator::enable_stats(profile::StatsReporter::Options opts) {
+    stats_ = std::make_unique<profile::StatsReporter>(
+        engine_->get_hart(), engine_->get_bus(), std::move(opts));
+}
+
+void Emulator::enable_mmio_profiler(const std::filesystem::path& output) {
+    mmio_profiler_ = std::make_unique<profile::MmioProfiler>();
+    mmio_profile_path_ = output;
+    engine_->get_bus().set_mmio_profiler(mmio_profiler_.get());
+}
+
+void Emulator::enable_irq_latency(const std::filesystem::path& output) {
+    core::Hart& hart = engine_->get_hart();
+    irq_latency_ =
+        std::make_unique<profile::IrqLatency>(hart.stats.instructions);
+    irq_latency_path_ = output;
+    hart.set_irq_latency(irq_latency_.get());
+}
+
+void Emulator::enable_regions(const std::filesystem::path& output) {
+    regions_ = std::make_unique<profile::RegionProfiler>(engine_->get_hart(),
+                                                         engine_->get_bus());
+    regions_path_ = output;
+    engine_->get_hart().set_region_profiler(regions_.get());
+}
+
+void Emulator::enable_bbv(profile::BbvProfiler::Options opts) {
+    bbv_ = std::make_shared<profile::BbvProfiler>(std::move(opts));
+    engine_->set_bbv(bbv_);
+}
+
+void Emulator::enable_coverage(profile::Coverage::Options opts) {
+    coverage_ = std::make_shared<profile::Coverage>(std::move(opts));
+    coverage_->add_module(program_.string(), program_base_, symbols_);
+    engine_->set_coverage(coverage_);
+}
+
+void Emulator::require_checkpointable(const char* what) const {
+    // The Linux personality and the SBI keep state on the host side.
+    if (linux_user_ || sbi_)
+        throw std::runtime_error(std::string(what) +
+                                 " needs a bare-metal program");
+    // A checkpoint holds no PLIC, APLIC or IMSIC state.
+    if (irqchip_)
+        throw std::runtime_error(std::string(what) +
+                                 " needs a machine without an irqchip");
+}
+
+void Emulator::save_simpoint_checkpoints(
+    const std::filesystem::path& simpoints, uint64_t interval,
+    uint64_t warmup, const std::filesystem::path& dir) {
+    require_checkpointable("Checkpointing");
+
+    std::ifstream in(simpoints);
+    if (!in)
+        throw std::runtime_error("Failed to open SimPoint file: " +
+                                 simpoints.string());
+
+    // One "<interval index> <cluster>" line per simulation point
+    auto plan = std::make_shared<CheckpointPlan>();
+    uint64_t index = 0;
+    uint64_t cluster = 0;
+    while (in >> index >> cluster)
+        plan->intervals.push_back(index);
+    if (plan->intervals.empty())
+        throw std::runtime_error("No simulation points in " +
+                                 simpoints.string());
+
+    std::ranges::sort(plan->intervals);
+    const auto dup = std::ranges::unique(plan->intervals);
+    plan->intervals.erase(dup.begin(), dup.end());
+    plan->length = interval;
+    plan->warmup = warmup;
+    plan->dir = dir;
+
+    std::filesystem::create_directories(dir);
+    schedule_checkpoint(std::move(plan), 0);
+}
+
+void Emulator::schedule_checkpoint(std::shared_ptr<const CheckpointPlan> plan,
+                                   size_t next) {
+    if (next == plan->intervals.size()) {
+        engine_->request_shutdown_from_guest(0,
+                                             device::SiFiveTest::Status::PASS);
+        return;
+    }
+
+    const uint64_t index = plan->intervals[next];
+    const uint64_t start = index * plan->length;
+    const uint64_t at = start - std::min(plan->warmup, start);
+
+    engine_->set_milestone(at, [this, plan, next, index, start] {
+        core::Hart& hart = engine_->get_hart();
+        // Later than planned when warm-up windows overlap
+        const uint64_t now = hart.stats.instructions.get();
+        const utils::Checkpoint::Slice slice{
+            .interval = index,
+            .warmup = start - std::min(now, start),
+            .length = plan->length,
+        };
+
+        const std::filesystem::path path =
+            plan->dir / std::format("simpoint-{}.ckpt", index);
+        utils::Checkpoint::save(path, hart, engine_->get_dram(),
+                                hart.get_clint(), slice);
+        std::println(stderr, "Checkpoint: {} at {} instructions",
+                     path.string(), now);
+
+        schedule_checkpoint(plan, next + 1);
+    });
+}
+
+void Emulator::restore_checkpoint(const std::filesystem::path& path) {
+    require_checkpointable("Restoring a checkpoint");
+
+    core::Hart& hart = engine_->get_hart();
+    const utils::Checkpoint::Slice slice = utils::Checkpoint::restore(
+        path, hart, engine_->get_dram(), hart.get_clint());
+    std::println("Checkpoint restored: {}", path.string());
+
+    if (slice.length == 0)
+        return;
+
+    std::println("  SimPoint {}: {} warm-up and {} measured instructions",
+                 slice.interval, slice.warmup, slice.length);
+
+    engine_->set_milestone(
+        hart.stats.instructions.get() + slice.warmup, [this, slice] {
+            // The statistics at exit cover the slice alone
+            restart_stats();
+            engine_->set_milestone(slice.length, [this] {
+                engine_->request_shutdown_from_guest(
+                    0, device::SiFiveTest::Status::PASS);
+            });
+        });
+}
+
+void Emulator::restart_stats() {
+    engine_->get_hart().stats = core::HartStats{};
+    for (const auto& dev : engine_->get_bus().devices())
+        dev->reset_mmio_counts();
+    if (stats_)
+        stats_->restart();
+    if (irq_latency_)
+        irq_latency_->restart();
+}
+
+std::string Emulator::stats_json() const {
+    if (stats_)
+        return stats_->json();
+    return profile::StatsReporter::json(engine_->get_hart(),
+                                        engine_->get_bus(), {});
+}
+
+void Emulator::loadelf(const std::filesystem::path& path,
+                       const std::vector<std::string>& args,
+                       bool map_segments) {
+    core::Dram& dram = engine_->get_dram();
+    utils::ElfLoader::Image image =
+        utils::ElfLoader::load(path, dram, map_segments);
+    const addr_t pc = image.entry;
+    symbols_ = std::move(image.symbols);
+    program_ = path;
+    program_base_ = image.load_base;
+
+    if (const auto tohost = symbols_.lookup("tohost")) {
+        const auto fromhost = symbols_.lookup("fromhost");
+
+        std::vector<std::string> argv{path.string()};
+        argv.insert(argv.end(), args.begin(), args.end());
+
+        htif_ = std::make_unique<core::Htif>(
+            engine_->get_bus(), dram, *tohost, fromhost, std::move(argv),
+            [this](uint16_t code) -> void {
+                using Status = device::SiFiveTest::Status;
+                engine_->request_shutdown_from_guest(
+                    code, code == 0 ? Status::PASS : Status::FAIL);
+            });
+        std::println("HTIF: tohost = 0x{:x}, fromhost = 0x{:x}", *tohost,
+                     fromhost.value_or(0));
+    }
+
+    const std::vector<uint8_t> blob = device_tree().serialize();
+    if (blob.size() > utils::LinuxLoader::MAX_FDT_SIZE)
+        throw std::runtime_error("Device tree does not fit in DRAM");
+
+    // Near the top of DRAM as for a kernel, or else right past an image
+    // that reaches there
+    const auto overlaps_image = [&](addr_t addr) -> bool {
+        return std::ranges::any_of(image.segments, [&](const auto& seg) {
+            return addr < seg.end && seg.start < addr + blob.size();
+        });
+    };
+    addr_t dtb_addr = utils::LinuxLoader::fdt_address(dram);
+    if (overlaps_image(dtb_addr)) {
+        addr_t image_end = 0;
+        for (const auto& seg : image.segments)
+            image_end = std::max(image_end, seg.end);
+        dtb_addr = (image_end + 0xFFF) & ~addr_t{0xFFF};
+        if (!dram.is_valid_addr(dtb_addr, blob.size()) ||
+            overlaps_image(dtb_addr))
+            throw std::runtime_error(
+                "No room for the device tree beside the ELF image");
+    }
+    dram.write_bytes(dtb_addr, blob.data(), blob.size());
+
+    core::Hart& hart = engine_->get_hart();
+    hart.gprs.write(10, 0);
+    hart.gprs.write(11, dtb_addr);
+    hart.pc = pc;
     std::println("ELF loaded: {}\n"
-                 "      entry PC = 0x{:016x}",
-                 path.string(), pc);
+                 "      entry PC = 0x{:016x}, dtb = 0x{:016x}",
+                 path.string(), pc, dtb_addr);
+}
+
+void Emulator::boot_linux(const utils::LinuxLoader::Options& opts,
+                          const std::filesystem::path& dtb) {
+    if (!sbi_)
+        throw std::runtime_error(
+            "Direct kernel boot requires the built-in SBI");
+
+    utils::Fdt fdt =
+        dtb.empty() ? device_tree()
+                    : utils::Fdt::parse(utils::FileLoader::read_file(dtb));
+    const auto info =
+        utils::LinuxLoader::load(opts, fdt, engine_->get_dram());
+
+    core::Hart& hart = engine_->get_hart();
+
+    // Do what M-mode firmware would have done before jumping to the kernel:
+    // delegate S-level traps and interrupts, and expose the counters.
+    using core::TrapCause;
+    constexpr auto bit = [](TrapCause cause) -> reg_t {
+        return reg_t{1} << static_cast<reg_t>(cause);
+    };
+    constexpr reg_t delegated_exceptions =
+        bit(TrapCause::InstructionAddressMisaligned) |
+        bit(TrapCause::InstructionAccessFault) |
+        bit(TrapCause::IllegalInstruction) | bit(TrapCause::Breakpoint) |
+        bit(TrapCause::LoadAddressMisaligned) |
+        bit(TrapCause::LoadAccessFault) |
+        bit(TrapCause::StoreAMOAddressMisaligned) |
+        bit(TrapCause::StoreAMOAccessFault) |
+        bit(TrapCause::EnvironmentCallFromU) |
+        bit(TrapCause::InstructionPageFault) |
+        bit(TrapCause::LoadPageFault) | bit(TrapCause::StoreAMOPageFault);
+
+    hart.csrs[core::MEDELEG::ADDRESS]->write_unchecked(delegated_exceptions);
+    hart.csrs[core::MIDELEG::ADDRESS]->write_unchecked(
+        core::MIDELEG::SSIP | core::MIDELEG::STIP | core::MIDELEG::SEIP);
+    hart.csrs[core::MCOUNTEREN::ADDRESS]->write_unchecked(
+        core::MCOUNTEREN::CY | core::MCOUNTEREN::TM | core::MCOUNTEREN::IR);
+
+    // Linux boot protocol: a0 = hartid, a1 = dtb, satp = 0
+    hart.gprs.write(10, 0);
+    hart.gprs.write(11, info.dtb_addr);
+    hart.pc = info.entry;
+    hart.priv = core::PrivilegeLevel::S;
+}
+
+void Emulator::load_user(const core::LinuxUser::Options& opts) {
+    core::Hart& hart = engine_->get_hart();
+
+    linux_user_ = std::make_unique<core::LinuxUser>(
+        hart, *hart.mmu, engine_->get_dram(), [this](int status) -> void {
+            using Status = device::SiFiveTest::Status;
+            engine_->request_shutdown_from_guest(
+                static_cast<uint16_t>(status),
+                status == 0 ? Status::PASS : Status::FAIL);
+        });
+    linux_user_->load(opts);
+}
+
+utils::Fdt Emulator::device_tree() {
+    const core::Hart& hart = engine_->get_hart();
+
+    return utils::DeviceTree::build(
+        engine_->get_bus(),
+        {.dram_size = engine_->get_dram().size(),
+         .num_harts = 1,
+         .misa = hart.csrs[core::MISA::ADDRESS]->read_unchecked(),
+         .timebase_frequency = device::Clint::DEFAULT_FREQ,
+         .bootargs = "root=/dev/vda rw earlycon=sbi"});
 }
 
 void Emulator::load(addr_t addr, const void* p, size_t n) {
@@ -162,10 +617,9 @@ void Emulator::load(addr_t addr, const void* p, size_t n) {
 }
 
 void Emulator::load(addr_t addr, const std::filesystem::path& path) {
-    auto data = utils::FileLoader::read_file(path);
-
-    if (!data.empty())
-        load(addr, data.data(), data.size());
+    const utils::MappedFile file(path);
+    if (file.size())
+        load(addr, file.data().data(), file.size());
 }
 
 } // namespace uemu
@@ -28,12 +28,16 @@ ExecutionEngine::ExecutionEngine(std::shared_ptr<core::Hart> hart,
       mcycle_(dynamic_cast<core::MCYCLE*>(
           hart_->csrs[core::MCYCLE::ADDRESS].get())),
       minstret_(dynamic_cast<core::MINSTRET*>(
-          hart_->csrs[core::MINSTRET::ADDRESS].get())) {
+          hart_->csrs[core::MINSTRET::ADDRESS].get())),
+      milestone_(UINT64_MAX) {
     shutdown_from_host_.store(false, std::memory_order::relaxed);
+    device_thread_running_.store(false, std::memory_order::relaxed);
     assert(mcycle_ && minstret_);
 }
 
 ExecutionEngine::~ExecutionEngine() {
+    stop_device_thread();
+
     if (cpu_thread_ && cpu_thread_->joinable()) {
         cpu_thread_->join();
         cpu_thread_.reset();
@@ -61,19 +65,35 @@ void ExecutionEngine::execute_until_halt(std::chrono::milliseconds timeout) {
 
     lock.unlock();
 
-    auto start_time = std::chrono::steady_clock::now();
-    bool timeout_enabled = timeout.count() > 0;
+    device_thread_running_.store(true, std::memory_order::relaxed);
+    device_thread_ =
+        std::make_unique<std::thread>(&ExecutionEngine::device_thread, this);
+
+    using clock = std::chrono::steady_clock;
 
+    const auto start_time = clock::now();
+    const bool timeout_enabled = timeout.count() > 0;
+    const std::chrono::microseconds frame_interval =
+        ui_backend_ ? ui_backend_->frame_interval()
+                    : std::chrono::milliseconds(10);
+    auto next_frame = start_time;
+
+    // The calling thread is the UI thread: it sleeps until the next frame
+    // (or until the CPU thread stops) and then lets the backend present.
     while (true) {
         {
-            std::scoped_lock lock(cpu_mutex_);
-            if (!cpu_thread_running_)
+            std::unique_lock<std::mutex> lock(cpu_mutex_);
+            if (cpu_cond_.wait_until(lock, next_frame, [this]() -> bool {
+                    return !cpu_thread_running_;
+                }))
                 break;
         }
 
+        const auto now = clock::now();
+
         // Check timeout
         if (timeout_enabled) {
-            auto elapsed = std::chrono::steady_clock::now() - start_time;
+            auto elapsed = now - start_time;
 
             if (elapsed >= timeout) {
                 request_shutdown_from_host();
@@ -84,16 +104,18 @@ void ExecutionEngine::execute_until_halt(std::chrono::milliseconds timeout) {
             }
         }
 
-        // Tick devices
-        bus_->tick_devices();
-
         // Update UI
         if (ui_backend_) [[likely]]
             ui_backend_->update();
 
-        std::this_thread::yield();
+        // Drop missed frames instead of bursting to catch up.
+        next_frame += frame_interval;
+        if (next_frame < now)
+            next_frame = now + frame_interval;
     }
 
+    stop_device_thread();
+
     if (cpu_thread_exception_)
         std::rethrow_exception(cpu_thread_exception_);
 }
@@ -109,6 +131,30 @@ void ExecutionEngine::request_shutdown_from_host() noexcept {
     shutdown_from_host_.store(true, std::memory_order::relaxed);
 }
 
+void ExecutionEngine::device_thread() {
+    while (device_thread_running_.load(std::memory_order::relaxed)) {
+        bus_->tick_devices();
+
+        if (ui_backend_) [[likely]]
+            ui_backend_->deliver_input();
+
+        std::this_thread::yield();
+    }
+}
+
+void ExecutionEngine::stop_device_thread() {
+    device_thread_running_.store(false, std::memory_order::relaxed);
+
+    if (device_thread_ && device_thread_->joinable()) {
+        device_thread_->join();
+        device_thread_.reset();
+
+        // Flush what the guest did last, e.g. UART output written just
+        // before it asked to shut down.
+        bus_->tick_devices();
+    }
+}
+
 void ExecutionEngine::cpu_thread() {
     {
         std::scoped_lock lock(cpu_mutex_);
@@ -126,7 +172,17 @@ void ExecutionEngine::cpu_thread() {
 
         mcycle_->advance();
 
+        if ((i & 0xFF) == 0 && sampler_) [[unlikely]]
+            sampler_->poll();
+
         try {
+            if (hart_->stats.instructions.get() >= milestone_) [[unlikely]] {
+                milestone_ = UINT64_MAX;
+                std::exchange(milestone_fn_, nullptr)();
+                if (shutdown_from_guest_)
+                    continue;
+            }
+
             // Normal execution
             if ((i & 0xFF) == 0 || hart_->interrupt_check_pending) [[unlikely]]
                 hart_->check_interrupts();
@@ -135,13 +191,36 @@ void ExecutionEngine::cpu_thread() {
             core::DecodedInsn decoded_insn =
                 core::Decoder::decode(insn, ilen, hart_->pc);
 
+            const addr_t pc = hart_->pc;
+            const core::PrivilegeLevel priv = hart_->priv;
             hart_->pc += static_cast<addr_t>(ilen);
             decoded_insn(*hart_, *mmu_);
             minstret_->advance();
+            hart_->stats.instructions.add();
+
+            if (tracer_ && hart_->pc != pc + static_cast<addr_t>(ilen))
+                [[unlikely]]
+                tracer_->branch(pc, hart_->pc);
+            if (bbv_) [[unlikely]]
+                bbv_->retire(pc, hart_->pc, static_cast<unsigned>(ilen));
+            if (coverage_) [[unlikely]]
+                coverage_->retire(pc, hart_->pc, static_cast<unsigned>(ilen),
+                                  priv);
         } catch (const core::WfiWait&) {
             // WFI: hart stalls until a locally-enabled interrupt becomes
             // pending (mip & mie != 0).
             minstret_->advance(); // WFI counts as retired
+            hart_->stats.instructions.add();
+
+            // WFI and the SBI suspend ecall are both 4 bytes, and pc is
+            // already past them.
+            const addr_t pc = hart_->pc - 4;
+            if (bbv_) [[unlikely]]
+                bbv_->retire(pc, hart_->pc, 4);
+            if (coverage_) [[unlikely]]
+                coverage_->retire(pc, hart_->pc, 4, hart_->priv);
+
+            const auto idle_start = std::chrono::steady_clock::now();
 
             while (true) {
                 if (shutdown_from_guest_) [[unlikely]]
@@ -158,15 +237,32 @@ void ExecutionEngine::cpu_thread() {
                         hart_->check_interrupts();
                     } catch (const core::Trap& trap) {
                         hart_->handle_trap(trap);
+                        if (tracer_) [[unlikely]]
+                            tracer_->trap(trap.pc, hart_->pc, trap.cause);
+                        if (bbv_) [[unlikely]]
+                            bbv_->trap();
+                        if (coverage_) [[unlikely]]
+                            coverage_->trap();
                         break;
                     }
 
                     break;
                 }
             }
+
+            hart_->stats.wfi_ns.add(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - idle_start)
+                    .count()));
         } catch (const core::Trap& trap) {
             // RISC-V Traps
             hart_->handle_trap(trap);
+            if (tracer_) [[unlikely]]
+                tracer_->trap(trap.pc, hart_->pc, trap.cause);
+            if (bbv_) [[unlikely]]
+                bbv_->trap();
+            if (coverage_) [[unlikely]]
+                coverage_->trap();
         } catch (...) {
             cpu_thread_exception_ = std::current_exception();
             shutdown_from_guest_ = true;
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdexcept>
+#include <string>
+
+#include "device/bcm2835_rng.hpp"
+#include "device/goldfish_battery.hpp"
+#include "device/goldfish_events.hpp"
+#include "device/goldfish_rtc.hpp"
+#include "device/ns16550.hpp"
+#include "device/virtio_blk.hpp"
+#include "machine_config.hpp"
+
+namespace uemu {
+
+MachineConfig MachineConfig::profile(Profile profile, size_t dram_size) {
+    MachineConfig cfg;
+    cfg.dram_size = dram_size;
+    cfg.sifive_test = true;
+    cfg.nemu_console = true;
+
+    if (profile == Profile::Minimal)
+        return cfg;
+
+    cfg.irqchip = true;
+    cfg.test_intr_gen = true;
+    cfg.uart = {.enabled = true,
+                .base = device::NS16550::DEFAULT_BASE,
+                .irq = device::NS16550::DEFAULT_INTERRUPT_ID};
+
+    if (profile == Profile::Test)
+        return cfg;
+
+    cfg.simple_fb = true;
+    cfg.pvclock = true;
+    cfg.flash = true;
+    cfg.virtio_blk = {.enabled = true,
+                      .base = device::VirtioBlk::DEFAULT_BASE,
+                      .irq = device::VirtioBlk::DEFAULT_INTERRUPT_ID};
+    cfg.rtc = {.enabled = true,
+               .base = device::GoldfishRTC::DEFAULT_BASE,
+               .irq = device::GoldfishRTC::DEFAULT_INTERRUPT_ID};
+    cfg.events = {.enabled = true,
+                  .base = device::GoldfishEvents::DEFAULT_BASE,
+                  .irq = device::GoldfishEvents::DEFAULT_INTERRUPT_ID};
+    cfg.battery = {.enabled = true,
+                   .base = device::GoldfishBattery::DEFAULT_BASE,
+                   .irq = device::GoldfishBattery::DEFAULT_INTERRUPT_ID};
+    cfg.rng = {
+        .enabled = true, .base = device::BCM2835Rng::DEFAULT_BASE, .irq = 0};
+
+    return cfg;
+}
+
+MachineConfig::Profile MachineConfig::parse_profile(std::string_view name) {
+    if (name == "minimal")
+        return Profile::Minimal;
+    if (name == "test")
+        return Profile::Test;
+    if (name == "desktop")
+        return Profile::Desktop;
+
+    throw std::invalid_argument("Unknown machine profile: " +
+                                std::string(name));
+}
+
+} // namespace uemu
@@ -16,14 +16,43 @@
 
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <iostream>
 #include <print>
 
+#include <unistd.h>
+
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 
 #include <CLI/CLI.hpp>
 
 #include "emulator.hpp"
+#include "profile/trace_decoder.hpp"
+#include "utils/mapped_file.hpp"
+
+namespace {
+
+int decode_trace(const std::filesystem::path& path,
+                 const std::vector<std::string>& images) {
+    uemu::profile::TraceDecoder decoder;
+
+    for (const std::string& image : images) {
+        if (const size_t at = image.rfind('@'); at != std::string::npos)
+            decoder.add_raw(image.substr(0, at),
+                            std::stoull(image.substr(at + 1), nullptr, 0));
+        else
+            decoder.add_elf(image);
+    }
+
+    const uemu::utils::MappedFile trace(path);
+    const auto stats = decoder.decode(trace.data(), std::cout);
+    std::println(stderr, "{} instructions, {} branches, {} traps, {} gaps",
+                 stats.instructions, stats.branches, stats.traps, stats.gaps);
+    return EXIT_SUCCESS;
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
     CLI::App app{"uemu-ng: RISC-V Emulator"};
@@ -33,14 +62,78 @@ int main(int argc, char* argv[]) {
     std::filesystem::path disk_file;
     std::filesystem::path flash0_file;
     std::filesystem::path flash1_file;
+    uemu::utils::LinuxLoader::Options linux_opts;
+    std::filesystem::path dtb_file;
+    std::filesystem::path dump_dtb_file;
     size_t dram_size_mb = 512;
     uint64_t timeout_ms = 0;
     bool headless = false;
+    bool aia = false;
+    bool sbi = false;
+    bool user_mode = false;
+    bool map_elf = false;
+    std::filesystem::path sysroot;
+    std::vector<std::string> guest_args;
+    std::string machine_profile = "desktop";
+    unsigned ui_fps = 60;
+    uemu::ui::FrameCapture::Options capture;
+    std::string capture_format = "png";
+    uemu::profile::Sampler::Options profile;
+    uemu::profile::Tracer::Options trace;
+    size_t trace_ring_kb = 0;
+    std::filesystem::path decode_trace_file;
+    std::vector<std::string> trace_images;
+    std::filesystem::path stats_file;
+    uint64_t stats_interval_ms = 0;
+    std::filesystem::path mmio_profile_file;
+    std::filesystem::path irq_latency_file;
+    std::filesystem::path regions_file;
+    uemu::profile::BbvProfiler::Options bbv;
+    std::filesystem::path simpoints_file;
+    std::filesystem::path checkpoint_dir = "checkpoints";
+    uint64_t warmup = 0;
+    std::filesystem::path restore_file;
+    std::filesystem::path coverage_file;
 
     // Configure command line options
-    app.add_option("-f,--file", elf_file, "ELF file to load")
-        ->required()
-        ->check(CLI::ExistingFile);
+    auto* file_opt = app.add_option("-f,--file", elf_file, "ELF file to load")
+                         ->check(CLI::ExistingFile);
+    auto* kernel_opt =
+        app.add_option("--kernel", linux_opts.kernel,
+                       "Linux Image to boot directly in S-mode (implies --sbi)")
+            ->check(CLI::ExistingFile)
+            ->excludes(file_opt);
+    app.add_option("--initrd", linux_opts.initrd, "Initrd for --kernel")
+        ->check(CLI::ExistingFile)
+        ->needs(kernel_opt);
+    app.add_option("--append", linux_opts.append,
+                   "Kernel command line for --kernel")
+        ->needs(kernel_opt);
+    app.add_option("--dtb", dtb_file,
+                   "Device tree blob for --kernel (default: generated)")
+        ->check(CLI::ExistingFile)
+        ->needs(kernel_opt);
+    app.add_option("--dump-dtb", dump_dtb_file,
+                   "Write the generated device tree blob to this file");
+    auto* user_opt =
+        app.add_flag("--user", user_mode,
+                     "Run --file as a riscv64 Linux executable, servicing its "
+                     "system calls on the host")
+            ->needs(file_opt);
+    app.add_option("--sysroot", sysroot,
+                   "Look up absolute guest paths (e.g. the ELF interpreter) "
+                   "here first")
+        ->check(CLI::ExistingDirectory)
+        ->needs(user_opt);
+    app.add_flag("--map-elf", map_elf,
+                 "Map --file segments copy-on-write instead of copying them; "
+                 "the file must not be rewritten while the emulator runs")
+        ->needs(file_opt)
+        ->excludes(user_opt);
+    app.add_option("args", guest_args,
+                   "Arguments passed to a --user program or to an HTIF one "
+                   "(e.g. riscv-pk)")
+        ->needs(file_opt);
     app.add_option("-m,--memory", dram_size_mb, "DRAM size in MB")
         ->default_val(512)
         ->check(CLI::Range(64, 16384));
@@ -50,26 +143,242 @@ int main(int argc, char* argv[]) {
     app.add_option("-t,--timeout", timeout_ms,
                    "Execution timeout in milliseconds (0 = no timeout)")
         ->default_val(0);
-    app.add_flag("--headless", headless, "Run in headless mode (no UI window)");
+    auto* headless_opt = app.add_flag("--headless", headless,
+                                      "Run in headless mode (no UI window)");
+    app.add_option("--fps", ui_fps,
+                   "UI frame rate (0 = follow the display with vsync)")
+        ->default_val(60)
+        ->check(CLI::Range(0, 240));
+    app.add_option("--machine", machine_profile,
+                   "Machine profile: which devices exist")
+        ->default_val("desktop")
+        ->check(CLI::IsMember({"minimal", "test", "desktop"}));
+    app.add_flag("--aia", aia,
+                 "Use AIA (APLIC in MSI mode + IMSIC) instead of the PLIC");
+    app.add_flag("--sbi", sbi,
+                 "Handle S-mode SBI calls in the emulator instead of M-mode "
+                 "firmware");
+    app.add_option("--capture-dir", capture.dir,
+                   "Dump every changed framebuffer frame into this directory")
+        ->needs(headless_opt);
+    app.add_option("--capture-format", capture_format,
+                   "Format of dumped frames")
+        ->default_val("png")
+        ->check(CLI::IsMember({"png", "raw"}));
+    app.add_option("--capture-fps", capture.fps,
+                   "Frame sampling rate (0 = every change)")
+        ->default_val(0)
+        ->check(CLI::Range(0, 100));
+    app.add_option("--capture-stream", capture.stream,
+                   "Write raw XRGB8888 frames to this file or FIFO")
+        ->needs(headless_opt);
+    app.add_option("--capture-golden", capture.golden,
+                   "Compare the final frame against this image and fail on "
+                   "mismatch")
+        ->needs(headless_opt)
+        ->check(CLI::ExistingFile);
+    app.add_option("--capture-tolerance", capture.tolerance,
+                   "Max per-channel difference for the golden compare")
+        ->default_val(0)
+        ->check(CLI::Range(0, 255));
+    app.add_option("--capture-max-mismatch", capture.max_mismatch,
+                   "Fraction of pixels allowed beyond the tolerance")
+        ->default_val(0.0)
+        ->check(CLI::Range(0.0, 1.0));
+    auto* profile_opt =
+        app.add_option("--profile", profile.output,
+                       "Sample guest call stacks and write them as folded "
+                       "stacks (flamegraph.pl, speedscope) to this file");
+    app.add_option("--profile-period", profile.period,
+                   "Sample every N instructions instead of on a host timer")
+        ->default_val(0)
+        ->needs(profile_opt);
+    app.add_option("--profile-freq", profile.frequency,
+                   "Host-timer samples per second")
+        ->default_val(1000)
+        ->check(CLI::Range(1, 100000))
+        ->needs(profile_opt);
+    app.add_option("--system-map", profile.system_map,
+                   "Kernel System.map used by --profile and --coverage")
+        ->check(CLI::ExistingFile);
+    app.add_option("--profile-comm-offset", profile.comm_offset,
+                   "offsetof(struct task_struct, comm) in the guest kernel, "
+                   "to name user processes after their tasks")
+        ->needs(profile_opt);
+    auto* trace_opt =
+        app.add_option("--trace", trace.output,
+                       "Record a control-flow trace to this file");
+    app.add_option("--trace-ring", trace_ring_kb,
+                   "Keep only the last N KiB of the trace (0 = all of it)")
+        ->default_val(0)
+        ->needs(trace_opt);
+    auto* decode_opt =
+        app.add_option("--decode-trace", decode_trace_file,
+                       "Print the instructions recorded in a --trace file "
+                       "and exit")
+            ->check(CLI::ExistingFile);
+    app.add_option("--trace-image", trace_images,
+                   "Code for --decode-trace: an ELF, or FILE@ADDR for a "
+                   "flat binary")
+        ->needs(decode_opt);
+    app.add_option("--stats", stats_file,
+                   "Write emulator statistics (MIPS, TLB, traps, MMIO) as "
+                   "JSON to this file at exit; SIGUSR1 dumps them anytime");
+    app.add_option("--stats-interval", stats_interval_ms,
+                   "Also write the statistics every N milliseconds")
+        ->default_val(0);
+    app.add_option("--mmio-profile", mmio_profile_file,
+                   "Time MMIO accesses per device register and write the "
+                   "hottest ones to this file");
+    app.add_option("--irq-latency", irq_latency_file,
+                   "Write interrupt and trap latency percentiles to this "
+                   "file");
+    app.add_option("--regions", regions_file,
+                   "Write per-region statistics for code the guest marks "
+                   "with CSRs 0x8c0/0x8c1 to this JSON file");
+    app.add_option("--bbv", bbv.output,
+                   "Write SimPoint basic-block vectors to this file");
+    app.add_option("--bbv-interval", bbv.interval,
+                   "Instructions per basic-block vector and SimPoint slice")
+        ->default_val(bbv.interval);
+    auto* simpoints_opt = app.add_option(
+        "--simpoints", simpoints_file,
+        "Checkpoint the intervals SimPoint picked in this file and exit");
+    app.add_option("--checkpoint-dir", checkpoint_dir,
+                   "Where --simpoints writes simpoint-<index>.ckpt")
+        ->default_val(checkpoint_dir);
+    app.add_option("--warmup", warmup,
+                   "Instructions to run before each SimPoint slice")
+        ->default_val(0);
+    app.add_option("--restore", restore_file,
+                   "Continue from a checkpoint of the --file program; a "
+                   "SimPoint slice stops after its interval")
+        ->excludes(simpoints_opt);
+    app.add_option("--coverage", coverage_file,
+                   "Write the guest basic blocks executed to this drcov file");
 
     try {
         // Parse command line
         CLI11_PARSE(app, argc, argv);
 
+        if (!decode_trace_file.empty())
+            return decode_trace(decode_trace_file, trace_images);
+
+        trace.ring_size = trace_ring_kb * 1024;
+        // Without --stats, the counters are still dumped to stderr on SIGUSR1.
+        const uemu::profile::StatsReporter::Options stats{
+            .output = stats_file,
+            .interval = std::chrono::milliseconds(stats_interval_ms),
+            .on_exit = !stats_file.empty() || stats_interval_ms > 0,
+        };
+        const bool direct_boot = !linux_opts.kernel.empty();
+
+        // Same for user mode and system emulation, once the guest is loaded
+        const auto enable_profiling = [&](uemu::Emulator& emulator) -> void {
+            if (!profile.output.empty())
+                emulator.enable_profiler(profile);
+            if (!trace.output.empty())
+                emulator.enable_tracer(trace);
+            emulator.enable_stats(stats);
+            if (!mmio_profile_file.empty())
+                emulator.enable_mmio_profiler(mmio_profile_file);
+            if (!irq_latency_file.empty())
+                emulator.enable_irq_latency(irq_latency_file);
+            if (!regions_file.empty())
+                emulator.enable_regions(regions_file);
+            if (!bbv.output.empty())
+                emulator.enable_bbv(bbv);
+            if (!coverage_file.empty())
+                emulator.enable_coverage({.output = coverage_file,
+                                          .system_map = profile.system_map});
+        };
+
+        if (elf_file.empty() && !direct_boot) {
+            std::println(stderr, "Either --file or --kernel is required");
+            return EXIT_FAILURE;
+        }
+
         size_t dram_size = dram_size_mb * 1024 * 1024;
 
+        // Only the program's own output belongs on stdout in user mode.
+        if (user_mode) {
+            uemu::core::LinuxUser::Options user_opts{
+                .exe = elf_file,
+                .argv = {elf_file.string()},
+                .envp = {},
+                .sysroot = sysroot,
+            };
+            user_opts.argv.insert(user_opts.argv.end(), guest_args.begin(),
+                                  guest_args.end());
+            for (char** env = environ; *env; env++)
+                user_opts.envp.emplace_back(*env);
+
+            uemu::MachineConfig machine = uemu::MachineConfig::profile(
+                uemu::MachineConfig::Profile::Minimal, dram_size);
+            machine.verbose = false;
+
+            uemu::Emulator emulator(machine);
+            emulator.load_user(user_opts);
+            enable_profiling(emulator);
+            if (!simpoints_file.empty() || !restore_file.empty())
+                throw std::runtime_error(
+                    "Checkpoints are not supported in user mode");
+            emulator.run(std::chrono::milliseconds(timeout_ms));
+            return emulator.shutdown_code();
+        }
+
         std::println("Initializing emulator...");
         std::println("  DRAM size: {} MB ({} bytes)", dram_size_mb, dram_size);
-        std::println("  ELF file: {}", elf_file.string());
+        std::println("  Machine: {}", machine_profile);
+        if (direct_boot)
+            std::println("  Kernel: {}", linux_opts.kernel.string());
+        else
+            std::println("  ELF file: {}", elf_file.string());
 
         if (timeout_ms > 0)
             std::println("  Timeout: {} ms", timeout_ms);
 
-        uemu::Emulator emulator(dram_size, headless, disk_file, flash0_file,
-                                flash1_file);
+        std::optional<uemu::ui::FrameCapture::Options> capture_opts;
+        if (!capture.dir.empty() || !capture.stream.empty() ||
+            !capture.golden.empty()) {
+            capture.format = capture_format == "raw"
+                                 ? uemu::ui::FrameCapture::Format::Raw
+                                 : uemu::ui::FrameCapture::Format::Png;
+            capture_opts = capture;
+        }
+
+        uemu::MachineConfig machine = uemu::MachineConfig::profile(
+            uemu::MachineConfig::parse_profile(machine_profile), dram_size);
+        machine.aia = aia;
+        machine.disk = disk_file;
+        machine.flash0 = flash0_file;
+        machine.flash1 = flash1_file;
 
-        emulator.loadelf(elf_file);
+        uemu::Emulator emulator(machine, headless, ui_fps, capture_opts,
+                                sbi || direct_boot);
+
+        if (!dump_dtb_file.empty()) {
+            const std::vector<uint8_t> blob =
+                emulator.device_tree().serialize();
+            std::ofstream(dump_dtb_file, std::ios::binary)
+                .write(reinterpret_cast<const char*>(blob.data()),
+                       static_cast<std::streamsize>(blob.size()));
+        }
+
+        if (direct_boot)
+            emulator.boot_linux(linux_opts, dtb_file);
+        else
+            emulator.loadelf(elf_file, guest_args, map_elf);
+        enable_profiling(emulator);
+        if (!simpoints_file.empty())
+            emulator.save_simpoint_checkpoints(simpoints_file, bbv.interval,
+                                               warmup, checkpoint_dir);
+        if (!restore_file.empty())
+            emulator.restore_checkpoint(restore_file);
         emulator.run(std::chrono::milliseconds(timeout_ms));
+
+        if (auto result = emulator.ui_result(); result && !*result)
+            return EXIT_FAILURE;
     } catch (const std::runtime_error& e) {
         std::println(stderr, "Runtime error: {}", e.what());
         return EXIT_FAILURE;
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+#include "profile/bbv.hpp"
+
+namespace uemu::profile {
+
+namespace {
+
+// Checked before the output is opened, which would truncate it.
+BbvProfiler::Options validate(BbvProfiler::Options opts) {
+    if (opts.interval == 0)
+        throw std::invalid_argument("BBV interval must not be zero");
+    return opts;
+}
+
+} // namespace
+
+BbvProfiler::BbvProfiler(Options opts)
+    : opts_(validate(std::move(opts))), out_(opts_.output) {
+    if (!out_)
+        throw std::runtime_error("Failed to open BBV output: " +
+                                 opts_.output.string());
+}
+
+BbvProfiler::~BbvProfiler() { finish(); }
+
+void BbvProfiler::commit() {
+    if (block_insns_ == 0)
+        return;
+
+    const auto [it, inserted] =
+        ids_.try_emplace(block_start_, static_cast<uint32_t>(ids_.size() + 1));
+    const uint32_t id = it->second;
+    if (inserted)
+        counts_.push_back(0);
+
+    if (counts_[id - 1] == 0)
+        touched_.push_back(id);
+    counts_[id - 1] += block_insns_;
+    block_insns_ = 0;
+}
+
+void BbvProfiler::end_block() {
+    commit();
+    in_block_ = false;
+}
+
+void BbvProfiler::flush() {
+    // A block cut by the interval boundary keeps its id in the next one.
+    commit();
+
+    std::ranges::sort(touched_);
+    std::string line = "T";
+    for (const uint32_t id : touched_) {
+        line += std::format(":{}:{} ", id, counts_[id - 1]);
+        counts_[id - 1] = 0;
+    }
+    touched_.clear();
+
+    out_ << line << '\n';
+    interval_insns_ = 0;
+    intervals_++;
+}
+
+void BbvProfiler::finish() {
+    if (interval_insns_ == 0)
+        return;
+
+    flush();
+    out_.flush();
+}
+
+} // namespace uemu::profile
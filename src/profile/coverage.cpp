@@ -0,0 +1,169 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#include "profile/coverage.hpp"
+
+namespace uemu::profile {
+
+namespace {
+
+// drcov basic-block entry
+struct [[gnu::packed]] BbEntry {
+    uint32_t start; // Offset from the module base
+    uint16_t size;
+    uint16_t module;
+};
+static_assert(sizeof(BbEntry) == 8);
+
+constexpr addr_t WINDOW = 1ULL << 32; // drcov offsets are 32-bit
+
+const char* priv_name(size_t priv) {
+    switch (priv) {
+        case 0:
+            return "user";
+        case 1:
+            return "kernel";
+        default:
+            return "firmware";
+    }
+}
+
+} // namespace
+
+Coverage::Coverage(Options opts) : opts_(std::move(opts)) {
+    if (opts_.system_map.empty())
+        return;
+
+    const utils::SymbolTable map =
+        utils::SymbolTable::load_system_map(opts_.system_map);
+    if (const auto text = map.lookup("_text"))
+        add_module("vmlinux", *text, map);
+    else if (const auto stext = map.lookup("_stext"))
+        add_module("vmlinux", *stext, map);
+}
+
+void Coverage::add_module(const std::string& path, addr_t base,
+                          const utils::SymbolTable& symbols) {
+    // Symbols below the image, e.g. weak ones left at 0, are not part of it
+    addr_t end = base;
+    for (const utils::Symbol& sym : symbols.symbols())
+        if (sym.addr >= base)
+            end = std::max(end, sym.addr + std::max<uint64_t>(sym.size, 1));
+
+    // Offsets must fit drcov's 32 bits
+    if (end != base && end - base <= WINDOW)
+        modules_.push_back({.path = path, .start = base, .end = end});
+}
+
+void Coverage::end_block() {
+    in_block_ = false;
+
+    CacheEntry& e = cache_[(block_start_ >> 1) % CACHE_SIZE];
+    if (e.start == block_start_ && e.priv == block_priv_ &&
+        e.end >= block_end_) [[likely]]
+        return;
+
+    auto& blocks = blocks_[static_cast<size_t>(block_priv_)];
+    const auto [it, inserted] = blocks.try_emplace(block_start_, block_end_);
+    if (!inserted)
+        it->second = std::max(it->second, block_end_);
+
+    e = {.start = block_start_, .end = it->second, .priv = block_priv_};
+}
+
+size_t Coverage::blocks() const noexcept {
+    size_t n = 0;
+    for (const auto& b : blocks_)
+        n += b.size();
+    return n;
+}
+
+void Coverage::finish() {
+    if (in_block_)
+        end_block();
+
+    std::vector<Module> modules = modules_;
+    std::map<std::pair<size_t, addr_t>, uint16_t> catch_all;
+    std::vector<BbEntry> entries;
+
+    const auto module_of = [&](size_t priv, addr_t start) -> uint16_t {
+        for (size_t i = 0; i < modules_.size(); i++)
+            if (start >= modules_[i].start && start < modules_[i].end)
+                return static_cast<uint16_t>(i);
+
+        const addr_t base = start & ~(WINDOW - 1);
+        const auto [it, inserted] = catch_all.try_emplace(
+            {priv, base}, static_cast<uint16_t>(modules.size()));
+        if (inserted)
+            modules.push_back({.path = std::format("[{}]@{:x}",
+                                                   priv_name(priv), base),
+                               .start = base,
+                               .end = base + (WINDOW - 1)});
+        return it->second;
+    };
+
+    for (size_t priv = 0; priv < PRIVS; priv++) {
+        std::vector<std::pair<addr_t, addr_t>> sorted(blocks_[priv].begin(),
+                                                      blocks_[priv].end());
+        std::ranges::sort(sorted);
+
+        for (auto [start, end] : sorted) {
+            const uint16_t id = module_of(priv, start);
+            const addr_t base = modules[id].start;
+
+            // drcov sizes are 16-bit; long blocks are split
+            while (start < end) {
+                const auto size = static_cast<uint16_t>(
+                    std::min<addr_t>(end - start, UINT16_MAX));
+                entries.push_back({.start = static_cast<uint32_t>(start - base),
+                                   .size = size,
+                                   .module = id});
+                start += size;
+            }
+        }
+    }
+
+    std::ofstream out(opts_.output, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Failed to open coverage output: " +
+                                 opts_.output.string());
+
+    out << "DRCOV VERSION: 2\nDRCOV FLAVOR: uemu\n";
+    out << std::format("Module Table: version 2, count {}\n", modules.size());
+    out << "Columns: id, base, end, entry, checksum, timestamp, path\n";
+    for (size_t i = 0; i < modules.size(); i++) {
+        const Module& m = modules[i];
+        out << std::format("{:3}, {:#018x}, {:#018x}, {:#018x}, {:#010x}, "
+                           "{:#010x}, {}\n",
+                           i, m.start, m.end, 0, 0, 0, m.path);
+    }
+
+    out << std::format("BB Table: {} bbs\n", entries.size());
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(BbEntry)));
+
+    if (!out)
+        throw std::runtime_error("Failed to write coverage output: " +
+                                 opts_.output.string());
+}
+
+} // namespace uemu::profile
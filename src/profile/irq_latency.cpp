@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <format>
+#include <print>
+#include <string>
+
+#include "profile/irq_latency.hpp"
+
+namespace uemu::profile {
+
+namespace {
+
+constexpr reg_t INTERRUPT_BIT = 1ULL << 63;
+
+std::string cause_name(reg_t cause) {
+    static constexpr const char* interrupts[IrqLatency::CODES] = {
+        nullptr, "SSI", nullptr, "MSI", nullptr, "STI", nullptr, "MTI",
+        nullptr, "SEI", nullptr, "MEI", nullptr, "LCOFI"};
+    const reg_t code = cause & ~INTERRUPT_BIT;
+
+    if (!(cause & INTERRUPT_BIT))
+        return std::format("exception {}", code);
+    if (code < IrqLatency::CODES && interrupts[code])
+        return interrupts[code];
+    return std::format("interrupt {}", code);
+}
+
+// By IrqLatency::Edge
+constexpr const char* EDGE_NAMES[] = {
+    "entry->xret ns",    "entry->xret insns",    "assert->pending ns",
+    "pending->taken ns", "pending->taken insns", "assert->taken ns"};
+
+} // namespace
+
+uint64_t IrqLatency::now_ns() noexcept {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+void IrqLatency::record(reg_t cause, Edge edge, uint64_t v) noexcept {
+    const reg_t code = cause & ~INTERRUPT_BIT;
+
+    if (cause & INTERRUPT_BIT) {
+        if (code < CODES)
+            interrupts_[code][edge].record(v);
+    } else if (code < EXCEPTION_CODES && edge < TRAP_EDGES) {
+        exceptions_[code][edge].record(v);
+    }
+}
+
+void IrqLatency::asserted(unsigned code, uint64_t late_ns) noexcept {
+    if (code >= CODES)
+        return;
+
+    // The first assertion not yet taken wins; later ones join its wait.
+    uint64_t expected = 0;
+    asserted_ns_[code].compare_exchange_strong(
+        expected, now_ns() - late_ns, std::memory_order_relaxed);
+}
+
+void IrqLatency::pending(reg_t bits) noexcept {
+    const uint64_t now = now_ns();
+    const uint64_t insns = instret_.get();
+
+    for (; bits; bits &= bits - 1) {
+        const auto code = static_cast<unsigned>(std::countr_zero(bits));
+        if (code >= CODES)
+            break;
+
+        pending_ns_[code].store(now, std::memory_order_relaxed);
+        pending_insns_[code].store(insns, std::memory_order_relaxed);
+    }
+}
+
+void IrqLatency::taken(reg_t cause) noexcept {
+    const uint64_t now = now_ns();
+    const uint64_t insns = instret_.get();
+    const reg_t code = cause & ~INTERRUPT_BIT;
+
+    if ((cause & INTERRUPT_BIT) && code < CODES) {
+        // Consumed, so a level that stays high is not counted twice
+        const uint64_t p = pending_ns_[code].exchange(0);
+        const uint64_t a = asserted_ns_[code].exchange(0);
+
+        if (p && p <= now) {
+            record(cause, PENDING_TAKEN_NS, now - p);
+            record(cause, PENDING_TAKEN_INSNS,
+                   insns - pending_insns_[code].load());
+        }
+        if (a && a <= p)
+            record(cause, ASSERT_PENDING_NS, p - a);
+        if (a && a <= now)
+            record(cause, ASSERT_TAKEN_NS, now - a);
+    }
+
+    // A handler that never returns (e.g. firmware jumping to the kernel)
+    // leaves a stale frame; the oldest is overwritten.
+    if (depth_ == MAX_NESTING) {
+        std::shift_left(frames_.begin(), frames_.end(), 1);
+        depth_--;
+    }
+    frames_[depth_++] = {.cause = cause, .ns = now, .insns = insns};
+}
+
+void IrqLatency::returned() noexcept {
+    // xRET without a traced trap, e.g. firmware entering S-mode at boot
+    if (depth_ == 0)
+        return;
+
+    const Frame f = frames_[--depth_];
+    record(f.cause, ENTRY_XRET_NS, now_ns() - f.ns);
+    record(f.cause, ENTRY_XRET_INSNS, instret_.get() - f.insns);
+}
+
+void IrqLatency::restart() noexcept {
+    // Stamps taken against the old instret would underflow against the new
+    for (unsigned code = 0; code < CODES; code++) {
+        asserted_ns_[code].store(0, std::memory_order_relaxed);
+        pending_ns_[code].store(0, std::memory_order_relaxed);
+    }
+    depth_ = 0;
+
+    for (auto& edges : interrupts_)
+        edges.fill(HdrHistogram{});
+    for (auto& edges : exceptions_)
+        edges.fill(HdrHistogram{});
+}
+
+void IrqLatency::report(std::ostream& out) const {
+    std::println(out, "{:<36} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}",
+                 "event", "count", "min", "p50", "p90", "p99", "p99.9",
+                 "max");
+
+    const auto row = [&out](reg_t cause, unsigned edge,
+                            const HdrHistogram& h) {
+        if (h.count() == 0)
+            return;
+        const std::string what =
+            std::format("{} {}", cause_name(cause), EDGE_NAMES[edge]);
+        std::println(out,
+                     "{:<36} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}",
+                     what, h.count(), h.min(), h.percentile(0.5),
+                     h.percentile(0.9), h.percentile(0.99),
+                     h.percentile(0.999), h.max());
+    };
+
+    for (reg_t code = 0; code < CODES; code++)
+        for (unsigned edge = 0; edge < EDGES; edge++)
+            row(INTERRUPT_BIT | code, edge, interrupts_[code][edge]);
+    for (reg_t code = 0; code < EXCEPTION_CODES; code++)
+        for (unsigned edge = 0; edge < TRAP_EDGES; edge++)
+            row(code, edge, exceptions_[code][edge]);
+}
+
+} // namespace uemu::profile
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <map>
+#include <print>
+#include <vector>
+
+#include "profile/mmio_profiler.hpp"
+
+namespace uemu::profile {
+
+uint64_t MmioProfiler::Entry::percentile_ns(double p) const noexcept {
+    const uint64_t n = count();
+    if (n == 0)
+        return 0;
+
+    const auto rank = static_cast<uint64_t>(p * static_cast<double>(n - 1));
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen > rank)
+            return uint64_t{1} << (i + 1);
+    }
+
+    return uint64_t{1} << BUCKETS;
+}
+
+void MmioProfiler::record(const device::Device& dev, addr_t offset,
+                          bool write, uint64_t ns) {
+    const size_t bucket =
+        std::min<size_t>(std::bit_width(ns) - (ns != 0), BUCKETS - 1);
+
+    std::scoped_lock lock(mutex_);
+    Entry& e = entries_[{.dev = &dev, .offset = offset}];
+    (write ? e.writes : e.reads)++;
+    e.total_ns += ns;
+    e.histogram[bucket]++;
+}
+
+void MmioProfiler::report(std::ostream& out) const {
+    std::scoped_lock lock(mutex_);
+
+    std::vector<std::pair<Key, const Entry*>> regs;
+    std::map<const device::Device*, Entry> devices;
+    uint64_t accesses = 0;
+    uint64_t total_ns = 0;
+
+    for (const auto& [key, e] : entries_) {
+        regs.emplace_back(key, &e);
+
+        Entry& d = devices[key.dev];
+        d.reads += e.reads;
+        d.writes += e.writes;
+        d.total_ns += e.total_ns;
+        for (size_t i = 0; i < BUCKETS; i++)
+            d.histogram[i] += e.histogram[i];
+
+        accesses += e.count();
+        total_ns += e.total_ns;
+    }
+
+    std::ranges::sort(regs, [](const auto& a, const auto& b) {
+        return a.second->total_ns > b.second->total_ns;
+    });
+
+    std::vector<std::pair<const device::Device*, const Entry*>> by_device;
+    for (const auto& [dev, e] : devices)
+        by_device.emplace_back(dev, &e);
+    std::ranges::sort(by_device, [](const auto& a, const auto& b) {
+        return a.second->total_ns > b.second->total_ns;
+    });
+
+    const auto row = [&out](const std::string& name, const std::string& off,
+                            const Entry& e) -> void {
+        std::println(out, "{:<20} {:>8} {:>12} {:>12} {:>12.1f} {:>8} {:>8} "
+                          "{:>8}",
+                     name, off, e.reads, e.writes,
+                     static_cast<double>(e.total_ns) / 1e3,
+                     e.total_ns / std::max<uint64_t>(e.count(), 1),
+                     e.percentile_ns(0.5), e.percentile_ns(0.99));
+    };
+    const auto header = [&out](const char* what) -> void {
+        std::println(out, "{:<20} {:>8} {:>12} {:>12} {:>12} {:>8} {:>8} {:>8}",
+                     what, "offset", "reads", "writes", "total_us",
+                     "mean_ns", "p50_ns", "p99_ns");
+    };
+
+    std::println(out, "MMIO: {} accesses, {:.3f} ms in device handlers",
+                 accesses, static_cast<double>(total_ns) / 1e6);
+
+    std::println(out, "");
+    header("device");
+    for (const auto& [dev, e] : by_device)
+        row(dev->name(), "*", *e);
+
+    std::println(out, "");
+    header("register");
+    for (const auto& [key, e] : regs)
+        row(key.dev->name(), std::format("{:#x}", key.offset), *e);
+}
+
+} // namespace uemu::profile
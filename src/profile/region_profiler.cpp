@@ -0,0 +1,133 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <format>
+#include <numeric>
+
+#include "profile/region_profiler.hpp"
+
+namespace uemu::profile {
+
+namespace {
+
+using CauseCounters = std::array<StatCounter, core::HartStats::CAUSES>;
+
+uint64_t sum(const CauseCounters& c) {
+    return std::accumulate(
+        c.begin(), c.end(), uint64_t{0},
+        [](uint64_t n, const StatCounter& s) { return n + s.get(); });
+}
+
+} // namespace
+
+RegionProfiler::Counters RegionProfiler::snapshot() const {
+    const core::HartStats& s = hart_.stats;
+    Counters c{
+        .instructions = s.instructions.get(),
+        .wall_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_)
+                .count()),
+        .itlb_misses = s.itlb_misses.get(),
+        .dtlb_misses = s.dtlb_misses.get(),
+        .page_walks = s.page_walks.get(),
+        .exceptions = sum(s.exceptions),
+        .interrupts = sum(s.interrupts),
+    };
+
+    for (const auto& dev : bus_.devices()) {
+        c.mmio_reads += dev->mmio_reads();
+        c.mmio_writes += dev->mmio_writes();
+    }
+
+    return c;
+}
+
+void RegionProfiler::begin(reg_t id) {
+    Counters c = snapshot();
+    // The marker instruction retires after this; keep it out of the region
+    c.instructions++;
+    open_[id] = c;
+}
+
+void RegionProfiler::end(reg_t id) {
+    const auto it = open_.find(id);
+    if (it == open_.end()) {
+        unmatched_ends_++;
+        return;
+    }
+
+    const Counters now = snapshot();
+    const Counters& then = it->second;
+    Region& r = regions_[id];
+    Counters& t = r.total;
+
+    // Wrapping subtraction keeps an (impossible) negative delta harmless
+    t.instructions += now.instructions - then.instructions;
+    t.wall_ns += now.wall_ns - then.wall_ns;
+    t.itlb_misses += now.itlb_misses - then.itlb_misses;
+    t.dtlb_misses += now.dtlb_misses - then.dtlb_misses;
+    t.page_walks += now.page_walks - then.page_walks;
+    t.exceptions += now.exceptions - then.exceptions;
+    t.interrupts += now.interrupts - then.interrupts;
+    t.mmio_reads += now.mmio_reads - then.mmio_reads;
+    t.mmio_writes += now.mmio_writes - then.mmio_writes;
+
+    r.runs++;
+    r.min_wall_ns = std::min(r.min_wall_ns, now.wall_ns - then.wall_ns);
+    r.max_wall_ns = std::max(r.max_wall_ns, now.wall_ns - then.wall_ns);
+
+    open_.erase(it);
+}
+
+std::string RegionProfiler::json() const {
+    std::string out = "{\n  \"regions\": [";
+
+    const char* sep = "\n";
+    for (const auto& [id, r] : regions_) {
+        const Counters& t = r.total;
+        const double seconds = static_cast<double>(t.wall_ns) / 1e9;
+
+        out += std::format(
+            "{}    {{\"id\": {}, \"runs\": {}, \"instructions\": {}, "
+            "\"wall_s\": {:.9f},\n     \"min_wall_s\": {:.9f}, "
+            "\"max_wall_s\": {:.9f}, \"mips\": {:.2f},\n     "
+            "\"itlb_misses\": {}, \"dtlb_misses\": {}, \"page_walks\": {},\n"
+            "     \"exceptions\": {}, \"interrupts\": {}, "
+            "\"mmio_reads\": {}, \"mmio_writes\": {}}}",
+            sep, id, r.runs, t.instructions, seconds,
+            static_cast<double>(r.min_wall_ns) / 1e9,
+            static_cast<double>(r.max_wall_ns) / 1e9,
+            seconds > 0 ? static_cast<double>(t.instructions) / seconds / 1e6
+                        : 0.0,
+            t.itlb_misses, t.dtlb_misses, t.page_walks, t.exceptions,
+            t.interrupts, t.mmio_reads, t.mmio_writes);
+        sep = ",\n";
+    }
+
+    out += "\n  ],\n  \"unclosed\": [";
+    sep = "";
+    for (const auto& [id, c] : open_) {
+        out += std::format("{}{}", sep, id);
+        sep = ", ";
+    }
+
+    return out + std::format("],\n  \"unmatched_ends\": {}\n}}\n",
+                             unmatched_ends_);
+}
+
+} // namespace uemu::profile
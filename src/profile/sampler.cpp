@@ -0,0 +1,235 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <print>
+
+#include "core/mmu.hpp"
+#include "profile/sampler.hpp"
+
+namespace uemu::profile {
+
+Sampler::Sampler(core::Hart& hart, core::MMU& mmu, core::Dram& dram,
+                 Options opts)
+    : hart_(hart), mmu_(mmu), dram_(dram), opts_(std::move(opts)) {
+    if (!opts_.system_map.empty())
+        kernel_symbols_ = utils::SymbolTable::load_system_map(opts_.system_map);
+
+    next_sample_ = opts_.period;
+
+    if (!opts_.period && opts_.frequency) {
+        timer_thread_ = std::thread([this]() -> void {
+            using clock = std::chrono::steady_clock;
+            const auto interval = std::chrono::nanoseconds(
+                std::chrono::seconds(1)) / opts_.frequency;
+            auto next = clock::now() + interval;
+
+            while (running_.load(std::memory_order_relaxed)) {
+                std::this_thread::sleep_until(next);
+                timer_due_.store(true, std::memory_order_relaxed);
+                next += interval;
+            }
+        });
+    }
+
+    drain_thread_ = std::thread(&Sampler::drain, this);
+}
+
+Sampler::~Sampler() { stop(); }
+
+void Sampler::take_sample() noexcept {
+    Sample s{
+        .pc = hart_.pc,
+        .satp = hart_.csrs[core::SATP::ADDRESS]->read_unchecked(),
+        .priv = hart_.priv,
+        .depth = 0,
+        .callers = {},
+        .comm = {},
+    };
+
+    read_comm(s);
+
+    // RISC-V frame records: return address at fp - 8, caller's fp at
+    // fp - 16. Stacks grow down, so a sane chain strictly increases.
+    addr_t fp = hart_.gprs[8];
+
+    while (s.depth < MAX_DEPTH && fp && fp % 8 == 0) {
+        const std::optional<uint64_t> ra = read_guest(fp - 8, s.priv);
+        const std::optional<uint64_t> prev = read_guest(fp - 16, s.priv);
+        if (!ra || !prev || *ra == 0)
+            break;
+
+        s.callers[s.depth++] = *ra;
+        if (*prev <= fp)
+            break;
+        fp = *prev;
+    }
+
+    if (!queue_.push(s)) [[unlikely]]
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::optional<uint64_t>
+Sampler::read_guest(addr_t va, core::PrivilegeLevel priv) const noexcept {
+    // Walked without touching the TLB, A bits or statistics, so sampling
+    // leaves the guest as it was. Only plain memory: a stray frame pointer
+    // must not poke MMIO.
+    const std::optional<addr_t> pa =
+        priv == core::PrivilegeLevel::M ? va : mmu_.peek_translate(va, dram_);
+    if (!pa || !dram_.is_valid_addr(*pa, sizeof(uint64_t)))
+        return std::nullopt;
+    return dram_.read<uint64_t>(*pa);
+}
+
+void Sampler::read_comm(Sample& s) const noexcept {
+    if (!opts_.comm_offset || s.priv == core::PrivilegeLevel::M)
+        return;
+
+    // Linux keeps `current` in tp while in the kernel and parks it in
+    // sscratch while the hart runs user code.
+    const addr_t task =
+        s.priv == core::PrivilegeLevel::U
+            ? hart_.csrs[core::SSCRATCH::ADDRESS]->read_unchecked()
+            : hart_.gprs[4];
+    if (!task)
+        return;
+
+    // comm is NUL-terminated within TASK_COMM_LEN and may straddle a page
+    const addr_t va = task + *opts_.comm_offset;
+    std::optional<addr_t> pa;
+    addr_t page_va = 0;
+
+    for (size_t i = 0; i < TASK_COMM_LEN; i++) {
+        const addr_t addr = va + i;
+        if (i == 0 || (addr & 0xFFF) == 0) {
+            pa = mmu_.peek_translate(addr, dram_);
+            page_va = addr;
+            if (!pa || !dram_.is_valid_addr(*pa, 1))
+                break;
+        }
+
+        const char c =
+            static_cast<char>(dram_.read<uint8_t>(*pa + (addr - page_va)));
+        if (c == '\0')
+            return;
+        if (c < ' ' || c > '~') // Not a task name after all
+            break;
+        s.comm[i] = c;
+    }
+
+    s.comm = {};
+}
+
+void Sampler::drain() {
+    while (true) {
+        const bool running = running_.load(std::memory_order_acquire);
+
+        while (std::optional<Sample> s = queue_.pop()) {
+            account(*s);
+        }
+
+        if (!running)
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+void Sampler::account(const Sample& s) {
+    std::string root;
+
+    switch (s.priv) {
+        case core::PrivilegeLevel::M:
+            root = "[firmware]";
+            breakdown_.firmware++;
+            break;
+        case core::PrivilegeLevel::S:
+            root = "[kernel]";
+            breakdown_.kernel++;
+            break;
+        default: {
+            const std::string name = process(s);
+            root = std::format("[user];[{}]", name);
+            breakdown_.user++;
+            breakdown_.processes[name]++;
+            break;
+        }
+    }
+
+    std::vector<addr_t> frames{static_cast<addr_t>(s.priv), s.pc};
+    frames.insert(frames.end(), s.callers.begin(),
+                  s.callers.begin() + s.depth);
+    stacks_[{std::move(root), std::move(frames)}]++;
+    total_++;
+}
+
+std::string Sampler::process(const Sample& s) {
+    if (s.comm[0])
+        return {s.comm.data()};
+
+    // Without task names, an address space is the best process identity.
+    const reg_t asid =
+        (s.satp & core::SATP::Field::ASID) >> core::SATP::Shift::ASID_SHIFT;
+    const reg_t ppn =
+        (s.satp & core::SATP::Field::PPN) >> core::SATP::Shift::PPN_SHIFT;
+    return std::format("asid {} root 0x{:x}", asid, ppn << 12);
+}
+
+void Sampler::stop() {
+    running_.store(false, std::memory_order_release);
+
+    if (timer_thread_.joinable())
+        timer_thread_.join();
+    if (drain_thread_.joinable())
+        drain_thread_.join();
+}
+
+void Sampler::finish(const utils::SymbolTable& symbols) {
+    stop();
+
+    std::ofstream out(opts_.output);
+    if (!out)
+        throw std::runtime_error("Failed to open profile output: " +
+                                 opts_.output.string());
+
+    // Folded stacks, outermost frame first, as flamegraph.pl expects
+    for (const auto& [key, count] : stacks_) {
+        const auto& [root, frames] = key;
+        const auto priv = static_cast<core::PrivilegeLevel>(frames[0]);
+        std::string line = root;
+
+        for (size_t i = frames.size(); i-- > 1;)
+            line += ';' + frame_name(frames[i], priv, symbols);
+
+        std::println(out, "{} {}", line, count);
+    }
+}
+
+std::string Sampler::frame_name(addr_t addr, core::PrivilegeLevel priv,
+                                const utils::SymbolTable& symbols) const {
+    // User processes are not covered by System.map
+    const utils::Symbol* sym = nullptr;
+    if (priv == core::PrivilegeLevel::S)
+        sym = kernel_symbols_.find(addr);
+    if (!sym)
+        sym = symbols.find(addr);
+
+    return sym ? sym->name : std::format("0x{:x}", addr);
+}
+
+} // namespace uemu::profile
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <print>
+
+#include "profile/stats_reporter.hpp"
+
+namespace uemu::profile {
+
+namespace {
+
+// Set from the signal handler, so it must be lock-free.
+std::atomic_bool dump_requested{false};
+static_assert(std::atomic_bool::is_always_lock_free);
+
+void request_dump(int /* sig */) {
+    dump_requested.store(true, std::memory_order_relaxed);
+}
+
+std::string quoted(std::string_view s) {
+    std::string out = "\"";
+    for (const char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20)
+            out += std::format("\\u{:04x}", c);
+        else
+            out += c;
+    }
+    return out + '"';
+}
+
+double ratio(uint64_t part, uint64_t total) {
+    return total ? static_cast<double>(part) / static_cast<double>(total)
+                 : 0.0;
+}
+
+// {"code": count, ...} with the zero entries left out
+using CauseCounters = std::array<StatCounter, core::HartStats::CAUSES>;
+
+std::string by_cause(const CauseCounters& c) {
+    std::string out = "{";
+    for (size_t i = 0; i < c.size(); i++) {
+        if (const uint64_t n = c[i].get()) {
+            out += std::format("{}\"{}\": {}", out.size() > 1 ? ", " : "", i,
+                               n);
+        }
+    }
+    return out + '}';
+}
+
+std::string tlb(const StatCounter& hits, const StatCounter& misses) {
+    const uint64_t h = hits.get();
+    const uint64_t m = misses.get();
+    return std::format(R"({{"hits": {}, "misses": {}, "hit_rate": {:.6f}}})",
+                       h, m, ratio(h, h + m));
+}
+
+} // namespace
+
+StatsReporter::StatsReporter(const core::Hart& hart, const core::Bus& bus,
+                             Options opts)
+    : hart_(hart), bus_(bus), opts_(std::move(opts)),
+      start_(std::chrono::steady_clock::now()) {
+    std::signal(SIGUSR1, request_dump);
+    thread_ = std::thread(&StatsReporter::run, this);
+}
+
+StatsReporter::~StatsReporter() { stop(); }
+
+std::string StatsReporter::json(const core::Hart& hart, const core::Bus& bus,
+                                std::chrono::nanoseconds elapsed) {
+    const core::HartStats& s = hart.stats;
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    const uint64_t insns = s.instructions.get();
+
+    std::string out = std::format(
+        "{{\n  \"elapsed_s\": {:.3f},\n  \"harts\": [{{\"hart\": 0, "
+        "\"instructions\": {}, \"mips\": {:.2f},\n    \"itlb\": {}, "
+        "\"dtlb\": {}, \"page_walks\": {},\n    \"exceptions\": {}, "
+        "\"interrupts\": {},\n    \"wfi_idle_s\": {:.3f}}}],\n"
+        "  \"mmio\": [",
+        seconds, insns,
+        seconds > 0 ? static_cast<double>(insns) / seconds / 1e6 : 0.0,
+        tlb(s.itlb_hits, s.itlb_misses), tlb(s.dtlb_hits, s.dtlb_misses),
+        s.page_walks.get(), by_cause(s.exceptions), by_cause(s.interrupts),
+        static_cast<double>(s.wfi_ns.get()) / 1e9);
+
+    const char* sep = "\n";
+    for (const auto& dev : bus.devices()) {
+        out += std::format(
+            R"({}    {{"device": {}, "reads": {}, "writes": {}}})", sep,
+            quoted(dev->name()), dev->mmio_reads(), dev->mmio_writes());
+        sep = ",\n";
+    }
+
+    return out + "\n  ]\n}\n";
+}
+
+std::string StatsReporter::json() const {
+    return json(hart_, bus_, std::chrono::steady_clock::now() - start_);
+}
+
+void StatsReporter::dump() const {
+    const std::string report = json();
+
+    if (opts_.output.empty()) {
+        std::print(stderr, "{}", report);
+        return;
+    }
+
+    // Readers polling the file never see a half-written report.
+    std::filesystem::path tmp = opts_.output;
+    tmp += ".tmp";
+    std::ofstream(tmp) << report;
+    std::error_code ec;
+    std::filesystem::rename(tmp, opts_.output, ec);
+}
+
+void StatsReporter::run() {
+    using clock = std::chrono::steady_clock;
+    constexpr auto poll = std::chrono::milliseconds(100);
+
+    auto next = clock::now() + opts_.interval;
+    std::unique_lock lock(mutex_);
+
+    while (!cond_.wait_for(lock, poll, [this] { return stop_; })) {
+        const bool periodic =
+            opts_.interval.count() > 0 && clock::now() >= next;
+        if (periodic)
+            next += opts_.interval;
+
+        if (dump_requested.exchange(false, std::memory_order_relaxed) ||
+            periodic)
+            dump();
+    }
+}
+
+void StatsReporter::stop() {
+    {
+        std::scoped_lock lock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void StatsReporter::restart() {
+    std::scoped_lock lock(mutex_);
+    start_ = std::chrono::steady_clock::now();
+}
+
+void StatsReporter::finish() {
+    stop();
+    if (opts_.on_exit)
+        dump();
+}
+
+} // namespace uemu::profile
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <elf.h>
+
+#include <cstring>
+#include <print>
+#include <stdexcept>
+
+#include "profile/trace_decoder.hpp"
+#include "profile/tracer.hpp"
+#include "utils/mapped_file.hpp"
+
+namespace uemu::profile {
+
+namespace {
+
+class Reader {
+public:
+    explicit Reader(std::span<const uint8_t> data) : data_(data) {}
+
+    [[nodiscard]] bool done() const noexcept { return pos_ == data_.size(); }
+
+    uint8_t byte() {
+        if (pos_ >= data_.size())
+            throw std::runtime_error("Truncated trace");
+        return data_[pos_++];
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const uint8_t b = byte();
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return v;
+        }
+        throw std::runtime_error("Malformed varint in trace");
+    }
+
+    // The [skip] field of BRANCH, TRAP and END records
+    addr_t skip(uint8_t header) {
+        const unsigned inline_skip = header >> Tracer::SKIP_SHIFT;
+        if (inline_skip)
+            return (inline_skip - 1) * 2;
+        return Tracer::unzigzag(varint());
+    }
+
+private:
+    std::span<const uint8_t> data_;
+    size_t pos_ = 0;
+};
+
+constexpr char priv_name(uint8_t priv) noexcept {
+    constexpr char names[] = {'U', 'S', 'H', 'M'};
+    return names[priv & 3];
+}
+
+} // namespace
+
+void TraceDecoder::add_elf(const std::filesystem::path& path) {
+    const utils::MappedFile file(path);
+    const std::span<const uint8_t> data = file.data();
+
+    if (data.size() < sizeof(Elf64_Ehdr) ||
+        std::memcmp(data.data(), ELFMAG, SELFMAG) != 0 ||
+        data[EI_CLASS] != ELFCLASS64)
+        throw std::runtime_error("Not a 64-bit ELF file: " + path.string());
+
+    Elf64_Ehdr hdr;
+    std::memcpy(&hdr, data.data(), sizeof(hdr));
+
+    for (size_t i = 0; i < hdr.e_phnum; i++) {
+        const size_t off = hdr.e_phoff + i * sizeof(Elf64_Phdr);
+        if (off + sizeof(Elf64_Phdr) > data.size())
+            throw std::runtime_error("Truncated ELF program headers");
+
+        Elf64_Phdr ph;
+        std::memcpy(&ph, data.data() + off, sizeof(ph));
+        if (ph.p_type != PT_LOAD || !(ph.p_flags & PF_X) || !ph.p_filesz)
+            continue;
+        if (ph.p_offset + ph.p_filesz > data.size())
+            throw std::runtime_error("ELF segment exceeds file size");
+
+        const uint8_t* src = data.data() + ph.p_offset;
+        add_image(ph.p_vaddr, {src, src + ph.p_filesz});
+    }
+}
+
+void TraceDecoder::add_raw(const std::filesystem::path& path, addr_t base) {
+    const utils::MappedFile file(path);
+    add_image(base, {file.data().begin(), file.data().end()});
+}
+
+void TraceDecoder::add_image(addr_t base, std::vector<uint8_t> bytes) {
+    images_.push_back({.base = base, .bytes = std::move(bytes)});
+}
+
+std::optional<uint32_t> TraceDecoder::fetch(addr_t pc) const noexcept {
+    for (const Image& img : images_) {
+        if (pc < img.base || pc - img.base + 2 > img.bytes.size())
+            continue;
+
+        const uint8_t* p = img.bytes.data() + (pc - img.base);
+        uint32_t insn = p[0] | p[1] << 8;
+        if ((insn & 3) != 3)
+            return insn;
+
+        if (pc - img.base + 4 > img.bytes.size())
+            return std::nullopt;
+        return insn | static_cast<uint32_t>(p[2] | p[3] << 8) << 16;
+    }
+
+    return std::nullopt;
+}
+
+void TraceDecoder::walk(addr_t pc, addr_t stop, bool inclusive,
+                        std::ostream& out, Stats& stats) const {
+    while (pc < stop || (inclusive && pc == stop)) {
+        const std::optional<uint32_t> insn = fetch(pc);
+        if (!insn) {
+            std::println(out, "# gap 0x{:x}-0x{:x}: no image", pc, stop);
+            stats.gaps++;
+            return;
+        }
+
+        if ((*insn & 3) != 3)
+            std::println(out, "{:x}: {:04x}", pc, *insn);
+        else
+            std::println(out, "{:x}: {:08x}", pc, *insn);
+        stats.instructions++;
+
+        if (pc == stop)
+            return;
+        pc += (*insn & 3) != 3 ? 2 : 4;
+    }
+
+    // The image does not match what ran, e.g. code was modified.
+    if (pc != stop) {
+        std::println(out, "# gap 0x{:x}-0x{:x}: out of sync", pc, stop);
+        stats.gaps++;
+    }
+}
+
+TraceDecoder::Stats TraceDecoder::decode(std::span<const uint8_t> trace,
+                                         std::ostream& out) const {
+    if (trace.size() < sizeof(Tracer::MAGIC) ||
+        std::memcmp(trace.data(), Tracer::MAGIC, sizeof(Tracer::MAGIC)) != 0)
+        throw std::runtime_error("Not a uemu trace");
+
+    Reader in(trace.subspan(sizeof(Tracer::MAGIC)));
+    Stats stats;
+    std::optional<addr_t> pc; // Unknown until the first SYNC
+
+    while (!in.done()) {
+        const uint8_t header = in.byte();
+
+        switch (header & 7) {
+            case Tracer::SYNC: {
+                pc = in.varint();
+                const reg_t satp = in.varint();
+                const uint8_t priv = in.byte();
+                std::println(out, "# sync pc 0x{:x} priv {} satp 0x{:x}", *pc,
+                             priv_name(priv), satp);
+                break;
+            }
+            case Tracer::BRANCH:
+            case Tracer::TRAP: {
+                if (!pc)
+                    throw std::runtime_error("Trace does not start with sync");
+
+                const addr_t from = *pc + in.skip(header);
+                const addr_t to = from + Tracer::unzigzag(in.varint());
+
+                if ((header & 7) == Tracer::BRANCH) {
+                    walk(*pc, from, true, out, stats);
+                    stats.branches++;
+                } else {
+                    const uint64_t v = in.varint();
+                    walk(*pc, from, false, out, stats);
+                    std::println(out, "# {} {} at 0x{:x} -> 0x{:x}",
+                                 v & 1 ? "interrupt" : "exception", v >> 1,
+                                 from, to);
+                    stats.traps++;
+                }
+
+                pc = to;
+                break;
+            }
+            case Tracer::CONTEXT:
+                if (header & 8)
+                    std::println(out, "# context priv {} satp 0x{:x}",
+                                 priv_name(header >> 4), in.varint());
+                else
+                    std::println(out, "# context priv {}",
+                                 priv_name(header >> 4));
+                break;
+            case Tracer::END:
+                if (!pc)
+                    throw std::runtime_error("Trace does not start with sync");
+                walk(*pc, *pc + in.skip(header), false, out, stats);
+                std::println(out, "# end");
+                return stats;
+            default: throw std::runtime_error("Unknown trace record");
+        }
+    }
+
+    // A trace cut short (e.g. the emulator was killed) still decodes.
+    return stats;
+}
+
+} // namespace uemu::profile
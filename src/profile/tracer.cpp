@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "profile/tracer.hpp"
+
+namespace uemu::profile {
+
+Tracer::Tracer(core::Hart& hart, Options opts)
+    : hart_(hart), satp_csr_(*hart.csrs[core::SATP::ADDRESS]),
+      opts_(std::move(opts)),
+      out_(opts_.output, std::ios::binary), buf_(CHUNK_SIZE),
+      last_(hart.pc), priv_(hart.priv),
+      satp_(satp_csr_.read_unchecked()) {
+    if (!out_)
+        throw std::runtime_error("Failed to open trace output: " +
+                                 opts_.output.string());
+
+    out_.write(MAGIC, sizeof(MAGIC));
+    put_sync();
+}
+
+void Tracer::put_sync() noexcept {
+    uint8_t* p = buf_.data() + pos_;
+    *p++ = SYNC;
+    p = put_varint(p, last_);
+    p = put_varint(p, satp_);
+    *p++ = static_cast<uint8_t>(priv_);
+    pos_ = static_cast<size_t>(p - buf_.data());
+}
+
+void Tracer::put_context() noexcept {
+    const reg_t satp = satp_csr_.read_unchecked();
+    const bool new_satp = satp != satp_;
+
+    priv_ = hart_.priv;
+    satp_ = satp;
+
+    uint8_t* p = buf_.data() + pos_;
+    *p++ = static_cast<uint8_t>(CONTEXT | new_satp << 3 |
+                                static_cast<uint8_t>(priv_) << 4);
+    if (new_satp)
+        p = put_varint(p, satp);
+    pos_ = static_cast<size_t>(p - buf_.data());
+}
+
+void Tracer::next_chunk() noexcept {
+    if (opts_.ring_size) {
+        ring_.emplace_back(buf_.begin(), buf_.begin() + pos_);
+        while (ring_.size() > 1 && ring_.size() * CHUNK_SIZE > opts_.ring_size)
+            ring_.pop_front();
+    } else {
+        // Write errors surface as a bad stream in finish().
+        out_.write(reinterpret_cast<const char*>(buf_.data()),
+                   static_cast<std::streamsize>(pos_));
+    }
+
+    written_ += pos_;
+    pos_ = 0;
+    put_sync();
+}
+
+void Tracer::finish() {
+    const addr_t pc = hart_.pc;
+    uint8_t* p = put_skip(reserve(), END, pc);
+    pos_ = static_cast<size_t>(p - buf_.data());
+    last_ = pc;
+
+    for (const std::vector<uint8_t>& chunk : ring_)
+        out_.write(reinterpret_cast<const char*>(chunk.data()),
+                   static_cast<std::streamsize>(chunk.size()));
+    ring_.clear();
+
+    out_.write(reinterpret_cast<const char*>(buf_.data()),
+               static_cast<std::streamsize>(pos_));
+    written_ += pos_;
+    pos_ = 0;
+
+    out_.flush();
+    if (!out_)
+        throw std::runtime_error("Failed to write trace output: " +
+                                 opts_.output.string());
+}
+
+} // namespace uemu::profile
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
+#include <print>
+#include <stdexcept>
+
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+
+#include "ui/frame_capture.hpp"
+
+namespace uemu::ui {
+
+FrameCapture::FrameCapture(std::shared_ptr<PixelSource> pixel_source,
+                           Options options)
+    : pixel_source_(std::move(pixel_source)), options_(std::move(options)),
+      width_(pixel_source_->get_width()), height_(pixel_source_->get_height()),
+      pitch_(width_ * 4), frame_(pixel_source_->get_size()) {
+    if (!options_.dir.empty())
+        std::filesystem::create_directories(options_.dir);
+
+    if (!options_.stream.empty()) {
+        stream_ = std::fopen(options_.stream.c_str(), "wb");
+
+        if (!stream_)
+            throw std::runtime_error("Failed to open capture stream: " +
+                                     options_.stream.string());
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    if (stream_)
+        std::fclose(stream_);
+}
+
+void FrameCapture::poll(std::chrono::steady_clock::time_point now) {
+    if (options_.fps) {
+        const auto interval = std::chrono::microseconds(1'000'000) /
+                              static_cast<int64_t>(options_.fps);
+
+        if (!next_capture_)
+            next_capture_ = now;
+
+        if (now < *next_capture_)
+            return;
+
+        *next_capture_ += interval;
+        if (*next_capture_ < now)
+            *next_capture_ = now + interval;
+    }
+
+    const bool changed = refresh();
+
+    if (changed && !options_.dir.empty())
+        dump_frame();
+
+    // A fixed-rate stream repeats unchanged frames to keep its timing.
+    if (stream_ && have_frame_ && (changed || options_.fps))
+        std::fwrite(frame_.data(), 1, frame_.size(), stream_);
+}
+
+std::optional<bool> FrameCapture::finish() {
+    if (refresh() && !options_.dir.empty())
+        dump_frame();
+
+    if (stream_)
+        std::fflush(stream_);
+
+    if (options_.golden.empty())
+        return std::nullopt;
+
+    return compare_golden();
+}
+
+bool FrameCapture::refresh() {
+    dirty_spans_.clear();
+    pixel_source_->take_dirty_spans(dirty_spans_);
+
+    // No store reached the framebuffer: nothing to copy or hash.
+    if (dirty_spans_.empty())
+        return false;
+
+    const uint8_t* pixels = pixel_source_->get_pixels();
+    for (const auto& span : dirty_spans_) {
+        const size_t offset = span.first_row * pitch_;
+        std::memcpy(frame_.data() + offset, pixels + offset,
+                    span.num_rows * pitch_);
+    }
+
+    // Stores may rewrite identical pixels, so confirm with the hash.
+    const uint64_t hash = hash_frame(frame_.data(), frame_.size());
+    const bool changed = !have_frame_ || hash != hash_;
+
+    hash_ = hash;
+    have_frame_ = true;
+
+    return changed;
+}
+
+void FrameCapture::dump_frame() {
+    const bool png = options_.format == Format::Png;
+    const auto path = options_.dir / std::format("frame_{:06}.{}", written_,
+                                                 png ? "png" : "raw");
+
+    if (png) {
+        write_png(path);
+    } else if (std::FILE* f = std::fopen(path.c_str(), "wb")) {
+        std::fwrite(frame_.data(), 1, frame_.size(), f);
+        std::fclose(f);
+    } else {
+        std::println(stderr, "FrameCapture: failed to write {}",
+                     path.string());
+    }
+
+    written_++;
+}
+
+void FrameCapture::write_png(const std::filesystem::path& path) const {
+    SDL_Surface* surface = SDL_CreateSurfaceFrom(
+        static_cast<int>(width_), static_cast<int>(height_),
+        SDL_PIXELFORMAT_XRGB8888, const_cast<uint8_t*>(frame_.data()),
+        static_cast<int>(pitch_));
+
+    if (!surface || !IMG_SavePNG(surface, path.c_str()))
+        std::println(stderr, "FrameCapture: failed to write {}: {}",
+                     path.string(), SDL_GetError());
+
+    if (surface)
+        SDL_DestroySurface(surface);
+}
+
+std::optional<bool> FrameCapture::compare_golden() const {
+    SDL_Surface* loaded = IMG_Load(options_.golden.c_str());
+    SDL_Surface* golden =
+        loaded ? SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_XRGB8888) : nullptr;
+
+    if (loaded)
+        SDL_DestroySurface(loaded);
+
+    if (!golden) {
+        std::println(stderr, "Golden compare: FAIL (cannot load {}: {})",
+                     options_.golden.string(), SDL_GetError());
+        return false;
+    }
+
+    if (static_cast<size_t>(golden->w) != width_ ||
+        static_cast<size_t>(golden->h) != height_) {
+        std::println(stderr, "Golden compare: FAIL (golden is {}x{}, frame is "
+                             "{}x{})",
+                     golden->w, golden->h, width_, height_);
+        SDL_DestroySurface(golden);
+        return false;
+    }
+
+    // The converted surface may have a padded pitch.
+    std::vector<uint8_t> expected(frame_.size());
+    for (size_t row = 0; row < height_; row++)
+        std::memcpy(expected.data() + row * pitch_,
+                    static_cast<const uint8_t*>(golden->pixels) +
+                        row * static_cast<size_t>(golden->pitch),
+                    pitch_);
+    SDL_DestroySurface(golden);
+
+    const auto [mismatched, max_delta] = compare_frames(
+        frame_.data(), expected.data(), frame_.size(), options_.tolerance);
+    const size_t total = width_ * height_;
+    const bool pass = static_cast<double>(mismatched) <=
+                      options_.max_mismatch * static_cast<double>(total);
+
+    std::println("Golden compare: {} ({} of {} pixels beyond tolerance {}, "
+                 "max delta {})",
+                 pass ? "PASS" : "FAIL", mismatched, total, options_.tolerance,
+                 max_delta);
+
+    return pass;
+}
+
+uint64_t FrameCapture::hash_frame(const uint8_t* data, size_t size) {
+    // Independent 32-bit xor-multiply lanes that the compiler vectorises.
+    // Each step is a bijection of the lane state, so any single changed
+    // pixel always changes the result.
+    constexpr size_t LANES = 16;
+    constexpr uint32_t PRIME = 0x9E3779B1u;
+    constexpr uint32_t RGB_MASK = 0x00FFFFFFu;
+
+    std::array<uint32_t, LANES> acc;
+    for (size_t i = 0; i < LANES; i++)
+        acc[i] = PRIME + static_cast<uint32_t>(i);
+
+    size_t off = 0;
+    for (; off + sizeof(acc) <= size; off += sizeof(acc)) {
+        std::array<uint32_t, LANES> words;
+        std::memcpy(words.data(), data + off, sizeof(words));
+
+        for (size_t i = 0; i < LANES; i++)
+            acc[i] = (acc[i] ^ (words[i] & RGB_MASK)) * PRIME;
+    }
+
+    for (; off + 4 <= size; off += 4) {
+        uint32_t word = 0;
+        std::memcpy(&word, data + off, 4);
+        acc[0] = (acc[0] ^ (word & RGB_MASK)) * PRIME;
+    }
+
+    uint64_t h = size;
+    for (uint32_t lane : acc) {
+        // splitmix64 finaliser
+        h ^= lane;
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+        h ^= h >> 31;
+    }
+
+    return h;
+}
+
+FrameCapture::CompareResult FrameCapture::compare_frames(const uint8_t* a,
+                                                         const uint8_t* b,
+                                                         size_t size,
+                                                         unsigned tolerance) {
+    CompareResult result{.mismatched_pixels = 0, .max_delta = 0};
+
+    for (size_t off = 0; off + 4 <= size; off += 4) {
+        unsigned delta = 0;
+
+        // B, G, R; byte 3 is the unused X channel.
+        for (size_t c = 0; c < 3; c++) {
+            const int d = static_cast<int>(a[off + c]) - b[off + c];
+            delta = std::max(delta, static_cast<unsigned>(d < 0 ? -d : d));
+        }
+
+        result.max_delta = std::max(result.max_delta, delta);
+        if (delta > tolerance)
+            result.mismatched_pixels++;
+    }
+
+    return result;
+}
+
+} // namespace uemu::ui
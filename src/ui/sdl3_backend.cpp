@@ -31,13 +31,12 @@ extern const ptrdiff_t uotan_icon_size;
 
 namespace uemu::ui {
 
-SDL3Backend::SDL3Backend(Endpoints endpoints)
+SDL3Backend::SDL3Backend(Endpoints endpoints, unsigned fps)
     : UIBackend(std::move(endpoints)) {
     const auto& pixel_source = endpoints_.pixel_source;
 
     display_width_ = pixel_source->get_width();
     display_height_ = pixel_source->get_height();
-    pixel_buffer_.resize(pixel_source->get_size());
 
     if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS))
         goto fail;
@@ -55,6 +54,24 @@ SDL3Backend::SDL3Backend(Endpoints endpoints)
                                        display_width_, display_height_)))
         goto fail;
 
+    if (fps == 0) {
+        // Pace to the display; vsync merely avoids tearing if unsupported.
+        float refresh_rate = 0.0f;
+
+        if (const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(
+                SDL_GetDisplayForWindow(window_)))
+            refresh_rate = mode->refresh_rate;
+
+        if (refresh_rate > 0.0f)
+            fps = static_cast<unsigned>(refresh_rate + 0.5f);
+        else
+            fps = DEFAULT_FPS;
+
+        SDL_SetRenderVSync(renderer_, 1);
+    }
+
+    frame_interval_ = std::chrono::microseconds(1'000'000 / fps);
+
     {
         // Set window icon from embedded PNG via SDL3_image
         SDL_IOStream* io = SDL_IOFromConstMem(
@@ -70,7 +87,8 @@ SDL3Backend::SDL3Backend(Endpoints endpoints)
         }
     }
 
-    HostConsole::apply_to_endpoint(*endpoints_.console_endpoint);
+    if (endpoints_.console_endpoint)
+        HostConsole::apply_to_endpoint(*endpoints_.console_endpoint);
 
     return;
 
@@ -110,7 +128,6 @@ SDL3Backend::~SDL3Backend() {
 }
 
 void SDL3Backend::update() {
-    const auto& input_sink = endpoints_.input_sink;
     const auto& pixel_source = endpoints_.pixel_source;
 
     SDL_Event event;
@@ -121,21 +138,26 @@ void SDL3Backend::update() {
 
             case SDL_EVENT_WINDOW_RESIZED: update_view(); break;
 
+            // The compositor may have dropped the window contents.
+            case SDL_EVENT_WINDOW_EXPOSED:
+            case SDL_EVENT_WINDOW_RESTORED:
+            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                redraw_pending_ = true;
+                break;
+
             case SDL_EVENT_KEY_DOWN: {
                 auto linux_code = sdl_scancode_to_linux(event.key.scancode);
-                if (linux_code != KEY_RESERVED && input_sink)
-                    input_sink->push_key_event(
-                        {.input_event_code = linux_code,
-                         .action = InputSink::KeyAction::Press});
+                if (linux_code != KEY_RESERVED)
+                    queue_key_event({.input_event_code = linux_code,
+                                     .action = InputSink::KeyAction::Press});
                 break;
             }
 
             case SDL_EVENT_KEY_UP: {
                 auto linux_code = sdl_scancode_to_linux(event.key.scancode);
-                if (linux_code != KEY_RESERVED && input_sink)
-                    input_sink->push_key_event(
-                        {.input_event_code = linux_code,
-                         .action = InputSink::KeyAction::Release});
+                if (linux_code != KEY_RESERVED)
+                    queue_key_event({.input_event_code = linux_code,
+                                     .action = InputSink::KeyAction::Release});
                 break;
             }
 
@@ -147,35 +169,60 @@ void SDL3Backend::update() {
         }
     }
 
-    using clock = std::chrono::steady_clock;
-    using namespace std::chrono_literals;
-
     if (!pixel_source) [[unlikely]]
         return;
 
-    static auto last_update = clock::now();
-    const auto now = clock::now();
-    constexpr auto frame_interval = 16ms + 648us;
+    dirty_spans_.clear();
+    pixel_source->take_dirty_spans(dirty_spans_);
 
-    if (now - last_update < frame_interval)
+    // An earlier upload failed after its rows were marked clean: redo all.
+    if (reupload_pending_) {
+        dirty_spans_.assign(1, {.first_row = 0, .num_rows = display_height_});
+        reupload_pending_ = false;
+    }
+
+    // Nothing changed since the last present: skip the frame entirely.
+    if (dirty_spans_.empty() && !redraw_pending_)
         return;
 
-    const size_t size = pixel_source->get_size();
-    uint8_t* buffer = pixel_buffer_.data();
+    // Copy the dirty rows straight from guest VRAM into the streaming
+    // texture. The guest keeps running; rows it touches meanwhile are
+    // reported dirty again and picked up on the next frame.
+    const size_t pitch = display_width_ * 4;
+    const uint8_t* pixels = pixel_source->get_pixels();
+
+    for (const auto& span : dirty_spans_) {
+        const SDL_Rect rect = {.x = 0,
+                               .y = static_cast<int>(span.first_row),
+                               .w = static_cast<int>(display_width_),
+                               .h = static_cast<int>(span.num_rows)};
+        void* dst = nullptr;
+        int dst_pitch = 0;
+
+        if (!SDL_LockTexture(texture_, &rect, &dst, &dst_pitch)) {
+            reupload_pending_ = true;
+            continue;
+        }
 
-    {
-        std::unique_lock<std::mutex> lock = pixel_source->acquire_lock();
-        const uint8_t* pixels = pixel_source->get_pixels();
-        std::memcpy(buffer, pixels, sizeof(uint8_t) * size);
+        const uint8_t* src = pixels + span.first_row * pitch;
+        auto* out = static_cast<uint8_t*>(dst);
+
+        if (static_cast<size_t>(dst_pitch) == pitch) {
+            std::memcpy(out, src, span.num_rows * pitch);
+        } else {
+            for (size_t row = 0; row < span.num_rows; row++)
+                std::memcpy(out + row * dst_pitch, src + row * pitch, pitch);
+        }
+
+        SDL_UnlockTexture(texture_);
     }
 
-    SDL_UpdateTexture(texture_, nullptr, buffer, display_width_ * 4);
     SDL_SetRenderDrawColor(renderer_, 64, 64, 64, 255);
     SDL_RenderClear(renderer_);
     SDL_RenderTexture(renderer_, texture_, nullptr, nullptr);
     SDL_RenderPresent(renderer_);
 
-    last_update = now;
+    redraw_pending_ = false;
 }
 
 void SDL3Backend::update_view() {
@@ -183,6 +230,9 @@ void SDL3Backend::update_view() {
     // letterbox layout for the new window dimensions.
     SDL_SetRenderLogicalPresentation(renderer_, display_width_, display_height_,
                                      SDL_LOGICAL_PRESENTATION_LETTERBOX);
+
+    // The window contents must be re-presented even if the guest is idle.
+    redraw_pending_ = true;
 }
 
 constexpr InputSink::linux_event_code_t
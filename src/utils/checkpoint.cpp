@@ -0,0 +1,255 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+
+#include "core/mmu.hpp" // IWYU pragma: keep
+#include "utils/checkpoint.hpp"
+
+namespace uemu::utils {
+
+namespace {
+
+constexpr uint64_t END_OF_LIST = UINT64_MAX; // Ends the CSRs and pages
+
+// CSRs that hold state of their own; read-only and unimplemented ones are
+// skipped, views such as sstatus restore to the same value either way.
+// The region markers have no state, writing them only drives the profiler;
+// the AIA windows into the IMSIC would claim or change its interrupts.
+bool is_saved(const core::CSR* csr) {
+    return !dynamic_cast<const core::UnimplementedCSR*>(csr) &&
+           !dynamic_cast<const core::ConstCSR*>(csr) &&
+           !dynamic_cast<const core::REGIONMARKER*>(csr) &&
+           !dynamic_cast<const core::IREGCSR*>(csr) &&
+           !dynamic_cast<const core::TOPEICSR*>(csr);
+}
+
+class Writer {
+public:
+    explicit Writer(const std::filesystem::path& path)
+        : path_(path), out_(path, std::ios::binary) {
+        if (!out_)
+            throw std::runtime_error("Failed to open checkpoint output: " +
+                                     path.string());
+    }
+
+    void bytes(const void* p, size_t n) {
+        out_.write(static_cast<const char*>(p),
+                   static_cast<std::streamsize>(n));
+    }
+
+    void u64(uint64_t v) {
+        std::array<uint8_t, 8> b{};
+        for (size_t i = 0; i < b.size(); i++)
+            b[i] = static_cast<uint8_t>(v >> (8 * i));
+        bytes(b.data(), b.size());
+    }
+
+    void close() {
+        out_.close();
+        if (!out_)
+            throw std::runtime_error("Failed to write checkpoint: " +
+                                     path_.string());
+    }
+
+private:
+    std::filesystem::path path_;
+    std::ofstream out_;
+};
+
+class Reader {
+public:
+    explicit Reader(const std::filesystem::path& path)
+        : path_(path), in_(path, std::ios::binary) {
+        if (!in_)
+            throw std::runtime_error("Failed to open checkpoint: " +
+                                     path.string());
+    }
+
+    void bytes(void* p, size_t n) {
+        if (!in_.read(static_cast<char*>(p), static_cast<std::streamsize>(n)))
+            throw std::runtime_error("Truncated checkpoint: " +
+                                     path_.string());
+    }
+
+    uint64_t u64() {
+        std::array<uint8_t, 8> b{};
+        bytes(b.data(), b.size());
+        uint64_t v = 0;
+        for (size_t i = 0; i < b.size(); i++)
+            v |= static_cast<uint64_t>(b[i]) << (8 * i);
+        return v;
+    }
+
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(std::string(what) + ": " + path_.string());
+    }
+
+private:
+    std::filesystem::path path_;
+    std::ifstream in_;
+};
+
+bool is_zero(const std::array<uint8_t, Checkpoint::PAGE_SIZE>& page) {
+    return std::ranges::all_of(page, [](uint8_t b) { return b == 0; });
+}
+
+} // namespace
+
+void Checkpoint::save(const std::filesystem::path& path,
+                      const core::Hart& hart, const core::Dram& dram,
+                      device::Clint* clint, const Slice& slice) {
+    Writer w(path);
+    w.bytes(MAGIC, sizeof(MAGIC));
+
+    w.u64(slice.interval);
+    w.u64(slice.warmup);
+    w.u64(slice.length);
+
+    w.u64(hart.pc);
+    w.u64(static_cast<uint64_t>(hart.priv));
+    for (size_t i = 0; i < core::Hart::GPR_COUNT; i++)
+        w.u64(hart.gprs[i]);
+    for (const core::FPR& f : hart.fprs)
+        w.u64(f.read_64().v);
+
+    for (size_t i = 0; i < hart.csrs.size(); i++) {
+        if (is_saved(hart.csrs[i].get())) {
+            w.u64(i);
+            w.u64(hart.csrs[i]->read_unchecked());
+        }
+    }
+    w.u64(END_OF_LIST);
+
+    const bool has_clint = clint != nullptr;
+    w.u64(has_clint);
+    if (has_clint) {
+        const addr_t base = clint->start();
+        w.u64(clint->read<uint32_t>(base + device::Clint::MSIP_OFFSET)
+                  .value_or(0));
+        w.u64(clint->read<uint64_t>(base + device::Clint::MTIMECMP_OFFSET)
+                  .value_or(0));
+        w.u64(clint->get_mtime());
+    }
+
+    // Untouched DRAM reads as zero without being committed, so the scan
+    // stays cheap; only pages with data are stored.
+    w.u64(dram.size());
+    std::array<uint8_t, PAGE_SIZE> page{};
+    for (uint64_t i = 0; i < dram.size() / PAGE_SIZE; i++) {
+        dram.read_bytes(core::Dram::DRAM_BASE + i * PAGE_SIZE, page.data(),
+                        PAGE_SIZE);
+        if (!is_zero(page)) {
+            w.u64(i);
+            w.bytes(page.data(), PAGE_SIZE);
+        }
+    }
+    w.u64(END_OF_LIST);
+
+    w.close();
+}
+
+Checkpoint::Slice Checkpoint::restore(const std::filesystem::path& path,
+                                      core::Hart& hart, core::Dram& dram,
+                                      device::Clint* clint) {
+    Reader r(path);
+
+    char magic[sizeof(MAGIC)];
+    r.bytes(magic, sizeof(magic));
+    if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+        r.fail("Not a checkpoint");
+
+    Slice slice;
+    slice.interval = r.u64();
+    slice.warmup = r.u64();
+    slice.length = r.u64();
+
+    hart.pc = r.u64();
+    const uint64_t priv = r.u64();
+    if (priv != static_cast<uint64_t>(core::PrivilegeLevel::U) &&
+        priv != static_cast<uint64_t>(core::PrivilegeLevel::S) &&
+        priv != static_cast<uint64_t>(core::PrivilegeLevel::M))
+        r.fail("Checkpoint has an invalid privilege level");
+    for (size_t i = 0; i < core::Hart::GPR_COUNT; i++)
+        hart.gprs.write(i, r.u64());
+    for (core::FPR& f : hart.fprs)
+        f.write_64(float64_t{r.u64()});
+
+    // Ascending addresses: every view comes before the register it shows.
+    for (uint64_t i = r.u64(); i != END_OF_LIST; i = r.u64()) {
+        const uint64_t v = r.u64();
+        if (i >= hart.csrs.size() || !is_saved(hart.csrs[i].get()))
+            r.fail("Checkpoint has a CSR this hart lacks");
+        hart.csrs[i]->write_unchecked(v);
+    }
+    hart.priv = static_cast<core::PrivilegeLevel>(priv);
+
+    if (r.u64()) {
+        const uint64_t msip = r.u64();
+        const uint64_t mtimecmp = r.u64();
+        const uint64_t mtime = r.u64();
+
+        if (clint) {
+            const addr_t base = clint->start();
+            std::ignore = clint->write<uint64_t>(
+                base + device::Clint::MTIME_OFFSET, mtime);
+            std::ignore = clint->write<uint64_t>(
+                base + device::Clint::MTIMECMP_OFFSET, mtimecmp);
+            std::ignore = clint->write<uint32_t>(
+                base + device::Clint::MSIP_OFFSET, static_cast<uint32_t>(msip));
+        }
+    }
+
+    if (r.u64() != dram.size())
+        r.fail("Checkpoint DRAM size does not match");
+
+    // Pages not in the checkpoint were zero; clear the ones that are not
+    // any more, without committing the rest.
+    std::array<uint8_t, PAGE_SIZE> page{};
+    const uint64_t pages = dram.size() / PAGE_SIZE;
+    uint64_t next = r.u64();
+
+    for (uint64_t i = 0; i < pages; i++) {
+        const addr_t addr = core::Dram::DRAM_BASE + i * PAGE_SIZE;
+
+        if (i == next) {
+            r.bytes(page.data(), PAGE_SIZE);
+            dram.write_bytes(addr, page.data(), PAGE_SIZE);
+            next = r.u64();
+            continue;
+        }
+
+        dram.read_bytes(addr, page.data(), PAGE_SIZE);
+        if (!is_zero(page))
+            dram.fill(addr, 0, PAGE_SIZE);
+    }
+
+    if (next != END_OF_LIST)
+        r.fail("Checkpoint has pages beyond DRAM");
+
+    if (hart.mmu)
+        hart.mmu->tlb_flush_all();
+    hart.interrupt_check_pending = true;
+
+    return slice;
+}
+
+} // namespace uemu::utils
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <format>
+
+#include "core/hart.hpp"
+#include "utils/device_tree.hpp"
+
+namespace uemu::device {
+
+utils::FdtNode& Device::add_soc_node(DtContext& ctx,
+                                     std::string_view node_name) const {
+    utils::FdtNode& node =
+        ctx.soc.child(std::format("{}@{:x}", node_name, start_));
+    node.set_cells("reg", {static_cast<uint32_t>(start_ >> 32),
+                           static_cast<uint32_t>(start_),
+                           static_cast<uint32_t>(size() >> 32),
+                           static_cast<uint32_t>(size())});
+    return node;
+}
+
+void IrqDevice::set_dt_interrupt(utils::FdtNode& node,
+                                 const DtContext& ctx) const {
+    if (ctx.irq_parent == 0)
+        return;
+
+    if (ctx.irq_cells == 2)
+        node.set_cells("interrupts", {interrupt_id_, 4}); // Level high
+    else
+        node.set_cells("interrupts", {interrupt_id_});
+    node.set_u32("interrupt-parent", ctx.irq_parent);
+}
+
+} // namespace uemu::device
+
+namespace uemu::utils {
+
+namespace {
+
+// Multi-letter extensions every hart implements
+constexpr std::string_view BASE_EXTENSIONS[] = {"zicntr", "zicsr",
+                                                "zifencei", "zihpm"};
+
+void add_cpu(Fdt::Node& cpus, unsigned hartid, uint32_t phandle,
+             uint32_t intc_phandle, reg_t misa,
+             const std::vector<std::string>& extensions) {
+    Fdt::Node& cpu = cpus.child(std::format("cpu@{}", hartid));
+
+    std::string isa = "rv64";
+    std::vector<std::string_view> isa_exts;
+    static constexpr std::string_view LETTERS[] = {"i", "m", "a",
+                                                   "f", "d", "c"};
+
+    for (std::string_view letter : LETTERS) {
+        if (misa & (reg_t{1} << (letter[0] - 'a'))) {
+            isa += letter;
+            isa_exts.push_back(letter);
+        }
+    }
+
+    isa_exts.insert(isa_exts.end(), std::begin(BASE_EXTENSIONS),
+                    std::end(BASE_EXTENSIONS));
+    isa_exts.insert(isa_exts.end(), extensions.begin(), extensions.end());
+
+    std::vector<uint8_t> exts;
+    for (std::string_view ext : isa_exts) {
+        exts.insert(exts.end(), ext.begin(), ext.end());
+        exts.push_back('\0');
+    }
+
+    cpu.set_u32("phandle", phandle);
+    cpu.set_string("device_type", "cpu");
+    cpu.set_u32("reg", hartid);
+    cpu.set_string("status", "okay");
+    cpu.set_string("compatible", "riscv");
+    cpu.set_string("mmu-type", "riscv,sv39");
+    cpu.set_string("riscv,isa", isa);
+    cpu.set_string("riscv,isa-base", "rv64i");
+    cpu.set_prop("riscv,isa-extensions", std::move(exts));
+
+    Fdt::Node& intc = cpu.child("interrupt-controller");
+    intc.set_u32("#interrupt-cells", 1);
+    intc.set_empty("interrupt-controller");
+    intc.set_string("compatible", "riscv,cpu-intc");
+    intc.set_u32("phandle", intc_phandle);
+}
+
+} // namespace
+
+Fdt DeviceTree::build(const core::Bus& bus, const Config& cfg) {
+    Fdt fdt;
+    Fdt::Node& root = fdt.root();
+
+    root.set_u32("#address-cells", 2);
+    root.set_u32("#size-cells", 2);
+    root.set_string("compatible", "riscv-virt");
+    root.set_string("model", "uemu-ng");
+
+    // Fix the order of the fixed nodes; they are filled in below.
+    root.child("chosen");
+    root.child("cpus");
+
+    const addr_t base = core::Dram::DRAM_BASE;
+    Fdt::Node& memory = root.child(std::format("memory@{:x}", base));
+    memory.set_string("device_type", "memory");
+    memory.set_cells("reg", {static_cast<uint32_t>(base >> 32),
+                             static_cast<uint32_t>(base),
+                             static_cast<uint32_t>(cfg.dram_size >> 32),
+                             static_cast<uint32_t>(cfg.dram_size)});
+
+    // The soc node is built detached so that emitters may add nodes to the
+    // root without invalidating it.
+    Fdt::Node soc{.name = "soc", .props = {}, .children = {}};
+    soc.set_u32("#address-cells", 2);
+    soc.set_u32("#size-cells", 2);
+    soc.set_string("compatible", "simple-bus");
+    soc.set_empty("ranges");
+
+    device::DtContext ctx{.root = root, .soc = soc};
+    std::vector<uint32_t> cpu_phandles;
+
+    for (unsigned i = 0; i < cfg.num_harts; i++) {
+        cpu_phandles.push_back(ctx.alloc_phandle());
+        ctx.cpu_intc.push_back(ctx.alloc_phandle());
+    }
+
+    for (const auto& dev : bus.devices())
+        dev->emit_dt(ctx);
+
+    Fdt::Node& chosen = *root.find_child("chosen");
+    if (!cfg.bootargs.empty())
+        chosen.set_string("bootargs", cfg.bootargs);
+
+    Fdt::Node& cpus = *root.find_child("cpus");
+    cpus.set_u32("#address-cells", 1);
+    cpus.set_u32("#size-cells", 0);
+    cpus.set_u32("timebase-frequency",
+                 static_cast<uint32_t>(cfg.timebase_frequency));
+
+    Fdt::Node& cluster = cpus.child("cpu-map").child("cluster0");
+    for (unsigned i = 0; i < cfg.num_harts; i++)
+        cluster.child(std::format("core{}", i)).set_u32("cpu", cpu_phandles[i]);
+
+    for (unsigned i = 0; i < cfg.num_harts; i++)
+        add_cpu(cpus, i, cpu_phandles[i], ctx.cpu_intc[i], cfg.misa,
+                ctx.isa_extensions);
+
+    // Insert /soc after the memory and flash nodes, ahead of any syscon
+    // nodes that refer into it.
+    auto pos = std::ranges::find_if(root.children, [](const Fdt::Node& n) {
+        return n.name == "poweroff" || n.name == "reboot";
+    });
+    root.children.insert(pos, std::move(soc));
+
+    return fdt;
+}
+
+} // namespace uemu::utils
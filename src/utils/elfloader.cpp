@@ -14,12 +14,16 @@
  * limitations under the License.
  */
 
+#include <unistd.h>
+
+#include <algorithm>
 #include <cstring>
+#include <fstream>
 #include <print>
 #include <utility>
 
 #include "utils/elfloader.hpp"
-#include "utils/fileloader.hpp"
+#include "utils/mapped_file.hpp"
 
 namespace uemu::utils {
 
@@ -37,84 +41,136 @@ bool ElfLoader::is_elf(const std::filesystem::path& p) {
     } catch (...) { return false; }
 }
 
-uint64_t ElfLoader::load(const std::filesystem::path& p, core::Dram& dram) {
-    std::vector<uint8_t> data = FileLoader::read_file(p);
-    const auto* hdr = reinterpret_cast<const Elf64_Ehdr*>(data.data());
+ElfLoader::Image ElfLoader::load(const std::filesystem::path& p,
+                                 core::Dram& dram, bool map_segments) {
+    const MappedFile file(p);
+    const std::span<const uint8_t> data = file.data();
+    const Elf64_Ehdr* hdr = validate_elf_header(data);
 
-    validate_elf_header(hdr);
+    if (hdr->e_phoff + hdr->e_phnum * sizeof(Elf64_Phdr) > data.size())
+        throw std::runtime_error("Truncated ELF program headers");
 
     const auto* phdr =
         reinterpret_cast<const Elf64_Phdr*>(data.data() + hdr->e_phoff);
+    uint64_t load_base = UINT64_MAX;
+    std::vector<Segment> segments;
 
     for (int i = 0; std::cmp_less(i, hdr->e_phnum); i++) {
         if (phdr[i].p_type != PT_LOAD)
             continue;
 
+        load_base = std::min(load_base, phdr[i].p_vaddr);
+
         const uint64_t paddr = phdr[i].p_paddr;
         const size_t filesz = phdr[i].p_filesz;
         const size_t memsz = phdr[i].p_memsz;
-        const uint64_t offset = phdr[i].p_offset;
 
-        if (!dram.is_valid_addr(paddr, memsz)) [[unlikely]]
+        if (!dram.is_valid_addr(paddr, memsz) || filesz > memsz) [[unlikely]]
             throw std::out_of_range("Segment address outside DRAM bounds");
 
-        if (filesz > 0)
-            dram.write_bytes(paddr, data.data() + offset, filesz);
+        if (phdr[i].p_offset + filesz > data.size()) [[unlikely]]
+            throw std::runtime_error("Truncated ELF segment");
 
-        if (memsz > filesz) {
-            std::vector<uint8_t> zeros(memsz - filesz, 0);
-            dram.write_bytes(paddr + filesz, zeros.data(), zeros.size());
-        }
+        load_segment(file, phdr[i], dram, map_segments);
+        segments.push_back({.start = paddr, .end = paddr + memsz});
+
+        if (memsz > filesz)
+            dram.fill(paddr + filesz, 0, memsz - filesz);
     }
 
-    return hdr->e_entry;
+    return {.entry = hdr->e_entry,
+            .load_base = load_base,
+            .segments = std::move(segments),
+            .symbols = read_symbols(data)};
 }
 
-const Elf64_Shdr* ElfLoader::get_section_header(const uint8_t* file_data,
-                                                const char* name) {
-    const auto* hdr = reinterpret_cast<const Elf64_Ehdr*>(file_data);
-    if (hdr->e_shoff == 0 || hdr->e_shnum == 0)
-        return nullptr;
-
-    const auto* sh_tbl =
-        reinterpret_cast<const Elf64_Shdr*>(file_data + hdr->e_shoff);
-    const auto& str_sh = sh_tbl[hdr->e_shstrndx];
-    const char* sh_str_tbl =
-        reinterpret_cast<const char*>(file_data + str_sh.sh_offset);
-
-    for (int i = 0; std::cmp_less(i, hdr->e_shnum); i++) {
-        const char* sname = &sh_str_tbl[sh_tbl[i].sh_name];
-        if (std::strcmp(name, sname) == 0)
-            return &sh_tbl[i];
+void ElfLoader::load_segment(const MappedFile& file, const Elf64_Phdr& phdr,
+                             core::Dram& dram, bool map) {
+    const uint8_t* src = file.data().data() + phdr.p_offset;
+    const uint64_t offset = phdr.p_offset;
+    addr_t addr = phdr.p_paddr;
+    size_t len = phdr.p_filesz;
+
+    // File offset and address must agree modulo the host page size for the
+    // middle of the segment to be mapped instead of copied.
+    const auto page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    const uint64_t head = (page - (addr - core::Dram::DRAM_BASE) % page) % page;
+
+    if (map && (addr - core::Dram::DRAM_BASE) % page == offset % page &&
+        len >= head + page) {
+        const size_t middle = (len - head) / page * page;
+
+        if (dram.map_file(addr + head, file.fd(), offset + head, middle)) {
+            dram.write_bytes(addr, src, head);
+            addr += head + middle;
+            src += head + middle;
+            len -= head + middle;
+        }
     }
 
-    return nullptr;
+    if (len > 0)
+        dram.write_bytes(addr, src, len);
 }
 
-const Elf64_Sym* ElfLoader::get_symbol(const uint8_t* file_data,
-                                       const char* name) {
-    const Elf64_Shdr* sym_hdr = get_section_header(file_data, ".symtab");
-    const Elf64_Shdr* str_hdr = get_section_header(file_data, ".strtab");
+SymbolTable ElfLoader::read_symbols(std::span<const uint8_t> file) {
+    const Elf64_Ehdr* hdr = validate_elf_header(file);
+
+    if (hdr->e_shoff == 0 || hdr->e_shentsize != sizeof(Elf64_Shdr) ||
+        hdr->e_shoff + hdr->e_shnum * sizeof(Elf64_Shdr) > file.size())
+        return {};
+
+    const std::span<const Elf64_Shdr> sections(
+        reinterpret_cast<const Elf64_Shdr*>(file.data() + hdr->e_shoff),
+        hdr->e_shnum);
 
-    if (!sym_hdr || !str_hdr)
-        return nullptr;
+    std::vector<Symbol> symbols;
 
-    const auto* sym_tbl =
-        reinterpret_cast<const Elf64_Sym*>(file_data + sym_hdr->sh_offset);
-    const char* str_tbl =
-        reinterpret_cast<const char*>(file_data + str_hdr->sh_offset);
-    const size_t sym_count = sym_hdr->sh_size / sizeof(Elf64_Sym);
+    for (const Elf64_Shdr& symtab : sections) {
+        if (symtab.sh_type != SHT_SYMTAB || symtab.sh_link >= sections.size())
+            continue;
+
+        const Elf64_Shdr& strtab = sections[symtab.sh_link];
+        if (symtab.sh_offset + symtab.sh_size > file.size() ||
+            strtab.sh_offset + strtab.sh_size > file.size())
+            continue;
 
-    for (size_t i = 0; i < sym_count; i++) {
-        const char* sym_name = &str_tbl[sym_tbl[i].st_name];
-        if (std::strcmp(name, sym_name) == 0)
-            return &sym_tbl[i];
+        const std::span<const Elf64_Sym> syms(
+            reinterpret_cast<const Elf64_Sym*>(file.data() + symtab.sh_offset),
+            symtab.sh_size / sizeof(Elf64_Sym));
+        const std::string_view strings(
+            reinterpret_cast<const char*>(file.data() + strtab.sh_offset),
+            strtab.sh_size);
+
+        symbols.reserve(symbols.size() + syms.size());
+
+        for (const Elf64_Sym& sym : syms) {
+            const int type = ELF64_ST_TYPE(sym.st_info);
+            if (sym.st_shndx == SHN_UNDEF || sym.st_shndx == SHN_ABS ||
+                sym.st_name >= strings.size() ||
+                (type != STT_FUNC && type != STT_OBJECT && type != STT_NOTYPE))
+                continue;
+
+            const std::string_view rest = strings.substr(sym.st_name);
+            const std::string_view name = rest.substr(0, rest.find('\0'));
+            if (name.empty())
+                continue;
+
+            symbols.push_back({.name = std::string(name),
+                               .addr = sym.st_value,
+                               .size = sym.st_size});
+        }
     }
 
-    return nullptr;
+    return SymbolTable(std::move(symbols));
 }
 
-void ElfLoader::validate_elf_header(const Elf64_Ehdr* hdr) {
+const Elf64_Ehdr*
+ElfLoader::validate_elf_header(std::span<const uint8_t> file) {
+    if (file.size() < sizeof(Elf64_Ehdr))
+        throw std::runtime_error("File too small to be an ELF file");
+
+    const auto* hdr = reinterpret_cast<const Elf64_Ehdr*>(file.data());
+
     if (std::memcmp(hdr->e_ident, ELFMAG, SELFMAG) != 0)
         throw std::runtime_error("Invalid ELF magic number");
 
@@ -123,6 +179,8 @@ void ElfLoader::validate_elf_header(const Elf64_Ehdr* hdr) {
 
     if (hdr->e_machine != EM_RISCV)
         throw std::runtime_error("Not a RISC-V ELF file");
+
+    return hdr;
 }
 
 }; // namespace uemu::utils
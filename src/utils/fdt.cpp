@@ -0,0 +1,359 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <map>
+#include <stdexcept>
+
+#include "utils/fdt.hpp"
+
+namespace uemu::utils {
+
+namespace {
+
+constexpr uint32_t FDT_BEGIN_NODE = 0x1;
+constexpr uint32_t FDT_END_NODE = 0x2;
+constexpr uint32_t FDT_PROP = 0x3;
+constexpr uint32_t FDT_NOP = 0x4;
+constexpr uint32_t FDT_END = 0x9;
+
+constexpr size_t HEADER_SIZE = 40;
+
+uint32_t load_be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void append_be32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void store_be32(std::vector<uint8_t>& out, size_t off, uint32_t v) {
+    out[off] = static_cast<uint8_t>(v >> 24);
+    out[off + 1] = static_cast<uint8_t>(v >> 16);
+    out[off + 2] = static_cast<uint8_t>(v >> 8);
+    out[off + 3] = static_cast<uint8_t>(v);
+}
+
+void pad4(std::vector<uint8_t>& out) {
+    while (out.size() % 4)
+        out.push_back(0);
+}
+
+[[noreturn]] void malformed(std::string_view what) {
+    throw std::runtime_error(std::format("Fdt: malformed blob ({})", what));
+}
+
+class Parser {
+public:
+    Parser(std::span<const uint8_t> structs, std::span<const uint8_t> strings)
+        : structs_(structs), strings_(strings) {}
+
+    void parse_node(Fdt::Node& node) {
+        node.name = read_string();
+
+        while (true) {
+            const uint32_t token = read_u32();
+
+            switch (token) {
+                case FDT_NOP: break;
+
+                case FDT_PROP: {
+                    const uint32_t len = read_u32();
+                    const uint32_t nameoff = read_u32();
+                    if (len > structs_.size() - pos_)
+                        malformed("property overruns struct block");
+                    node.props.push_back(
+                        {.name = string_at(nameoff),
+                         .value = {structs_.begin() + pos_,
+                                   structs_.begin() + pos_ + len}});
+                    pos_ = (pos_ + len + 3) & ~size_t{3};
+                    break;
+                }
+
+                case FDT_BEGIN_NODE:
+                    parse_node(node.children.emplace_back());
+                    break;
+
+                case FDT_END_NODE: return;
+
+                default: malformed("unexpected token");
+            }
+        }
+    }
+
+    uint32_t read_u32() {
+        if (pos_ + 4 > structs_.size())
+            malformed("truncated struct block");
+        const uint32_t v = load_be32(structs_.data() + pos_);
+        pos_ += 4;
+        return v;
+    }
+
+private:
+    std::string read_string() {
+        const auto* begin = structs_.data() + pos_;
+        const size_t max = structs_.size() - pos_;
+        const size_t len = strnlen(reinterpret_cast<const char*>(begin), max);
+        if (len == max)
+            malformed("unterminated node name");
+
+        std::string s(reinterpret_cast<const char*>(begin), len);
+        pos_ = (pos_ + len + 1 + 3) & ~size_t{3};
+        return s;
+    }
+
+    std::string string_at(uint32_t off) const {
+        if (off >= strings_.size())
+            malformed("bad string offset");
+        const auto* p = reinterpret_cast<const char*>(strings_.data() + off);
+        return {p, strnlen(p, strings_.size() - off)};
+    }
+
+    std::span<const uint8_t> structs_;
+    std::span<const uint8_t> strings_;
+    size_t pos_ = 0;
+};
+
+class Writer {
+public:
+    void write_node(const Fdt::Node& node) {
+        append_be32(structs_, FDT_BEGIN_NODE);
+        structs_.insert(structs_.end(), node.name.begin(), node.name.end());
+        structs_.push_back(0);
+        pad4(structs_);
+
+        for (const auto& prop : node.props) {
+            append_be32(structs_, FDT_PROP);
+            append_be32(structs_, static_cast<uint32_t>(prop.value.size()));
+            append_be32(structs_, string_offset(prop.name));
+            structs_.insert(structs_.end(), prop.value.begin(),
+                            prop.value.end());
+            pad4(structs_);
+        }
+
+        for (const auto& child : node.children)
+            write_node(child);
+
+        append_be32(structs_, FDT_END_NODE);
+    }
+
+    std::vector<uint8_t> finish(uint32_t boot_cpuid_phys) {
+        append_be32(structs_, FDT_END);
+
+        // Header, one empty memory reservation entry, structs, strings
+        constexpr size_t rsvmap_off = HEADER_SIZE;
+        constexpr size_t struct_off = rsvmap_off + 16;
+        const size_t strings_off = struct_off + structs_.size();
+        const size_t total = strings_off + strings_.size();
+
+        std::vector<uint8_t> out(struct_off, 0);
+        out.insert(out.end(), structs_.begin(), structs_.end());
+        out.insert(out.end(), strings_.begin(), strings_.end());
+
+        store_be32(out, 0, Fdt::MAGIC);
+        store_be32(out, 4, static_cast<uint32_t>(total));
+        store_be32(out, 8, static_cast<uint32_t>(struct_off));
+        store_be32(out, 12, static_cast<uint32_t>(strings_off));
+        store_be32(out, 16, static_cast<uint32_t>(rsvmap_off));
+        store_be32(out, 20, Fdt::VERSION);
+        store_be32(out, 24, Fdt::LAST_COMP_VERSION);
+        store_be32(out, 28, boot_cpuid_phys);
+        store_be32(out, 32, static_cast<uint32_t>(strings_.size()));
+        store_be32(out, 36, static_cast<uint32_t>(structs_.size()));
+
+        return out;
+    }
+
+private:
+    uint32_t string_offset(const std::string& name) {
+        auto [it, inserted] = string_offsets_.try_emplace(
+            name, static_cast<uint32_t>(strings_.size()));
+
+        if (inserted) {
+            strings_.insert(strings_.end(), name.begin(), name.end());
+            strings_.push_back(0);
+        }
+
+        return it->second;
+    }
+
+    std::vector<uint8_t> structs_;
+    std::vector<uint8_t> strings_;
+    std::map<std::string, uint32_t, std::less<>> string_offsets_;
+};
+
+} // namespace
+
+Fdt::Node* Fdt::Node::find_child(std::string_view child_name) {
+    auto it = std::ranges::find(children, child_name, &FdtNode::name);
+    return it == children.end() ? nullptr : &*it;
+}
+
+const Fdt::Property*
+Fdt::Node::find_prop(std::string_view prop_name) const {
+    auto it = std::ranges::find(props, prop_name, &FdtProperty::name);
+    return it == props.end() ? nullptr : &*it;
+}
+
+Fdt::Node& Fdt::Node::child(std::string_view child_name) {
+    if (FdtNode* existing = find_child(child_name))
+        return *existing;
+
+    FdtNode& node = children.emplace_back();
+    node.name = child_name;
+    return node;
+}
+
+void Fdt::Node::set_prop(std::string_view prop_name,
+                         std::vector<uint8_t> value) {
+    auto it = std::ranges::find(props, prop_name, &FdtProperty::name);
+
+    if (it != props.end())
+        it->value = std::move(value);
+    else
+        props.push_back({.name = std::string(prop_name),
+                         .value = std::move(value)});
+}
+
+void Fdt::Node::set_empty(std::string_view prop_name) {
+    set_prop(prop_name, {});
+}
+
+void Fdt::Node::set_u32(std::string_view prop_name, uint32_t value) {
+    set_cells(prop_name, {value});
+}
+
+void Fdt::Node::set_u64(std::string_view prop_name, uint64_t value) {
+    set_cells(prop_name, {static_cast<uint32_t>(value >> 32),
+                          static_cast<uint32_t>(value)});
+}
+
+void Fdt::Node::set_string(std::string_view prop_name, std::string_view value) {
+    set_strings(prop_name, {value});
+}
+
+void Fdt::Node::set_strings(std::string_view prop_name,
+                            std::initializer_list<std::string_view> values) {
+    std::vector<uint8_t> bytes;
+
+    for (std::string_view v : values) {
+        bytes.insert(bytes.end(), v.begin(), v.end());
+        bytes.push_back(0);
+    }
+
+    set_prop(prop_name, std::move(bytes));
+}
+
+void Fdt::Node::set_cells(std::string_view prop_name,
+                          std::initializer_list<uint32_t> cells) {
+    set_cells(prop_name, std::span<const uint32_t>(cells.begin(), cells.end()));
+}
+
+void Fdt::Node::set_cells(std::string_view prop_name,
+                          std::span<const uint32_t> cells) {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(cells.size() * 4);
+
+    for (uint32_t c : cells)
+        append_be32(bytes, c);
+
+    set_prop(prop_name, std::move(bytes));
+}
+
+void Fdt::Node::append_cells(std::string_view prop_name,
+                             std::span<const uint32_t> cells) {
+    for (FdtProperty& p : props) {
+        if (p.name == prop_name) {
+            for (uint32_t c : cells)
+                append_be32(p.value, c);
+            return;
+        }
+    }
+
+    set_cells(prop_name, cells);
+}
+
+void Fdt::Node::remove_prop(std::string_view prop_name) {
+    std::erase_if(props, [prop_name](const FdtProperty& p) {
+        return p.name == prop_name;
+    });
+}
+
+Fdt Fdt::parse(std::span<const uint8_t> blob) {
+    if (blob.size() < HEADER_SIZE || load_be32(blob.data()) != MAGIC)
+        malformed("bad header");
+
+    const uint32_t total = load_be32(blob.data() + 4);
+    const uint32_t struct_off = load_be32(blob.data() + 8);
+    const uint32_t strings_off = load_be32(blob.data() + 12);
+    const uint32_t version = load_be32(blob.data() + 20);
+    const uint32_t strings_size = load_be32(blob.data() + 32);
+    const uint32_t struct_size = load_be32(blob.data() + 36);
+
+    if (version < LAST_COMP_VERSION || total > blob.size() ||
+        struct_off > total || struct_size > total - struct_off ||
+        strings_off > total || strings_size > total - strings_off)
+        malformed("bad block layout");
+
+    Fdt fdt;
+    fdt.boot_cpuid_phys = load_be32(blob.data() + 28);
+
+    Parser parser(blob.subspan(struct_off, struct_size),
+                  blob.subspan(strings_off, strings_size));
+
+    uint32_t token = parser.read_u32();
+    while (token == FDT_NOP)
+        token = parser.read_u32();
+
+    if (token != FDT_BEGIN_NODE)
+        malformed("missing root node");
+
+    parser.parse_node(fdt.root_);
+
+    return fdt;
+}
+
+std::vector<uint8_t> Fdt::serialize() const {
+    Writer writer;
+    writer.write_node(root_);
+    return writer.finish(boot_cpuid_phys);
+}
+
+Fdt::Node* Fdt::find(std::string_view path) {
+    if (path.empty() || path.front() != '/')
+        return nullptr;
+
+    Node* node = &root_;
+    path.remove_prefix(1);
+
+    while (node && !path.empty()) {
+        const size_t slash = path.find('/');
+        node = node->find_child(path.substr(0, slash));
+        path = slash == std::string_view::npos ? std::string_view{}
+                                               : path.substr(slash + 1);
+    }
+
+    return node;
+}
+
+} // namespace uemu::utils
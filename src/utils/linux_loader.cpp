@@ -0,0 +1,129 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <print>
+
+#include "utils/fileloader.hpp"
+#include "utils/linux_loader.hpp"
+
+namespace uemu::utils {
+
+namespace {
+
+constexpr addr_t align_down(addr_t v, addr_t a) { return v & ~(a - 1); }
+
+constexpr addr_t align_up(addr_t v, addr_t a) {
+    return (v + a - 1) & ~(a - 1);
+}
+
+uint64_t load_le64(const uint8_t* p) {
+    uint64_t v = 0;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+} // namespace
+
+addr_t LinuxLoader::fdt_address(const core::Dram& dram) noexcept {
+    constexpr addr_t FDT_ALIGN = 0x200000;
+    constexpr addr_t FDT_LIMIT = 3ULL << 30;
+
+    const addr_t dram_base = core::Dram::DRAM_BASE;
+    const addr_t top = std::min(dram_base + dram.size(), dram_base + FDT_LIMIT);
+    return align_down(top - MAX_FDT_SIZE, FDT_ALIGN);
+}
+
+LinuxLoader::BootInfo LinuxLoader::load(const Options& opts, Fdt& fdt,
+                                        core::Dram& dram) {
+    constexpr addr_t PAGE_SIZE = 0x1000;
+
+    const addr_t dram_base = core::Dram::DRAM_BASE;
+    const addr_t dram_end = dram_base + dram.size();
+
+    BootInfo info{};
+    const std::vector<uint8_t> image = FileLoader::read_file(opts.kernel);
+
+    // RISC-V Image header: text_offset @8, image_size @16, magic2 @56
+    addr_t text_offset = DEFAULT_TEXT_OFFSET;
+    uint64_t image_size = image.size();
+
+    if (image.size() >= 64) {
+        uint32_t magic2 = 0;
+        std::memcpy(&magic2, image.data() + 56, sizeof(magic2));
+
+        if (magic2 == IMAGE_MAGIC2) {
+            text_offset = load_le64(image.data() + 8);
+            image_size = std::max<uint64_t>(load_le64(image.data() + 16),
+                                            image.size());
+        }
+    }
+
+    info.entry = dram_base + text_offset;
+    const addr_t kernel_end = info.entry + image_size;
+
+    if (kernel_end > dram_end)
+        throw std::runtime_error("Kernel image does not fit in DRAM");
+
+    dram.write_bytes(info.entry, image.data(), image.size());
+
+    // The device tree goes at the top of (low) DRAM and the initrd just
+    // below it, as QEMU's virt machine does.
+    const addr_t dtb_addr = fdt_address(dram);
+
+    Fdt::Node& chosen = fdt.root().child("chosen");
+
+    if (!opts.append.empty())
+        chosen.set_string("bootargs", opts.append);
+
+    if (!opts.initrd.empty()) {
+        const std::vector<uint8_t> initrd = FileLoader::read_file(opts.initrd);
+
+        if (initrd.size() > dtb_addr - dram_base ||
+            align_down(dtb_addr - initrd.size(), PAGE_SIZE) <
+                align_up(kernel_end, PAGE_SIZE))
+            throw std::runtime_error("Initrd does not fit in DRAM");
+
+        info.initrd_start = align_down(dtb_addr - initrd.size(), PAGE_SIZE);
+        info.initrd_end = info.initrd_start + initrd.size();
+        dram.write_bytes(info.initrd_start, initrd.data(), initrd.size());
+
+        chosen.set_u64("linux,initrd-start", info.initrd_start);
+        chosen.set_u64("linux,initrd-end", info.initrd_end);
+    } else {
+        chosen.remove_prop("linux,initrd-start");
+        chosen.remove_prop("linux,initrd-end");
+    }
+
+    const std::vector<uint8_t> blob = fdt.serialize();
+
+    if (blob.size() > MAX_FDT_SIZE || dtb_addr < kernel_end)
+        throw std::runtime_error("Device tree does not fit in DRAM");
+
+    info.dtb_addr = dtb_addr;
+    dram.write_bytes(dtb_addr, blob.data(), blob.size());
+
+    std::println("Linux boot: kernel entry 0x{:x}, dtb 0x{:x} ({} bytes)",
+                 info.entry, info.dtb_addr, blob.size());
+    if (info.initrd_end)
+        std::println("            initrd [0x{:x}-0x{:x})", info.initrd_start,
+                     info.initrd_end);
+
+    return info;
+}
+
+} // namespace uemu::utils
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "utils/mapped_file.hpp"
+
+namespace uemu::utils {
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+    : fd_(::open(path.c_str(), O_RDONLY | O_CLOEXEC)), data_(nullptr),
+      size_(0) {
+    if (fd_ < 0)
+        throw std::runtime_error("Failed to open file: " + path.string());
+
+    struct stat st;
+    if (::fstat(fd_, &st) < 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd_);
+        throw std::runtime_error("Not a regular file: " + path.string());
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+
+    // mmap rejects empty mappings; an empty span is fine.
+    if (size_ == 0)
+        return;
+
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (p == MAP_FAILED) {
+        const int err = errno;
+        ::close(fd_);
+        throw std::runtime_error("Failed to map file: " + path.string() +
+                                 ": " + std::strerror(err));
+    }
+
+    data_ = static_cast<const uint8_t*>(p);
+}
+
+MappedFile::~MappedFile() {
+    if (data_)
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+    ::close(fd_);
+}
+
+} // namespace uemu::utils
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "utils/symbol_table.hpp"
+
+namespace uemu::utils {
+
+SymbolTable::SymbolTable(std::vector<Symbol> symbols)
+    : by_addr_(std::move(symbols)) {
+    // Sized symbols first among equal addresses, so find() prefers them
+    // over labels sharing the address.
+    std::ranges::stable_sort(by_addr_, [](const Symbol& a, const Symbol& b) {
+        return a.addr != b.addr ? a.addr < b.addr : a.size > b.size;
+    });
+
+    by_name_.reserve(by_addr_.size());
+    for (const Symbol& sym : by_addr_)
+        by_name_.try_emplace(sym.name, sym.addr);
+}
+
+SymbolTable SymbolTable::load_system_map(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Failed to open file: " + path.string());
+
+    std::vector<Symbol> symbols;
+    std::string line;
+
+    // "<hex address> <type> <name>"; lowercase types are local symbols.
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string addr;
+        char type = 0;
+        Symbol sym{.name = {}, .addr = 0, .size = 0};
+
+        if (!(fields >> addr >> type >> sym.name))
+            continue;
+        if (type != 'T' && type != 't' && type != 'W' && type != 'w')
+            continue;
+
+        const char* end = addr.data() + addr.size();
+        if (std::from_chars(addr.data(), end, sym.addr, 16).ptr != end)
+            continue;
+
+        symbols.push_back(std::move(sym));
+    }
+
+    return SymbolTable(std::move(symbols));
+}
+
+std::optional<uint64_t> SymbolTable::lookup(std::string_view name) const {
+    const auto it = by_name_.find(name);
+    if (it == by_name_.end())
+        return std::nullopt;
+    return it->second;
+}
+
+const Symbol* SymbolTable::find(uint64_t addr) const noexcept {
+    auto it = std::ranges::upper_bound(by_addr_, addr, {}, &Symbol::addr);
+    if (it == by_addr_.begin())
+        return nullptr;
+
+    // Step back to the first entry at the closest address.
+    const uint64_t base = (--it)->addr;
+    while (it != by_addr_.begin() && std::prev(it)->addr == base)
+        --it;
+
+    if (it->size != 0 && addr - it->addr >= it->size)
+        return nullptr;
+    return &*it;
+}
+
+} // namespace uemu::utils
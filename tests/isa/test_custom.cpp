@@ -14,6 +14,16 @@
  * limitations under the License.
  */
 
+#include <elf.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "core/dram.hpp"
@@ -24,6 +34,47 @@ namespace uemu::test {
 
 constexpr size_t TEST_DRAM_SIZE = 32 * 1024 * 1024;
 
+namespace {
+
+// A static ELF with one RWX segment of `memsz` bytes at `addr`, holding
+// `code` and then bss
+void write_elf(const std::filesystem::path& path, uint16_t type, addr_t addr,
+               std::span<const uint32_t> code, size_t memsz) {
+    std::vector<uint8_t> image(0x1000 + code.size_bytes(), 0);
+    Elf64_Ehdr ehdr{};
+    std::memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_type = type;
+    ehdr.e_machine = EM_RISCV;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_entry = addr;
+    ehdr.e_phoff = sizeof(Elf64_Ehdr);
+    ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr.e_phentsize = sizeof(Elf64_Phdr);
+    ehdr.e_phnum = 1;
+
+    Elf64_Phdr phdr{};
+    phdr.p_type = PT_LOAD;
+    phdr.p_flags = PF_R | PF_W | PF_X;
+    phdr.p_offset = 0x1000;
+    phdr.p_vaddr = phdr.p_paddr = addr;
+    phdr.p_filesz = code.size_bytes();
+    phdr.p_memsz = memsz;
+    phdr.p_align = 0x1000;
+
+    std::memcpy(image.data(), &ehdr, sizeof(ehdr));
+    std::memcpy(image.data() + sizeof(ehdr), &phdr, sizeof(phdr));
+    std::memcpy(image.data() + 0x1000, code.data(), code.size_bytes());
+
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char*>(image.data()),
+               static_cast<std::streamsize>(image.size()));
+}
+
+} // namespace
+
 // Execute a simple program for 64 times
 TEST(CustomISATest, BasicExecution) {
     constexpr size_t REPEAT_TIMES = 64;
@@ -351,4 +402,167 @@ TEST(CustomISATest, Sv39Test) {
     EXPECT_EQ(emulator.shutdown_status(), device::SiFiveTest::Status::PASS);
 }
 
+TEST(CustomISATest, LoadEmptyFile) {
+    const auto path =
+        std::filesystem::temp_directory_path() / "uemu_test_empty.bin";
+    std::ofstream(path).close();
+
+    Emulator emulator(TEST_DRAM_SIZE);
+    EXPECT_NO_THROW(emulator.load(core::Dram::DRAM_BASE, path));
+
+    std::filesystem::remove(path);
+}
+
+// A checkpoint holds no interrupt controller state.
+TEST(CustomISATest, CheckpointNeedsNoIrqchip) {
+    const auto path =
+        std::filesystem::temp_directory_path() / "uemu_test_irqchip.ckpt";
+
+    // Refused before the missing files are even looked at
+    const auto refusal = [](auto&& action) -> std::string {
+        try {
+            action();
+        } catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return {};
+    };
+
+    Emulator emulator(TEST_DRAM_SIZE);
+    EXPECT_NE(refusal([&] { emulator.restore_checkpoint(path); })
+                  .find("irqchip"),
+              std::string::npos);
+    EXPECT_NE(refusal([&] {
+                  emulator.save_simpoint_checkpoints(path, 1, 0, path);
+              }).find("irqchip"),
+              std::string::npos);
+}
+
+// WFI retires like any other instruction, so the basic-block vectors
+// split at the same instruction counts as the checkpoint milestones.
+TEST(CustomISATest, BbvCountsWfi) {
+    // 10 times: mtimecmp = mtime + 100, then wfi; exit via SiFiveTest.
+    // 70 instructions in total.
+    std::vector<uint8_t> firmware = {
+        0x93, 0x02, 0x00, 0x08, 0x73, 0x90, 0x42, 0x30, 0x37, 0x43, 0x00, 0x02,
+        0x37, 0xce, 0x00, 0x02, 0x1b, 0x0e, 0x8e, 0xff, 0x93, 0x03, 0xa0, 0x00,
+        0x83, 0x3e, 0x0e, 0x00, 0x93, 0x8e, 0x4e, 0x06, 0x23, 0x30, 0xd3, 0x01,
+        0x73, 0x00, 0x50, 0x10, 0x93, 0x83, 0xf3, 0xff, 0xe3, 0x96, 0x03, 0xfe,
+        0x37, 0x03, 0x10, 0x00, 0xb7, 0x52, 0x00, 0x00, 0x9b, 0x82, 0x52, 0x55,
+        0x23, 0x20, 0x53, 0x00, 0x6f, 0x00, 0x00, 0x00,
+    };
+    const auto path =
+        std::filesystem::temp_directory_path() / "uemu_test_wfi.bb";
+
+    std::string stats;
+    {
+        Emulator emulator(TEST_DRAM_SIZE);
+        emulator.enable_bbv({.output = path, .interval = 16});
+        emulator.load(core::Dram::DRAM_BASE, firmware);
+        emulator.run();
+        ASSERT_EQ(emulator.shutdown_status(), device::SiFiveTest::Status::PASS);
+        stats = emulator.stats_json();
+    }
+    EXPECT_NE(stats.find("\"instructions\": 70,"), std::string::npos);
+
+    std::ifstream in(path);
+    std::vector<uint64_t> sums;
+    for (std::string line; std::getline(in, line);) {
+        uint64_t sum = 0;
+        for (size_t pos = line.find(' '); pos != std::string::npos;
+             pos = line.find(' ', pos + 1))
+            sum += std::stoull(line.substr(line.rfind(':', pos) + 1));
+        sums.push_back(sum);
+    }
+    EXPECT_EQ(sums, (std::vector<uint64_t>{16, 16, 16, 16, 6}));
+
+    std::filesystem::remove(path);
+}
+
+// Two guest threads of a Linux executable: the parent spins until the child
+// sets a flag, which only works if the time slice switches threads.
+TEST(CustomISATest, UserThreadsArePreempted) {
+    constexpr addr_t TEXT = 0x10000;
+    constexpr uint32_t CODE[] = {
+        0x0dc00893, // li a7, 220 (clone)
+        0x00051537, // lui a0, 0x51
+        0xf005051b, // addiw a0, a0, -256 (VM|FS|FILES|SIGHAND|THREAD|SYSVSEM)
+        0x000125b7, // lui a1, 0x12 (child stack)
+        0x00000613, // li a2, 0
+        0x00000693, // li a3, 0
+        0x00000713, // li a4, 0
+        0x00000073, // ecall
+        0x000102b7, // lui t0, 0x10
+        0x1002829b, // addiw t0, t0, 256 (flag)
+        0x00050c63, // beqz a0, child
+        0x0002a303, // 1: lw t1, 0(t0)
+        0xfe030ee3, // beqz t1, 1b
+        0x02a00513, // li a0, 42
+        0x05e00893, // li a7, 94 (exit_group)
+        0x00000073, // ecall
+        0x00100313, // child: li t1, 1
+        0x0062a023, // sw t1, 0(t0)
+        0x0000006f, // j .
+    };
+
+    // The flag and the child stack are bss.
+    const auto exe =
+        std::filesystem::temp_directory_path() / "uemu_user_threads.elf";
+    write_elf(exe, ET_EXEC, TEXT, CODE, 0x3000);
+
+    Emulator emulator(TEST_DRAM_SIZE);
+    emulator.load_user({.exe = exe, .argv = {}, .envp = {}, .sysroot = {}});
+    emulator.run(std::chrono::seconds(10));
+    EXPECT_EQ(emulator.shutdown_code(), 42);
+
+    std::filesystem::remove(exe);
+}
+
+// An image over the usual device tree spot near the top of DRAM pushes the
+// DTB past its end; the guest checks the magic at a1 and reports where.
+TEST(CustomISATest, DtbAvoidsElfSegments) {
+    constexpr addr_t BASE = 0x81E00000; // fdt_address() of a 32 MiB DRAM
+    constexpr uint32_t CODE[] = {
+        0x0005e283, // lwu t0, 0(a1)
+        0x000ee337, // lui t1, 0xee
+        0xfe13031b, // addiw t1, t1, -31
+        0x00c31313, // slli t1, t1, 12
+        0xdd030313, // addi t1, t1, -560 (0xedfe0dd0: FDT magic)
+        0x00100e37, // lui t3, 0x100 (SiFiveTest)
+        0x02629463, // bne t0, t1, 1f
+        0x40f00393, // li t2, 1039
+        0x01539393, // slli t2, t2, 21 (BASE)
+        0x407583b3, // sub t2, a1, t2
+        0x00c3d393, // srli t2, t2, 12
+        0x01039393, // slli t2, t2, 16
+        0x00005eb7, // lui t4, 5
+        0x555e8e9b, // addiw t4, t4, 1365 (PASS)
+        0x01d3e3b3, // or t2, t2, t4
+        0x007e2023, // sw t2, 0(t3)
+        0x000133b7, // 1: lui t2, 19
+        0x3333839b, // addiw t2, t2, 819 (FAIL, code 1)
+        0x007e2023, // sw t2, 0(t3)
+        0x0000006f, // j .
+    };
+
+    const auto path = std::filesystem::temp_directory_path() / "uemu_dtb.elf";
+    write_elf(path, ET_EXEC, BASE, CODE, 0x1800);
+
+    {
+        Emulator emulator(TEST_DRAM_SIZE);
+        emulator.loadelf(path);
+        emulator.run();
+        EXPECT_EQ(emulator.shutdown_code(), 2); // Pages past BASE
+        EXPECT_EQ(emulator.shutdown_status(),
+                  device::SiFiveTest::Status::PASS);
+    }
+
+    // Up to the end of DRAM, nothing is left for the device tree.
+    write_elf(path, ET_EXEC, BASE, CODE, 0x200000);
+    Emulator emulator(TEST_DRAM_SIZE);
+    EXPECT_THROW(emulator.loadelf(path), std::runtime_error);
+
+    std::filesystem::remove(path);
+}
+
 } // namespace uemu::test
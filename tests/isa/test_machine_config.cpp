@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "emulator.hpp"
+#include "machine_config.hpp"
+
+namespace uemu::test {
+
+namespace {
+
+using Devices = std::set<std::pair<std::string, addr_t>>;
+
+constexpr size_t DRAM_SIZE = 32 * 1024 * 1024;
+
+const Devices MINIMAL_DEVICES = {
+    {"CLINT", 0x2000000},
+    {"SiFiveTest", 0x100000},
+    {"NemuConsole", 0x10008000},
+};
+
+const Devices TEST_DEVICES = {
+    {"CLINT", 0x2000000},
+    {"SiFiveTest", 0x100000},
+    {"NemuConsole", 0x10008000},
+    {"TestIntrGen", 0x40000000},
+    {"PLIC", 0xc000000},
+    {"NS16550", 0x10000000},
+};
+
+// Without a disk image, so no virtio-blk
+const Devices DESKTOP_DEVICES = {
+    {"CLINT", 0x2000000},
+    {"SiFiveTest", 0x100000},
+    {"NemuConsole", 0x10008000},
+    {"TestIntrGen", 0x40000000},
+    {"PLIC", 0xc000000},
+    {"NS16550", 0x10000000},
+    {"SimpleFB", 0x50000000},
+    {"pflash-cfi01", 0x20000000},
+    {"pflash-cfi01", 0x22000000},
+    {"GoldfishEvents", 0x10002000},
+    {"GoldfishRTC", 0x101000},
+    {"GoldfishBattery", 0x10003000},
+    {"PvClock", 0x10005000},
+    {"BCM2835Rng", 0x10004000},
+};
+
+Devices bus_devices(const Emulator& emulator) {
+    Devices devices;
+    for (const auto& dev : emulator.bus().devices())
+        devices.emplace(dev->name(), dev->start());
+    return devices;
+}
+
+std::unique_ptr<Emulator> build(MachineConfig::Profile profile) {
+    MachineConfig machine = MachineConfig::profile(profile, DRAM_SIZE);
+    machine.verbose = false;
+    return std::make_unique<Emulator>(machine);
+}
+
+} // namespace
+
+TEST(MachineConfigTest, ParsesProfileNames) {
+    EXPECT_EQ(MachineConfig::parse_profile("minimal"),
+              MachineConfig::Profile::Minimal);
+    EXPECT_EQ(MachineConfig::parse_profile("test"),
+              MachineConfig::Profile::Test);
+    EXPECT_EQ(MachineConfig::parse_profile("desktop"),
+              MachineConfig::Profile::Desktop);
+    EXPECT_THROW(std::ignore = MachineConfig::parse_profile("server"),
+                 std::invalid_argument);
+}
+
+TEST(MachineConfigTest, MinimalProfile) {
+    const auto emulator = build(MachineConfig::Profile::Minimal);
+    EXPECT_EQ(bus_devices(*emulator), MINIMAL_DEVICES);
+
+    utils::Fdt fdt = emulator->device_tree();
+    EXPECT_NE(fdt.find("/soc/clint@2000000"), nullptr);
+    EXPECT_NE(fdt.find("/soc/sifive_test@100000"), nullptr);
+    EXPECT_NE(fdt.find("/poweroff"), nullptr);
+    EXPECT_EQ(fdt.find("/soc/interrupt-controller@c000000"), nullptr);
+    EXPECT_EQ(fdt.find("/soc/uart@10000000"), nullptr);
+}
+
+TEST(MachineConfigTest, TestProfile) {
+    const auto emulator = build(MachineConfig::Profile::Test);
+    EXPECT_EQ(bus_devices(*emulator), TEST_DEVICES);
+
+    utils::Fdt fdt = emulator->device_tree();
+    EXPECT_NE(fdt.find("/soc/clint@2000000"), nullptr);
+    EXPECT_NE(fdt.find("/soc/sifive_test@100000"), nullptr);
+    EXPECT_NE(fdt.find("/soc/interrupt-controller@c000000"), nullptr);
+    EXPECT_NE(fdt.find("/soc/uart@10000000"), nullptr);
+    EXPECT_EQ(fdt.find("/soc/frame-buffer@50000000"), nullptr);
+    EXPECT_EQ(fdt.find("/flash@20000000"), nullptr);
+}
+
+TEST(MachineConfigTest, DesktopProfile) {
+    const auto emulator = build(MachineConfig::Profile::Desktop);
+    EXPECT_EQ(bus_devices(*emulator), DESKTOP_DEVICES);
+
+    utils::Fdt fdt = emulator->device_tree();
+    for (const char* path :
+         {"/soc/clint@2000000", "/soc/sifive_test@100000",
+          "/soc/interrupt-controller@c000000", "/soc/uart@10000000",
+          "/soc/frame-buffer@50000000", "/soc/events@10002000",
+          "/soc/rtc@101000", "/soc/goldfish_battery@10003000",
+          "/soc/rng@10004000", "/flash@20000000"})
+        EXPECT_NE(fdt.find(path), nullptr);
+}
+
+} // namespace uemu::test
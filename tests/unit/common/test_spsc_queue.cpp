@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "common/spsc_queue.hpp"
+
+namespace uemu::test {
+
+TEST(SpscQueueTest, FifoOrderAndCapacity) {
+    SpscQueue<int, 4> q;
+
+    EXPECT_TRUE(q.empty());
+    EXPECT_FALSE(q.pop().has_value());
+
+    EXPECT_TRUE(q.push(1));
+    EXPECT_TRUE(q.push(2));
+    EXPECT_TRUE(q.push(3));
+    EXPECT_FALSE(q.push(4)); // Usable capacity is N - 1
+
+    EXPECT_EQ(q.pop().value(), 1);
+    EXPECT_TRUE(q.push(4));
+    EXPECT_EQ(q.pop().value(), 2);
+    EXPECT_EQ(q.pop().value(), 3);
+    EXPECT_EQ(q.pop().value(), 4);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(SpscQueueTest, ConcurrentProducerConsumer) {
+    constexpr uint32_t COUNT = 100000;
+    SpscQueue<uint32_t, 64> q;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < COUNT; i++)
+            while (!q.push(i))
+                std::this_thread::yield();
+    });
+
+    uint32_t expected = 0;
+    while (expected < COUNT) {
+        if (auto v = q.pop())
+            EXPECT_EQ(*v, expected++);
+        else
+            std::this_thread::yield();
+    }
+
+    producer.join();
+    EXPECT_TRUE(q.empty());
+}
+
+} // namespace uemu::test
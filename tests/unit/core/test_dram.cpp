@@ -86,6 +86,20 @@ TEST_F(DramTest, BulkByteOperations) {
     EXPECT_STREQ(secret, buffer);
 }
 
+// Fill clears a range in place; out-of-range fills throw.
+TEST_F(DramTest, Fill) {
+    uemu::addr_t addr = core::Dram::DRAM_BASE + 0x300;
+
+    dram->write<uint64_t>(addr, ~0ULL);
+    dram->write<uint64_t>(addr + 8, ~0ULL);
+    dram->fill(addr + 4, 0, 8);
+
+    EXPECT_EQ(dram->read<uint64_t>(addr), 0x00000000FFFFFFFFULL);
+    EXPECT_EQ(dram->read<uint64_t>(addr + 8), 0xFFFFFFFF00000000ULL);
+    EXPECT_THROW(dram->fill(core::Dram::DRAM_BASE + TEST_DRAM_SIZE - 4, 0, 8),
+                 std::out_of_range);
+}
+
 // Test that out-of-bounds byte operations throw std::out_of_range.
 TEST_F(DramTest, ExceptionHandling) {
     uint8_t dummy[10]{};
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <cerrno>
+
+#include <gtest/gtest.h>
+
+#include "core/bus.hpp"
+#include "core/htif.hpp"
+
+namespace uemu::test {
+
+class HtifTest : public ::testing::Test {
+protected:
+    static constexpr addr_t TOHOST = core::Dram::DRAM_BASE + 0x1000;
+    static constexpr addr_t FROMHOST = TOHOST + 0x40;
+    static constexpr addr_t MAGIC = core::Dram::DRAM_BASE + 0x2000;
+
+    void SetUp() override {
+        dram = std::make_shared<core::Dram>(1024 * 1024);
+        bus = std::make_shared<core::Bus>(dram, false);
+        htif = std::make_unique<core::Htif>(
+            *bus, *dram, TOHOST, FROMHOST,
+            std::vector<std::string>{"pk", "bench"},
+            [this](uint16_t code) { exit_code = code; });
+    }
+
+    // Issues a proxied syscall through magic memory and returns its result.
+    int64_t syscall(std::array<uint64_t, 8> args) {
+        dram->write_bytes(MAGIC, args.data(), sizeof(args));
+        EXPECT_TRUE(bus->write<uint64_t>(TOHOST, MAGIC));
+        return static_cast<int64_t>(dram->read<uint64_t>(MAGIC));
+    }
+
+    std::shared_ptr<core::Dram> dram;
+    std::shared_ptr<core::Bus> bus;
+    std::unique_ptr<core::Htif> htif;
+    int exit_code = -1;
+};
+
+TEST_F(HtifTest, ExitCode) {
+    // Stores elsewhere on the page are not commands.
+    EXPECT_TRUE(bus->write<uint64_t>(TOHOST + 8, 1));
+    EXPECT_EQ(exit_code, -1);
+
+    EXPECT_TRUE(bus->write<uint64_t>(TOHOST, (21 << 1) | 1));
+    EXPECT_EQ(exit_code, 21);
+}
+
+TEST_F(HtifTest, SyscallReplies) {
+    constexpr addr_t BUF = core::Dram::DRAM_BASE + 0x3000;
+
+    EXPECT_EQ(syscall({core::Htif::SYS_GETMAINVARS, BUF, 0x100}), 0);
+    EXPECT_EQ(dram->read<uint64_t>(TOHOST), 0u);
+    EXPECT_EQ(dram->read<uint64_t>(FROMHOST), 1u);
+
+    EXPECT_EQ(dram->read<uint64_t>(BUF), 2u);
+    const addr_t argv1 = dram->read<uint64_t>(BUF + 16);
+    char name[6] = {};
+    dram->read_bytes(argv1, name, sizeof(name));
+    EXPECT_STREQ(name, "bench");
+
+    EXPECT_EQ(syscall({core::Htif::SYS_GETMAINVARS, BUF, 8}), -ENOMEM);
+    EXPECT_EQ(syscall({9999}), -ENOSYS);
+}
+
+TEST_F(HtifTest, BadBuffersFault) {
+    // Buffers are checked before the host call and the block gets -EFAULT.
+    EXPECT_EQ(syscall({core::Htif::SYS_WRITE, 1, MAGIC, 1ULL << 40}), -EFAULT);
+    EXPECT_EQ(syscall({core::Htif::SYS_FSTAT, 1, 0}), -EFAULT);
+    EXPECT_EQ(syscall({core::Htif::SYS_GETCWD, 0, 0x100}), -EFAULT);
+    EXPECT_EQ(dram->read<uint64_t>(FROMHOST), 1u);
+}
+
+} // namespace uemu::test
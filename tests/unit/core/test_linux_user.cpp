@@ -0,0 +1,285 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <elf.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "core/bus.hpp"
+#include "core/linux_user.hpp"
+#include "core/mmu.hpp"
+
+namespace uemu::test {
+
+class LinuxUserTest : public ::testing::Test {
+protected:
+    static constexpr addr_t TEXT = 0x10000;
+    static constexpr size_t FILESZ = 0x20;
+    static constexpr size_t MEMSZ = 0x3000;
+
+    void SetUp() override {
+        hart = std::make_shared<core::Hart>();
+        dram = std::make_shared<core::Dram>(16 * 1024 * 1024);
+        bus = std::make_shared<core::Bus>(dram);
+        mmu = std::make_shared<core::MMU>(hart.get(), bus);
+        hart->connect_mmu(mmu.get());
+
+        user = std::make_unique<core::LinuxUser>(
+            *hart, *mmu, *dram, [this](int status) { exit_status = status; });
+
+        // A static ET_EXEC with one RWX segment whose tail is bss
+        std::vector<uint8_t> image(0x1000 + FILESZ, 0);
+        Elf64_Ehdr ehdr{};
+        std::memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+        ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+        ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+        ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+        ehdr.e_type = ET_EXEC;
+        ehdr.e_machine = EM_RISCV;
+        ehdr.e_version = EV_CURRENT;
+        ehdr.e_entry = TEXT;
+        ehdr.e_phoff = sizeof(Elf64_Ehdr);
+        ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+        ehdr.e_phentsize = sizeof(Elf64_Phdr);
+        ehdr.e_phnum = 1;
+
+        Elf64_Phdr phdr{};
+        phdr.p_type = PT_LOAD;
+        phdr.p_flags = PF_R | PF_W | PF_X;
+        phdr.p_offset = 0x1000;
+        phdr.p_vaddr = TEXT;
+        phdr.p_filesz = FILESZ;
+        phdr.p_memsz = MEMSZ;
+        phdr.p_align = 0x1000;
+
+        std::memcpy(image.data(), &ehdr, sizeof(ehdr));
+        std::memcpy(image.data() + sizeof(ehdr), &phdr, sizeof(phdr));
+        for (size_t i = 0; i < FILESZ; i++)
+            image[0x1000 + i] = static_cast<uint8_t>(i + 1);
+
+        exe = std::filesystem::temp_directory_path() / "uemu_linux_user.elf";
+        std::ofstream(exe, std::ios::binary)
+            .write(reinterpret_cast<const char*>(image.data()),
+                   static_cast<std::streamsize>(image.size()));
+    }
+
+    void TearDown() override { std::filesystem::remove(exe); }
+
+    int64_t syscall(reg_t nr, reg_t a0 = 0, reg_t a1 = 0, reg_t a2 = 0,
+                    reg_t a3 = 0, reg_t a4 = 0, reg_t a5 = 0) {
+        hart->gprs.write(17, nr);
+        hart->gprs.write(10, a0);
+        hart->gprs.write(11, a1);
+        hart->gprs.write(12, a2);
+        hart->gprs.write(13, a3);
+        hart->gprs.write(14, a4);
+        hart->gprs.write(15, a5);
+        user->handle_ecall();
+        return static_cast<int64_t>(hart->gprs[10]);
+    }
+
+    std::shared_ptr<core::Hart> hart;
+    std::shared_ptr<core::Dram> dram;
+    std::shared_ptr<core::Bus> bus;
+    std::shared_ptr<core::MMU> mmu;
+    std::unique_ptr<core::LinuxUser> user;
+    std::filesystem::path exe;
+    int exit_status = -1;
+};
+
+TEST_F(LinuxUserTest, LoadsImageAndStack) {
+    user->load({.exe = exe,
+                .argv = {"prog", "arg"},
+                .envp = {"A=1"},
+                .sysroot = {}});
+
+    EXPECT_EQ(hart->get_linux_user(), user.get());
+    EXPECT_EQ(hart->priv, core::PrivilegeLevel::U);
+    EXPECT_EQ(hart->pc, TEXT);
+    EXPECT_EQ(hart->csrs[core::SATP::ADDRESS]->read_unchecked() >>
+                  core::SATP::MODE_SHIFT,
+              core::SATP::Sv39);
+
+    uint8_t text[FILESZ + 8];
+    ASSERT_TRUE(user->copy_from_guest(TEXT, text, sizeof(text)));
+    EXPECT_EQ(text[0], 1);
+    EXPECT_EQ(text[FILESZ - 1], FILESZ);
+    EXPECT_EQ(text[FILESZ], 0); // bss
+    EXPECT_EQ(user->brk(), TEXT + MEMSZ);
+
+    const addr_t sp = hart->gprs[2];
+    EXPECT_EQ(sp % 16, 0u);
+
+    uint64_t argc = 0;
+    uint64_t argv0 = 0;
+    ASSERT_TRUE(user->copy_from_guest(sp, &argc, sizeof(argc)));
+    ASSERT_TRUE(user->copy_from_guest(sp + 8, &argv0, sizeof(argv0)));
+    EXPECT_EQ(argc, 2u);
+    EXPECT_EQ(user->read_string(argv0), "prog");
+
+    // Nothing is mapped below the image.
+    uint8_t byte;
+    EXPECT_FALSE(user->copy_from_guest(TEXT - 1, &byte, 1));
+}
+
+TEST_F(LinuxUserTest, MemorySyscalls) {
+    user->load({.exe = exe, .argv = {}, .envp = {}, .sysroot = {}});
+
+    // brk(0) queries; growing maps zeroed pages.
+    const int64_t brk = syscall(214, 0);
+    EXPECT_EQ(brk, static_cast<int64_t>(TEXT + MEMSZ));
+    EXPECT_EQ(syscall(214, brk + 0x2000), brk + 0x2000);
+    uint64_t word = 1;
+    EXPECT_TRUE(user->copy_from_guest(brk + 0x1000, &word, sizeof(word)));
+    EXPECT_EQ(word, 0u);
+
+    // Anonymous mmap, then munmap
+    constexpr int PROT_RW = 3;
+    constexpr int MAP_PRIVATE_ANON = 0x22;
+    const int64_t addr = syscall(222, 0, 0x4000, PROT_RW, MAP_PRIVATE_ANON,
+                                 static_cast<reg_t>(-1), 0);
+    ASSERT_GT(addr, 0);
+    word = 0xDEADBEEF;
+    EXPECT_TRUE(user->copy_to_guest(addr + 0x3000, &word, sizeof(word)));
+    EXPECT_EQ(syscall(215, addr, 0x4000), 0);
+    EXPECT_FALSE(user->copy_from_guest(addr, &word, sizeof(word)));
+
+    EXPECT_EQ(syscall(220), -ENOSYS); // clone without CLONE_VM: fork
+
+    syscall(94, 3); // exit_group
+    EXPECT_EQ(exit_status, 3);
+}
+
+TEST_F(LinuxUserTest, SyscallsHonourPageProtection) {
+    user->load({.exe = exe, .argv = {}, .envp = {}, .sysroot = {}});
+
+    constexpr int PROT_R = 1;
+    constexpr int PROT_RW = 3;
+    constexpr int MAP_PRIVATE_ANON = 0x22;
+    const int64_t addr = syscall(222, 0, 0x2000, PROT_R, MAP_PRIVATE_ANON,
+                                 static_cast<reg_t>(-1), 0);
+    ASSERT_GT(addr, 0);
+
+    // clock_gettime stores into read-only memory, write() loads from it.
+    const int null = ::open("/dev/null", O_WRONLY);
+    ASSERT_GE(null, 0);
+    EXPECT_EQ(syscall(113, CLOCK_MONOTONIC, addr), -EFAULT);
+    EXPECT_EQ(syscall(64, null, addr, 0x1000), 0x1000);
+    EXPECT_FALSE(user->copy_to_guest(addr, "x", 1));
+
+    // read() must fault before it consumes anything from the host fd.
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    ASSERT_EQ(::write(fds[1], "abcd", 4), 4);
+    EXPECT_EQ(syscall(63, fds[0], addr, 4), -EFAULT);
+    EXPECT_EQ(syscall(67, fds[0], addr, 4, 0), -EFAULT);
+    char left[4];
+    EXPECT_EQ(::read(fds[0], left, sizeof(left)), 4);
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    // A PROT_NONE guard page can be neither read nor written.
+    EXPECT_EQ(syscall(226, addr, 0x1000, 0), 0);
+    EXPECT_EQ(syscall(64, null, addr, 1), -EFAULT);
+    uint8_t byte;
+    EXPECT_FALSE(user->copy_from_guest(addr, &byte, 1));
+
+    EXPECT_EQ(syscall(226, addr, 0x2000, PROT_RW), 0);
+    EXPECT_EQ(syscall(113, CLOCK_MONOTONIC, addr), 0);
+    ::close(null);
+}
+
+TEST_F(LinuxUserTest, ThreadsSwitchOnFutex) {
+    user->load({.exe = exe, .argv = {}, .envp = {}, .sysroot = {}});
+
+    // Words in the bss: the futex, and the parent and child tid slots
+    constexpr addr_t FUTEX = TEXT + 0x100;
+    constexpr addr_t PTID = TEXT + 0x108;
+    constexpr addr_t CTID = TEXT + 0x110;
+    constexpr addr_t STACK = TEXT + 0x2000;
+    constexpr addr_t TLS = 0x5000;
+    constexpr reg_t FLAGS = CLONE_VM | CLONE_FS | CLONE_FILES |
+                            CLONE_SIGHAND | CLONE_THREAD | CLONE_SYSVSEM |
+                            CLONE_SETTLS | CLONE_PARENT_SETTID |
+                            CLONE_CHILD_CLEARTID;
+
+    const int main_tid = ::getpid();
+    EXPECT_EQ(syscall(178), main_tid); // gettid
+
+    hart->pc = TEXT + 0x10;
+    const int64_t child = syscall(220, FLAGS, STACK, PTID, TLS, CTID);
+    ASSERT_GT(child, 0);
+    EXPECT_NE(child, main_tid);
+    EXPECT_EQ(user->thread_count(), 2u);
+    uint32_t word = 0;
+    EXPECT_TRUE(user->copy_from_guest(PTID, &word, sizeof(word)));
+    EXPECT_EQ(word, static_cast<uint32_t>(child));
+    ASSERT_TRUE(user->copy_to_guest(CTID, &word, sizeof(word)));
+
+    // The parent sleeps on the futex and the child runs from the same pc.
+    EXPECT_EQ(syscall(98, FUTEX, 0, 1), -EAGAIN); // Word is 0, not 1
+    EXPECT_EQ(syscall(98, FUTEX, 0, 0), 0);
+    EXPECT_EQ(syscall(178), child);
+    EXPECT_EQ(hart->pc, TEXT + 0x10);
+    EXPECT_EQ(hart->gprs[2], STACK);
+    EXPECT_EQ(hart->gprs[4], TLS);
+
+    // Alone on the hart, yielding keeps running the child.
+    EXPECT_EQ(syscall(124), 0);
+    EXPECT_EQ(syscall(178), child);
+
+    // FUTEX_WAKE wakes the parent, whose wait returns 0 once the child
+    // exits; the exit clears the child tid slot.
+    EXPECT_EQ(syscall(98, FUTEX, 1, 5), 1);
+    EXPECT_EQ(syscall(98, FUTEX, 1, 5), 0);
+    EXPECT_EQ(syscall(93, 0), 0); // exit
+    EXPECT_EQ(user->thread_count(), 1u);
+    EXPECT_EQ(syscall(178), main_tid);
+    EXPECT_TRUE(user->copy_from_guest(CTID, &word, sizeof(word)));
+    EXPECT_EQ(word, 0u);
+    EXPECT_EQ(exit_status, -1);
+
+    syscall(93, 7); // exit of the last thread ends the process
+    EXPECT_EQ(exit_status, 7);
+}
+
+TEST_F(LinuxUserTest, FutexWaitTimesOut) {
+    user->load({.exe = exe, .argv = {}, .envp = {}, .sysroot = {}});
+
+    constexpr addr_t FUTEX = TEXT + 0x100;
+    constexpr addr_t TIMEOUT = TEXT + 0x120;
+    const timespec ts = {.tv_sec = 0, .tv_nsec = 1000000};
+    ASSERT_TRUE(user->copy_to_guest(TIMEOUT, &ts, sizeof(ts)));
+
+    EXPECT_EQ(syscall(98, FUTEX, 0, 0, TIMEOUT), -ETIMEDOUT);
+    EXPECT_EQ(exit_status, -1);
+
+    // Without a timeout and nobody to wake it, the process aborts.
+    syscall(98, FUTEX, 0, 0);
+    EXPECT_EQ(exit_status, 128 + SIGABRT);
+}
+
+} // namespace uemu::test
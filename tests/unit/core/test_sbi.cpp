@@ -0,0 +1,152 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "core/bus.hpp"
+#include "core/mmu.hpp"
+#include "core/sbi.hpp"
+#include "device/clint.hpp"
+
+namespace uemu::test {
+
+class SbiTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        hart = std::make_shared<core::Hart>();
+        dram = std::make_shared<core::Dram>(1024 * 1024);
+        bus = std::make_shared<core::Bus>(dram);
+        mmu = std::make_shared<core::MMU>(hart.get(), bus);
+        hart->connect_mmu(mmu.get());
+        clint = std::make_shared<device::Clint>(hart, 1000000);
+        mip = dynamic_cast<core::MIP*>(hart->csrs[core::MIP::ADDRESS].get());
+
+        sbi = std::make_unique<core::Sbi>(
+            *hart, *mmu, *bus, *clint,
+            core::Sbi::Console{
+                .write_char = [this](char ch) { output += ch; },
+                .read_char = []() -> std::optional<char> { return 'x'; },
+            },
+            [this](uint32_t type, uint32_t reason) {
+                reset_type = type;
+                reset_reason = reason;
+            });
+    }
+
+    // Issues an SBI call and returns {a0, a1}.
+    std::pair<int64_t, reg_t> call(reg_t eid, reg_t fid, reg_t a0 = 0,
+                                   reg_t a1 = 0, reg_t a2 = 0, reg_t a3 = 0) {
+        hart->gprs.write(17, eid);
+        hart->gprs.write(16, fid);
+        hart->gprs.write(10, a0);
+        hart->gprs.write(11, a1);
+        hart->gprs.write(12, a2);
+        hart->gprs.write(13, a3);
+        sbi->handle_ecall();
+        return {static_cast<int64_t>(hart->gprs[10]), hart->gprs[11]};
+    }
+
+    std::shared_ptr<core::Hart> hart;
+    std::shared_ptr<core::Dram> dram;
+    std::shared_ptr<core::Bus> bus;
+    std::shared_ptr<core::MMU> mmu;
+    std::shared_ptr<device::Clint> clint;
+    core::MIP* mip = nullptr;
+    std::unique_ptr<core::Sbi> sbi;
+
+    std::string output;
+    uint32_t reset_type = ~0u;
+    uint32_t reset_reason = ~0u;
+};
+
+TEST_F(SbiTest, BaseExtension) {
+    EXPECT_EQ(hart->get_sbi(), sbi.get());
+
+    auto [err, val] = call(core::Sbi::EXT_BASE, 0);
+    EXPECT_EQ(err, core::Sbi::SUCCESS);
+    EXPECT_EQ(val, core::Sbi::SPEC_VERSION);
+
+    std::tie(err, val) = call(core::Sbi::EXT_BASE, 3, core::Sbi::EXT_TIME);
+    EXPECT_EQ(val, 1u);
+
+    std::tie(err, val) = call(core::Sbi::EXT_BASE, 3, 0x12345678);
+    EXPECT_EQ(val, 0u);
+
+    std::tie(err, val) = call(0x12345678, 0);
+    EXPECT_EQ(err, core::Sbi::ERR_NOT_SUPPORTED);
+}
+
+TEST_F(SbiTest, SetTimerDrivesStip) {
+    call(core::Sbi::EXT_TIME, 0, 0);
+    EXPECT_TRUE(mip->read_unchecked() & core::MIP::STIP);
+
+    // A deadline in the future clears the pending timer.
+    call(core::Sbi::EXT_TIME, 0, ~reg_t{0});
+    EXPECT_FALSE(mip->read_unchecked() & core::MIP::STIP);
+
+    clint->tick();
+    EXPECT_FALSE(mip->read_unchecked() & core::MIP::STIP);
+}
+
+TEST_F(SbiTest, IpiAndHartMask) {
+    auto [err, val] = call(core::Sbi::EXT_IPI, 0, 0x2, 0);
+    EXPECT_EQ(err, core::Sbi::ERR_INVALID_PARAM);
+    EXPECT_FALSE(mip->read_unchecked() & core::MIP::SSIP);
+
+    std::tie(err, val) = call(core::Sbi::EXT_IPI, 0, 0x1, 0);
+    EXPECT_EQ(err, core::Sbi::SUCCESS);
+    EXPECT_TRUE(mip->read_unchecked() & core::MIP::SSIP);
+
+    std::tie(err, val) = call(core::Sbi::EXT_RFENCE, 1, 0, ~reg_t{0}, 0, 0);
+    EXPECT_EQ(err, core::Sbi::SUCCESS);
+
+    std::tie(err, val) = call(core::Sbi::EXT_HSM, 2, 0);
+    EXPECT_EQ(err, core::Sbi::SUCCESS);
+    EXPECT_EQ(val, core::Sbi::HART_STARTED);
+}
+
+TEST_F(SbiTest, DebugConsole) {
+    const std::string msg = "hello";
+    dram->write_bytes(core::Dram::DRAM_BASE, msg.data(), msg.size());
+
+    auto [err, val] = call(core::Sbi::EXT_DBCN, 0, msg.size(),
+                           core::Dram::DRAM_BASE, 0);
+    EXPECT_EQ(err, core::Sbi::SUCCESS);
+    EXPECT_EQ(val, msg.size());
+
+    call(core::Sbi::EXT_DBCN, 2, '!');
+    EXPECT_EQ(output, "hello!");
+
+    std::tie(err, val) =
+        call(core::Sbi::EXT_DBCN, 1, 2, core::Dram::DRAM_BASE + 16, 0);
+    EXPECT_EQ(val, 2u);
+    EXPECT_EQ(dram->read<uint8_t>(core::Dram::DRAM_BASE + 17), 'x');
+}
+
+TEST_F(SbiTest, SystemReset) {
+    auto [err, val] = call(core::Sbi::EXT_SRST, 0, 5, 0);
+    EXPECT_EQ(err, core::Sbi::ERR_INVALID_PARAM);
+    EXPECT_EQ(reset_type, ~0u);
+
+    call(core::Sbi::EXT_SRST, 0, core::Sbi::RESET_SHUTDOWN,
+         core::Sbi::RESET_REASON_SYSFAIL);
+    EXPECT_EQ(reset_type, core::Sbi::RESET_SHUTDOWN);
+    EXPECT_EQ(reset_reason, core::Sbi::RESET_REASON_SYSFAIL);
+}
+
+} // namespace uemu::test
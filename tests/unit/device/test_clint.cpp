@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <thread>
+
 #include <gtest/gtest.h>
 
 #include "core/hart.hpp"
@@ -47,6 +50,91 @@ TEST(ClintTest, MTIMECMPTrigger) {
     EXPECT_FALSE(mip->read_unchecked() & core::MIP::MTIP);
 }
 
+TEST(ClintTest, StaleDeadlineNeverRaisesMtip) {
+    constexpr size_t MTIMECMP_ADDR =
+        device::Clint::DEFAULT_BASE + device::Clint::MTIMECMP_OFFSET;
+
+    auto hart = std::make_shared<uemu::core::Hart>();
+    core::MIP* mip =
+        dynamic_cast<core::MIP*>(hart->csrs[core::MIP::ADDRESS].get());
+    device::Clint clint(hart);
+
+    // The device thread keeps evaluating deadlines while the CPU moves an
+    // expired one into the far future.
+    std::atomic<bool> stop = false;
+    std::thread ticker([&] {
+        while (!stop.load())
+            clint.tick();
+    });
+
+    int spurious = 0;
+    for (int i = 0; i < 20000; i++) {
+        std::ignore = clint.write<uint64_t>(MTIMECMP_ADDR, 0ull);
+        std::ignore = clint.write<uint64_t>(MTIMECMP_ADDR, UINT64_MAX);
+        std::this_thread::yield();
+        if (mip->read_unchecked() & core::MIP::MTIP)
+            spurious++;
+    }
+
+    stop = true;
+    ticker.join();
+    EXPECT_EQ(spurious, 0);
+}
+
+TEST(ClintTest, StaleSbiDeadlineNeverRaisesStip) {
+    auto hart = std::make_shared<uemu::core::Hart>();
+    core::MIP* mip =
+        dynamic_cast<core::MIP*>(hart->csrs[core::MIP::ADDRESS].get());
+    device::Clint clint(hart);
+
+    std::atomic<bool> stop = false;
+    std::thread ticker([&] {
+        while (!stop.load())
+            clint.tick();
+    });
+
+    int spurious = 0;
+    for (int i = 0; i < 20000; i++) {
+        clint.set_sbi_timer(0);
+        clint.set_sbi_timer(UINT64_MAX);
+        std::this_thread::yield();
+        if (mip->read_unchecked() & core::MIP::STIP)
+            spurious++;
+    }
+
+    stop = true;
+    ticker.join();
+    EXPECT_EQ(spurious, 0);
+}
+
+TEST(ClintTest, StaleStimecmpNeverRaisesStip) {
+    auto hart = std::make_shared<uemu::core::Hart>();
+    core::MIP* mip =
+        dynamic_cast<core::MIP*>(hart->csrs[core::MIP::ADDRESS].get());
+    auto* stimecmp = hart->csrs[core::STIMECMP::ADDRESS].get();
+    hart->csrs[core::MENVCFG::ADDRESS]->write_unchecked(core::MENVCFG::STCE);
+    device::Clint clint(hart);
+
+    std::atomic<bool> stop = false;
+    std::thread ticker([&] {
+        while (!stop.load())
+            clint.tick();
+    });
+
+    int spurious = 0;
+    for (int i = 0; i < 20000; i++) {
+        stimecmp->write_unchecked(0);
+        stimecmp->write_unchecked(UINT64_MAX);
+        std::this_thread::yield();
+        if (mip->read_unchecked() & core::MIP::STIP)
+            spurious++;
+    }
+
+    stop = true;
+    ticker.join();
+    EXPECT_EQ(spurious, 0);
+}
+
 TEST(ClintTest, MSIPWrite) {
     constexpr size_t MSIP_ADDR =
         device::Clint::DEFAULT_BASE + device::Clint::MSIP_OFFSET;
@@ -69,4 +157,24 @@ TEST(ClintTest, MSIPWrite) {
     EXPECT_FALSE(mip->read_unchecked() & core::MIP::MSIP);
 }
 
+TEST(ClintTest, MTIMEWriteRebases) {
+    constexpr size_t MTIME_ADDR =
+        device::Clint::DEFAULT_BASE + device::Clint::MTIME_OFFSET;
+
+    auto hart = std::make_shared<uemu::core::Hart>();
+    device::Clint clint(hart, 1000000);
+
+    constexpr uint64_t base = 1ull << 40;
+    bool r = clint.write<uint64_t>(MTIME_ADDR, base);
+    EXPECT_TRUE(r);
+
+    uint64_t t0 = clint.get_mtime();
+    EXPECT_GE(t0, base);
+    EXPECT_LT(t0, base + 1000000);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uint64_t t1 = clint.read<uint64_t>(MTIME_ADDR).value_or(0);
+    EXPECT_GE(t1, t0 + 10000);
+}
+
 } // namespace uemu::test
@@ -15,6 +15,7 @@
  */
 
 #include <gtest/gtest.h>
+#include <thread>
 
 #include "device/device.hpp"
 
@@ -85,4 +86,20 @@ TEST(DeviceTest, WriteLittleEndian) {
     EXPECT_EQ(dest, 0xFFFFFFFF1234FFFFULL);
 }
 
+TEST(DeviceTest, CountsWritesFromTwoThreads) {
+    constexpr int N = 100000;
+    TestDevice dev;
+
+    auto writer = [&dev] {
+        for (int i = 0; i < N; i++)
+            (void)dev.write<uint32_t>(0x1000, 0);
+    };
+
+    std::thread other(writer);
+    writer();
+    other.join();
+
+    EXPECT_EQ(dev.mmio_writes(), 2u * N);
+}
+
 } // namespace uemu::test
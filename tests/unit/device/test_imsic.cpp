@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include "core/hart.hpp"
+#include "device/aplic.hpp"
+#include "device/imsic.hpp"
+
+namespace uemu::test {
+
+using device::Aplic;
+using device::Imsic;
+
+class ImsicTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        hart = std::make_shared<core::Hart>();
+        mip = dynamic_cast<core::MIP*>(hart->csrs[core::MIP::ADDRESS].get());
+        imsic = std::make_shared<Imsic>(hart, false);
+    }
+
+    void ireg_write(reg_t iselect, reg_t val) {
+        hart->csrs[core::SISELECT::ADDRESS]->write_unchecked(iselect);
+        hart->csrs[core::SIREG::ADDRESS]->write_unchecked(val);
+    }
+
+    reg_t topei() {
+        return hart->csrs[core::STOPEI::ADDRESS]->read_unchecked();
+    }
+
+    bool seip() const {
+        return mip->read_unchecked() & core::MIP::Field::SEIP;
+    }
+
+    std::shared_ptr<core::Hart> hart;
+    core::MIP* mip = nullptr;
+    std::shared_ptr<Imsic> imsic;
+};
+
+TEST_F(ImsicTest, TopeiClaimsLowestIdentity) {
+    ireg_write(Imsic::EIE0, (1ULL << 5) | (1ULL << 9));
+    ireg_write(Imsic::EIDELIVERY, 1);
+
+    ASSERT_TRUE(imsic->write<uint32_t>(Imsic::DEFAULT_S_BASE, 9));
+    ASSERT_TRUE(imsic->write<uint32_t>(Imsic::DEFAULT_S_BASE, 5));
+    EXPECT_TRUE(seip());
+    EXPECT_EQ(topei(), (5ULL << 16) | 5);
+
+    hart->csrs[core::STOPEI::ADDRESS]->write_unchecked(0);
+    EXPECT_EQ(topei(), (9ULL << 16) | 9);
+
+    hart->csrs[core::STOPEI::ADDRESS]->write_unchecked(0);
+    EXPECT_EQ(topei(), 0u);
+    EXPECT_FALSE(seip());
+}
+
+TEST_F(ImsicTest, ThresholdAndDelivery) {
+    ireg_write(Imsic::EIE0, 1ULL << 7);
+    imsic->send_msi(7);
+    EXPECT_FALSE(seip());
+
+    ireg_write(Imsic::EIDELIVERY, 1);
+    EXPECT_TRUE(seip());
+
+    ireg_write(Imsic::EITHRESHOLD, 7);
+    EXPECT_FALSE(seip());
+    EXPECT_EQ(topei(), 0u);
+
+    ireg_write(Imsic::EITHRESHOLD, 8);
+    EXPECT_TRUE(seip());
+}
+
+TEST_F(ImsicTest, AplicForwardsAsMsi) {
+    Aplic aplic(
+        [this](addr_t addr, uint32_t data) {
+            EXPECT_TRUE(imsic->contains(addr, 4));
+            std::ignore = imsic->write<uint32_t>(addr, data);
+        },
+        false, Imsic::DEFAULT_S_BASE);
+
+    auto aplic_write = [&aplic](addr_t offset, uint32_t val) {
+        ASSERT_TRUE(aplic.write<uint32_t>(Aplic::DEFAULT_BASE + offset, val));
+    };
+
+    ireg_write(Imsic::EIE0, 1ULL << 42);
+    ireg_write(Imsic::EIDELIVERY, 1);
+
+    // Source 10: level-high, routed to hart 0 with EIID 42
+    aplic_write(Aplic::SOURCECFG_BASE + 9 * 4, Aplic::SM_LEVEL1);
+    aplic_write(Aplic::TARGET_BASE + 9 * 4, 42);
+    aplic_write(Aplic::SETIENUM, 10);
+    aplic_write(Aplic::DOMAINCFG, Aplic::DOMAINCFG_IE);
+
+    aplic.set_interrupt_level(10, true);
+    EXPECT_EQ(topei(), (42ULL << 16) | 42);
+    hart->csrs[core::STOPEI::ADDRESS]->write_unchecked(0);
+    EXPECT_FALSE(seip());
+
+    // Still asserted: software re-arms the level source via setipnum
+    aplic_write(Aplic::SETIPNUM_LE, 10);
+    EXPECT_TRUE(seip());
+    hart->csrs[core::STOPEI::ADDRESS]->write_unchecked(0);
+
+    aplic.set_interrupt_level(10, false);
+    aplic_write(Aplic::SETIPNUM_LE, 10);
+    EXPECT_FALSE(seip());
+}
+
+} // namespace uemu::test
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "device/ns16550.hpp"
+
+namespace uemu::test {
+
+using device::NS16550;
+
+class NS16550Test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        uart = std::make_unique<NS16550>(
+            [this](uint32_t, bool lvl) { irq = lvl; });
+        uart->write_char = [this](char c) { out.push_back(c); };
+        uart->read_char = [this]() -> std::optional<char> {
+            if (in.empty())
+                return std::nullopt;
+            char c = in.front();
+            in.pop_front();
+            return c;
+        };
+    }
+
+    uint8_t reg_read(uint8_t reg) {
+        return uart->read<uint8_t>(NS16550::DEFAULT_BASE + reg).value_or(0xff);
+    }
+
+    void reg_write(uint8_t reg, uint8_t val) {
+        ASSERT_TRUE(uart->write<uint8_t>(NS16550::DEFAULT_BASE + reg, val));
+    }
+
+    std::unique_ptr<NS16550> uart;
+    std::string out;
+    std::deque<char> in;
+    bool irq = false;
+};
+
+TEST_F(NS16550Test, TxFifoRaisesSingleThre) {
+    reg_write(NS16550::FCR, NS16550::FCR_ENABLE_FIFO);
+    reg_write(NS16550::IER, NS16550::IER_THRI);
+    EXPECT_EQ(reg_read(NS16550::IIR) & NS16550::IIR_ID, NS16550::IIR_THRI);
+
+    std::string msg = "0123456789abcdef";
+    for (char c : msg)
+        reg_write(NS16550::TX, c);
+
+    EXPECT_TRUE(out.empty());
+    EXPECT_FALSE(reg_read(NS16550::LSR) & NS16550::LSR_THRE);
+    EXPECT_FALSE(irq);
+
+    uart->tick();
+    EXPECT_EQ(out, msg);
+    EXPECT_TRUE(reg_read(NS16550::LSR) & NS16550::LSR_THRE);
+    EXPECT_TRUE(irq);
+
+    // Reading IIR acknowledges THRE
+    EXPECT_EQ(reg_read(NS16550::IIR) & NS16550::IIR_ID, NS16550::IIR_THRI);
+    EXPECT_FALSE(irq);
+    EXPECT_TRUE(reg_read(NS16550::IIR) & NS16550::IIR_NO_INT);
+
+    uart->tick();
+    EXPECT_FALSE(irq);
+}
+
+TEST_F(NS16550Test, TxOverrunKeepsEveryByte) {
+    // FIFOs are off after reset: THR holds a single byte.
+    const std::string msg = "hello";
+    for (char c : msg)
+        reg_write(NS16550::TX, c);
+    EXPECT_EQ(out, "hell");
+
+    uart->tick();
+    EXPECT_EQ(out, msg);
+}
+
+TEST_F(NS16550Test, RxTriggerLevel) {
+    reg_write(NS16550::FCR, NS16550::FCR_ENABLE_FIFO | NS16550::FCR_TRIGGER_4);
+    reg_write(NS16550::IER, NS16550::IER_RDI);
+
+    in = {'a', 'b', 'c'};
+    uart->tick();
+    EXPECT_TRUE(reg_read(NS16550::LSR) & NS16550::LSR_DR);
+    EXPECT_FALSE(irq);
+
+    in = {'d'};
+    uart->tick();
+    EXPECT_TRUE(irq);
+    EXPECT_EQ(reg_read(NS16550::IIR) & NS16550::IIR_ID, NS16550::IIR_RDI);
+
+    std::string got;
+    while (reg_read(NS16550::LSR) & NS16550::LSR_DR)
+        got.push_back(static_cast<char>(reg_read(NS16550::RX)));
+    EXPECT_EQ(got, "abcd");
+    EXPECT_FALSE(irq);
+}
+
+TEST_F(NS16550Test, RxCharacterTimeout) {
+    reg_write(NS16550::FCR, NS16550::FCR_ENABLE_FIFO | NS16550::FCR_TRIGGER_8);
+    reg_write(NS16550::IER, NS16550::IER_RDI);
+
+    in = {'x'};
+    uart->tick();
+    EXPECT_FALSE(irq);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uart->tick();
+    EXPECT_TRUE(irq);
+    EXPECT_EQ(reg_read(NS16550::IIR) & (NS16550::IIR_ID | NS16550::IIR_NO_INT),
+              NS16550::IIR_CTI);
+
+    EXPECT_EQ(reg_read(NS16550::RX), 'x');
+    EXPECT_FALSE(irq);
+}
+
+} // namespace uemu::test
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "core/hart.hpp"
+#include "device/plic.hpp"
+
+namespace uemu::test {
+
+using device::Plic;
+
+class PlicTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        hart = std::make_shared<core::Hart>();
+        mip = dynamic_cast<core::MIP*>(hart->csrs[core::MIP::ADDRESS].get());
+        plic = std::make_unique<Plic>(hart);
+    }
+
+    void write32(addr_t offset, uint32_t val) {
+        ASSERT_TRUE(plic->write<uint32_t>(Plic::DEFAULT_BASE + offset, val));
+    }
+
+    uint32_t read32(addr_t offset) {
+        return plic->read<uint32_t>(Plic::DEFAULT_BASE + offset).value_or(~0u);
+    }
+
+    // Context 0 is M-mode on hart 0.
+    static constexpr addr_t M_ENABLE = Plic::ENABLE_BASE;
+    static constexpr addr_t M_THRESHOLD =
+        Plic::CONTEXT_BASE + Plic::CONTEXT_THRESHOLD;
+    static constexpr addr_t M_CLAIM = Plic::CONTEXT_BASE + Plic::CONTEXT_CLAIM;
+
+    bool meip() const {
+        return mip->read_unchecked() & core::MIP::Field::MEIP;
+    }
+
+    std::shared_ptr<core::Hart> hart;
+    core::MIP* mip = nullptr;
+    std::unique_ptr<Plic> plic;
+};
+
+TEST_F(PlicTest, ClaimHighestPriority) {
+    write32(Plic::PRIORITY_BASE + 3 * Plic::PRIORITY_PER_ID, 1);
+    write32(Plic::PRIORITY_BASE + 5 * Plic::PRIORITY_PER_ID, 7);
+    write32(M_ENABLE, (1u << 3) | (1u << 5));
+
+    plic->set_interrupt_level(3, true);
+    EXPECT_TRUE(meip());
+    plic->set_interrupt_level(5, true);
+
+    EXPECT_EQ(read32(Plic::PENDING_BASE), (1u << 3) | (1u << 5));
+    EXPECT_EQ(read32(M_CLAIM), 5u);
+    EXPECT_EQ(read32(M_CLAIM), 3u);
+    EXPECT_EQ(read32(M_CLAIM), 0u);
+    EXPECT_FALSE(meip());
+
+    // Still asserted after completion: the level source pends again.
+    write32(M_CLAIM, 5);
+    EXPECT_TRUE(meip());
+    EXPECT_EQ(read32(M_CLAIM), 5u);
+}
+
+TEST_F(PlicTest, ClaimUpdatesContextsSharingTheSource) {
+    // Context 1 is S-mode on hart 0.
+    constexpr addr_t S_ENABLE = M_ENABLE + Plic::ENABLE_PER_HART;
+    constexpr addr_t S_CLAIM = M_CLAIM + Plic::CONTEXT_PER_HART;
+    const auto seip = [this] {
+        return mip->read_unchecked() & core::MIP::Field::SEIP;
+    };
+
+    write32(Plic::PRIORITY_BASE + 3 * Plic::PRIORITY_PER_ID, 1);
+    write32(Plic::PRIORITY_BASE + 5 * Plic::PRIORITY_PER_ID, 7);
+    write32(M_ENABLE, 1u << 5);
+    write32(S_ENABLE, (1u << 3) | (1u << 5));
+
+    plic->set_interrupt_level(3, true);
+    plic->set_interrupt_level(5, true);
+    EXPECT_TRUE(meip());
+    EXPECT_TRUE(seip());
+
+    // Both contexts cached 5; the S context falls back to 3.
+    EXPECT_EQ(read32(M_CLAIM), 5u);
+    EXPECT_FALSE(meip());
+    EXPECT_TRUE(seip());
+    EXPECT_EQ(read32(S_CLAIM), 3u);
+    EXPECT_FALSE(seip());
+}
+
+TEST_F(PlicTest, ThresholdAndDeassert) {
+    write32(Plic::PRIORITY_BASE + 2 * Plic::PRIORITY_PER_ID, 2);
+    write32(M_ENABLE, 1u << 2);
+    write32(M_THRESHOLD, 2);
+
+    plic->set_interrupt_level(2, true);
+    EXPECT_FALSE(meip());
+    EXPECT_EQ(read32(M_CLAIM), 0u);
+
+    write32(M_THRESHOLD, 1);
+    EXPECT_TRUE(meip());
+
+    plic->set_interrupt_level(2, false);
+    EXPECT_FALSE(meip());
+    EXPECT_EQ(read32(M_CLAIM), 0u);
+}
+
+TEST_F(PlicTest, DisabledSourceNotDelivered) {
+    write32(Plic::PRIORITY_BASE + 4 * Plic::PRIORITY_PER_ID, 1);
+    plic->set_interrupt_level(4, true);
+    EXPECT_FALSE(meip());
+
+    write32(M_ENABLE, 1u << 4);
+    EXPECT_TRUE(meip());
+    EXPECT_EQ(read32(M_CLAIM), 4u);
+}
+
+} // namespace uemu::test
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "core/dram.hpp"
+#include "core/hart.hpp"
+#include "device/clint.hpp"
+#include "device/pvclock.hpp"
+
+namespace uemu::test {
+
+using device::PvClock;
+
+// Guest-side read, as documented in pvclock.hpp.
+static uint64_t guest_read(const core::Dram& dram, addr_t gpa, uint64_t time) {
+    PvClock::PvClockInfo info;
+    dram.read_bytes(gpa, &info, sizeof(info));
+
+    uint64_t delta = time - info.cycle_timestamp;
+    delta = info.cycle_shift >= 0 ? delta << info.cycle_shift
+                                  : delta >> -info.cycle_shift;
+
+    return info.system_time +
+           static_cast<uint64_t>(
+               (static_cast<__uint128_t>(delta) * info.cycle_to_system_mul) >>
+               32);
+}
+
+TEST(PvClockTest, TracksClintTimebase) {
+    constexpr addr_t GPA = core::Dram::DRAM_BASE + 0x1000;
+
+    auto hart = std::make_shared<core::Hart>();
+    auto dram = std::make_shared<core::Dram>(0x10000);
+    auto clint = std::make_shared<device::Clint>(hart);
+    PvClock pvclock(dram, clint);
+
+    EXPECT_EQ(pvclock.read<uint32_t>(PvClock::DEFAULT_BASE + PvClock::MAGIC),
+              PvClock::MAGIC_VALUE);
+
+    // Misaligned or outside DRAM: not enabled
+    ASSERT_TRUE(pvclock.write<uint64_t>(
+        PvClock::DEFAULT_BASE + PvClock::SYSTEM_TIME, 0x1000 | 1));
+    EXPECT_EQ(pvclock.read<uint64_t>(PvClock::DEFAULT_BASE +
+                                     PvClock::SYSTEM_TIME),
+              0x1000u);
+
+    ASSERT_TRUE(pvclock.write<uint64_t>(
+        PvClock::DEFAULT_BASE + PvClock::SYSTEM_TIME, GPA | 1));
+    EXPECT_EQ(dram->read<uint32_t>(GPA) % 2, 0u);
+    EXPECT_NE(dram->read<uint32_t>(GPA), 0u);
+
+    // 10 MHz is 100 ns per tick, which the scale holds exactly.
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    const uint64_t mtime = clint->get_mtime();
+    EXPECT_EQ(guest_read(*dram, GPA, mtime), mtime * 100);
+}
+
+TEST(PvClockTest, SkewStaysBoundedAsTheInstructionRateChanges) {
+    constexpr addr_t GPA = core::Dram::DRAM_BASE + 0x1000;
+    constexpr uint64_t FREQ = 3000000; // 333.33... ns per tick
+
+    auto hart = std::make_shared<core::Hart>();
+    auto dram = std::make_shared<core::Dram>(0x10000);
+    auto clint = std::make_shared<device::Clint>(hart, FREQ);
+    PvClock pvclock(dram, clint);
+    core::CSR* mcycle = hart->csrs[core::MCYCLE::ADDRESS].get();
+
+    ASSERT_TRUE(pvclock.write<uint64_t>(
+        PvClock::DEFAULT_BASE + PvClock::SYSTEM_TIME, GPA | 1));
+
+    // Windows alternate between a busy and a nearly idle hart; neither
+    // may push guest time away from the timebase.
+    uint64_t prev = 0;
+    for (int i = 0; i < 16; i++) {
+        mcycle->write_unchecked(mcycle->read_unchecked() +
+                                (i % 2 ? 100 : 1000000));
+        std::this_thread::sleep_for(PvClock::UPDATE_INTERVAL);
+        pvclock.tick();
+
+        const uint64_t mtime = clint->get_mtime();
+        const uint64_t guest_ns = guest_read(*dram, GPA, mtime);
+        const auto exact = static_cast<uint64_t>(
+            static_cast<__uint128_t>(mtime) * device::Clint::NS_PER_SEC /
+            FREQ);
+
+        EXPECT_GE(guest_ns, prev);
+        EXPECT_LE(guest_ns, exact);
+        EXPECT_LT(exact - guest_ns, 10u);
+        prev = guest_ns;
+    }
+}
+
+} // namespace uemu::test
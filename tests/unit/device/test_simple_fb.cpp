@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <thread>
+
 #include <gtest/gtest.h>
 
 #include "device/simple_fb.hpp"
@@ -115,4 +117,86 @@ TEST_F(SimpleFBTest, UnalignedAccess) {
     EXPECT_EQ(b3.value(), 0xAA);
 }
 
+TEST_F(SimpleFBTest, DirtyTrackingStartsFullyDirty) {
+    std::vector<ui::PixelSource::DirtySpan> spans;
+
+    fb->take_dirty_spans(spans);
+
+    ASSERT_EQ(spans.size(), 1u);
+    EXPECT_EQ(spans[0].first_row, 0u);
+    EXPECT_EQ(spans[0].num_rows, fb->get_height());
+
+    // Collecting clears the bitmap
+    spans.clear();
+    fb->take_dirty_spans(spans);
+    EXPECT_TRUE(spans.empty());
+}
+
+TEST_F(SimpleFBTest, DirtyTrackingCoalescesRows) {
+    addr_t base = fb->start();
+    constexpr size_t pitch = device::SimpleFB::PITCH;
+    std::vector<ui::PixelSource::DirtySpan> spans;
+
+    fb->take_dirty_spans(spans);
+    spans.clear();
+
+    // Rows 10 and 11, then a write straddling rows 63/64, then row 700
+    EXPECT_TRUE(fb->write<uint32_t>(base + 10 * pitch, 0x1));
+    EXPECT_TRUE(fb->write<uint32_t>(base + 11 * pitch + 8, 0x2));
+    EXPECT_TRUE(fb->write<uint64_t>(base + 64 * pitch - 4, 0x3));
+    EXPECT_TRUE(fb->write<uint8_t>(base + 700 * pitch + pitch - 1, 0x4));
+
+    // Reads never dirty anything
+    EXPECT_TRUE(fb->read<uint32_t>(base + 300 * pitch).has_value());
+
+    fb->take_dirty_spans(spans);
+
+    ASSERT_EQ(spans.size(), 3u);
+    EXPECT_EQ(spans[0].first_row, 10u);
+    EXPECT_EQ(spans[0].num_rows, 2u);
+    EXPECT_EQ(spans[1].first_row, 63u);
+    EXPECT_EQ(spans[1].num_rows, 2u);
+    EXPECT_EQ(spans[2].first_row, 700u);
+    EXPECT_EQ(spans[2].num_rows, 1u);
+}
+
+TEST_F(SimpleFBTest, DirtyTrackingConcurrentWriter) {
+    addr_t base = fb->start();
+    constexpr size_t pitch = device::SimpleFB::PITCH;
+    const size_t height = fb->get_height();
+    std::vector<ui::PixelSource::DirtySpan> spans;
+
+    fb->take_dirty_spans(spans);
+
+    // The writer never blocks on the collector; every row it writes must be
+    // reported by some collection, including the one after it finishes.
+    std::vector<bool> seen(height, false);
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (size_t row = 0; row < height; row++)
+            (void)fb->write<uint32_t>(base + row * pitch, 0xFF00FF00);
+        done.store(true);
+    });
+
+    while (!done.load()) {
+        spans.clear();
+        fb->take_dirty_spans(spans);
+        for (const auto& span : spans)
+            for (size_t i = 0; i < span.num_rows; i++)
+                seen[span.first_row + i] = true;
+    }
+    writer.join();
+
+    spans.clear();
+    fb->take_dirty_spans(spans);
+    for (const auto& span : spans)
+        for (size_t i = 0; i < span.num_rows; i++)
+            seen[span.first_row + i] = true;
+
+    for (size_t row = 0; row < height; row++)
+        EXPECT_TRUE(seen[row]);
+
+    EXPECT_EQ(fb->get_pixels()[(height - 1) * pitch + 1], 0xFF);
+}
+
 } // namespace uemu::test
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "device/device.hpp"
+
+namespace uemu::test {
+
+// MMIO stub for the profiler tests: reads return 0, writes are accepted.
+// A slow probe stalls every read to stand in for a costly register.
+class Probe : public device::Device {
+public:
+    explicit Probe(const std::string& name = "probe",
+                   addr_t base = 0x10000000, bool slow = false)
+        : Device(name, base, 0x100), slow_(slow) {}
+
+    size_t reads = 0;
+
+protected:
+    std::optional<uint64_t> read_internal(addr_t, size_t) override {
+        reads++;
+        if (slow_)
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        return 0;
+    }
+
+    bool write_internal(addr_t, size_t, uint64_t) override { return true; }
+
+private:
+    bool slow_;
+};
+
+} // namespace uemu::test
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "profile/bbv.hpp"
+
+namespace uemu::test {
+
+namespace {
+
+std::vector<std::string> read_lines(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);)
+        lines.push_back(line);
+    return lines;
+}
+
+} // namespace
+
+TEST(BbvProfilerTest, CountsBlocksPerInterval) {
+    const auto path = std::filesystem::temp_directory_path() / "uemu_test.bb";
+
+    {
+        profile::BbvProfiler bbv({.output = path, .interval = 6});
+
+        // Block 1: 0x1000..0x1008, jumping to block 2 at 0x2000
+        bbv.retire(0x1000, 0x1004, 4);
+        bbv.retire(0x1004, 0x1008, 4);
+        bbv.retire(0x1008, 0x2000, 4);
+        // Block 2, a compressed instruction, then back to block 1
+        bbv.retire(0x2000, 0x2002, 2);
+        bbv.retire(0x2002, 0x1000, 4);
+        // Block 1 again, cut by the interval boundary after one insn
+        bbv.retire(0x1000, 0x1004, 4);
+        bbv.retire(0x1004, 0x1008, 4);
+        // Traps before retiring; the handler at 0x3000 is block 3
+        bbv.trap();
+        bbv.retire(0x3000, 0x3004, 4);
+
+        EXPECT_EQ(bbv.intervals(), 1u);
+        EXPECT_EQ(bbv.blocks(), 2u); // Block 3 is still running
+    }
+
+    const std::vector<std::string> lines = read_lines(path);
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "T:1:4 :2:2 ");
+    EXPECT_EQ(lines[1], "T:1:1 :3:1 ");
+
+    std::filesystem::remove(path);
+}
+
+TEST(BbvProfilerTest, RejectsZeroInterval) {
+    const auto path =
+        std::filesystem::temp_directory_path() / "uemu_test_zero.bb";
+    std::filesystem::remove(path);
+
+    EXPECT_THROW(profile::BbvProfiler({.output = path, .interval = 0}),
+                 std::invalid_argument);
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+} // namespace uemu::test
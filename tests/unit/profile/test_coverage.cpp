@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "profile/coverage.hpp"
+
+namespace uemu::test {
+
+namespace {
+
+struct Bb {
+    uint32_t start;
+    uint16_t size;
+    uint16_t module;
+};
+
+} // namespace
+
+TEST(CoverageTest, WritesDrcovWithModules) {
+    using core::PrivilegeLevel;
+    const auto path =
+        std::filesystem::temp_directory_path() / "uemu_test.drcov";
+
+    {
+        profile::Coverage coverage({.output = path, .system_map = {}});
+        // A symbol below the load base is not part of the module
+        coverage.add_module(
+            "fw.elf", 0x80000000,
+            utils::SymbolTable({{"_start", 0x80000000, 0x100},
+                                {"main", 0x80000100, 0x100},
+                                {"__weak_hook", 0, 0}}));
+
+        for (int i = 0; i < 3; i++) {
+            // 0x80000000..0x8000000c in M-mode, jumping to main
+            coverage.retire(0x80000000, 0x80000004, 4, PrivilegeLevel::M);
+            coverage.retire(0x80000004, 0x80000008, 4, PrivilegeLevel::M);
+            coverage.retire(0x80000008, 0x80000100, 4, PrivilegeLevel::M);
+            // main, left by a trap in its second instruction
+            coverage.retire(0x80000100, 0x80000102, 2, PrivilegeLevel::M);
+            coverage.trap();
+        }
+        // The same start seen running further extends the block
+        coverage.retire(0x80000100, 0x80000102, 2, PrivilegeLevel::M);
+        coverage.retire(0x80000102, 0x80000000, 4, PrivilegeLevel::M);
+        // User code outside of any module
+        coverage.retire(0x10000, 0x10004, 4, PrivilegeLevel::U);
+        coverage.retire(0x10004, 0x10010, 4, PrivilegeLevel::U);
+
+        EXPECT_EQ(coverage.blocks(), 3u);
+        coverage.finish();
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string file = ss.str();
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(file.rfind("DRCOV VERSION: 2\n", 0), 0u);
+    EXPECT_NE(file.find("Module Table: version 2, count 2\n"),
+              std::string::npos);
+    EXPECT_NE(file.find("  0, 0x0000000080000000, 0x0000000080000200, "),
+              std::string::npos);
+    EXPECT_NE(file.find(", fw.elf\n"), std::string::npos);
+    EXPECT_NE(file.find(", [user]@0\n"), std::string::npos);
+
+    const std::string table = "BB Table: 3 bbs\n";
+    const size_t pos = file.find(table);
+    ASSERT_NE(pos, std::string::npos);
+    ASSERT_EQ(file.size() - pos - table.size(), 3 * sizeof(Bb));
+
+    Bb bbs[3];
+    std::memcpy(bbs, file.data() + pos + table.size(), sizeof(bbs));
+    // User blocks first (by privilege level), then M-mode by address
+    EXPECT_EQ(bbs[0].start, 0x10000u);
+    EXPECT_EQ(bbs[0].size, 8u);
+    EXPECT_EQ(bbs[0].module, 1u);
+    EXPECT_EQ(bbs[1].start, 0x0u);
+    EXPECT_EQ(bbs[1].size, 12u);
+    EXPECT_EQ(bbs[1].module, 0u);
+    EXPECT_EQ(bbs[2].start, 0x100u);
+    EXPECT_EQ(bbs[2].size, 6u);
+    EXPECT_EQ(bbs[2].module, 0u);
+}
+
+TEST(CoverageTest, KernelModuleStartsAtText) {
+    const auto path =
+        std::filesystem::temp_directory_path() / "uemu_test_kernel.drcov";
+    const auto map =
+        std::filesystem::temp_directory_path() / "uemu_test_System.map";
+    std::ofstream(map) << "0000000000000000 w __weak_hook\n"
+                          "ffffffff80000000 T _text\n"
+                          "ffffffff80000000 T _start\n"
+                          "ffffffff80002000 T _stext\n"
+                          "ffffffff80002000 T start_kernel\n";
+
+    {
+        profile::Coverage coverage({.output = path, .system_map = map});
+        coverage.retire(0xffffffff80002000, 0xffffffff80002004, 4,
+                        core::PrivilegeLevel::S);
+        coverage.trap();
+        coverage.finish();
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string file = ss.str();
+    std::filesystem::remove(path);
+    std::filesystem::remove(map);
+
+    EXPECT_NE(file.find("  0, 0xffffffff80000000, 0xffffffff80002001, "),
+              std::string::npos);
+    EXPECT_NE(file.find(", vmlinux\n"), std::string::npos);
+
+    const std::string table = "BB Table: 1 bbs\n";
+    const size_t pos = file.find(table);
+    ASSERT_NE(pos, std::string::npos);
+    Bb bb{};
+    std::memcpy(&bb, file.data() + pos + table.size(), sizeof(bb));
+    EXPECT_EQ(bb.start, 0x2000u);
+    EXPECT_EQ(bb.module, 0u);
+}
+
+} // namespace uemu::test
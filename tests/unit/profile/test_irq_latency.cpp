@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <format>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "core/hart.hpp"
+#include "device/plic.hpp"
+#include "profile/hdr_histogram.hpp"
+#include "profile/irq_latency.hpp"
+
+namespace uemu::test {
+
+TEST(HdrHistogramTest, PercentilesWithinBucketPrecision) {
+    profile::HdrHistogram h;
+    for (uint64_t v = 1; v <= 1000; v++)
+        h.record(v);
+
+    EXPECT_EQ(h.count(), 1000u);
+    EXPECT_EQ(h.min(), 1u);
+    EXPECT_EQ(h.max(), 1000u);
+
+    // Values below 16 are exact; above, buckets are 1/16 of a power of two
+    EXPECT_EQ(h.percentile(0.0), 1u);
+    EXPECT_GE(h.percentile(0.5), 500u);
+    EXPECT_LE(h.percentile(0.5), 500u + 500u / 16);
+    EXPECT_GE(h.percentile(0.99), 990u);
+    EXPECT_EQ(h.percentile(1.0), 1000u);
+}
+
+TEST(HdrHistogramTest, EmptyAndHugeValues) {
+    profile::HdrHistogram h;
+    EXPECT_EQ(h.percentile(0.5), 0u);
+    EXPECT_EQ(h.min(), 0u);
+
+    h.record(UINT64_MAX);
+    EXPECT_EQ(h.percentile(0.5), UINT64_MAX);
+}
+
+TEST(IrqLatencyTest, FollowsInterruptToXret) {
+    core::Hart hart;
+    profile::IrqLatency latency(hart.stats.instructions);
+    hart.set_irq_latency(&latency);
+
+    auto* mip =
+        dynamic_cast<core::MIP*>(hart.csrs[core::MIP::ADDRESS].get());
+    ASSERT_NE(mip, nullptr);
+
+    latency.asserted(7);
+    mip->set_pending(core::MIP::Field::MTIP);
+    // Already pending: must not restart the clock
+    mip->set_pending(core::MIP::Field::MTIP);
+    hart.stats.instructions.add(5);
+
+    hart.handle_trap(
+        core::Trap(hart.pc, core::TrapCause::MachineTimerInterrupt, 0));
+    hart.stats.instructions.add(40);
+    latency.returned();
+
+    // An exception nested in nothing, and a stray xRET
+    hart.handle_trap(
+        core::Trap(hart.pc, core::TrapCause::IllegalInstruction, 0));
+    latency.returned();
+    latency.returned();
+
+    std::ostringstream out;
+    latency.report(out);
+    const std::string report = out.str();
+
+    const auto row = [](std::string_view what, uint64_t count, uint64_t v) {
+        return std::format("{:<36} {:>10} {:>10} {:>10}", what, count, v, v);
+    };
+    EXPECT_NE(report.find(row("MTI pending->taken insns", 1, 5)),
+              std::string::npos);
+    EXPECT_NE(report.find(row("MTI entry->xret insns", 1, 40)),
+              std::string::npos);
+    EXPECT_NE(report.find(row("exception 2 entry->xret insns", 1, 0)),
+              std::string::npos);
+    EXPECT_NE(report.find("MTI assert->pending ns"), std::string::npos);
+    EXPECT_NE(report.find("MTI assert->taken ns"), std::string::npos);
+    EXPECT_EQ(report.find("exception 2 pending"), std::string::npos);
+}
+
+TEST(IrqLatencyTest, RestartDropsStaleStamps) {
+    core::Hart hart;
+    profile::IrqLatency latency(hart.stats.instructions);
+    hart.set_irq_latency(&latency);
+
+    auto* mip =
+        dynamic_cast<core::MIP*>(hart.csrs[core::MIP::ADDRESS].get());
+    ASSERT_NE(mip, nullptr);
+
+    // A handler and a pending interrupt straddle a stats restart.
+    hart.stats.instructions.add(1000);
+    hart.handle_trap(
+        core::Trap(hart.pc, core::TrapCause::IllegalInstruction, 0));
+    mip->set_pending(core::MIP::Field::MTIP);
+
+    hart.stats = core::HartStats{};
+    latency.restart();
+    hart.stats.instructions.add(3);
+    latency.returned();
+    hart.handle_trap(
+        core::Trap(hart.pc, core::TrapCause::MachineTimerInterrupt, 0));
+
+    std::ostringstream out;
+    latency.report(out);
+    EXPECT_EQ(out.str().find("insns"), std::string::npos);
+}
+
+TEST(IrqLatencyTest, LaterPlicSourcesKeepTheFirstStamp) {
+    using device::Plic;
+
+    auto hart = std::make_shared<core::Hart>();
+    profile::IrqLatency latency(hart->stats.instructions);
+    hart->set_irq_latency(&latency);
+    Plic plic(hart);
+
+    const auto write32 = [&plic](addr_t offset, uint32_t val) {
+        ASSERT_TRUE(plic.write<uint32_t>(Plic::DEFAULT_BASE + offset, val));
+    };
+    write32(Plic::PRIORITY_BASE + 3 * Plic::PRIORITY_PER_ID, 2);
+    write32(Plic::PRIORITY_BASE + 5 * Plic::PRIORITY_PER_ID, 1);
+    write32(Plic::ENABLE_BASE, (1u << 3) | (1u << 5) | (1u << 6));
+
+    // Source 3 waits; 5 is outranked and 6 is below the threshold.
+    plic.set_interrupt_level(3, true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    plic.set_interrupt_level(5, true);
+    plic.set_interrupt_level(6, true);
+
+    hart->handle_trap(
+        core::Trap(hart->pc, core::TrapCause::MachineExternalInterrupt, 0));
+
+    std::ostringstream out;
+    latency.report(out);
+    const std::string report = out.str();
+    const size_t row = report.find("MEI assert->taken ns");
+    ASSERT_NE(row, std::string::npos);
+
+    std::istringstream fields(report.substr(row + 20));
+    uint64_t count = 0, min_ns = 0;
+    fields >> count >> min_ns;
+    EXPECT_EQ(count, 1u);
+    EXPECT_GE(min_ns, 5000000u);
+}
+
+} // namespace uemu::test
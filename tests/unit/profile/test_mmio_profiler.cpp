@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <format>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "core/bus.hpp"
+#include "profile/mmio_profiler.hpp"
+
+#include "probe_device.hpp"
+
+namespace uemu::test {
+
+TEST(MmioProfilerTest, SortsRegistersByCost) {
+    auto dram = std::make_shared<core::Dram>(1024 * 1024);
+    core::Bus bus(dram, false);
+    bus.add_device(std::make_shared<Probe>("fast", 0x10000000, false));
+    bus.add_device(std::make_shared<Probe>("slow", 0x10001000, true));
+
+    profile::MmioProfiler profiler;
+    bus.set_mmio_profiler(&profiler);
+
+    for (int i = 0; i < 10; i++)
+        (void)bus.read<uint8_t>(0x10000005);
+    EXPECT_TRUE(bus.write<uint32_t>(0x10000010, 1));
+    (void)bus.read<uint32_t>(0x10001004);
+
+    // DRAM is never profiled.
+    (void)bus.read<uint64_t>(core::Dram::DRAM_BASE);
+
+    std::ostringstream out;
+    profiler.report(out);
+    const std::string report = out.str();
+
+    EXPECT_NE(report.find("MMIO: 12 accesses"), std::string::npos);
+
+    // The single slow read outweighs ten fast ones.
+    const size_t slow = report.find(std::format("{:<20} {:>8}", "slow", "0x4"));
+    const size_t fast = report.find(
+        std::format("{:<20} {:>8} {:>12} {:>12}", "fast", "0x5", 10, 0));
+    ASSERT_NE(slow, std::string::npos);
+    ASSERT_NE(fast, std::string::npos);
+    EXPECT_LT(slow, fast);
+}
+
+TEST(MmioProfilerTest, Percentiles) {
+    profile::MmioProfiler::Entry e;
+    e.reads = 100;
+    e.histogram[4] = 90; // [16, 32) ns
+    e.histogram[10] = 10;
+
+    EXPECT_EQ(e.percentile_ns(0.5), 32u);
+    EXPECT_EQ(e.percentile_ns(0.99), 2048u);
+}
+
+} // namespace uemu::test
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "profile/region_profiler.hpp"
+
+#include "probe_device.hpp"
+
+namespace uemu::test {
+
+TEST(RegionProfilerTest, SumsCountersPerRegion) {
+    core::Hart hart;
+    auto dram = std::make_shared<core::Dram>(1024 * 1024);
+    core::Bus bus(dram, false);
+    bus.add_device(std::make_shared<Probe>());
+
+    profile::RegionProfiler regions(hart, bus);
+    hart.set_region_profiler(&regions);
+
+    core::CSR& begin = *hart.csrs[core::REGIONMARKER::BEGIN_ADDRESS];
+    core::CSR& end = *hart.csrs[core::REGIONMARKER::END_ADDRESS];
+
+    // Each marker retires like any instruction; neither is counted
+    for (int run = 0; run < 2; run++) {
+        begin.write_unchecked(7);
+        hart.stats.instructions.add();
+        hart.stats.instructions.add(100);
+        (void)bus.read<uint32_t>(0x10000000);
+        hart.handle_trap(
+            core::Trap(hart.pc, core::TrapCause::IllegalInstruction, 0));
+        end.write_unchecked(7);
+        hart.stats.instructions.add();
+    }
+
+    // Outside any region
+    (void)bus.read<uint32_t>(0x10000000);
+    end.write_unchecked(3);
+    begin.write_unchecked(9);
+
+    EXPECT_EQ(begin.read_unchecked(), 0u);
+
+    const std::string json = regions.json();
+    EXPECT_NE(json.find(R"({"id": 7, "runs": 2, "instructions": 200, )"),
+              std::string::npos);
+    EXPECT_NE(json.find(R"("exceptions": 2, "interrupts": 0, )"
+                        R"("mmio_reads": 2, "mmio_writes": 0})"),
+              std::string::npos);
+    EXPECT_NE(json.find(R"("unclosed": [9])"), std::string::npos);
+    EXPECT_NE(json.find(R"("unmatched_ends": 1)"), std::string::npos);
+}
+
+TEST(RegionProfilerTest, MarkersAreInertWithoutProfiler) {
+    core::Hart hart;
+    hart.csrs[core::REGIONMARKER::BEGIN_ADDRESS]->write_unchecked(1);
+    hart.csrs[core::REGIONMARKER::END_ADDRESS]->write_unchecked(1);
+    EXPECT_EQ(hart.csrs[core::REGIONMARKER::END_ADDRESS]->read_unchecked(),
+              0u);
+}
+
+} // namespace uemu::test
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "core/bus.hpp"
+#include "core/mmu.hpp"
+#include "profile/sampler.hpp"
+
+#include "probe_device.hpp"
+
+namespace uemu::test {
+
+class SamplerTest : public ::testing::Test {
+protected:
+    static constexpr addr_t MAIN = core::Dram::DRAM_BASE + 0x1000;
+    static constexpr addr_t MID = MAIN + 0x100;
+    static constexpr addr_t LEAF = MID + 0x100;
+    static constexpr addr_t STACK = core::Dram::DRAM_BASE + 0x8000;
+
+    void SetUp() override {
+        hart = std::make_shared<core::Hart>();
+        dram = std::make_shared<core::Dram>(1024 * 1024);
+        bus = std::make_shared<core::Bus>(dram, false);
+        mmu = std::make_shared<core::MMU>(hart.get(), bus);
+        hart->connect_mmu(mmu.get());
+
+        output = std::filesystem::temp_directory_path() /
+                 "uemu_test_sampler.folded";
+
+        symbols = utils::SymbolTable({
+            {.name = "main", .addr = MAIN, .size = 0x100},
+            {.name = "mid", .addr = MID, .size = 0x100},
+            {.name = "leaf", .addr = LEAF, .size = 0x100},
+        });
+
+        // leaf's frame -> mid's frame -> main's frame (end of chain)
+        const addr_t fp_mid = STACK;
+        const addr_t fp_main = STACK + 0x100;
+        dram->write<uint64_t>(fp_mid - 8, MID + 0x10);
+        dram->write<uint64_t>(fp_mid - 16, fp_main);
+        dram->write<uint64_t>(fp_main - 8, MAIN + 0x20);
+        dram->write<uint64_t>(fp_main - 16, 0);
+
+        hart->pc = LEAF + 4;
+        hart->gprs.write(8, fp_mid);
+    }
+
+    void TearDown() override { std::filesystem::remove(output); }
+
+    std::string report() {
+        std::ifstream in(output);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    std::shared_ptr<core::Hart> hart;
+    std::shared_ptr<core::Dram> dram;
+    std::shared_ptr<core::Bus> bus;
+    std::shared_ptr<core::MMU> mmu;
+    std::filesystem::path output;
+    utils::SymbolTable symbols;
+};
+
+TEST_F(SamplerTest, PeriodicFoldedStacks) {
+    profile::Sampler sampler(*hart, *mmu, *dram,
+                             {.output = output,
+                              .period = 2 * profile::Sampler::BATCH,
+                              .frequency = 0,
+                              .system_map = {},
+                              .comm_offset = {}});
+
+    for (int i = 0; i < 8; i++)
+        sampler.poll();
+    sampler.finish(symbols);
+
+    EXPECT_EQ(sampler.samples(), 4u);
+    EXPECT_EQ(sampler.dropped(), 0u);
+    EXPECT_EQ(report(), "[firmware];main;mid;leaf 4\n");
+}
+
+TEST_F(SamplerTest, UnknownFramesAndBadChain) {
+    profile::Sampler sampler(*hart, *mmu, *dram,
+                             {.output = output,
+                              .period = profile::Sampler::BATCH,
+                              .frequency = 0,
+                              .system_map = {},
+                              .comm_offset = {}});
+
+    // A frame pointer outside DRAM ends the chain without reading MMIO.
+    hart->pc = 0x1234;
+    hart->gprs.write(8, 0x10000000);
+    sampler.poll();
+    sampler.finish(symbols);
+
+    EXPECT_EQ(sampler.samples(), 1u);
+    EXPECT_EQ(report(), "[firmware];0x1234 1\n");
+}
+
+TEST_F(SamplerTest, SplitsByContextAndTask) {
+    constexpr addr_t TASK = core::Dram::DRAM_BASE + 0x4000;
+    constexpr uint64_t COMM = 0x5F8;
+    dram->write_bytes(TASK + COMM, "busybox", 8);
+
+    profile::Sampler sampler(*hart, *mmu, *dram,
+                             {.output = output,
+                              .period = profile::Sampler::BATCH,
+                              .frequency = 0,
+                              .system_map = {},
+                              .comm_offset = COMM});
+
+    // User code: current is parked in sscratch
+    hart->priv = core::PrivilegeLevel::U;
+    hart->csrs[core::SSCRATCH::ADDRESS]->write_unchecked(TASK);
+    sampler.poll();
+
+    // Kernel code: current is in tp
+    hart->priv = core::PrivilegeLevel::S;
+    hart->gprs.write(4, TASK);
+    sampler.poll();
+    sampler.finish(symbols);
+
+    EXPECT_EQ(sampler.breakdown().user, 1u);
+    EXPECT_EQ(sampler.breakdown().kernel, 1u);
+    EXPECT_EQ(sampler.breakdown().firmware, 0u);
+    EXPECT_EQ(sampler.breakdown().processes.at("busybox"), 1u);
+    EXPECT_EQ(report(), "[kernel];main;mid;leaf 1\n"
+                        "[user];[busybox];main;mid;leaf 1\n");
+}
+
+TEST_F(SamplerTest, UnwindingLeavesGuestStateAlone) {
+    // Sv39 gigapage mapping VA 0 to the start of DRAM, not yet accessed
+    constexpr addr_t ROOT = core::Dram::DRAM_BASE + 0x10000;
+    constexpr uint64_t PTE = (core::Dram::DRAM_BASE >> 12) << 10 |
+                             core::MMU::PTE_V | core::MMU::PTE_R |
+                             core::MMU::PTE_W | core::MMU::PTE_X;
+    dram->write<uint64_t>(ROOT, PTE);
+    hart->csrs[core::SATP::ADDRESS]->write_unchecked(8ULL << 60 | ROOT >> 12);
+    hart->priv = core::PrivilegeLevel::S;
+    hart->pc = LEAF + 4 - core::Dram::DRAM_BASE;
+    hart->gprs.write(8, STACK - core::Dram::DRAM_BASE);
+    // The saved frame pointer is a VA as well
+    dram->write<uint64_t>(STACK - 16, STACK + 0x100 - core::Dram::DRAM_BASE);
+
+    profile::Sampler sampler(*hart, *mmu, *dram,
+                             {.output = output,
+                              .period = profile::Sampler::BATCH,
+                              .frequency = 0,
+                              .system_map = {},
+                              .comm_offset = {}});
+    sampler.poll();
+    sampler.finish({});
+
+    EXPECT_EQ(sampler.samples(), 1u);
+    // Return addresses in the frames are DRAM addresses, not VAs
+    EXPECT_NE(report().find(std::format(";{:#x};{:#x};{:#x} 1",
+                                        MAIN + 0x20, MID + 0x10,
+                                        LEAF + 4 - core::Dram::DRAM_BASE)),
+              std::string::npos);
+    EXPECT_EQ(dram->read<uint64_t>(ROOT), PTE);
+    EXPECT_EQ(hart->stats.dtlb_hits.get(), 0u);
+    EXPECT_EQ(hart->stats.dtlb_misses.get(), 0u);
+    EXPECT_EQ(hart->stats.page_walks.get(), 0u);
+}
+
+TEST_F(SamplerTest, PageWalkNeverReadsMmio) {
+    // A root page table under construction pointing at a device
+    auto probe = std::make_shared<Probe>();
+    bus->add_device(probe);
+    hart->csrs[core::SATP::ADDRESS]->write_unchecked(8ULL << 60 |
+                                                     probe->start() >> 12);
+    hart->priv = core::PrivilegeLevel::S;
+    hart->gprs.write(4, 0x1000);
+
+    profile::Sampler sampler(*hart, *mmu, *dram,
+                             {.output = output,
+                              .period = profile::Sampler::BATCH,
+                              .frequency = 0,
+                              .system_map = {},
+                              .comm_offset = 0x5F8});
+    sampler.poll();
+    sampler.finish(symbols);
+
+    EXPECT_EQ(sampler.samples(), 1u);
+    EXPECT_EQ(probe->reads, 0u);
+}
+
+} // namespace uemu::test
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "core/mmu.hpp"
+#include "profile/stats_reporter.hpp"
+
+#include "probe_device.hpp"
+
+namespace uemu::test {
+
+class StatsReporterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        hart = std::make_shared<core::Hart>();
+        dram = std::make_shared<core::Dram>(1024 * 1024);
+        bus = std::make_shared<core::Bus>(dram, false);
+        mmu = std::make_shared<core::MMU>(hart.get(), bus);
+        hart->connect_mmu(mmu.get());
+        bus->add_device(std::make_shared<Probe>());
+    }
+
+    std::shared_ptr<core::Hart> hart;
+    std::shared_ptr<core::Dram> dram;
+    std::shared_ptr<core::Bus> bus;
+    std::shared_ptr<core::MMU> mmu;
+};
+
+TEST_F(StatsReporterTest, CountsTlbTrapsAndMmio) {
+    // Sv39 with a gigapage mapping VA 0 to the start of DRAM
+    constexpr addr_t ROOT = core::Dram::DRAM_BASE + 0x10000;
+    dram->write<uint64_t>(ROOT, (core::Dram::DRAM_BASE >> 12) << 10 |
+                                    core::MMU::PTE_V | core::MMU::PTE_R |
+                                    core::MMU::PTE_W | core::MMU::PTE_A |
+                                    core::MMU::PTE_D);
+    hart->csrs[core::SATP::ADDRESS]->write_unchecked(8ULL << 60 | ROOT >> 12);
+    hart->priv = core::PrivilegeLevel::S;
+
+    (void)mmu->read<uint64_t>(hart->pc, 0x1000);
+    (void)mmu->read<uint64_t>(hart->pc, 0x1008);
+
+    (void)bus->read<uint32_t>(0x10000000);
+    (void)bus->read<uint32_t>(0x10000004);
+    EXPECT_TRUE(bus->write<uint32_t>(0x10000000, 1));
+
+    hart->handle_trap(
+        core::Trap(hart->pc, core::TrapCause::IllegalInstruction, 0));
+
+    EXPECT_EQ(hart->stats.dtlb_hits.get(), 1u);
+    EXPECT_EQ(hart->stats.dtlb_misses.get(), 1u);
+    EXPECT_EQ(hart->stats.page_walks.get(), 1u);
+    EXPECT_EQ(hart->stats.exceptions[2].get(), 1u);
+
+    const std::string json =
+        profile::StatsReporter::json(*hart, *bus, std::chrono::seconds(1));
+    EXPECT_NE(json.find(R"("dtlb": {"hits": 1, "misses": 1, )"
+                        R"("hit_rate": 0.500000})"),
+              std::string::npos);
+    EXPECT_NE(json.find(R"("exceptions": {"2": 1})"), std::string::npos);
+    EXPECT_NE(json.find(R"({"device": "probe", "reads": 2, "writes": 1})"),
+              std::string::npos);
+}
+
+TEST_F(StatsReporterTest, DumpsOnSignal) {
+    const auto path =
+        std::filesystem::temp_directory_path() / "uemu_test_stats.json";
+    std::filesystem::remove(path);
+
+    profile::StatsReporter reporter(
+        *hart, *bus,
+        {.output = path, .interval = std::chrono::milliseconds(0),
+         .on_exit = false});
+    std::raise(SIGUSR1);
+
+    for (int i = 0; i < 50 && !std::filesystem::exists(path); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    reporter.finish();
+
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    EXPECT_NE(ss.str().find("\"mmio\""), std::string::npos);
+    std::filesystem::remove(path);
+}
+
+} // namespace uemu::test
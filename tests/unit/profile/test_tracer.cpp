@@ -0,0 +1,150 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "core/mmu.hpp"
+#include "profile/trace_decoder.hpp"
+#include "profile/tracer.hpp"
+#include "utils/mapped_file.hpp"
+
+namespace uemu::test {
+
+class TracerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        hart = std::make_shared<core::Hart>();
+        hart->pc = 0x1000;
+        output = std::filesystem::temp_directory_path() / "uemu_test.trace";
+
+        // nop; c.nop; nop at 0x1000, then nop; nop at 0x2000 and 0x3000
+        decoder.add_image(0x1000, {0x13, 0, 0, 0, 0x01, 0, 0x13, 0, 0, 0});
+        decoder.add_image(0x2000, {0x13, 0, 0, 0, 0x13, 0, 0, 0});
+        decoder.add_image(0x3000, {0x13, 0, 0, 0});
+    }
+
+    void TearDown() override { std::filesystem::remove(output); }
+
+    profile::TraceDecoder::Stats decode(std::string& text) {
+        const utils::MappedFile trace(output);
+        std::ostringstream out;
+        const auto stats = decoder.decode(trace.data(), out);
+        text = out.str();
+        return stats;
+    }
+
+    std::shared_ptr<core::Hart> hart;
+    std::filesystem::path output;
+    profile::TraceDecoder decoder;
+};
+
+TEST_F(TracerTest, RebuildsInstructionStream) {
+    profile::Tracer tracer(*hart, {.output = output, .ring_size = 0});
+
+    tracer.branch(0x1006, 0x2000);
+    hart->priv = core::PrivilegeLevel::S;
+    hart->pc = 0x3000;
+    tracer.trap(0x2004, 0x3000, core::TrapCause::IllegalInstruction);
+    hart->pc = 0x3004;
+    tracer.finish();
+
+    std::string text;
+    const auto stats = decode(text);
+
+    EXPECT_EQ(stats.instructions, 5u);
+    EXPECT_EQ(stats.branches, 1u);
+    EXPECT_EQ(stats.traps, 1u);
+    EXPECT_EQ(stats.gaps, 0u);
+    EXPECT_EQ(text, "# sync pc 0x1000 priv M satp 0x0\n"
+                    "1000: 00000013\n"
+                    "1004: 0001\n"
+                    "1006: 00000013\n"
+                    "2000: 00000013\n"
+                    "# exception 2 at 0x2004 -> 0x3000\n"
+                    "# context priv S\n"
+                    "3000: 00000013\n"
+                    "# end\n");
+}
+
+TEST_F(TracerTest, RecordsSatpSwitchInSMode) {
+    auto dram = std::make_shared<core::Dram>(1024 * 1024);
+    auto bus = std::make_shared<core::Bus>(dram, false);
+    core::MMU mmu(hart.get(), bus);
+    hart->connect_mmu(&mmu);
+    hart->priv = core::PrivilegeLevel::S;
+
+    profile::Tracer tracer(*hart, {.output = output, .ring_size = 0});
+
+    // The kernel switches address spaces and jumps, staying in S-mode
+    constexpr reg_t SATP = 8ULL << 60 | 1ULL << 44 | 0x80010;
+    hart->csrs[core::SATP::ADDRESS]->write_unchecked(SATP);
+    tracer.branch(0x1006, 0x2000);
+    hart->pc = 0x2004;
+    tracer.finish();
+
+    std::string text;
+    decode(text);
+    EXPECT_EQ(text, "# sync pc 0x1000 priv S satp 0x0\n"
+                    "1000: 00000013\n"
+                    "1004: 0001\n"
+                    "1006: 00000013\n"
+                    "# context priv S satp 0x8000100000080010\n"
+                    "2000: 00000013\n"
+                    "# end\n");
+}
+
+TEST_F(TracerTest, ChunksResyncAndRingKeepsTail) {
+    constexpr int LOOPS = 100000;
+
+    // A tight loop: each iteration is a taken branch back to 0x1000.
+    {
+        profile::Tracer tracer(*hart, {.output = output, .ring_size = 0});
+        for (int i = 0; i < LOOPS; i++)
+            tracer.branch(0x1006, 0x1000);
+        tracer.finish();
+
+        EXPECT_GT(tracer.bytes(), profile::Tracer::CHUNK_SIZE);
+        EXPECT_LT(tracer.bytes(), 3u * LOOPS); // ~2 bytes per branch
+
+        std::string text;
+        const auto stats = decode(text);
+        EXPECT_EQ(stats.branches, static_cast<uint64_t>(LOOPS));
+        EXPECT_EQ(stats.instructions, 3u * LOOPS);
+        EXPECT_EQ(stats.gaps, 0u);
+    }
+
+    {
+        constexpr size_t RING = profile::Tracer::CHUNK_SIZE;
+        profile::Tracer tracer(*hart, {.output = output, .ring_size = RING});
+        for (int i = 0; i < LOOPS; i++)
+            tracer.branch(0x1006, 0x1000);
+        tracer.finish();
+
+        EXPECT_LE(std::filesystem::file_size(output),
+                  2 * profile::Tracer::CHUNK_SIZE + 8);
+
+        std::string text;
+        const auto stats = decode(text);
+        EXPECT_GT(stats.branches, 0u);
+        EXPECT_LT(stats.branches, static_cast<uint64_t>(LOOPS));
+        EXPECT_EQ(stats.gaps, 0u);
+    }
+}
+
+} // namespace uemu::test
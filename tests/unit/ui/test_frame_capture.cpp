@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "device/simple_fb.hpp"
+#include "ui/frame_capture.hpp"
+
+namespace uemu::test {
+
+class FrameCaptureTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fb = std::make_shared<device::SimpleFB>();
+        dir = std::filesystem::temp_directory_path() / "uemu_frame_capture";
+        std::filesystem::remove_all(dir);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    size_t count_dumps() const {
+        size_t n = 0;
+        for ([[maybe_unused]] const auto& entry :
+             std::filesystem::directory_iterator(dir))
+            n++;
+        return n;
+    }
+
+    std::shared_ptr<device::SimpleFB> fb;
+    std::filesystem::path dir;
+};
+
+TEST_F(FrameCaptureTest, DumpsOnlyChangedFrames) {
+    ui::FrameCapture::Options options;
+    options.dir = dir;
+    options.format = ui::FrameCapture::Format::Raw;
+
+    ui::FrameCapture capture(fb, options);
+    const auto now = std::chrono::steady_clock::now();
+
+    capture.poll(now); // Initial frame
+    EXPECT_EQ(capture.frames_written(), 1u);
+
+    capture.poll(now); // Nothing written
+    EXPECT_EQ(capture.frames_written(), 1u);
+
+    // Rewriting identical pixels dirties rows but must not produce a dump.
+    EXPECT_TRUE(fb->write<uint32_t>(fb->start(), 0));
+    capture.poll(now);
+    EXPECT_EQ(capture.frames_written(), 1u);
+
+    EXPECT_TRUE(fb->write<uint32_t>(fb->start() + 4096, 0x00FF0000));
+    capture.poll(now);
+    EXPECT_EQ(capture.frames_written(), 2u);
+
+    EXPECT_EQ(count_dumps(), 2u);
+    EXPECT_EQ(std::filesystem::file_size(dir / "frame_000001.raw"),
+              device::SimpleFB::SIZE);
+}
+
+TEST_F(FrameCaptureTest, FixedRateStreamRepeatsFrames) {
+    std::filesystem::create_directories(dir);
+    const auto stream = dir / "video.raw";
+    const auto start = std::chrono::steady_clock::now();
+
+    {
+        ui::FrameCapture::Options options;
+        options.fps = 10;
+        options.stream = stream;
+
+        ui::FrameCapture capture(fb, options);
+
+        capture.poll(start);
+        capture.poll(start + std::chrono::milliseconds(50)); // Too early
+        capture.poll(start + std::chrono::milliseconds(100));
+        capture.poll(start + std::chrono::milliseconds(200));
+        EXPECT_FALSE(capture.finish().has_value());
+    }
+
+    EXPECT_EQ(std::filesystem::file_size(stream), 3 * device::SimpleFB::SIZE);
+}
+
+TEST_F(FrameCaptureTest, HashIgnoresPaddingByte) {
+    std::vector<uint8_t> a(256, 0), b(256, 0);
+
+    b[3] = 0xFF; // X byte of the first pixel
+    EXPECT_EQ(ui::FrameCapture::hash_frame(a.data(), a.size()),
+              ui::FrameCapture::hash_frame(b.data(), b.size()));
+
+    b[200] = 1;
+    EXPECT_NE(ui::FrameCapture::hash_frame(a.data(), a.size()),
+              ui::FrameCapture::hash_frame(b.data(), b.size()));
+}
+
+TEST_F(FrameCaptureTest, CompareWithTolerance) {
+    std::vector<uint8_t> a(16, 100), b(16, 100);
+
+    b[0] = 103;  // Pixel 0: delta 3
+    b[6] = 90;   // Pixel 1: delta 10
+    b[11] = 0;   // Pixel 2: X byte only
+
+    auto r = ui::FrameCapture::compare_frames(a.data(), b.data(), a.size(), 3);
+    EXPECT_EQ(r.mismatched_pixels, 1u);
+    EXPECT_EQ(r.max_delta, 10u);
+
+    r = ui::FrameCapture::compare_frames(a.data(), b.data(), a.size(), 0);
+    EXPECT_EQ(r.mismatched_pixels, 2u);
+}
+
+} // namespace uemu::test
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+#include "device/imsic.hpp"
+#include "profile/region_profiler.hpp"
+#include "utils/checkpoint.hpp"
+
+namespace uemu::test {
+
+class CheckpointTest : public ::testing::Test {
+protected:
+    static constexpr size_t DRAM_SIZE = 16 * 1024 * 1024;
+    static constexpr addr_t MTIMECMP =
+        device::Clint::DEFAULT_BASE + device::Clint::MTIMECMP_OFFSET;
+
+    void SetUp() override {
+        path = std::filesystem::temp_directory_path() / "uemu_test.ckpt";
+    }
+
+    void TearDown() override { std::filesystem::remove(path); }
+
+    std::filesystem::path path;
+};
+
+TEST_F(CheckpointTest, RestoresHartDramAndClint) {
+    auto hart = std::make_shared<core::Hart>();
+    core::Dram dram(DRAM_SIZE);
+    device::Clint clint(hart, 1000);
+    hart->set_clint(&clint);
+
+    hart->pc = core::Dram::DRAM_BASE + 0x1234;
+    hart->priv = core::PrivilegeLevel::S;
+    hart->gprs.write(5, 0xdeadbeef);
+    hart->fprs[3].write_64(float64_t{0x4000000000000000});
+    hart->csrs[core::MSCRATCH::ADDRESS]->write_unchecked(0x55aa);
+    hart->csrs[core::MSTATUS::ADDRESS]->write_unchecked(
+        core::MSTATUS::Field::SUM | core::MSTATUS::Field::MPIE);
+    dram.write<uint64_t>(core::Dram::DRAM_BASE + 0x8000, 0x0123456789abcdef);
+    ASSERT_TRUE(clint.write<uint64_t>(MTIMECMP, 0x1000000));
+
+    utils::Checkpoint::save(path, *hart, dram, &clint,
+                            {.interval = 42, .warmup = 10, .length = 100});
+
+    auto other = std::make_shared<core::Hart>();
+    core::Dram other_dram(DRAM_SIZE);
+    device::Clint other_clint(other, 1000);
+    other->set_clint(&other_clint);
+    // Left behind by loading the program again; zero at checkpoint time
+    other_dram.write<uint32_t>(core::Dram::DRAM_BASE + 0x20000, 7);
+
+    const utils::Checkpoint::Slice slice =
+        utils::Checkpoint::restore(path, *other, other_dram, &other_clint);
+    EXPECT_EQ(slice.interval, 42u);
+    EXPECT_EQ(slice.warmup, 10u);
+    EXPECT_EQ(slice.length, 100u);
+
+    EXPECT_EQ(other->pc, hart->pc);
+    EXPECT_EQ(other->priv, core::PrivilegeLevel::S);
+    EXPECT_EQ(other->gprs[5], 0xdeadbeefu);
+    EXPECT_EQ(other->fprs[3].read_64().v, 0x4000000000000000u);
+    EXPECT_EQ(other_dram.read<uint64_t>(core::Dram::DRAM_BASE + 0x8000),
+              0x0123456789abcdefu);
+    EXPECT_EQ(other_dram.read<uint32_t>(core::Dram::DRAM_BASE + 0x20000), 0u);
+    EXPECT_EQ(other_clint.read<uint64_t>(MTIMECMP), 0x1000000u);
+
+    for (size_t i = 0; i < hart->csrs.size(); i++) {
+        const core::CSR* csr = hart->csrs[i].get();
+        if (dynamic_cast<const core::UnimplementedCSR*>(csr) ||
+            dynamic_cast<const core::ConstCSR*>(csr) ||
+            dynamic_cast<const core::REGIONMARKER*>(csr) ||
+            dynamic_cast<const core::IREGCSR*>(csr) ||
+            dynamic_cast<const core::TOPEICSR*>(csr))
+            continue;
+        EXPECT_EQ(other->csrs[i]->read_unchecked(), csr->read_unchecked());
+    }
+}
+
+TEST_F(CheckpointTest, RejectsOtherDramSize) {
+    auto hart = std::make_shared<core::Hart>();
+    core::Dram dram(DRAM_SIZE);
+    utils::Checkpoint::save(path, *hart, dram, nullptr, {});
+
+    core::Dram bigger(2 * DRAM_SIZE);
+    EXPECT_THROW(utils::Checkpoint::restore(path, *hart, bigger, nullptr),
+                 std::runtime_error);
+}
+
+TEST_F(CheckpointTest, RejectsReservedPrivilegeLevel) {
+    auto hart = std::make_shared<core::Hart>();
+    core::Dram dram(DRAM_SIZE);
+    hart->priv = static_cast<core::PrivilegeLevel>(2); // Reserved encoding
+    utils::Checkpoint::save(path, *hart, dram, nullptr, {});
+
+    auto other = std::make_shared<core::Hart>();
+    EXPECT_THROW(utils::Checkpoint::restore(path, *other, dram, nullptr),
+                 std::runtime_error);
+    EXPECT_EQ(other->priv, core::PrivilegeLevel::M);
+}
+
+TEST_F(CheckpointTest, SkipsRegionMarkers) {
+    auto hart = std::make_shared<core::Hart>();
+    core::Dram dram(DRAM_SIZE);
+    utils::Checkpoint::save(path, *hart, dram, nullptr, {});
+
+    // Restoring must not replay region_begin(0) / region_end(0)
+    auto other = std::make_shared<core::Hart>();
+    auto other_dram = std::make_shared<core::Dram>(DRAM_SIZE);
+    core::Bus bus(other_dram, false);
+    profile::RegionProfiler regions(*other, bus);
+    other->set_region_profiler(&regions);
+
+    utils::Checkpoint::restore(path, *other, *other_dram, nullptr);
+
+    const std::string json = regions.json();
+    EXPECT_NE(json.find(R"("unclosed": [])"), std::string::npos);
+    EXPECT_NE(json.find(R"("unmatched_ends": 0)"), std::string::npos);
+}
+
+TEST_F(CheckpointTest, LeavesImsicInterruptsAlone) {
+    auto hart = std::make_shared<core::Hart>();
+    core::Dram dram(DRAM_SIZE);
+    utils::Checkpoint::save(path, *hart, dram, nullptr, {});
+
+    // Writing stopei back would claim the pending interrupt.
+    auto other = std::make_shared<core::Hart>();
+    core::Dram other_dram(DRAM_SIZE);
+    device::Imsic imsic(other, false);
+    other->csrs[core::SISELECT::ADDRESS]->write_unchecked(device::Imsic::EIE0);
+    other->csrs[core::SIREG::ADDRESS]->write_unchecked(1ULL << 5);
+    other->csrs[core::SISELECT::ADDRESS]->write_unchecked(
+        device::Imsic::EIDELIVERY);
+    other->csrs[core::SIREG::ADDRESS]->write_unchecked(1);
+    imsic.send_msi(5);
+
+    utils::Checkpoint::restore(path, *other, other_dram, nullptr);
+    EXPECT_EQ(other->csrs[core::STOPEI::ADDRESS]->read_unchecked(),
+              (5ULL << 16) | 5);
+}
+
+} // namespace uemu::test
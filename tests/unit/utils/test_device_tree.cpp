@@ -0,0 +1,155 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "device/aplic.hpp"
+#include "device/clint.hpp"
+#include "device/imsic.hpp"
+#include "device/ns16550.hpp"
+#include "device/pflash_cfi01.hpp"
+#include "device/plic.hpp"
+#include "device/sifive_test.hpp"
+#include "utils/device_tree.hpp"
+
+namespace uemu::test {
+
+namespace {
+
+std::string prop_string(const utils::Fdt::Property* prop) {
+    return prop ? std::string(reinterpret_cast<const char*>(prop->value.data()))
+                : std::string();
+}
+
+uint32_t prop_cell(const utils::Fdt::Property* prop, size_t index) {
+    const uint8_t* p = prop->value.data() + index * 4;
+    return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) |
+           (uint32_t{p[2]} << 8) | uint32_t{p[3]};
+}
+
+} // namespace
+
+class DeviceTreeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        hart = std::make_shared<core::Hart>();
+        dram = std::make_shared<core::Dram>(256 * 1024 * 1024);
+        bus = std::make_shared<core::Bus>(dram);
+        bus->add_device(std::make_shared<device::Clint>(hart));
+    }
+
+    void add_common_devices(device::IrqDevice::IrqCallback irq) {
+        bus->add_device(std::make_shared<device::SiFiveTest>(
+            [](int, device::SiFiveTest::Status) -> void {}));
+        bus->add_device(std::make_shared<device::NS16550>(irq));
+        bus->add_device(
+            std::make_shared<device::PFlashCFI01>(0x20000000, 0x10000, 512));
+        bus->add_device(
+            std::make_shared<device::PFlashCFI01>(0x22000000, 0x10000, 512));
+    }
+
+    utils::Fdt build() {
+        utils::Fdt fdt = utils::DeviceTree::build(
+            *bus, {.dram_size = dram->size(),
+                   .num_harts = 1,
+                   .misa = hart->csrs[core::MISA::ADDRESS]->read_unchecked(),
+                   .timebase_frequency = device::Clint::DEFAULT_FREQ,
+                   .bootargs = "console=ttyS0"});
+
+        // Everything must survive a trip through the blob format.
+        return utils::Fdt::parse(fdt.serialize());
+    }
+
+    std::shared_ptr<core::Hart> hart;
+    std::shared_ptr<core::Dram> dram;
+    std::shared_ptr<core::Bus> bus;
+};
+
+TEST_F(DeviceTreeTest, DescribesMachine) {
+    auto plic = std::make_shared<device::Plic>(hart);
+    bus->add_device(plic);
+    add_common_devices([](uint32_t, bool) -> void {});
+
+    utils::Fdt fdt = build();
+
+    auto* memory = fdt.find("/memory@80000000");
+    ASSERT_NE(memory, nullptr);
+    EXPECT_EQ(prop_cell(memory->find_prop("reg"), 3), 256u * 1024 * 1024);
+
+    auto* cpu = fdt.find("/cpus/cpu@0");
+    ASSERT_NE(cpu, nullptr);
+    EXPECT_EQ(prop_string(cpu->find_prop("riscv,isa")), "rv64imafdc");
+    EXPECT_EQ(prop_cell(fdt.find("/cpus")->find_prop("timebase-frequency"), 0),
+              device::Clint::DEFAULT_FREQ);
+
+    auto* chosen = fdt.find("/chosen");
+    ASSERT_NE(chosen, nullptr);
+    EXPECT_EQ(prop_string(chosen->find_prop("bootargs")), "console=ttyS0");
+    EXPECT_EQ(prop_string(chosen->find_prop("stdout-path")),
+              "/soc/uart@10000000");
+
+    // The UART is wired to the PLIC with a single interrupt cell.
+    auto* plic_node = fdt.find("/soc/interrupt-controller@c000000");
+    auto* uart = fdt.find("/soc/uart@10000000");
+    ASSERT_NE(plic_node, nullptr);
+    ASSERT_NE(uart, nullptr);
+    EXPECT_EQ(prop_cell(uart->find_prop("interrupt-parent"), 0),
+              prop_cell(plic_node->find_prop("phandle"), 0));
+    EXPECT_EQ(uart->find_prop("interrupts")->value.size(), 4u);
+
+    // Both flash banks share one node.
+    auto* flash = fdt.find("/flash@20000000");
+    ASSERT_NE(flash, nullptr);
+    EXPECT_EQ(flash->find_prop("reg")->value.size(), 32u);
+    EXPECT_EQ(prop_cell(flash->find_prop("reg"), 5), 0x22000000u);
+
+    auto* poweroff = fdt.find("/poweroff");
+    ASSERT_NE(poweroff, nullptr);
+    EXPECT_EQ(prop_cell(poweroff->find_prop("value"), 0),
+              device::SiFiveTest::PASS);
+}
+
+TEST_F(DeviceTreeTest, DescribesAia) {
+    bus->add_device(std::make_shared<device::Imsic>(hart, true));
+    bus->add_device(std::make_shared<device::Imsic>(hart, false));
+    bus->add_device(std::make_shared<device::Aplic>(
+        [](addr_t, uint32_t) -> void {}, false,
+        device::Imsic::DEFAULT_S_BASE));
+    add_common_devices([](uint32_t, bool) -> void {});
+
+    utils::Fdt fdt = build();
+
+    auto* aplic = fdt.find("/soc/interrupt-controller@d000000");
+    auto* imsic_s = fdt.find("/soc/interrupt-controller@28000000");
+    auto* uart = fdt.find("/soc/uart@10000000");
+    ASSERT_NE(aplic, nullptr);
+    ASSERT_NE(imsic_s, nullptr);
+    ASSERT_NE(uart, nullptr);
+
+    EXPECT_EQ(prop_cell(aplic->find_prop("msi-parent"), 0),
+              prop_cell(imsic_s->find_prop("phandle"), 0));
+    EXPECT_EQ(prop_cell(uart->find_prop("interrupt-parent"), 0),
+              prop_cell(aplic->find_prop("phandle"), 0));
+    EXPECT_EQ(uart->find_prop("interrupts")->value.size(), 8u);
+
+    const auto* exts =
+        fdt.find("/cpus/cpu@0")->find_prop("riscv,isa-extensions");
+    ASSERT_NE(exts, nullptr);
+    const std::string all(exts->value.begin(), exts->value.end());
+    EXPECT_NE(all.find("ssaia"), std::string::npos);
+}
+
+} // namespace uemu::test
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <elf.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/elfloader.hpp"
+
+namespace uemu::test {
+
+namespace {
+
+constexpr addr_t BASE = core::Dram::DRAM_BASE;
+constexpr size_t FILESZ = 0x2100; // Two whole pages and a partial one
+constexpr size_t MEMSZ = 0x3000;
+constexpr size_t SEGMENT_OFFSET = 0x1000;
+
+// One PT_LOAD segment followed by a .symtab/.strtab pair
+std::vector<uint8_t> build_elf() {
+    const char strings[] = "\0tohost\0_start\0__stack_size";
+    const size_t symtab_off = SEGMENT_OFFSET + FILESZ;
+    const size_t strtab_off = symtab_off + 4 * sizeof(Elf64_Sym);
+    const size_t shdr_off = (strtab_off + sizeof(strings) + 7) & ~size_t{7};
+
+    std::vector<uint8_t> image(shdr_off + 3 * sizeof(Elf64_Shdr), 0);
+
+    Elf64_Ehdr ehdr{};
+    std::memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_type = ET_EXEC;
+    ehdr.e_machine = EM_RISCV;
+    ehdr.e_entry = BASE + 0x100;
+    ehdr.e_phoff = sizeof(Elf64_Ehdr);
+    ehdr.e_phentsize = sizeof(Elf64_Phdr);
+    ehdr.e_phnum = 1;
+    ehdr.e_shoff = shdr_off;
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = 3;
+    std::memcpy(image.data(), &ehdr, sizeof(ehdr));
+
+    Elf64_Phdr phdr{};
+    phdr.p_type = PT_LOAD;
+    phdr.p_offset = SEGMENT_OFFSET;
+    phdr.p_vaddr = phdr.p_paddr = BASE;
+    phdr.p_filesz = FILESZ;
+    phdr.p_memsz = MEMSZ;
+    std::memcpy(image.data() + ehdr.e_phoff, &phdr, sizeof(phdr));
+
+    for (size_t i = 0; i < FILESZ; i++)
+        image[SEGMENT_OFFSET + i] = static_cast<uint8_t>(i * 7 + 1);
+
+    Elf64_Sym syms[4]{};
+    syms[1].st_name = 1;
+    syms[1].st_info = ELF64_ST_INFO(STB_GLOBAL, STT_OBJECT);
+    syms[1].st_shndx = 1;
+    syms[1].st_value = BASE + 0x10;
+    syms[1].st_size = 8;
+    syms[2].st_name = 8;
+    syms[2].st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+    syms[2].st_shndx = 1;
+    syms[2].st_value = BASE + 0x100;
+    syms[3].st_name = 15; // A linker-script constant
+    syms[3].st_info = ELF64_ST_INFO(STB_GLOBAL, STT_NOTYPE);
+    syms[3].st_shndx = SHN_ABS;
+    syms[3].st_value = 0x4000;
+    std::memcpy(image.data() + symtab_off, syms, sizeof(syms));
+    std::memcpy(image.data() + strtab_off, strings, sizeof(strings));
+
+    Elf64_Shdr shdrs[3]{};
+    shdrs[1].sh_type = SHT_SYMTAB;
+    shdrs[1].sh_offset = symtab_off;
+    shdrs[1].sh_size = sizeof(syms);
+    shdrs[1].sh_link = 2;
+    shdrs[1].sh_entsize = sizeof(Elf64_Sym);
+    shdrs[2].sh_type = SHT_STRTAB;
+    shdrs[2].sh_offset = strtab_off;
+    shdrs[2].sh_size = sizeof(strings);
+    std::memcpy(image.data() + shdr_off, shdrs, sizeof(shdrs));
+
+    return image;
+}
+
+// Writes `image` under a name unique to the test and the process, so that
+// concurrently running tests never share a file.
+std::filesystem::path write_temp_elf(const std::vector<uint8_t>& image) {
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() /
+        ("uemu_" +
+         std::string(testing::UnitTest::GetInstance()
+                         ->current_test_info()
+                         ->name()) +
+         "_" + std::to_string(::getpid()) + ".elf");
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char*>(image.data()),
+               static_cast<std::streamsize>(image.size()));
+    return path;
+}
+
+} // namespace
+
+TEST(ElfLoaderTest, LoadsSegmentsAndSymbols) {
+    const std::vector<uint8_t> image = build_elf();
+    const std::filesystem::path path = write_temp_elf(image);
+
+    core::Dram dram(1024 * 1024);
+    dram.fill(BASE, 0xAA, MEMSZ); // bss must be cleared, not assumed zero
+
+    const utils::ElfLoader::Image loaded = utils::ElfLoader::load(path, dram);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(loaded.entry, BASE + 0x100);
+    EXPECT_EQ(loaded.load_base, BASE);
+    ASSERT_EQ(loaded.segments.size(), 1u);
+    EXPECT_EQ(loaded.segments[0].start, BASE);
+    EXPECT_EQ(loaded.segments[0].end, BASE + MEMSZ);
+
+    std::vector<uint8_t> mem(MEMSZ);
+    dram.read_bytes(BASE, mem.data(), mem.size());
+    EXPECT_TRUE(std::equal(mem.begin(), mem.begin() + FILESZ,
+                           image.begin() + SEGMENT_OFFSET));
+    EXPECT_TRUE(std::all_of(mem.begin() + FILESZ, mem.end(),
+                            [](uint8_t b) { return b == 0; }));
+
+    EXPECT_EQ(loaded.symbols.lookup("tohost"), BASE + 0x10);
+    ASSERT_NE(loaded.symbols.find(BASE + 0x104), nullptr);
+    EXPECT_EQ(loaded.symbols.find(BASE + 0x104)->name, "_start");
+    EXPECT_FALSE(loaded.symbols.lookup("__stack_size"));
+}
+
+TEST(ElfLoaderTest, MapsSegmentsCopyOnWrite) {
+    const std::vector<uint8_t> image = build_elf();
+    const std::filesystem::path path = write_temp_elf(image);
+
+    core::Dram dram(1024 * 1024);
+    utils::ElfLoader::load(path, dram, true);
+
+    std::vector<uint8_t> mem(FILESZ);
+    dram.read_bytes(BASE, mem.data(), mem.size());
+    EXPECT_TRUE(
+        std::equal(mem.begin(), mem.end(), image.begin() + SEGMENT_OFFSET));
+
+    // Guest stores never reach the file.
+    dram.write<uint8_t>(BASE + 0x1000, 0x55);
+    EXPECT_EQ(dram.read<uint8_t>(BASE + 0x1000), 0x55);
+    std::ifstream in(path, std::ios::binary);
+    in.seekg(SEGMENT_OFFSET + 0x1000);
+    EXPECT_EQ(in.get(), image[SEGMENT_OFFSET + 0x1000]);
+    std::filesystem::remove(path);
+}
+
+} // namespace uemu::test
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "utils/fdt.hpp"
+
+namespace uemu::test {
+
+TEST(FdtTest, RoundTrip) {
+    utils::Fdt fdt;
+    fdt.root().set_u32("#address-cells", 2);
+    fdt.root().set_string("compatible", "uemu,virt");
+
+    auto& memory = fdt.root().child("memory@80000000");
+    memory.set_string("device_type", "memory");
+    memory.set_cells("reg", {0x0, 0x80000000, 0x0, 0x20000000});
+
+    auto& chosen = fdt.root().child("chosen");
+    chosen.set_string("bootargs", "console=ttyS0");
+    chosen.set_u64("linux,initrd-start", 0x9000000012345678ULL);
+
+    const auto blob = fdt.serialize();
+    ASSERT_GE(blob.size(), 40u);
+    EXPECT_EQ(blob[0], 0xd0);
+    EXPECT_EQ(blob[3], 0xed);
+
+    utils::Fdt parsed = utils::Fdt::parse(blob);
+    EXPECT_EQ(parsed.serialize(), blob);
+
+    auto* mem = parsed.find("/memory@80000000");
+    ASSERT_NE(mem, nullptr);
+    const auto* reg = mem->find_prop("reg");
+    ASSERT_NE(reg, nullptr);
+    EXPECT_EQ(reg->value.size(), 16u);
+    EXPECT_EQ(reg->value[7], 0x00); // low byte of 0x80000000
+    EXPECT_EQ(reg->value[4], 0x80);
+
+    auto* ch = parsed.find("/chosen");
+    ASSERT_NE(ch, nullptr);
+    const auto* bootargs = ch->find_prop("bootargs");
+    ASSERT_NE(bootargs, nullptr);
+    EXPECT_EQ(std::string(bootargs->value.begin(), bootargs->value.end()),
+              std::string("console=ttyS0", 14));
+
+    EXPECT_EQ(parsed.find("/nonexistent"), nullptr);
+}
+
+TEST(FdtTest, EditAndRemove) {
+    utils::Fdt fdt;
+    auto& chosen = fdt.root().child("chosen");
+    chosen.set_string("bootargs", "a");
+    chosen.set_string("bootargs", "bb");
+    chosen.set_empty("flag");
+
+    EXPECT_EQ(chosen.props.size(), 2u);
+    EXPECT_EQ(chosen.find_prop("bootargs")->value.size(), 3u);
+
+    chosen.remove_prop("flag");
+    EXPECT_EQ(chosen.find_prop("flag"), nullptr);
+    EXPECT_EQ(&fdt.root().child("chosen"), &chosen);
+}
+
+TEST(FdtTest, RejectsMalformedBlob) {
+    std::vector<uint8_t> junk(64, 0);
+    EXPECT_THROW(std::ignore = utils::Fdt::parse(junk), std::runtime_error);
+
+    utils::Fdt fdt;
+    fdt.root().child("cpus");
+    auto blob = fdt.serialize();
+    blob.resize(blob.size() - 8); // Truncate
+    EXPECT_THROW(std::ignore = utils::Fdt::parse(blob), std::runtime_error);
+}
+
+} // namespace uemu::test
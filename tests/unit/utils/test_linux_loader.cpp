@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "utils/linux_loader.hpp"
+
+namespace uemu::test {
+
+class LinuxLoaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = std::filesystem::temp_directory_path() / "uemu_linux_loader";
+        std::filesystem::create_directories(dir);
+        dram = std::make_shared<core::Dram>(64 * 1024 * 1024);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    std::filesystem::path write_file(const std::string& name,
+                                     const std::vector<uint8_t>& data) {
+        const auto path = dir / name;
+        std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+        return path;
+    }
+
+    std::filesystem::path dir;
+    std::shared_ptr<core::Dram> dram;
+};
+
+TEST_F(LinuxLoaderTest, PlacesImageInitrdAndDtb) {
+    // Minimal Image header: text_offset = 0x400000, magic2 = "RSC\x05"
+    std::vector<uint8_t> image(4096, 0);
+    image[0] = 0x13; // nop
+    image[10] = 0x40;
+    std::memcpy(image.data() + 56, "RSC\x05", 4);
+
+    utils::LinuxLoader::Options opts{
+        .kernel = write_file("Image", image),
+        .initrd = write_file("initrd", std::vector<uint8_t>(10000, 0xAB)),
+        .append = "console=ttyS0 earlycon=sbi",
+    };
+
+    utils::Fdt fdt;
+    const auto info = utils::LinuxLoader::load(opts, fdt, *dram);
+
+    EXPECT_EQ(info.entry, core::Dram::DRAM_BASE + 0x400000);
+    EXPECT_EQ(dram->read<uint8_t>(info.entry), 0x13);
+
+    EXPECT_EQ(info.dtb_addr % 0x200000, 0u);
+    EXPECT_EQ(info.initrd_end - info.initrd_start, 10000u);
+    EXPECT_LE(info.initrd_end, info.dtb_addr);
+    EXPECT_EQ(dram->read<uint8_t>(info.initrd_start), 0xAB);
+
+    // The device tree in DRAM carries the command line and initrd range.
+    std::vector<uint8_t> blob(utils::LinuxLoader::MAX_FDT_SIZE);
+    dram->read_bytes(info.dtb_addr, blob.data(), blob.size());
+    utils::Fdt placed = utils::Fdt::parse(blob);
+
+    auto* chosen = placed.find("/chosen");
+    ASSERT_NE(chosen, nullptr);
+    ASSERT_NE(chosen->find_prop("bootargs"), nullptr);
+    const auto* start = chosen->find_prop("linux,initrd-start");
+    ASSERT_NE(start, nullptr);
+    EXPECT_EQ(start->value.size(), 8u);
+}
+
+TEST_F(LinuxLoaderTest, RejectsOversizedInitrd) {
+    utils::LinuxLoader::Options opts{
+        .kernel = write_file("Image", std::vector<uint8_t>(4096, 0)),
+        .initrd = write_file("initrd",
+                             std::vector<uint8_t>(64 * 1024 * 1024, 0)),
+        .append = "",
+    };
+
+    utils::Fdt fdt;
+    EXPECT_THROW(utils::LinuxLoader::load(opts, fdt, *dram),
+                 std::runtime_error);
+}
+
+} // namespace uemu::test
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026 Nuo Shen, Nanjing University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "utils/symbol_table.hpp"
+
+namespace uemu::test {
+
+TEST(SymbolTableTest, LooksUpByNameAndAddress) {
+    const utils::SymbolTable table({
+        {.name = "main", .addr = 0x1000, .size = 0x40},
+        {.name = "_start", .addr = 0x800, .size = 0},
+        {.name = "helper", .addr = 0x1100, .size = 0x10},
+        {.name = "main_label", .addr = 0x1000, .size = 0},
+    });
+
+    EXPECT_EQ(table.size(), 4u);
+    EXPECT_EQ(table.lookup("helper"), 0x1100u);
+    EXPECT_EQ(table.lookup("missing"), std::nullopt);
+
+    // Sized symbols win over labels at the same address.
+    ASSERT_NE(table.find(0x1000), nullptr);
+    EXPECT_EQ(table.find(0x1000)->name, "main");
+    EXPECT_EQ(table.find(0x103F)->name, "main");
+    EXPECT_EQ(table.find(0x1040), nullptr); // Past the end of main
+
+    // Unsized symbols extend to the next one.
+    EXPECT_EQ(table.find(0x900)->name, "_start");
+    EXPECT_EQ(table.find(0x7FF), nullptr);
+    EXPECT_EQ(table.find(0x110F)->name, "helper");
+}
+
+TEST(SymbolTableTest, LoadsSystemMap) {
+    const auto path =
+        std::filesystem::temp_directory_path() / "uemu_test_System.map";
+    std::ofstream(path) << "ffffffff80000000 T _start\n"
+                           "ffffffff80001000 t do_idle\n"
+                           "ffffffff80002000 D jiffies\n"
+                           "garbage line\n"
+                           "ffffffff80003000 W arch_cpu_idle\n";
+
+    const utils::SymbolTable table = utils::SymbolTable::load_system_map(path);
+    std::filesystem::remove(path);
+
+    // Only text symbols are kept.
+    EXPECT_EQ(table.size(), 3u);
+    EXPECT_EQ(table.lookup("jiffies"), std::nullopt);
+    EXPECT_EQ(table.find(0xffffffff80002010)->name, "do_idle");
+    EXPECT_EQ(table.find(0xffffffff80003004)->name, "arch_cpu_idle");
+}
+
+} // namespace uemu::test